@@ -0,0 +1,120 @@
+#include "Cpu.h"
+
+#include "Simd.h"
+
+#if ODM_ARCH_X86
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+namespace odm
+{
+#if ODM_ARCH_X86
+	static void QueryCpuid(int leaf, int subLeaf, unsigned int regs[4])
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuidex(info, leaf, subLeaf);
+		for (int i = 0; i < 4; ++i)
+			regs[i] = static_cast<unsigned int>(info[i]);
+#else
+		regs[0] = regs[1] = regs[2] = regs[3] = 0;
+		__get_cpuid_count(leaf, subLeaf, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+	}
+
+	static unsigned long long QueryXcr0()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned int eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	}
+
+	static CpuFeatures DetectCpuFeatures()
+	{
+		CpuFeatures features;
+		unsigned int regs[4];
+
+		QueryCpuid(0, 0, regs);
+		const unsigned int maxLeaf = regs[0];
+		// "AuthenticAMD", or "HygonGenuine", whose processors are built on AMD's Zen cores and share their microcode pdep.
+		const bool amd = (regs[1] == 0x68747541 && regs[3] == 0x69746E65 && regs[2] == 0x444D4163)
+			|| (regs[1] == 0x6F677948 && regs[3] == 0x6E65476E && regs[2] == 0x656E6975);
+		if (maxLeaf < 1)
+			return features;
+
+		QueryCpuid(1, 0, regs);
+		const unsigned int ecx1 = regs[2];
+		const unsigned int baseFamily = (regs[0] >> 8) & 0xF;
+		const unsigned int family = baseFamily == 0xF ? baseFamily + ((regs[0] >> 20) & 0xFF) : baseFamily;
+		features.sse41 = (ecx1 & (1u << 19)) != 0;
+
+		// The AVX register state must be enabled by the OS (OSXSAVE + XCR0) before any VEX code may run.
+		const bool osxsave = (ecx1 & (1u << 27)) != 0;
+		const unsigned long long xcr0 = osxsave ? QueryXcr0() : 0;
+		const bool osAvx = (xcr0 & 0x6) == 0x6;
+		const bool osAvx512 = (xcr0 & 0xE6) == 0xE6;
+
+		features.avx = osAvx && (ecx1 & (1u << 28)) != 0;
+		features.fma = osAvx && (ecx1 & (1u << 12)) != 0;
+
+		if (maxLeaf >= 7)
+		{
+			QueryCpuid(7, 0, regs);
+			const unsigned int ebx7 = regs[1];
+			features.avx2 = features.avx && (ebx7 & (1u << 5)) != 0;
+			features.bmi2 = (ebx7 & (1u << 8)) != 0;
+			features.fastPdep = features.bmi2 && !(amd && family < 0x19);
+			features.avx512f = osAvx512 && (ebx7 & (1u << 16)) != 0;
+		}
+		return features;
+	}
+#endif
+
+	const CpuFeatures& GetCpuFeatures()
+	{
+#if ODM_ARCH_X86
+		static const CpuFeatures features = DetectCpuFeatures();
+#else
+		static const CpuFeatures features;
+#endif
+		return features;
+	}
+
+	bool IsSimdLevelSupported(SimdLevel level)
+	{
+#if ODM_SIMD_SSE
+		const CpuFeatures& features = GetCpuFeatures();
+		switch (level)
+		{
+		case SimdLevel::Baseline:	return true;
+		case SimdLevel::SSE41:		return features.sse41;
+		case SimdLevel::AVX2:		return features.avx2 && features.fma;
+		// Every kernel table runs its AVX2 kernels at this tier, so it needs their instructions as well.
+		case SimdLevel::AVX512:		return features.avx512f && features.avx2 && features.fma;
+		}
+		return false;
+#else
+		return level == SimdLevel::Baseline;
+#endif
+	}
+
+	SimdLevel GetSimdLevel()
+	{
+		static const SimdLevel level = []
+		{
+			if (IsSimdLevelSupported(SimdLevel::AVX512))	return SimdLevel::AVX512;
+			if (IsSimdLevelSupported(SimdLevel::AVX2))		return SimdLevel::AVX2;
+			if (IsSimdLevelSupported(SimdLevel::SSE41))		return SimdLevel::SSE41;
+			return SimdLevel::Baseline;
+		}();
+		return level;
+	}
+}
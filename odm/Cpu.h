@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef _CPU_H_
+#define _CPU_H_
+
+namespace odm
+{
+	/** Instruction set tiers the batch kernels are compiled for, in ascending order. */
+	enum class SimdLevel
+	{
+		Baseline,	// The compile-time backend selected in Simd.h (SSE2 or scalar).
+		SSE41,
+		AVX2,		// AVX2 together with FMA3.
+		// AVX-512 Foundation, along with AVX2 and FMA. Tables without kernels of their own for this tier return their AVX2 ones,
+		// among them all that work on the eight-lane packets: sixteen lanes would take two packets per call.
+		AVX512
+	};
+
+	/** Instruction set extensions reported by CPUID and enabled by the operating system. */
+	struct CpuFeatures
+	{
+		bool sse41 = false;
+		bool avx = false;
+		bool avx2 = false;
+		bool fma = false;
+		bool bmi2 = false;
+		bool fastPdep = false;	// BMI2 pdep and pext run in hardware; AMD (and Hygon) processors before Zen 3 emulate them in microcode.
+		bool avx512f = false;
+	};
+
+	/**
+	 * Queries the processor the first time it is called and caches the result.
+	 * @returns The features of the processor running this process.
+	 */
+	const CpuFeatures& GetCpuFeatures();
+
+	/**
+	 * Gets the highest tier supported by this processor.
+	 * Always SimdLevel::Baseline when the library is built with ODM_FORCE_SCALAR or for a non-x86 target.
+	 */
+	SimdLevel GetSimdLevel();
+
+	/**
+	 * Whether or not the kernels of the given tier can run on this processor.
+	 * @param level The tier to be checked.
+	 */
+	bool IsSimdLevelSupported(SimdLevel level);
+}
+
+#endif /* end of include guard: _CPU_H_ */
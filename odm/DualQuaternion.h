@@ -0,0 +1,180 @@
+#pragma once
+
+#ifndef _DUAL_QUATERNION_H_
+#define _DUAL_QUATERNION_H_
+
+#include <cassert>
+#include "Quaternion.h"
+#include "Span.h"
+
+namespace odm
+{
+	/**
+	 * Rigid transform stored as a unit dual quaternion: real is the rotation and dual is half the translation times the rotation.
+	 * Eight floats per transform, against sixteen for a Matrix4x4, and blends without the volume loss of linear blend skinning.
+	 */
+	struct DualQuaternion
+	{
+		Quaternion real;
+		Quaternion dual;
+
+		/** Constructs the identity transform. */
+		DualQuaternion();
+
+		/**
+		 * Constructs from raw parts.
+		 * @param real The rotation part.
+		 * @param dual The translation part, 0.5 * translation * real.
+		 */
+		DualQuaternion(const Quaternion& real, const Quaternion& dual);
+
+		/**
+		 * Constructs the transform that rotates, then translates.
+		 * @param rotation Unit quaternion of the rotation.
+		 * @param translation Translation applied after the rotation.
+		 */
+		DualQuaternion(const Quaternion& rotation, const Vector3f& translation);
+
+		static DualQuaternion Identity();
+
+		/**
+		 * Converts a rigid matrix; scale and shear cannot be represented.
+		 * @param mat A rotation followed by a translation.
+		 */
+		static DualQuaternion FromMatrix(const Matrix4x4& mat);
+
+		Quaternion GetRotation() const;
+		Vector3f GetTranslation() const;
+		Matrix4x4 ToMatrix() const;
+
+		/**
+		 * Transforms a point: rotation, then translation.
+		 * @param point The point to be transformed; the transform must be normalized.
+		 */
+		Vector3f TransformPoint(const Vector3f& point) const;
+
+		/**
+		 * Rotates a direction, ignoring the translation.
+		 * @param vector The direction to be rotated; the transform must be normalized.
+		 */
+		Vector3f TransformVector(const Vector3f& vector) const;
+
+		/**
+		 * Composes two transforms; the right hand side applies first, as with Matrix4x4.
+		 * The product is not renormalized, see Normalize.
+		 */
+		DualQuaternion operator*(const DualQuaternion& dq) const;
+
+		DualQuaternion operator+(const DualQuaternion& dq) const;
+		DualQuaternion operator*(float scalar) const;
+		DualQuaternion operator-() const;
+
+		/** Inverts a unit dual quaternion. */
+		DualQuaternion Conjugate() const;
+	};
+
+	inline DualQuaternion::DualQuaternion()
+		: real(0.0f, 0.0f, 0.0f, 1.0f), dual(0.0f, 0.0f, 0.0f, 0.0f)
+	{}
+
+	inline DualQuaternion::DualQuaternion(const Quaternion& real, const Quaternion& dual)
+		: real(real), dual(dual)
+	{}
+
+	inline DualQuaternion::DualQuaternion(const Quaternion& rotation, const Vector3f& translation)
+		: real(rotation), dual(Quaternion(translation, 0.0f).MulNoNormalize(rotation) * 0.5f)
+	{}
+
+	inline DualQuaternion DualQuaternion::Identity() {
+		return DualQuaternion();
+	}
+
+	inline DualQuaternion DualQuaternion::FromMatrix(const Matrix4x4& mat) {
+		return DualQuaternion(Quaternion::FromMatrix(mat), Vector3f(mat.m[3].x, mat.m[3].y, mat.m[3].z));
+	}
+
+	inline Quaternion DualQuaternion::GetRotation() const {
+		return real;
+	}
+
+	inline Vector3f DualQuaternion::GetTranslation() const {
+		return (dual * 2.0f).MulNoNormalize(real.Conjugate()).GetXYZ();
+	}
+
+	inline Matrix4x4 DualQuaternion::ToMatrix() const {
+		Matrix4x4 result = real.ToMatrix();
+		result.m[3] = Vector4f(GetTranslation(), 1.0f);
+		return result;
+	}
+
+	inline Vector3f DualQuaternion::TransformPoint(const Vector3f& point) const {
+		// p + 2 r x (r x p + w p) + 2 (w d - dw r + r x d), with r, w the real part and d, dw the dual part.
+		const Vector3f r = real.GetXYZ();
+		const Vector3f d = dual.GetXYZ();
+		const Vector3f t = (d * real.w - r * dual.w + r.Cross(d)) * 2.0f;
+		return point + r.Cross(r.Cross(point) + point * real.w) * 2.0f + t;
+	}
+
+	inline Vector3f DualQuaternion::TransformVector(const Vector3f& vector) const {
+		const Vector3f r = real.GetXYZ();
+		return vector + r.Cross(r.Cross(vector) + vector * real.w) * 2.0f;
+	}
+
+	inline DualQuaternion DualQuaternion::operator*(const DualQuaternion& dq) const {
+		return DualQuaternion(real.MulNoNormalize(dq.real), real.MulNoNormalize(dq.dual) + dual.MulNoNormalize(dq.real));
+	}
+
+	inline DualQuaternion DualQuaternion::operator+(const DualQuaternion& dq) const {
+		return DualQuaternion(real + dq.real, dual + dq.dual);
+	}
+
+	inline DualQuaternion DualQuaternion::operator*(float scalar) const {
+		return DualQuaternion(real * scalar, dual * scalar);
+	}
+
+	inline DualQuaternion DualQuaternion::operator-() const {
+		return DualQuaternion(-real, -dual);
+	}
+
+	inline DualQuaternion DualQuaternion::Conjugate() const {
+		return DualQuaternion(real.Conjugate(), dual.Conjugate());
+	}
+
+	/**
+	 * Brings a blended dual quaternion back to a rigid transform: unit real part, dual part orthogonal to it.
+	 * @param dq The dual quaternion, e.g. a weighted sum of bone transforms.
+	 */
+	inline DualQuaternion Normalize(const DualQuaternion& dq) {
+		const float lenInv = 1.0f / std::sqrt(Norm(dq.real));
+		const Quaternion real = dq.real * lenInv;
+		const Quaternion dual = dq.dual * lenInv;
+		return DualQuaternion(real, dual - real * real.Dot(dual));
+	}
+
+	/**
+	 * Dual quaternion linear blending of two transforms along the shorter arc.
+	 * @param dq0 The transform at t = 0.
+	 * @param dq1 The transform at t = 1.
+	 * @param t Interpolation parameter, usually in [0, 1].
+	 */
+	inline DualQuaternion Blend(const DualQuaternion& dq0, const DualQuaternion& dq1, float t) {
+		const DualQuaternion end = dq0.real.Dot(dq1.real) < 0.0f ? -dq1 : dq1;
+		return Normalize(dq0 * (1.0f - t) + end * t);
+	}
+
+	/**
+	 * Dual quaternion linear blending of several transforms, e.g. the bones influencing one vertex.
+	 * Each transform is flipped into the hemisphere of the first before it is accumulated.
+	 * @param dqs The transforms to be blended, at least one.
+	 * @param weights One weight per transform; they need not sum to 1.
+	 */
+	inline DualQuaternion Blend(Span<const DualQuaternion> dqs, Span<const float> weights) {
+		assert(!dqs.empty() && dqs.size() == weights.size());
+		DualQuaternion sum = dqs[0] * weights[0];
+		for (size_t i = 1; i < dqs.size(); ++i)
+			sum = sum + dqs[i] * (dqs[0].real.Dot(dqs[i].real) < 0.0f ? -weights[i] : weights[i]);
+		return Normalize(sum);
+	}
+}
+
+#endif /* end of include guard: _DUAL_QUATERNION_H_ */
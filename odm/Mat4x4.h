@@ -59,7 +59,25 @@ namespace odm
 		inline void SetIdentity();
 		inline Matrix4x4 Transpose() const;
 		inline static Matrix4x4 Transpose(const Matrix4x4 &mat);
-		inline Matrix4x4 Inverse();
+
+		/**
+		 * Calculates the inverse of a general matrix with Cramer's rule.
+		 * The result is undefined for a singular matrix.
+		 */
+		inline Matrix4x4 Inverse() const;
+
+		/**
+		 * Calculates the inverse of an affine matrix: an invertible 3x3 block and a translation,
+		 * with the fourth row (0, 0, 0, 1).
+		 */
+		inline Matrix4x4 InverseAffine() const;
+
+		/**
+		 * Calculates the inverse of a rigid transform, a pure rotation followed by a translation.
+		 * The rotation is transposed and the translation rotated back and negated.
+		 */
+		inline Matrix4x4 InverseRigid() const;
+
 			
 		inline Vector4f &operator[](int colIndex);
 		inline Vector4f operator[](int colIndex) const;
@@ -40,7 +40,7 @@ namespace odm
 		m[0] = Vector4f(x0, x1, x2, x3);
 		m[1] = Vector4f(y0, y1, y2, y3);
 		m[2] = Vector4f(z0, z1, z2, z3);
-		m[3] = Vector4f(z0, z1, z2, z3);
+		m[3] = Vector4f(w0, w1, w2, w3);
 	}
 
 	void Matrix4x4::SetIdentity()
@@ -53,14 +53,17 @@ namespace odm
 
 	Matrix4x4 Matrix4x4::Transpose() const
 	{
-		Matrix4x4 result;
-
-		for (int col = 0; col < 3; ++col){
-			for (int row = 0; row < 3; ++row)
+		Matrix4x4 result(*this);
+#if ODM_SIMD_SSE
+		_MM_TRANSPOSE4_PS(result.m[0].simd, result.m[1].simd, result.m[2].simd, result.m[3].simd);
+#else
+		for (int col = 0; col < 4; ++col){
+			for (int row = 0; row < 4; ++row)
 			{
 				result[col][row] = m[row][col];
 			}
 		}
+#endif
 		return result;
 	}
 
@@ -68,9 +71,235 @@ namespace odm
 	{
 		return mat.Transpose();
 	}
+
+	Matrix4x4 Matrix4x4::Inverse() const
+	{
+#if ODM_SIMD_SSE
+		// Blockwise Cramer's rule on the 2x2 sub-matrices A B / C D, each held in one register.
+		// The columns are treated as rows: the inverse of the transpose is the transpose of the inverse.
+		// 2x2 products: A * B, adj(A) * B and A * adj(B).
+		const auto mul2 = [](__m128 a, __m128 b) {
+			return _mm_add_ps(
+				_mm_mul_ps(a, _mm_shuffle_ps(b, b, ODM_SHUFFLE(0, 3, 0, 3))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, ODM_SHUFFLE(1, 0, 3, 2)), _mm_shuffle_ps(b, b, ODM_SHUFFLE(2, 1, 2, 1))));
+		};
+		const auto adjMul2 = [](__m128 a, __m128 b) {
+			return _mm_sub_ps(
+				_mm_mul_ps(_mm_shuffle_ps(a, a, ODM_SHUFFLE(3, 3, 0, 0)), b),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, ODM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(b, b, ODM_SHUFFLE(2, 3, 0, 1))));
+		};
+		const auto mulAdj2 = [](__m128 a, __m128 b) {
+			return _mm_sub_ps(
+				_mm_mul_ps(a, _mm_shuffle_ps(b, b, ODM_SHUFFLE(3, 0, 3, 0))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, ODM_SHUFFLE(1, 0, 3, 2)), _mm_shuffle_ps(b, b, ODM_SHUFFLE(2, 1, 2, 1))));
+		};
+
+		const __m128 r0 = m[0].simd, r1 = m[1].simd, r2 = m[2].simd, r3 = m[3].simd;
+		const __m128 A = _mm_movelh_ps(r0, r1);
+		const __m128 B = _mm_movehl_ps(r1, r0);
+		const __m128 C = _mm_movelh_ps(r2, r3);
+		const __m128 D = _mm_movehl_ps(r3, r2);
+
+		// |A| |B| |C| |D|
+		const __m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(r0, r2, ODM_SHUFFLE(0, 2, 0, 2)), _mm_shuffle_ps(r1, r3, ODM_SHUFFLE(1, 3, 1, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(r0, r2, ODM_SHUFFLE(1, 3, 1, 3)), _mm_shuffle_ps(r1, r3, ODM_SHUFFLE(0, 2, 0, 2))));
+		const __m128 detA = _mm_shuffle_ps(detSub, detSub, ODM_SHUFFLE(0, 0, 0, 0));
+		const __m128 detB = _mm_shuffle_ps(detSub, detSub, ODM_SHUFFLE(1, 1, 1, 1));
+		const __m128 detC = _mm_shuffle_ps(detSub, detSub, ODM_SHUFFLE(2, 2, 2, 2));
+		const __m128 detD = _mm_shuffle_ps(detSub, detSub, ODM_SHUFFLE(3, 3, 3, 3));
+
+		const __m128 DC = adjMul2(D, C);
+		const __m128 AB = adjMul2(A, B);
+
+		__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mul2(B, DC));
+		__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mul2(C, AB));
+		__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mulAdj2(D, AB));
+		__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mulAdj2(A, DC));
+
+		// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+		__m128 tr = _mm_mul_ps(AB, _mm_shuffle_ps(DC, DC, ODM_SHUFFLE(0, 2, 1, 3)));
+		tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, ODM_SHUFFLE(1, 0, 3, 2)));
+		tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, ODM_SHUFFLE(2, 3, 0, 1)));
+		const __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+		const __m128 rcpDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+		X = _mm_mul_ps(X, rcpDet);
+		Y = _mm_mul_ps(Y, rcpDet);
+		Z = _mm_mul_ps(Z, rcpDet);
+		W = _mm_mul_ps(W, rcpDet);
+
+		Matrix4x4 result;
+		result.m[0].simd = _mm_shuffle_ps(X, Y, ODM_SHUFFLE(3, 1, 3, 1));
+		result.m[1].simd = _mm_shuffle_ps(X, Y, ODM_SHUFFLE(2, 0, 2, 0));
+		result.m[2].simd = _mm_shuffle_ps(Z, W, ODM_SHUFFLE(3, 1, 3, 1));
+		result.m[3].simd = _mm_shuffle_ps(Z, W, ODM_SHUFFLE(2, 0, 2, 0));
+		return result;
+#else
+		const float coef00 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+		const float coef02 = m[1][2] * m[3][3] - m[3][2] * m[1][3];
+		const float coef03 = m[1][2] * m[2][3] - m[2][2] * m[1][3];
+		const float coef04 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+		const float coef06 = m[1][1] * m[3][3] - m[3][1] * m[1][3];
+		const float coef07 = m[1][1] * m[2][3] - m[2][1] * m[1][3];
+		const float coef08 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+		const float coef10 = m[1][1] * m[3][2] - m[3][1] * m[1][2];
+		const float coef11 = m[1][1] * m[2][2] - m[2][1] * m[1][2];
+		const float coef12 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+		const float coef14 = m[1][0] * m[3][3] - m[3][0] * m[1][3];
+		const float coef15 = m[1][0] * m[2][3] - m[2][0] * m[1][3];
+		const float coef16 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+		const float coef18 = m[1][0] * m[3][2] - m[3][0] * m[1][2];
+		const float coef19 = m[1][0] * m[2][2] - m[2][0] * m[1][2];
+		const float coef20 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+		const float coef22 = m[1][0] * m[3][1] - m[3][0] * m[1][1];
+		const float coef23 = m[1][0] * m[2][1] - m[2][0] * m[1][1];
+
+		const vec4 fac0(coef00, coef00, coef02, coef03);
+		const vec4 fac1(coef04, coef04, coef06, coef07);
+		const vec4 fac2(coef08, coef08, coef10, coef11);
+		const vec4 fac3(coef12, coef12, coef14, coef15);
+		const vec4 fac4(coef16, coef16, coef18, coef19);
+		const vec4 fac5(coef20, coef20, coef22, coef23);
+
+		const vec4 v0(m[1][0], m[0][0], m[0][0], m[0][0]);
+		const vec4 v1(m[1][1], m[0][1], m[0][1], m[0][1]);
+		const vec4 v2(m[1][2], m[0][2], m[0][2], m[0][2]);
+		const vec4 v3(m[1][3], m[0][3], m[0][3], m[0][3]);
+
+		const vec4 inv0(v1 * fac0 - v2 * fac1 + v3 * fac2);
+		const vec4 inv1(v0 * fac0 - v2 * fac3 + v3 * fac4);
+		const vec4 inv2(v0 * fac1 - v1 * fac3 + v3 * fac5);
+		const vec4 inv3(v0 * fac2 - v1 * fac4 + v2 * fac5);
+
+		const vec4 signA(+1, -1, +1, -1);
+		const vec4 signB(-1, +1, -1, +1);
+
+		Matrix4x4 result;
+		result[0] = inv0 * signA;
+		result[1] = inv1 * signB;
+		result[2] = inv2 * signA;
+		result[3] = inv3 * signB;
+
+		const vec4 row0(result[0][0], result[1][0], result[2][0], result[3][0]);
+		const vec4 dot0(m[0] * row0);
+		const float det = (dot0.x + dot0.y) + (dot0.z + dot0.w);
+
+		const float rcpDet = 1.0f / det;
+		result[0] *= rcpDet;
+		result[1] *= rcpDet;
+		result[2] *= rcpDet;
+		result[3] *= rcpDet;
+		return result;
+#endif
+	}
+
+	Matrix4x4 Matrix4x4::InverseAffine() const
+	{
+#if ODM_SIMD_SSE
+		// The rows of the inverse 3x3 block are the pairwise cross products of its columns over the determinant.
+		const auto cross = [](__m128 a, __m128 b) {
+			const __m128 aYZX = _mm_shuffle_ps(a, a, ODM_SHUFFLE(1, 2, 0, 3));
+			const __m128 bYZX = _mm_shuffle_ps(b, b, ODM_SHUFFLE(1, 2, 0, 3));
+			const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+			return _mm_shuffle_ps(c, c, ODM_SHUFFLE(1, 2, 0, 3));
+		};
+
+		const __m128 c0 = m[0].simd, c1 = m[1].simd, c2 = m[2].simd;
+		__m128 r0 = cross(c1, c2);
+		__m128 r1 = cross(c2, c0);
+		__m128 r2 = cross(c0, c1);
+		__m128 r3 = _mm_setzero_ps();
+
+		__m128 det = _mm_mul_ps(c0, r0);
+		det = _mm_add_ps(det, _mm_shuffle_ps(det, det, ODM_SHUFFLE(1, 0, 3, 2)));
+		det = _mm_add_ps(det, _mm_shuffle_ps(det, det, ODM_SHUFFLE(2, 3, 0, 1)));
+		const __m128 rcpDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		r0 = _mm_mul_ps(r0, rcpDet);
+		r1 = _mm_mul_ps(r1, rcpDet);
+		r2 = _mm_mul_ps(r2, rcpDet);
+
+		const __m128 t = m[3].simd;
+		__m128 translation = _mm_mul_ps(r0, _mm_shuffle_ps(t, t, ODM_SHUFFLE(0, 0, 0, 0)));
+		translation = _mm_add_ps(translation, _mm_mul_ps(r1, _mm_shuffle_ps(t, t, ODM_SHUFFLE(1, 1, 1, 1))));
+		translation = _mm_add_ps(translation, _mm_mul_ps(r2, _mm_shuffle_ps(t, t, ODM_SHUFFLE(2, 2, 2, 2))));
+		translation = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translation);
+
+		Matrix4x4 result;
+		result.m[0].simd = r0;
+		result.m[1].simd = r1;
+		result.m[2].simd = r2;
+		result.m[3].simd = translation;
+		return result;
+#else
+		const vec3 c0(m[0].x, m[0].y, m[0].z);
+		const vec3 c1(m[1].x, m[1].y, m[1].z);
+		const vec3 c2(m[2].x, m[2].y, m[2].z);
+		const vec3 t(m[3].x, m[3].y, m[3].z);
+
+		const float rcpDet = 1.0f / c0.Dot(c1.Cross(c2));
+		const vec3 r0 = c1.Cross(c2) * rcpDet;
+		const vec3 r1 = c2.Cross(c0) * rcpDet;
+		const vec3 r2 = c0.Cross(c1) * rcpDet;
+
+		return Matrix4x4(
+			r0.x, r0.y, r0.z, -r0.Dot(t),
+			r1.x, r1.y, r1.z, -r1.Dot(t),
+			r2.x, r2.y, r2.z, -r2.Dot(t),
+			0.0f, 0.0f, 0.0f, 1.0f);
+#endif
+	}
+
+	Matrix4x4 Matrix4x4::InverseRigid() const
+	{
+#if ODM_SIMD_SSE
+		__m128 r0 = m[0].simd, r1 = m[1].simd, r2 = m[2].simd, r3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		const __m128 t = m[3].simd;
+		__m128 translation = _mm_mul_ps(r0, _mm_shuffle_ps(t, t, ODM_SHUFFLE(0, 0, 0, 0)));
+		translation = _mm_add_ps(translation, _mm_mul_ps(r1, _mm_shuffle_ps(t, t, ODM_SHUFFLE(1, 1, 1, 1))));
+		translation = _mm_add_ps(translation, _mm_mul_ps(r2, _mm_shuffle_ps(t, t, ODM_SHUFFLE(2, 2, 2, 2))));
+		translation = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translation);
+
+		Matrix4x4 result;
+		result.m[0].simd = r0;
+		result.m[1].simd = r1;
+		result.m[2].simd = r2;
+		result.m[3].simd = translation;
+		return result;
+#else
+		// The rows of the inverse rotation are the columns of this one.
+		const vec3 c0(m[0].x, m[0].y, m[0].z);
+		const vec3 c1(m[1].x, m[1].y, m[1].z);
+		const vec3 c2(m[2].x, m[2].y, m[2].z);
+		const vec3 t(m[3].x, m[3].y, m[3].z);
+
+		return Matrix4x4(
+			c0.x, c0.y, c0.z, -c0.Dot(t),
+			c1.x, c1.y, c1.z, -c1.Dot(t),
+			c2.x, c2.y, c2.z, -c2.Dot(t),
+			0.0f, 0.0f, 0.0f, 1.0f);
+#endif
+	}
 	
 	Matrix4x4 Matrix4x4::operator*(const Matrix4x4& mat) const
 	{
+#if ODM_SIMD_SSE
+		Matrix4x4 Result;
+		for (int col = 0; col < 4; ++col)
+		{
+			const __m128 b = mat.m[col].simd;
+			__m128 r = _mm_mul_ps(m[0].simd, _mm_shuffle_ps(b, b, ODM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm_add_ps(r, _mm_mul_ps(m[1].simd, _mm_shuffle_ps(b, b, ODM_SHUFFLE(1, 1, 1, 1))));
+			r = _mm_add_ps(r, _mm_mul_ps(m[2].simd, _mm_shuffle_ps(b, b, ODM_SHUFFLE(2, 2, 2, 2))));
+			r = _mm_add_ps(r, _mm_mul_ps(m[3].simd, _mm_shuffle_ps(b, b, ODM_SHUFFLE(3, 3, 3, 3))));
+			Result.m[col].simd = r;
+		}
+		return Result;
+#else
 		vec4 const SrcA0 = m[0];
 		vec4 const SrcA1 = m[1];
 		vec4 const SrcA2 = m[2];
@@ -87,6 +316,7 @@ namespace odm
 		Result[2] = SrcA0 * SrcB2[0] + SrcA1 * SrcB2[1] + SrcA2 * SrcB2[2] + SrcA3 * SrcB2[3];
 		Result[3] = SrcA0 * SrcB3[0] + SrcA1 * SrcB3[1] + SrcA2 * SrcB3[2] + SrcA3 * SrcB3[3];
 		return Result;
+#endif
 	}
 
 	inline Matrix4x4& Matrix4x4::operator*=(const Matrix4x4& mat)
@@ -97,19 +327,26 @@ namespace odm
 
 	inline vec3 Matrix4x4::operator*(const vec3& v) const
 	{
-		return Vector3f(
-			((v.x * m[0][0]) + (v.y * m[0][1]) + (v.z * m[0][2]) + m[0][3]) * (1.0f / ((v.x * m[3][0]) + (v.y * m[3][1]) + (v.z * m[3][2]) + m[3][3])),
-			((v.x * m[1][0]) + (v.y * m[1][1]) + (v.z * m[1][2]) + m[1][2]) * (1.0f / ((v.x * m[3][0]) + (v.y * m[3][1]) + (v.z * m[3][2]) + m[3][3])),
-			((v.x * m[2][0]) + (v.y * m[2][1]) + (v.z * m[2][2]) + m[2][3]) * (1.0f / ((v.x * m[3][0]) + (v.y * m[3][1]) + (v.z * m[3][2]) + m[3][3])));
+		const vec4 r = *this * vec4(v, 1.0f);
+		const float invW = 1.0f / r.w;
+		return Vector3f(r.x * invW, r.y * invW, r.z * invW);
 	}
 
 	inline vec4 Matrix4x4::operator*(const vec4& v) const
 	{
+#if ODM_SIMD_SSE
+		__m128 r = _mm_mul_ps(m[0].simd, _mm_shuffle_ps(v.simd, v.simd, ODM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(m[1].simd, _mm_shuffle_ps(v.simd, v.simd, ODM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(m[2].simd, _mm_shuffle_ps(v.simd, v.simd, ODM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm_add_ps(r, _mm_mul_ps(m[3].simd, _mm_shuffle_ps(v.simd, v.simd, ODM_SHUFFLE(3, 3, 3, 3))));
+		return vec4(r);
+#else
 		return vec4(
-			m[0][0] * v[0] + m[0][1] * v[1] + m[0][2] * v[2] + m[0][3] * v[3],
-			m[1][0] * v[0] + m[1][1] * v[1] + m[1][2] * v[2] + m[1][3] * v[3],
-			m[2][0] * v[0] + m[2][1] * v[1] + m[2][2] * v[2] + m[2][3] * v[3],
-			m[3][0] * v[0] + m[3][1] * v[1] + m[3][2] * v[2] + m[3][3] * v[3]);
+			m[0][0] * v[0] + m[1][0] * v[1] + m[2][0] * v[2] + m[3][0] * v[3],
+			m[0][1] * v[0] + m[1][1] * v[1] + m[2][1] * v[2] + m[3][1] * v[3],
+			m[0][2] * v[0] + m[1][2] * v[1] + m[2][2] * v[2] + m[3][2] * v[3],
+			m[0][3] * v[0] + m[1][3] * v[1] + m[2][3] * v[2] + m[3][3] * v[3]);
+#endif
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,756 @@
+#include "Mat4x4_batch.h"
+
+#include <cassert>
+#include <cstdint>
+#include "Simd.h"
+#include "Simd_soa.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	static void MulMatBaseline(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = a[i] * b[i];
+	}
+
+	static void MulVec4Baseline(const Matrix4x4& m, const Vector4f* in, Vector4f* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = m * in[i];
+	}
+
+	static void MulVec3Baseline(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = m * in[i];
+	}
+
+	static void InverseBaseline(const Matrix4x4* in, Matrix4x4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = in[i].Inverse();
+	}
+
+	static Vector3f TransformOne(const Matrix4x4& m, const Vector3f& v, TransformMode mode)
+	{
+		const vec4 r = m * vec4(v, mode == TransformMode::Vector ? 0.0f : 1.0f);
+		if (mode == TransformMode::ProjectivePoint)
+		{
+			const float invW = 1.0f / r.w;
+			return Vector3f(r.x * invW, r.y * invW, r.z * invW);
+		}
+		return Vector3f(r.x, r.y, r.z);
+	}
+
+	/** Number of leading elements to handle one by one before out + count reaches the alignment streaming stores need. */
+	template <class T>
+	static size_t CountUntilAligned(const T* out, size_t count, size_t alignment)
+	{
+		size_t n = 0;
+		while (n < count && (reinterpret_cast<uintptr_t>(out + n) & (alignment - 1)) != 0)
+			++n;
+		return n;
+	}
+
+#if ODM_SIMD_SSE
+
+	using Transform3Fn = void (*)(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count);
+
+	template <TransformMode Mode, bool Stream>
+	static void Transform3SSE(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count)
+	{
+		const __m128 m00 = _mm_set1_ps(m.m[0].x), m01 = _mm_set1_ps(m.m[0].y), m02 = _mm_set1_ps(m.m[0].z), m03 = _mm_set1_ps(m.m[0].w);
+		const __m128 m10 = _mm_set1_ps(m.m[1].x), m11 = _mm_set1_ps(m.m[1].y), m12 = _mm_set1_ps(m.m[1].z), m13 = _mm_set1_ps(m.m[1].w);
+		const __m128 m20 = _mm_set1_ps(m.m[2].x), m21 = _mm_set1_ps(m.m[2].y), m22 = _mm_set1_ps(m.m[2].z), m23 = _mm_set1_ps(m.m[2].w);
+		const __m128 m30 = _mm_set1_ps(m.m[3].x), m31 = _mm_set1_ps(m.m[3].y), m32 = _mm_set1_ps(m.m[3].z), m33 = _mm_set1_ps(m.m[3].w);
+
+		size_t i = Stream ? CountUntilAligned(out, count, 16) : 0;
+		for (size_t j = 0; j < i; ++j)
+			out[j] = TransformOne(m, in[j], Mode);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x, y, z;
+			LoadPoints4(&in[i].x, x, y, z);
+
+			__m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_mul_ps(m20, z));
+			__m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m21, z));
+			__m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), _mm_mul_ps(m22, z));
+			if (Mode != TransformMode::Vector)
+			{
+				rx = _mm_add_ps(rx, m30);
+				ry = _mm_add_ps(ry, m31);
+				rz = _mm_add_ps(rz, m32);
+			}
+			if (Mode == TransformMode::ProjectivePoint)
+			{
+				const __m128 rw = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m03, x), _mm_mul_ps(m13, y)), _mm_mul_ps(m23, z)), m33);
+				const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), rw);
+				rx = _mm_mul_ps(rx, invW);
+				ry = _mm_mul_ps(ry, invW);
+				rz = _mm_mul_ps(rz, invW);
+			}
+
+			__m128 a, b, c;
+			PackPoints4(rx, ry, rz, a, b, c);
+			float* f = &out[i].x;
+			if (Stream)
+			{
+				_mm_stream_ps(f, a);
+				_mm_stream_ps(f + 4, b);
+				_mm_stream_ps(f + 8, c);
+			}
+			else
+			{
+				_mm_storeu_ps(f, a);
+				_mm_storeu_ps(f + 4, b);
+				_mm_storeu_ps(f + 8, c);
+			}
+		}
+
+		for (; i < count; ++i)
+			out[i] = TransformOne(m, in[i], Mode);
+
+		if (Stream)
+			_mm_sfence();
+	}
+
+	template <bool Stream>
+	static void Transform3To4SSE(const Matrix4x4& m, const Vector3f* in, Vector4f* out, size_t count)
+	{
+		const __m128 m00 = _mm_set1_ps(m.m[0].x), m01 = _mm_set1_ps(m.m[0].y), m02 = _mm_set1_ps(m.m[0].z), m03 = _mm_set1_ps(m.m[0].w);
+		const __m128 m10 = _mm_set1_ps(m.m[1].x), m11 = _mm_set1_ps(m.m[1].y), m12 = _mm_set1_ps(m.m[1].z), m13 = _mm_set1_ps(m.m[1].w);
+		const __m128 m20 = _mm_set1_ps(m.m[2].x), m21 = _mm_set1_ps(m.m[2].y), m22 = _mm_set1_ps(m.m[2].z), m23 = _mm_set1_ps(m.m[2].w);
+		const __m128 m30 = _mm_set1_ps(m.m[3].x), m31 = _mm_set1_ps(m.m[3].y), m32 = _mm_set1_ps(m.m[3].z), m33 = _mm_set1_ps(m.m[3].w);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x, y, z;
+			LoadPoints4(&in[i].x, x, y, z);
+
+			__m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_mul_ps(m20, z)), m30);
+			__m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m21, z)), m31);
+			__m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), _mm_mul_ps(m22, z)), m32);
+			__m128 rw = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m03, x), _mm_mul_ps(m13, y)), _mm_mul_ps(m23, z)), m33);
+			_MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+
+			if (Stream)
+			{
+				_mm_stream_ps(&out[i].x, rx);
+				_mm_stream_ps(&out[i + 1].x, ry);
+				_mm_stream_ps(&out[i + 2].x, rz);
+				_mm_stream_ps(&out[i + 3].x, rw);
+			}
+			else
+			{
+				out[i].simd = rx;
+				out[i + 1].simd = ry;
+				out[i + 2].simd = rz;
+				out[i + 3].simd = rw;
+			}
+		}
+
+		for (; i < count; ++i)
+			out[i] = m * vec4(in[i], 1.0f);
+
+		if (Stream)
+			_mm_sfence();
+	}
+
+	static void Transform3Baseline(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count, TransformMode mode, StoreHint hint)
+	{
+		static const Transform3Fn kernels[3][2] = {
+			{ &Transform3SSE<TransformMode::Point, false>, &Transform3SSE<TransformMode::Point, true> },
+			{ &Transform3SSE<TransformMode::Vector, false>, &Transform3SSE<TransformMode::Vector, true> },
+			{ &Transform3SSE<TransformMode::ProjectivePoint, false>, &Transform3SSE<TransformMode::ProjectivePoint, true> }
+		};
+		kernels[static_cast<int>(mode)][hint == StoreHint::NonTemporal](m, in, out, count);
+	}
+
+	static void Transform3To4Baseline(const Matrix4x4& m, const Vector3f* in, Vector4f* out, size_t count, StoreHint hint)
+	{
+		if (hint == StoreHint::NonTemporal)
+			Transform3To4SSE<true>(m, in, out, count);
+		else
+			Transform3To4SSE<false>(m, in, out, count);
+	}
+
+#else
+
+	static void Transform3Baseline(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count, TransformMode mode, StoreHint)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = TransformOne(m, in[i], mode);
+	}
+
+	static void Transform3To4Baseline(const Matrix4x4& m, const Vector3f* in, Vector4f* out, size_t count, StoreHint)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = m * vec4(in[i], 1.0f);
+	}
+
+#endif
+
+	static const Mat4x4Kernels s_BaselineKernels = {
+		SimdLevel::Baseline, &MulMatBaseline, &MulVec4Baseline, &MulVec3Baseline, &InverseBaseline, &Transform3Baseline, &Transform3To4Baseline
+	};
+
+#if ODM_SIMD_SSE
+
+#pragma region SSE4.1
+
+	ODM_TARGET("sse4.1")
+	static void MulMatSSE41(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const __m128 a0 = _mm_load_ps(&a[i].elem[0]);
+			const __m128 a1 = _mm_load_ps(&a[i].elem[4]);
+			const __m128 a2 = _mm_load_ps(&a[i].elem[8]);
+			const __m128 a3 = _mm_load_ps(&a[i].elem[12]);
+
+			__m128 r[4];
+			for (int col = 0; col < 4; ++col)
+			{
+				const __m128 bc = _mm_load_ps(&b[i].elem[col * 4]);
+				__m128 rc = _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, ODM_SHUFFLE(0, 0, 0, 0)));
+				rc = _mm_add_ps(rc, _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, ODM_SHUFFLE(1, 1, 1, 1))));
+				rc = _mm_add_ps(rc, _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, ODM_SHUFFLE(2, 2, 2, 2))));
+				rc = _mm_add_ps(rc, _mm_mul_ps(a3, _mm_shuffle_ps(bc, bc, ODM_SHUFFLE(3, 3, 3, 3))));
+				r[col] = rc;
+			}
+
+			_mm_store_ps(&out[i].elem[0], r[0]);
+			_mm_store_ps(&out[i].elem[4], r[1]);
+			_mm_store_ps(&out[i].elem[8], r[2]);
+			_mm_store_ps(&out[i].elem[12], r[3]);
+		}
+	}
+
+	ODM_TARGET("sse4.1")
+	static void MulVec4SSE41(const Matrix4x4& m, const Vector4f* in, Vector4f* out, size_t count)
+	{
+		const __m128 c0 = m.m[0].simd, c1 = m.m[1].simd, c2 = m.m[2].simd, c3 = m.m[3].simd;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const __m128 v = in[i].simd;
+			__m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, ODM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, ODM_SHUFFLE(1, 1, 1, 1))));
+			r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, ODM_SHUFFLE(2, 2, 2, 2))));
+			r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, ODM_SHUFFLE(3, 3, 3, 3))));
+			out[i].simd = r;
+		}
+	}
+
+	ODM_TARGET("sse4.1")
+	static void MulVec3SSE41(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count)
+	{
+		const __m128 c0 = m.m[0].simd, c1 = m.m[1].simd, c2 = m.m[2].simd, c3 = m.m[3].simd;
+		for (size_t i = 0; i < count; ++i)
+		{
+			// Vector3f is 12 bytes, so x, y and z are loaded without touching the next element.
+			__m128 v = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&in[i].x)));
+			v = _mm_insert_ps(v, _mm_load_ss(&in[i].z), 0x20);
+
+			__m128 r = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_shuffle_ps(v, v, ODM_SHUFFLE(0, 0, 0, 0))));
+			r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, ODM_SHUFFLE(1, 1, 1, 1))));
+			r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, ODM_SHUFFLE(2, 2, 2, 2))));
+			r = _mm_div_ps(r, _mm_shuffle_ps(r, r, ODM_SHUFFLE(3, 3, 3, 3)));
+
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&out[i].x), _mm_castps_si128(r));
+			_mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
+		}
+	}
+
+	static const Mat4x4Kernels s_SSE41Kernels = {
+		SimdLevel::SSE41, &MulMatSSE41, &MulVec4SSE41, &MulVec3SSE41, &InverseBaseline, &Transform3Baseline, &Transform3To4Baseline
+	};
+
+#pragma endregion
+
+#pragma region AVX2
+
+	ODM_TARGET("avx2,fma")
+	static void MulMatAVX2(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			// Each column of a sits in both 128-bit halves, so one pass produces two result columns.
+			const __m256 a0 = _mm256_broadcast_ps(&a[i].m[0].simd);
+			const __m256 a1 = _mm256_broadcast_ps(&a[i].m[1].simd);
+			const __m256 a2 = _mm256_broadcast_ps(&a[i].m[2].simd);
+			const __m256 a3 = _mm256_broadcast_ps(&a[i].m[3].simd);
+			const __m256 b01 = _mm256_loadu_ps(&b[i].elem[0]);
+			const __m256 b23 = _mm256_loadu_ps(&b[i].elem[8]);
+
+			__m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, ODM_SHUFFLE(0, 0, 0, 0)));
+			r01 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, ODM_SHUFFLE(1, 1, 1, 1)), r01);
+			r01 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b01, ODM_SHUFFLE(2, 2, 2, 2)), r01);
+			r01 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b01, ODM_SHUFFLE(3, 3, 3, 3)), r01);
+
+			__m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, ODM_SHUFFLE(0, 0, 0, 0)));
+			r23 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, ODM_SHUFFLE(1, 1, 1, 1)), r23);
+			r23 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, ODM_SHUFFLE(2, 2, 2, 2)), r23);
+			r23 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b23, ODM_SHUFFLE(3, 3, 3, 3)), r23);
+
+			_mm256_storeu_ps(&out[i].elem[0], r01);
+			_mm256_storeu_ps(&out[i].elem[8], r23);
+		}
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void MulVec4AVX2(const Matrix4x4& m, const Vector4f* in, Vector4f* out, size_t count)
+	{
+		const __m256 c0 = _mm256_broadcast_ps(&m.m[0].simd);
+		const __m256 c1 = _mm256_broadcast_ps(&m.m[1].simd);
+		const __m256 c2 = _mm256_broadcast_ps(&m.m[2].simd);
+		const __m256 c3 = _mm256_broadcast_ps(&m.m[3].simd);
+
+		size_t i = 0;
+		for (; i + 2 <= count; i += 2)
+		{
+			const __m256 v = _mm256_loadu_ps(&in[i].x);
+			__m256 r = _mm256_mul_ps(c0, _mm256_permute_ps(v, ODM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm256_fmadd_ps(c1, _mm256_permute_ps(v, ODM_SHUFFLE(1, 1, 1, 1)), r);
+			r = _mm256_fmadd_ps(c2, _mm256_permute_ps(v, ODM_SHUFFLE(2, 2, 2, 2)), r);
+			r = _mm256_fmadd_ps(c3, _mm256_permute_ps(v, ODM_SHUFFLE(3, 3, 3, 3)), r);
+			_mm256_storeu_ps(&out[i].x, r);
+		}
+
+		if (i < count)
+		{
+			const __m128 v = in[i].simd;
+			__m128 r = _mm_mul_ps(m.m[0].simd, _mm_permute_ps(v, ODM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm_fmadd_ps(m.m[1].simd, _mm_permute_ps(v, ODM_SHUFFLE(1, 1, 1, 1)), r);
+			r = _mm_fmadd_ps(m.m[2].simd, _mm_permute_ps(v, ODM_SHUFFLE(2, 2, 2, 2)), r);
+			r = _mm_fmadd_ps(m.m[3].simd, _mm_permute_ps(v, ODM_SHUFFLE(3, 3, 3, 3)), r);
+			out[i].simd = r;
+		}
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void MulVec3AVX2(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count)
+	{
+		const __m256 c0 = _mm256_broadcast_ps(&m.m[0].simd);
+		const __m256 c1 = _mm256_broadcast_ps(&m.m[1].simd);
+		const __m256 c2 = _mm256_broadcast_ps(&m.m[2].simd);
+		const __m256 c3 = _mm256_broadcast_ps(&m.m[3].simd);
+
+		// Two points (six floats) per iteration: spread x, y and z of each point over its 128-bit half.
+		const __m256i loadMask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+		const __m256i splatX = _mm256_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3);
+		const __m256i splatY = _mm256_setr_epi32(1, 1, 1, 1, 4, 4, 4, 4);
+		const __m256i splatZ = _mm256_setr_epi32(2, 2, 2, 2, 5, 5, 5, 5);
+		const __m256i pack = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+		size_t i = 0;
+		for (; i + 2 <= count; i += 2)
+		{
+			const __m256 p = _mm256_maskload_ps(&in[i].x, loadMask);
+			__m256 r = _mm256_fmadd_ps(c0, _mm256_permutevar8x32_ps(p, splatX), c3);
+			r = _mm256_fmadd_ps(c1, _mm256_permutevar8x32_ps(p, splatY), r);
+			r = _mm256_fmadd_ps(c2, _mm256_permutevar8x32_ps(p, splatZ), r);
+			r = _mm256_div_ps(r, _mm256_permute_ps(r, ODM_SHUFFLE(3, 3, 3, 3)));
+			_mm256_maskstore_ps(&out[i].x, loadMask, _mm256_permutevar8x32_ps(r, pack));
+		}
+
+		if (i < count)
+			MulVec3SSE41(m, in + i, out + i, count - i);
+	}
+
+	// 2x2 products on two matrices at once: A * B, adj(A) * B and A * adj(B).
+	ODM_TARGET("avx2,fma")
+	static inline __m256 Mul2AVX2(__m256 a, __m256 b)
+	{
+		return _mm256_fmadd_ps(a, _mm256_permute_ps(b, ODM_SHUFFLE(0, 3, 0, 3)),
+			_mm256_mul_ps(_mm256_permute_ps(a, ODM_SHUFFLE(1, 0, 3, 2)), _mm256_permute_ps(b, ODM_SHUFFLE(2, 1, 2, 1))));
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline __m256 AdjMul2AVX2(__m256 a, __m256 b)
+	{
+		return _mm256_fmsub_ps(_mm256_permute_ps(a, ODM_SHUFFLE(3, 3, 0, 0)), b,
+			_mm256_mul_ps(_mm256_permute_ps(a, ODM_SHUFFLE(1, 1, 2, 2)), _mm256_permute_ps(b, ODM_SHUFFLE(2, 3, 0, 1))));
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline __m256 MulAdj2AVX2(__m256 a, __m256 b)
+	{
+		return _mm256_fmsub_ps(a, _mm256_permute_ps(b, ODM_SHUFFLE(3, 0, 3, 0)),
+			_mm256_mul_ps(_mm256_permute_ps(a, ODM_SHUFFLE(1, 0, 3, 2)), _mm256_permute_ps(b, ODM_SHUFFLE(2, 1, 2, 1))));
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void InverseAVX2(const Matrix4x4* in, Matrix4x4* out, size_t count)
+	{
+		// Two matrices per iteration, one per 128-bit half; same blockwise scheme as Matrix4x4::Inverse.
+		size_t i = 0;
+		for (; i + 2 <= count; i += 2)
+		{
+			const __m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(in[i].m[0].simd), in[i + 1].m[0].simd, 1);
+			const __m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(in[i].m[1].simd), in[i + 1].m[1].simd, 1);
+			const __m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(in[i].m[2].simd), in[i + 1].m[2].simd, 1);
+			const __m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(in[i].m[3].simd), in[i + 1].m[3].simd, 1);
+
+			const __m256 A = _mm256_shuffle_ps(r0, r1, ODM_SHUFFLE(0, 1, 0, 1));
+			const __m256 B = _mm256_shuffle_ps(r0, r1, ODM_SHUFFLE(2, 3, 2, 3));
+			const __m256 C = _mm256_shuffle_ps(r2, r3, ODM_SHUFFLE(0, 1, 0, 1));
+			const __m256 D = _mm256_shuffle_ps(r2, r3, ODM_SHUFFLE(2, 3, 2, 3));
+
+			const __m256 detSub = _mm256_fmsub_ps(
+				_mm256_shuffle_ps(r0, r2, ODM_SHUFFLE(0, 2, 0, 2)), _mm256_shuffle_ps(r1, r3, ODM_SHUFFLE(1, 3, 1, 3)),
+				_mm256_mul_ps(_mm256_shuffle_ps(r0, r2, ODM_SHUFFLE(1, 3, 1, 3)), _mm256_shuffle_ps(r1, r3, ODM_SHUFFLE(0, 2, 0, 2))));
+			const __m256 detA = _mm256_permute_ps(detSub, ODM_SHUFFLE(0, 0, 0, 0));
+			const __m256 detB = _mm256_permute_ps(detSub, ODM_SHUFFLE(1, 1, 1, 1));
+			const __m256 detC = _mm256_permute_ps(detSub, ODM_SHUFFLE(2, 2, 2, 2));
+			const __m256 detD = _mm256_permute_ps(detSub, ODM_SHUFFLE(3, 3, 3, 3));
+
+			const __m256 DC = AdjMul2AVX2(D, C);
+			const __m256 AB = AdjMul2AVX2(A, B);
+
+			__m256 X = _mm256_fmsub_ps(detD, A, Mul2AVX2(B, DC));
+			__m256 W = _mm256_fmsub_ps(detA, D, Mul2AVX2(C, AB));
+			__m256 Y = _mm256_fmsub_ps(detB, C, MulAdj2AVX2(D, AB));
+			__m256 Z = _mm256_fmsub_ps(detC, B, MulAdj2AVX2(A, DC));
+
+			__m256 tr = _mm256_mul_ps(AB, _mm256_permute_ps(DC, ODM_SHUFFLE(0, 2, 1, 3)));
+			tr = _mm256_add_ps(tr, _mm256_permute_ps(tr, ODM_SHUFFLE(1, 0, 3, 2)));
+			tr = _mm256_add_ps(tr, _mm256_permute_ps(tr, ODM_SHUFFLE(2, 3, 0, 1)));
+			const __m256 detM = _mm256_sub_ps(_mm256_fmadd_ps(detA, detD, _mm256_mul_ps(detB, detC)), tr);
+
+			const __m256 rcpDet = _mm256_div_ps(_mm256_setr_ps(1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f), detM);
+			X = _mm256_mul_ps(X, rcpDet);
+			Y = _mm256_mul_ps(Y, rcpDet);
+			Z = _mm256_mul_ps(Z, rcpDet);
+			W = _mm256_mul_ps(W, rcpDet);
+
+			const __m256 o0 = _mm256_shuffle_ps(X, Y, ODM_SHUFFLE(3, 1, 3, 1));
+			const __m256 o1 = _mm256_shuffle_ps(X, Y, ODM_SHUFFLE(2, 0, 2, 0));
+			const __m256 o2 = _mm256_shuffle_ps(Z, W, ODM_SHUFFLE(3, 1, 3, 1));
+			const __m256 o3 = _mm256_shuffle_ps(Z, W, ODM_SHUFFLE(2, 0, 2, 0));
+
+			out[i].m[0].simd = _mm256_castps256_ps128(o0);
+			out[i].m[1].simd = _mm256_castps256_ps128(o1);
+			out[i].m[2].simd = _mm256_castps256_ps128(o2);
+			out[i].m[3].simd = _mm256_castps256_ps128(o3);
+			out[i + 1].m[0].simd = _mm256_extractf128_ps(o0, 1);
+			out[i + 1].m[1].simd = _mm256_extractf128_ps(o1, 1);
+			out[i + 1].m[2].simd = _mm256_extractf128_ps(o2, 1);
+			out[i + 1].m[3].simd = _mm256_extractf128_ps(o3, 1);
+		}
+
+		if (i < count)
+			out[i] = in[i].Inverse();
+	}
+
+	template <TransformMode Mode, bool Stream>
+	ODM_TARGET("avx2,fma")
+	static void Transform3AVX2(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count)
+	{
+		const __m256 m00 = _mm256_set1_ps(m.m[0].x), m01 = _mm256_set1_ps(m.m[0].y), m02 = _mm256_set1_ps(m.m[0].z), m03 = _mm256_set1_ps(m.m[0].w);
+		const __m256 m10 = _mm256_set1_ps(m.m[1].x), m11 = _mm256_set1_ps(m.m[1].y), m12 = _mm256_set1_ps(m.m[1].z), m13 = _mm256_set1_ps(m.m[1].w);
+		const __m256 m20 = _mm256_set1_ps(m.m[2].x), m21 = _mm256_set1_ps(m.m[2].y), m22 = _mm256_set1_ps(m.m[2].z), m23 = _mm256_set1_ps(m.m[2].w);
+		const __m256 m30 = _mm256_set1_ps(m.m[3].x), m31 = _mm256_set1_ps(m.m[3].y), m32 = _mm256_set1_ps(m.m[3].z), m33 = _mm256_set1_ps(m.m[3].w);
+
+		size_t i = Stream ? CountUntilAligned(out, count, 32) : 0;
+		for (size_t j = 0; j < i; ++j)
+			out[j] = TransformOne(m, in[j], Mode);
+
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z;
+			LoadPoints8(&in[i].x, x, y, z);
+
+			const __m256 bx = Mode == TransformMode::Vector ? _mm256_setzero_ps() : m30;
+			const __m256 by = Mode == TransformMode::Vector ? _mm256_setzero_ps() : m31;
+			const __m256 bz = Mode == TransformMode::Vector ? _mm256_setzero_ps() : m32;
+			__m256 rx = _mm256_fmadd_ps(m20, z, _mm256_fmadd_ps(m10, y, _mm256_fmadd_ps(m00, x, bx)));
+			__m256 ry = _mm256_fmadd_ps(m21, z, _mm256_fmadd_ps(m11, y, _mm256_fmadd_ps(m01, x, by)));
+			__m256 rz = _mm256_fmadd_ps(m22, z, _mm256_fmadd_ps(m12, y, _mm256_fmadd_ps(m02, x, bz)));
+			if (Mode == TransformMode::ProjectivePoint)
+			{
+				const __m256 rw = _mm256_fmadd_ps(m23, z, _mm256_fmadd_ps(m13, y, _mm256_fmadd_ps(m03, x, m33)));
+				const __m256 invW = _mm256_div_ps(_mm256_set1_ps(1.0f), rw);
+				rx = _mm256_mul_ps(rx, invW);
+				ry = _mm256_mul_ps(ry, invW);
+				rz = _mm256_mul_ps(rz, invW);
+			}
+
+			__m256 l0, l1, l2;
+			PackPoints8(rx, ry, rz, l0, l1, l2);
+			float* f = &out[i].x;
+			if (Stream)
+			{
+				_mm256_stream_ps(f, l0);
+				_mm256_stream_ps(f + 8, l1);
+				_mm256_stream_ps(f + 16, l2);
+			}
+			else
+			{
+				_mm256_storeu_ps(f, l0);
+				_mm256_storeu_ps(f + 8, l1);
+				_mm256_storeu_ps(f + 16, l2);
+			}
+		}
+
+		for (; i < count; ++i)
+			out[i] = TransformOne(m, in[i], Mode);
+
+		if (Stream)
+			_mm_sfence();
+	}
+
+	template <bool Stream>
+	ODM_TARGET("avx2,fma")
+	static void Transform3To4AVX2(const Matrix4x4& m, const Vector3f* in, Vector4f* out, size_t count)
+	{
+		const __m256 m00 = _mm256_set1_ps(m.m[0].x), m01 = _mm256_set1_ps(m.m[0].y), m02 = _mm256_set1_ps(m.m[0].z), m03 = _mm256_set1_ps(m.m[0].w);
+		const __m256 m10 = _mm256_set1_ps(m.m[1].x), m11 = _mm256_set1_ps(m.m[1].y), m12 = _mm256_set1_ps(m.m[1].z), m13 = _mm256_set1_ps(m.m[1].w);
+		const __m256 m20 = _mm256_set1_ps(m.m[2].x), m21 = _mm256_set1_ps(m.m[2].y), m22 = _mm256_set1_ps(m.m[2].z), m23 = _mm256_set1_ps(m.m[2].w);
+		const __m256 m30 = _mm256_set1_ps(m.m[3].x), m31 = _mm256_set1_ps(m.m[3].y), m32 = _mm256_set1_ps(m.m[3].z), m33 = _mm256_set1_ps(m.m[3].w);
+
+		size_t i = Stream ? CountUntilAligned(out, count, 32) : 0;
+		for (size_t j = 0; j < i; ++j)
+			out[j] = m * vec4(in[j], 1.0f);
+
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z;
+			LoadPoints8(&in[i].x, x, y, z);
+
+			const __m256 rx = _mm256_fmadd_ps(m20, z, _mm256_fmadd_ps(m10, y, _mm256_fmadd_ps(m00, x, m30)));
+			const __m256 ry = _mm256_fmadd_ps(m21, z, _mm256_fmadd_ps(m11, y, _mm256_fmadd_ps(m01, x, m31)));
+			const __m256 rz = _mm256_fmadd_ps(m22, z, _mm256_fmadd_ps(m12, y, _mm256_fmadd_ps(m02, x, m32)));
+			const __m256 rw = _mm256_fmadd_ps(m23, z, _mm256_fmadd_ps(m13, y, _mm256_fmadd_ps(m03, x, m33)));
+
+			// 4x4 transpose inside each half: p0 holds points 0 and 4, p1 points 1 and 5, and so on.
+			const __m256 t0 = _mm256_unpacklo_ps(rx, ry);
+			const __m256 t1 = _mm256_unpacklo_ps(rz, rw);
+			const __m256 t2 = _mm256_unpackhi_ps(rx, ry);
+			const __m256 t3 = _mm256_unpackhi_ps(rz, rw);
+			const __m256 p0 = _mm256_shuffle_ps(t0, t1, ODM_SHUFFLE(0, 1, 0, 1));
+			const __m256 p1 = _mm256_shuffle_ps(t0, t1, ODM_SHUFFLE(2, 3, 2, 3));
+			const __m256 p2 = _mm256_shuffle_ps(t2, t3, ODM_SHUFFLE(0, 1, 0, 1));
+			const __m256 p3 = _mm256_shuffle_ps(t2, t3, ODM_SHUFFLE(2, 3, 2, 3));
+
+			const __m256 o01 = _mm256_permute2f128_ps(p0, p1, 0x20);
+			const __m256 o23 = _mm256_permute2f128_ps(p2, p3, 0x20);
+			const __m256 o45 = _mm256_permute2f128_ps(p0, p1, 0x31);
+			const __m256 o67 = _mm256_permute2f128_ps(p2, p3, 0x31);
+
+			float* f = &out[i].x;
+			if (Stream)
+			{
+				_mm256_stream_ps(f, o01);
+				_mm256_stream_ps(f + 8, o23);
+				_mm256_stream_ps(f + 16, o45);
+				_mm256_stream_ps(f + 24, o67);
+			}
+			else
+			{
+				_mm256_storeu_ps(f, o01);
+				_mm256_storeu_ps(f + 8, o23);
+				_mm256_storeu_ps(f + 16, o45);
+				_mm256_storeu_ps(f + 24, o67);
+			}
+		}
+
+		for (; i < count; ++i)
+			out[i] = m * vec4(in[i], 1.0f);
+
+		if (Stream)
+			_mm_sfence();
+	}
+
+	static void Transform3AVX2Dispatch(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count, TransformMode mode, StoreHint hint)
+	{
+		static const Transform3Fn kernels[3][2] = {
+			{ &Transform3AVX2<TransformMode::Point, false>, &Transform3AVX2<TransformMode::Point, true> },
+			{ &Transform3AVX2<TransformMode::Vector, false>, &Transform3AVX2<TransformMode::Vector, true> },
+			{ &Transform3AVX2<TransformMode::ProjectivePoint, false>, &Transform3AVX2<TransformMode::ProjectivePoint, true> }
+		};
+		kernels[static_cast<int>(mode)][hint == StoreHint::NonTemporal](m, in, out, count);
+	}
+
+	static void Transform3To4AVX2Dispatch(const Matrix4x4& m, const Vector3f* in, Vector4f* out, size_t count, StoreHint hint)
+	{
+		if (hint == StoreHint::NonTemporal)
+			Transform3To4AVX2<true>(m, in, out, count);
+		else
+			Transform3To4AVX2<false>(m, in, out, count);
+	}
+
+	static const Mat4x4Kernels s_AVX2Kernels = {
+		SimdLevel::AVX2, &MulMatAVX2, &MulVec4AVX2, &MulVec3AVX2, &InverseAVX2, &Transform3AVX2Dispatch, &Transform3To4AVX2Dispatch
+	};
+
+#pragma endregion
+
+#pragma region AVX-512
+
+	ODM_TARGET("avx512f")
+	static void MulMatAVX512(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			// Every column of a is repeated in the four 128-bit lanes, one lane per result column.
+			const __m512 a0 = _mm512_broadcast_f32x4(a[i].m[0].simd);
+			const __m512 a1 = _mm512_broadcast_f32x4(a[i].m[1].simd);
+			const __m512 a2 = _mm512_broadcast_f32x4(a[i].m[2].simd);
+			const __m512 a3 = _mm512_broadcast_f32x4(a[i].m[3].simd);
+			const __m512 bm = _mm512_loadu_ps(b[i].elem);
+
+			__m512 r = _mm512_mul_ps(a0, _mm512_permute_ps(bm, ODM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm512_fmadd_ps(a1, _mm512_permute_ps(bm, ODM_SHUFFLE(1, 1, 1, 1)), r);
+			r = _mm512_fmadd_ps(a2, _mm512_permute_ps(bm, ODM_SHUFFLE(2, 2, 2, 2)), r);
+			r = _mm512_fmadd_ps(a3, _mm512_permute_ps(bm, ODM_SHUFFLE(3, 3, 3, 3)), r);
+			_mm512_storeu_ps(out[i].elem, r);
+		}
+	}
+
+	ODM_TARGET("avx512f")
+	static void MulVec4AVX512(const Matrix4x4& m, const Vector4f* in, Vector4f* out, size_t count)
+	{
+		const __m512 c0 = _mm512_broadcast_f32x4(m.m[0].simd);
+		const __m512 c1 = _mm512_broadcast_f32x4(m.m[1].simd);
+		const __m512 c2 = _mm512_broadcast_f32x4(m.m[2].simd);
+		const __m512 c3 = _mm512_broadcast_f32x4(m.m[3].simd);
+
+		for (size_t i = 0; i < count; i += 4)
+		{
+			const size_t n = count - i < 4 ? count - i : 4;
+			const __mmask16 mask = static_cast<__mmask16>((1u << (n * 4)) - 1);
+
+			const __m512 v = _mm512_maskz_loadu_ps(mask, &in[i].x);
+			__m512 r = _mm512_mul_ps(c0, _mm512_permute_ps(v, ODM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm512_fmadd_ps(c1, _mm512_permute_ps(v, ODM_SHUFFLE(1, 1, 1, 1)), r);
+			r = _mm512_fmadd_ps(c2, _mm512_permute_ps(v, ODM_SHUFFLE(2, 2, 2, 2)), r);
+			r = _mm512_fmadd_ps(c3, _mm512_permute_ps(v, ODM_SHUFFLE(3, 3, 3, 3)), r);
+			_mm512_mask_storeu_ps(&out[i].x, mask, r);
+		}
+	}
+
+	ODM_TARGET("avx512f")
+	static void MulVec3AVX512(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count)
+	{
+		const __m512 c0 = _mm512_broadcast_f32x4(m.m[0].simd);
+		const __m512 c1 = _mm512_broadcast_f32x4(m.m[1].simd);
+		const __m512 c2 = _mm512_broadcast_f32x4(m.m[2].simd);
+		const __m512 c3 = _mm512_broadcast_f32x4(m.m[3].simd);
+
+		// Four points (twelve floats) per iteration, one point per 128-bit lane.
+		const __m512i splatX = _mm512_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3, 6, 6, 6, 6, 9, 9, 9, 9);
+		const __m512i splatY = _mm512_setr_epi32(1, 1, 1, 1, 4, 4, 4, 4, 7, 7, 7, 7, 10, 10, 10, 10);
+		const __m512i splatZ = _mm512_setr_epi32(2, 2, 2, 2, 5, 5, 5, 5, 8, 8, 8, 8, 11, 11, 11, 11);
+
+		for (size_t i = 0; i < count; i += 4)
+		{
+			const size_t n = count - i < 4 ? count - i : 4;
+			const __mmask16 loadMask = static_cast<__mmask16>((1u << (n * 3)) - 1);
+			const __mmask16 storeMask = static_cast<__mmask16>(0x7777u & ((1u << (n * 4)) - 1));
+
+			const __m512 p = _mm512_maskz_loadu_ps(loadMask, &in[i].x);
+			__m512 r = _mm512_fmadd_ps(c0, _mm512_permutexvar_ps(splatX, p), c3);
+			r = _mm512_fmadd_ps(c1, _mm512_permutexvar_ps(splatY, p), r);
+			r = _mm512_fmadd_ps(c2, _mm512_permutexvar_ps(splatZ, p), r);
+			r = _mm512_div_ps(r, _mm512_permute_ps(r, ODM_SHUFFLE(3, 3, 3, 3)));
+			_mm512_mask_compressstoreu_ps(&out[i].x, storeMask, r);
+		}
+	}
+
+	static const Mat4x4Kernels s_AVX512Kernels = {
+		SimdLevel::AVX512, &MulMatAVX512, &MulVec4AVX512, &MulVec3AVX512, &InverseAVX2, &Transform3AVX2Dispatch, &Transform3To4AVX2Dispatch
+	};
+
+#pragma endregion
+
+#endif
+
+	const Mat4x4Kernels& GetMat4x4Kernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::SSE41:	return s_SSE41Kernels;
+		case SimdLevel::AVX2:	return s_AVX2Kernels;
+		case SimdLevel::AVX512:	return s_AVX512Kernels;
+		default:				break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const Mat4x4Kernels& GetMat4x4Kernels()
+	{
+		static const Mat4x4Kernels& kernels = GetMat4x4Kernels(GetSimdLevel());
+		return kernels;
+	}
+
+	void Multiply(Span<const Matrix4x4> a, Span<const Matrix4x4> b, Span<Matrix4x4> out)
+	{
+		assert(a.size() == b.size() && a.size() == out.size());
+		GetMat4x4Kernels().MulMat(a.data(), b.data(), out.data(), out.size());
+	}
+
+	void Multiply(const Matrix4x4& m, Span<const Vector4f> in, Span<Vector4f> out)
+	{
+		assert(in.size() == out.size());
+		GetMat4x4Kernels().MulVec4(m, in.data(), out.data(), out.size());
+	}
+
+	void Multiply(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector3f> out)
+	{
+		assert(in.size() == out.size());
+		GetMat4x4Kernels().MulVec3(m, in.data(), out.data(), out.size());
+	}
+
+	void TransformPoints(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector3f> out, StoreHint hint)
+	{
+		assert(in.size() == out.size());
+		GetMat4x4Kernels().Transform3(m, in.data(), out.data(), out.size(), TransformMode::Point, hint);
+	}
+
+	void TransformPoints(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector4f> out, StoreHint hint)
+	{
+		assert(in.size() == out.size());
+		GetMat4x4Kernels().Transform3To4(m, in.data(), out.data(), out.size(), hint);
+	}
+
+	void TransformVectors(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector3f> out, StoreHint hint)
+	{
+		assert(in.size() == out.size());
+		GetMat4x4Kernels().Transform3(m, in.data(), out.data(), out.size(), TransformMode::Vector, hint);
+	}
+
+	void TransformPointsProjective(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector3f> out, StoreHint hint)
+	{
+		assert(in.size() == out.size());
+		GetMat4x4Kernels().Transform3(m, in.data(), out.data(), out.size(), TransformMode::ProjectivePoint, hint);
+	}
+
+	void Inverse(Span<const Matrix4x4> in, Span<Matrix4x4> out)
+	{
+		assert(in.size() == out.size());
+		GetMat4x4Kernels().Inverse(in.data(), out.data(), out.size());
+	}
+
+	void InverseAffine(Span<const Matrix4x4> in, Span<Matrix4x4> out)
+	{
+		assert(in.size() == out.size());
+		for (size_t i = 0; i < out.size(); ++i)
+			out[i] = in[i].InverseAffine();
+	}
+
+	void InverseRigid(Span<const Matrix4x4> in, Span<Matrix4x4> out)
+	{
+		assert(in.size() == out.size());
+		for (size_t i = 0; i < out.size(); ++i)
+			out[i] = in[i].InverseRigid();
+	}
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#ifndef _MAT4_BATCH_H_
+#define _MAT4_BATCH_H_
+
+#include <cstddef>
+#include "Mat4x4.h"
+#include "Cpu.h"
+#include "Span.h"
+
+namespace odm
+{
+	/** How Transform kernels treat their Vector3f inputs. */
+	enum class TransformMode
+	{
+		Point,				// w = 1, the translation applies.
+		Vector,				// w = 0, directions and offsets ignore the translation.
+		ProjectivePoint		// w = 1 and the result is divided by its transformed w.
+	};
+
+	/** Where batch kernels leave their results. */
+	enum class StoreHint
+	{
+		Cached,				// Regular stores, for results that are read again soon.
+		NonTemporal			// Streaming stores that bypass the cache, for large outputs consumed later (e.g. by the GPU).
+	};
+
+	/**
+	 * Table of matrix kernels compiled for one instruction set tier.
+	 * Every kernel accepts an output that aliases its input element for element.
+	 */
+	struct Mat4x4Kernels
+	{
+		SimdLevel level;
+
+		/** out[i] = a[i] * b[i] */
+		void (*MulMat)(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out, size_t count);
+
+		/** out[i] = m * in[i] */
+		void (*MulVec4)(const Matrix4x4& m, const Vector4f* in, Vector4f* out, size_t count);
+
+		/** out[i] = m * in[i], with the perspective divide of Matrix4x4::operator*(const vec3&) */
+		void (*MulVec3)(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count);
+
+		/** out[i] = in[i].Inverse() */
+		void (*Inverse)(const Matrix4x4* in, Matrix4x4* out, size_t count);
+
+		/** out[i] = m * in[i], with in[i] extended and the result reduced as described by mode */
+		void (*Transform3)(const Matrix4x4& m, const Vector3f* in, Vector3f* out, size_t count, TransformMode mode, StoreHint hint);
+
+		/** out[i] = m * vec4(in[i], 1) */
+		void (*Transform3To4)(const Matrix4x4& m, const Vector3f* in, Vector4f* out, size_t count, StoreHint hint);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const Mat4x4Kernels& GetMat4x4Kernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const Mat4x4Kernels& GetMat4x4Kernels(SimdLevel level);
+
+	/**
+	 * Multiplies matrices pairwise.
+	 * @param a Left hand side matrices.
+	 * @param b Right hand side matrices, as many as in a.
+	 * @param out Receives a[i] * b[i]; may alias a or b.
+	 */
+	void Multiply(Span<const Matrix4x4> a, Span<const Matrix4x4> b, Span<Matrix4x4> out);
+
+	/**
+	 * Multiplies 4D vectors by one matrix.
+	 * @param m The matrix applied to every vector.
+	 * @param in Vectors to be transformed.
+	 * @param out Receives m * in[i]; may alias in.
+	 */
+	void Multiply(const Matrix4x4& m, Span<const Vector4f> in, Span<Vector4f> out);
+
+	/**
+	 * Multiplies 3D points by one matrix, dividing each result by its w.
+	 * @param m The matrix applied to every point.
+	 * @param in Points to be transformed.
+	 * @param out Receives m * in[i]; may alias in.
+	 */
+	void Multiply(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector3f> out);
+
+	/**
+	 * Transforms points by one matrix, applying its translation.
+	 * @param m The affine matrix applied to every point.
+	 * @param in Points to be transformed.
+	 * @param out Receives (m * vec4(in[i], 1)).xyz; may alias in.
+	 * @param hint StoreHint::NonTemporal streams the results past the cache.
+	 */
+	void TransformPoints(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector3f> out, StoreHint hint = StoreHint::Cached);
+
+	/**
+	 * Transforms points by one matrix and keeps the homogeneous result, e.g. for clip space positions.
+	 * @param m The matrix applied to every point.
+	 * @param in Points to be transformed.
+	 * @param out Receives m * vec4(in[i], 1).
+	 * @param hint StoreHint::NonTemporal streams the results past the cache.
+	 */
+	void TransformPoints(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector4f> out, StoreHint hint = StoreHint::Cached);
+
+	/**
+	 * Transforms directions by one matrix, ignoring its translation.
+	 * @param m The matrix applied to every vector.
+	 * @param in Vectors to be transformed.
+	 * @param out Receives (m * vec4(in[i], 0)).xyz; may alias in.
+	 * @param hint StoreHint::NonTemporal streams the results past the cache.
+	 */
+	void TransformVectors(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector3f> out, StoreHint hint = StoreHint::Cached);
+
+	/**
+	 * Transforms points by a projective matrix, dividing each result by its w.
+	 * @param m The matrix applied to every point.
+	 * @param in Points to be transformed.
+	 * @param out Receives m * in[i] as Matrix4x4::operator*(const vec3&) computes it; may alias in.
+	 * @param hint StoreHint::NonTemporal streams the results past the cache.
+	 */
+	void TransformPointsProjective(const Matrix4x4& m, Span<const Vector3f> in, Span<Vector3f> out, StoreHint hint = StoreHint::Cached);
+
+	/**
+	 * Inverts general matrices, see Matrix4x4::Inverse.
+	 * @param in Matrices to be inverted.
+	 * @param out Receives the inverses; may alias in.
+	 */
+	void Inverse(Span<const Matrix4x4> in, Span<Matrix4x4> out);
+
+	/**
+	 * Inverts affine matrices, see Matrix4x4::InverseAffine.
+	 * @param in Matrices to be inverted.
+	 * @param out Receives the inverses; may alias in.
+	 */
+	void InverseAffine(Span<const Matrix4x4> in, Span<Matrix4x4> out);
+
+	/**
+	 * Inverts rigid transforms, see Matrix4x4::InverseRigid.
+	 * @param in Matrices to be inverted.
+	 * @param out Receives the inverses; may alias in.
+	 */
+	void InverseRigid(Span<const Matrix4x4> in, Span<Matrix4x4> out);
+}
+
+#endif /* end of include guard: _MAT4_BATCH_H_ */
@@ -0,0 +1,396 @@
+#pragma once
+
+#ifndef _PACKET_H_
+#define _PACKET_H_
+
+#include <cassert>
+#include <cstdint>
+#include "Simd.h"
+#include "Defines.h"
+#include "MathUtil.h"
+
+/*
+ * Packets hold one value per lane and apply every operation to all lanes at once, so branchy
+ * per-element code becomes compare + Select. floatx4 maps to an SSE register and floatx8 to two floatx4.
+ * Unlike the batch kernels these are inline types, so they follow the compile-time backend rather than CPUID;
+ * their layout and code must not depend on per-file flags such as -mavx or -mfma, or translation units built
+ * with different flags would disagree on the same inline definitions. Code that wants AVX uses __m256 inside
+ * ODM_TARGET functions, as the batch kernels do.
+ */
+
+namespace odm
+{
+	/** Per-lane booleans of a floatx4, produced by comparisons and consumed by Select. */
+	struct maskx4
+	{
+		static constexpr int Width = 4;
+
+#if ODM_SIMD_SSE
+		__m128 v;		// All bits set in true lanes.
+#else
+		bool v[4];
+#endif
+
+		maskx4() = default;
+
+		/**
+		 * Constructs a mask with every lane set to b.
+		 * @param b The value of all lanes.
+		 */
+		explicit maskx4(bool b)
+		{
+#if ODM_SIMD_SSE
+			v = _mm_castsi128_ps(_mm_set1_epi32(b ? -1 : 0));
+#else
+			v[0] = v[1] = v[2] = v[3] = b;
+#endif
+		}
+
+#if ODM_SIMD_SSE
+		explicit maskx4(__m128 m) : v(m) {}
+#endif
+
+		/** Gets the lanes as bits, lane i in bit i. */
+		NODISCARD int Bits() const
+		{
+#if ODM_SIMD_SSE
+			return _mm_movemask_ps(v);
+#else
+			return (v[0] ? 1 : 0) | (v[1] ? 2 : 0) | (v[2] ? 4 : 0) | (v[3] ? 8 : 0);
+#endif
+		}
+
+		NODISCARD bool GetLane(int lane) const { assert(lane >= 0 && lane < Width); return (Bits() >> lane) & 1; }
+		NODISCARD bool Any() const { return Bits() != 0; }
+		NODISCARD bool All() const { return Bits() == 0xF; }
+		NODISCARD bool None() const { return Bits() == 0; }
+	};
+
+	/** Four float lanes. */
+	struct floatx4
+	{
+		static constexpr int Width = 4;
+		using Mask = maskx4;
+
+#if ODM_SIMD_SSE
+		__m128 v;
+#else
+		float v[4];
+#endif
+
+		floatx4() = default;
+
+		/**
+		 * Constructs a packet with every lane set to f.
+		 * @param f The value of all lanes.
+		 */
+		floatx4(float f)
+		{
+#if ODM_SIMD_SSE
+			v = _mm_set1_ps(f);
+#else
+			v[0] = v[1] = v[2] = v[3] = f;
+#endif
+		}
+
+		/** Constructs from one value per lane. */
+		floatx4(float f0, float f1, float f2, float f3)
+		{
+#if ODM_SIMD_SSE
+			v = _mm_setr_ps(f0, f1, f2, f3);
+#else
+			v[0] = f0, v[1] = f1, v[2] = f2, v[3] = f3;
+#endif
+		}
+
+#if ODM_SIMD_SSE
+		explicit floatx4(__m128 f) : v(f) {}
+#endif
+
+		/**
+		 * Loads four consecutive floats.
+		 * @param f Pointer to the first float; needs no alignment.
+		 */
+		NODISCARD static floatx4 Load(const float* f)
+		{
+#if ODM_SIMD_SSE
+			return floatx4(_mm_loadu_ps(f));
+#else
+			return floatx4(f[0], f[1], f[2], f[3]);
+#endif
+		}
+
+		/**
+		 * Stores the lanes to four consecutive floats.
+		 * @param f Pointer to the first float; needs no alignment.
+		 */
+		void Store(float* f) const
+		{
+#if ODM_SIMD_SSE
+			_mm_storeu_ps(f, v);
+#else
+			f[0] = v[0], f[1] = v[1], f[2] = v[2], f[3] = v[3];
+#endif
+		}
+
+		NODISCARD float GetLane(int lane) const
+		{
+			assert(lane >= 0 && lane < Width);
+			float f[Width];
+			Store(f);
+			return f[lane];
+		}
+
+		void SetLane(int lane, float f)
+		{
+			assert(lane >= 0 && lane < Width);
+			float lanes[Width];
+			Store(lanes);
+			lanes[lane] = f;
+			*this = Load(lanes);
+		}
+	};
+
+#if ODM_SIMD_SSE
+	#define ODM_PACKET4_BINARY(op, intrinsic) \
+		inline floatx4 operator op(const floatx4& a, const floatx4& b) { return floatx4(intrinsic(a.v, b.v)); }
+	#define ODM_PACKET4_COMPARE(op, intrinsic) \
+		inline maskx4 operator op(const floatx4& a, const floatx4& b) { return maskx4(intrinsic(a.v, b.v)); }
+	#define ODM_MASK4_BINARY(op, intrinsic) \
+		inline maskx4 operator op(const maskx4& a, const maskx4& b) { return maskx4(intrinsic(a.v, b.v)); }
+
+	ODM_PACKET4_BINARY(+, _mm_add_ps)
+	ODM_PACKET4_BINARY(-, _mm_sub_ps)
+	ODM_PACKET4_BINARY(*, _mm_mul_ps)
+	ODM_PACKET4_BINARY(/, _mm_div_ps)
+	ODM_PACKET4_COMPARE(==, _mm_cmpeq_ps)
+	ODM_PACKET4_COMPARE(!=, _mm_cmpneq_ps)
+	ODM_PACKET4_COMPARE(<, _mm_cmplt_ps)
+	ODM_PACKET4_COMPARE(<=, _mm_cmple_ps)
+	ODM_PACKET4_COMPARE(>, _mm_cmpgt_ps)
+	ODM_PACKET4_COMPARE(>=, _mm_cmpge_ps)
+	ODM_MASK4_BINARY(&, _mm_and_ps)
+	ODM_MASK4_BINARY(|, _mm_or_ps)
+	ODM_MASK4_BINARY(^, _mm_xor_ps)
+
+	inline floatx4 operator-(const floatx4& a) { return floatx4(_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))); }
+	inline maskx4 operator~(const maskx4& a) { return maskx4(_mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1)))); }
+
+	inline floatx4 Min(const floatx4& a, const floatx4& b) { return floatx4(_mm_min_ps(a.v, b.v)); }
+	inline floatx4 Max(const floatx4& a, const floatx4& b) { return floatx4(_mm_max_ps(a.v, b.v)); }
+	inline floatx4 Sqrt(const floatx4& a) { return floatx4(_mm_sqrt_ps(a.v)); }
+	inline floatx4 Abs(const floatx4& a) { return floatx4(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+
+	/** Lanes of a where mask is false and of b where it is true, like Select(quat0, quat1, select1). */
+	inline floatx4 Select(const floatx4& a, const floatx4& b, const maskx4& mask)
+	{
+		return floatx4(_mm_or_ps(_mm_andnot_ps(mask.v, a.v), _mm_and_ps(mask.v, b.v)));
+	}
+
+	/** a * b + c */
+	inline floatx4 MulAdd(const floatx4& a, const floatx4& b, const floatx4& c) { return floatx4(_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)); }
+
+	#undef ODM_PACKET4_BINARY
+	#undef ODM_PACKET4_COMPARE
+	#undef ODM_MASK4_BINARY
+#else
+	#define ODM_PACKET4_BINARY(op) \
+		inline floatx4 operator op(const floatx4& a, const floatx4& b) \
+		{ return floatx4(a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2], a.v[3] op b.v[3]); }
+	#define ODM_PACKET4_COMPARE(op) \
+		inline maskx4 operator op(const floatx4& a, const floatx4& b) \
+		{ maskx4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] op b.v[i]; return r; }
+	#define ODM_MASK4_BINARY(op) \
+		inline maskx4 operator op(const maskx4& a, const maskx4& b) \
+		{ maskx4 r; for (int i = 0; i < 4; ++i) r.v[i] = (a.v[i] op b.v[i]) != 0; return r; }
+
+	ODM_PACKET4_BINARY(+)
+	ODM_PACKET4_BINARY(-)
+	ODM_PACKET4_BINARY(*)
+	ODM_PACKET4_BINARY(/)
+	ODM_PACKET4_COMPARE(==)
+	ODM_PACKET4_COMPARE(!=)
+	ODM_PACKET4_COMPARE(<)
+	ODM_PACKET4_COMPARE(<=)
+	ODM_PACKET4_COMPARE(>)
+	ODM_PACKET4_COMPARE(>=)
+	ODM_MASK4_BINARY(&)
+	ODM_MASK4_BINARY(|)
+	ODM_MASK4_BINARY(^)
+
+	inline floatx4 operator-(const floatx4& a) { return floatx4(-a.v[0], -a.v[1], -a.v[2], -a.v[3]); }
+	inline maskx4 operator~(const maskx4& a) { maskx4 r; for (int i = 0; i < 4; ++i) r.v[i] = !a.v[i]; return r; }
+
+	inline floatx4 Min(const floatx4& a, const floatx4& b)
+	{
+		return floatx4(MathF::Min(a.v[0], b.v[0]), MathF::Min(a.v[1], b.v[1]), MathF::Min(a.v[2], b.v[2]), MathF::Min(a.v[3], b.v[3]));
+	}
+
+	inline floatx4 Max(const floatx4& a, const floatx4& b)
+	{
+		return floatx4(MathF::Max(a.v[0], b.v[0]), MathF::Max(a.v[1], b.v[1]), MathF::Max(a.v[2], b.v[2]), MathF::Max(a.v[3], b.v[3]));
+	}
+
+	inline floatx4 Sqrt(const floatx4& a) { return floatx4(std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])); }
+	inline floatx4 Abs(const floatx4& a) { return floatx4(std::abs(a.v[0]), std::abs(a.v[1]), std::abs(a.v[2]), std::abs(a.v[3])); }
+
+	/** Lanes of a where mask is false and of b where it is true, like Select(quat0, quat1, select1). */
+	inline floatx4 Select(const floatx4& a, const floatx4& b, const maskx4& mask)
+	{
+		return floatx4(mask.v[0] ? b.v[0] : a.v[0], mask.v[1] ? b.v[1] : a.v[1], mask.v[2] ? b.v[2] : a.v[2], mask.v[3] ? b.v[3] : a.v[3]);
+	}
+
+	/** a * b + c */
+	inline floatx4 MulAdd(const floatx4& a, const floatx4& b, const floatx4& c) { return a * b + c; }
+
+	#undef ODM_PACKET4_BINARY
+	#undef ODM_PACKET4_COMPARE
+	#undef ODM_MASK4_BINARY
+#endif
+
+	/** Per-lane booleans of a floatx8, produced by comparisons and consumed by Select. */
+	struct maskx8
+	{
+		static constexpr int Width = 8;
+
+		maskx4 lo, hi;	// Lanes 0-3 and 4-7.
+
+		maskx8() = default;
+
+		/**
+		 * Constructs a mask with every lane set to b.
+		 * @param b The value of all lanes.
+		 */
+		explicit maskx8(bool b)
+		{
+			lo = hi = maskx4(b);
+		}
+
+		maskx8(const maskx4& l, const maskx4& h) : lo(l), hi(h) {}
+
+		/** Gets the lanes as bits, lane i in bit i. */
+		NODISCARD int Bits() const
+		{
+			return lo.Bits() | (hi.Bits() << 4);
+		}
+
+		NODISCARD bool GetLane(int lane) const { assert(lane >= 0 && lane < Width); return (Bits() >> lane) & 1; }
+		NODISCARD bool Any() const { return Bits() != 0; }
+		NODISCARD bool All() const { return Bits() == 0xFF; }
+		NODISCARD bool None() const { return Bits() == 0; }
+	};
+
+	/** Eight float lanes. */
+	struct floatx8
+	{
+		static constexpr int Width = 8;
+		using Mask = maskx8;
+
+		floatx4 lo, hi;	// Lanes 0-3 and 4-7.
+
+		floatx8() = default;
+
+		/**
+		 * Constructs a packet with every lane set to f.
+		 * @param f The value of all lanes.
+		 */
+		floatx8(float f)
+		{
+			lo = hi = floatx4(f);
+		}
+
+		floatx8(const floatx4& l, const floatx4& h) : lo(l), hi(h) {}
+
+		/**
+		 * Loads eight consecutive floats.
+		 * @param f Pointer to the first float; needs no alignment.
+		 */
+		NODISCARD static floatx8 Load(const float* f)
+		{
+			return floatx8(floatx4::Load(f), floatx4::Load(f + 4));
+		}
+
+		/**
+		 * Stores the lanes to eight consecutive floats.
+		 * @param f Pointer to the first float; needs no alignment.
+		 */
+		void Store(float* f) const
+		{
+			lo.Store(f);
+			hi.Store(f + 4);
+		}
+
+		NODISCARD float GetLane(int lane) const
+		{
+			assert(lane >= 0 && lane < Width);
+			float f[Width];
+			Store(f);
+			return f[lane];
+		}
+
+		void SetLane(int lane, float f)
+		{
+			assert(lane >= 0 && lane < Width);
+			float lanes[Width];
+			Store(lanes);
+			lanes[lane] = f;
+			*this = Load(lanes);
+		}
+	};
+
+	#define ODM_PACKET8_BINARY(op) \
+		inline floatx8 operator op(const floatx8& a, const floatx8& b) { return floatx8(a.lo op b.lo, a.hi op b.hi); }
+	#define ODM_PACKET8_COMPARE(op) \
+		inline maskx8 operator op(const floatx8& a, const floatx8& b) { return maskx8(a.lo op b.lo, a.hi op b.hi); }
+	#define ODM_MASK8_BINARY(op) \
+		inline maskx8 operator op(const maskx8& a, const maskx8& b) { return maskx8(a.lo op b.lo, a.hi op b.hi); }
+
+	ODM_PACKET8_BINARY(+)
+	ODM_PACKET8_BINARY(-)
+	ODM_PACKET8_BINARY(*)
+	ODM_PACKET8_BINARY(/)
+	ODM_PACKET8_COMPARE(==)
+	ODM_PACKET8_COMPARE(!=)
+	ODM_PACKET8_COMPARE(<)
+	ODM_PACKET8_COMPARE(<=)
+	ODM_PACKET8_COMPARE(>)
+	ODM_PACKET8_COMPARE(>=)
+	ODM_MASK8_BINARY(&)
+	ODM_MASK8_BINARY(|)
+	ODM_MASK8_BINARY(^)
+
+	inline floatx8 operator-(const floatx8& a) { return floatx8(-a.lo, -a.hi); }
+	inline maskx8 operator~(const maskx8& a) { return maskx8(~a.lo, ~a.hi); }
+
+	inline floatx8 Min(const floatx8& a, const floatx8& b) { return floatx8(Min(a.lo, b.lo), Min(a.hi, b.hi)); }
+	inline floatx8 Max(const floatx8& a, const floatx8& b) { return floatx8(Max(a.lo, b.lo), Max(a.hi, b.hi)); }
+	inline floatx8 Sqrt(const floatx8& a) { return floatx8(Sqrt(a.lo), Sqrt(a.hi)); }
+	inline floatx8 Abs(const floatx8& a) { return floatx8(Abs(a.lo), Abs(a.hi)); }
+
+	/** Lanes of a where mask is false and of b where it is true, like Select(quat0, quat1, select1). */
+	inline floatx8 Select(const floatx8& a, const floatx8& b, const maskx8& mask)
+	{
+		return floatx8(Select(a.lo, b.lo, mask.lo), Select(a.hi, b.hi, mask.hi));
+	}
+
+	/** a * b + c */
+	inline floatx8 MulAdd(const floatx8& a, const floatx8& b, const floatx8& c)
+	{
+		return floatx8(MulAdd(a.lo, b.lo, c.lo), MulAdd(a.hi, b.hi, c.hi));
+	}
+
+	#undef ODM_PACKET8_BINARY
+	#undef ODM_PACKET8_COMPARE
+	#undef ODM_MASK8_BINARY
+
+	inline floatx4& operator+=(floatx4& a, const floatx4& b) { return a = a + b; }
+	inline floatx4& operator-=(floatx4& a, const floatx4& b) { return a = a - b; }
+	inline floatx4& operator*=(floatx4& a, const floatx4& b) { return a = a * b; }
+	inline floatx4& operator/=(floatx4& a, const floatx4& b) { return a = a / b; }
+	inline floatx8& operator+=(floatx8& a, const floatx8& b) { return a = a + b; }
+	inline floatx8& operator-=(floatx8& a, const floatx8& b) { return a = a - b; }
+	inline floatx8& operator*=(floatx8& a, const floatx8& b) { return a = a * b; }
+	inline floatx8& operator/=(floatx8& a, const floatx8& b) { return a = a / b; }
+}
+
+#endif /* end of include guard: _PACKET_H_ */
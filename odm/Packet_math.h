@@ -0,0 +1,377 @@
+#pragma once
+
+#ifndef _PACKET_MATH_H_
+#define _PACKET_MATH_H_
+
+#include <cassert>
+#include "Packet.h"
+#include "Vector3f.h"
+#include "Quaternion.h"
+#include "Mat4x4.h"
+
+/*
+ * Wide counterparts of Vector3f, Quaternion and Matrix4x4: one component packet per field, element i in lane i.
+ * The member and free functions mirror the scalar API so a per-element routine ports lane for lane.
+ */
+
+namespace odm
+{
+	template <class F>
+	struct Vector3Packet
+	{
+		static constexpr int Width = F::Width;
+		using Mask = typename F::Mask;
+
+		F x, y, z;
+
+		Vector3Packet() = default;
+
+		Vector3Packet(const F& x, const F& y, const F& z)
+			: x(x), y(y), z(z)
+		{}
+
+		/**
+		 * Constructs a packet with every lane set to v.
+		 * @param v The value of all lanes.
+		 */
+		explicit Vector3Packet(const Vector3f& v)
+			: x(v.x), y(v.y), z(v.z)
+		{}
+
+		/**
+		 * Loads Width packed vectors.
+		 * @param in Pointer to the first vector.
+		 */
+		NODISCARD static Vector3Packet Load(const Vector3f* in)
+		{
+			float xs[Width], ys[Width], zs[Width];
+			for (int i = 0; i < Width; ++i)
+				xs[i] = in[i].x, ys[i] = in[i].y, zs[i] = in[i].z;
+			return LoadSoA(xs, ys, zs);
+		}
+
+		/**
+		 * Loads Width elements of component arrays, the fast path for Vec3SoA data.
+		 * @param xs Pointer to the first x component.
+		 * @param ys Pointer to the first y component.
+		 * @param zs Pointer to the first z component.
+		 */
+		NODISCARD static Vector3Packet LoadSoA(const float* xs, const float* ys, const float* zs)
+		{
+			return Vector3Packet(F::Load(xs), F::Load(ys), F::Load(zs));
+		}
+
+		/**
+		 * Stores the lanes as Width packed vectors.
+		 * @param out Pointer to the first vector.
+		 */
+		void Store(Vector3f* out) const
+		{
+			float xs[Width], ys[Width], zs[Width];
+			StoreSoA(xs, ys, zs);
+			for (int i = 0; i < Width; ++i)
+				out[i] = Vector3f(xs[i], ys[i], zs[i]);
+		}
+
+		/**
+		 * Stores the lanes to Width elements of component arrays.
+		 * @param xs Pointer to the first x component.
+		 * @param ys Pointer to the first y component.
+		 * @param zs Pointer to the first z component.
+		 */
+		void StoreSoA(float* xs, float* ys, float* zs) const
+		{
+			x.Store(xs);
+			y.Store(ys);
+			z.Store(zs);
+		}
+
+		NODISCARD Vector3f GetLane(int lane) const { return Vector3f(x.GetLane(lane), y.GetLane(lane), z.GetLane(lane)); }
+		void SetLane(int lane, const Vector3f& v) { x.SetLane(lane, v.x), y.SetLane(lane, v.y), z.SetLane(lane, v.z); }
+
+		NODISCARD F LengthSquared() const { return Dot(*this, *this); }
+		NODISCARD F Length() const { return Sqrt(LengthSquared()); }
+
+		/** Returns the normalized vectors; zero vectors are left as they are, like Vector3f::Normalize. */
+		NODISCARD Vector3Packet Normalize() const
+		{
+			const F lengthSquared = LengthSquared();
+			const F invLength = Select(F(1.0f), F(1.0f) / Sqrt(lengthSquared), lengthSquared > F(0.0f));
+			return *this * invLength;
+		}
+
+		static F Dot(const Vector3Packet& a, const Vector3Packet& b) { return MulAdd(a.z, b.z, MulAdd(a.y, b.y, a.x * b.x)); }
+
+		static Vector3Packet Cross(const Vector3Packet& lhs, const Vector3Packet& rhs)
+		{
+			return Vector3Packet(
+				lhs.y * rhs.z - rhs.y * lhs.z,
+				lhs.z * rhs.x - rhs.z * lhs.x,
+				lhs.x * rhs.y - rhs.x * lhs.y);
+		}
+
+		static Vector3Packet Min(const Vector3Packet& a, const Vector3Packet& b) { return Vector3Packet(odm::Min(a.x, b.x), odm::Min(a.y, b.y), odm::Min(a.z, b.z)); }
+		static Vector3Packet Max(const Vector3Packet& a, const Vector3Packet& b) { return Vector3Packet(odm::Max(a.x, b.x), odm::Max(a.y, b.y), odm::Max(a.z, b.z)); }
+
+		NODISCARD F Dot(const Vector3Packet& v) const { return Dot(*this, v); }
+		NODISCARD Vector3Packet Cross(const Vector3Packet& v) const { return Cross(*this, v); }
+
+		Vector3Packet operator+(const Vector3Packet& v) const { return Vector3Packet(x + v.x, y + v.y, z + v.z); }
+		Vector3Packet operator-(const Vector3Packet& v) const { return Vector3Packet(x - v.x, y - v.y, z - v.z); }
+		Vector3Packet operator*(const Vector3Packet& v) const { return Vector3Packet(x * v.x, y * v.y, z * v.z); }
+		Vector3Packet operator/(const Vector3Packet& v) const { return Vector3Packet(x / v.x, y / v.y, z / v.z); }
+		Vector3Packet operator*(const F& f) const { return Vector3Packet(x * f, y * f, z * f); }
+		Vector3Packet operator/(const F& f) const { return *this * (F(1.0f) / f); }
+		Vector3Packet operator-() const { return Vector3Packet(-x, -y, -z); }
+
+		Vector3Packet& operator+=(const Vector3Packet& v) { return *this = *this + v; }
+		Vector3Packet& operator-=(const Vector3Packet& v) { return *this = *this - v; }
+		Vector3Packet& operator*=(const F& f) { return *this = *this * f; }
+	};
+
+	template <class F>
+	inline Vector3Packet<F> Select(const Vector3Packet<F>& a, const Vector3Packet<F>& b, const typename F::Mask& mask)
+	{
+		return Vector3Packet<F>(Select(a.x, b.x, mask), Select(a.y, b.y, mask), Select(a.z, b.z, mask));
+	}
+
+	template <class F>
+	struct QuaternionPacket
+	{
+		static constexpr int Width = F::Width;
+		using Mask = typename F::Mask;
+
+		F x, y, z, w;
+
+		QuaternionPacket() = default;
+
+		QuaternionPacket(const F& x, const F& y, const F& z, const F& w)
+			: x(x), y(y), z(z), w(w)
+		{}
+
+		/**
+		 * Constructs a packet with every lane set to q.
+		 * @param q The value of all lanes.
+		 */
+		explicit QuaternionPacket(const Quaternion& q)
+			: x(q.x), y(q.y), z(q.z), w(q.w)
+		{}
+
+		static QuaternionPacket Identity() { return QuaternionPacket(F(0.0f), F(0.0f), F(0.0f), F(1.0f)); }
+
+		/**
+		 * Loads Width quaternions.
+		 * @param in Pointer to the first quaternion.
+		 */
+		NODISCARD static QuaternionPacket Load(const Quaternion* in)
+		{
+			float xs[Width], ys[Width], zs[Width], ws[Width];
+			for (int i = 0; i < Width; ++i)
+				xs[i] = in[i].x, ys[i] = in[i].y, zs[i] = in[i].z, ws[i] = in[i].w;
+			return QuaternionPacket(F::Load(xs), F::Load(ys), F::Load(zs), F::Load(ws));
+		}
+
+		/**
+		 * Stores the lanes as Width quaternions.
+		 * @param out Pointer to the first quaternion.
+		 */
+		void Store(Quaternion* out) const
+		{
+			float xs[Width], ys[Width], zs[Width], ws[Width];
+			x.Store(xs), y.Store(ys), z.Store(zs), w.Store(ws);
+			for (int i = 0; i < Width; ++i)
+				out[i] = Quaternion(xs[i], ys[i], zs[i], ws[i]);
+		}
+
+		NODISCARD Quaternion GetLane(int lane) const { return Quaternion(x.GetLane(lane), y.GetLane(lane), z.GetLane(lane), w.GetLane(lane)); }
+		void SetLane(int lane, const Quaternion& q) { x.SetLane(lane, q.x), y.SetLane(lane, q.y), z.SetLane(lane, q.z), w.SetLane(lane, q.w); }
+
+		NODISCARD F Dot(const QuaternionPacket& other) const { return MulAdd(w, other.w, MulAdd(z, other.z, MulAdd(y, other.y, x * other.x))); }
+		NODISCARD QuaternionPacket Conjugate() const { return QuaternionPacket(-x, -y, -z, w); }
+
+		/** Rotates vec by quat lane for lane, see Quaternion::Rotate. */
+		static Vector3Packet<F> Rotate(const QuaternionPacket& quat, const Vector3Packet<F>& vec)
+		{
+			const F tmpX = quat.w * vec.x + quat.y * vec.z - quat.z * vec.y;
+			const F tmpY = quat.w * vec.y + quat.z * vec.x - quat.x * vec.z;
+			const F tmpZ = quat.w * vec.z + quat.x * vec.y - quat.y * vec.x;
+			const F tmpW = quat.x * vec.x + quat.y * vec.y + quat.z * vec.z;
+			return Vector3Packet<F>(
+				tmpW * quat.x + tmpX * quat.w - tmpY * quat.z + tmpZ * quat.y,
+				tmpW * quat.y + tmpY * quat.w - tmpZ * quat.x + tmpX * quat.z,
+				tmpW * quat.z + tmpZ * quat.w - tmpX * quat.y + tmpY * quat.x);
+		}
+
+		QuaternionPacket operator+(const QuaternionPacket& q) const { return QuaternionPacket(x + q.x, y + q.y, z + q.z, w + q.w); }
+		QuaternionPacket operator-(const QuaternionPacket& q) const { return QuaternionPacket(x - q.x, y - q.y, z - q.z, w - q.w); }
+		QuaternionPacket operator*(const F& f) const { return QuaternionPacket(x * f, y * f, z * f, w * f); }
+		QuaternionPacket operator-() const { return QuaternionPacket(-x, -y, -z, -w); }
+
+		/** Hamilton product, normalized like Quaternion::operator*. */
+		QuaternionPacket operator*(const QuaternionPacket& quat) const;
+
+		/** Hamilton product without the normalization, see Quaternion::MulNoNormalize. */
+		NODISCARD QuaternionPacket MulNoNormalize(const QuaternionPacket& quat) const
+		{
+			return QuaternionPacket(
+				w * quat.x + x * quat.w + y * quat.z - z * quat.y,
+				w * quat.y + y * quat.w + z * quat.x - x * quat.z,
+				w * quat.z + z * quat.w + x * quat.y - y * quat.x,
+				w * quat.w - x * quat.x - y * quat.y - z * quat.z);
+		}
+	};
+
+	template <class F>
+	inline F Norm(const QuaternionPacket<F>& quaternion) { return quaternion.Dot(quaternion); }
+
+	template <class F>
+	inline F Length(const QuaternionPacket<F>& quaternion) { return Sqrt(Norm(quaternion)); }
+
+	template <class F>
+	inline QuaternionPacket<F> Normalize(const QuaternionPacket<F>& quaternion) { return quaternion * (F(1.0f) / Length(quaternion)); }
+
+	template <class F>
+	inline QuaternionPacket<F> Select(const QuaternionPacket<F>& quat0, const QuaternionPacket<F>& quat1, const typename F::Mask& select1)
+	{
+		return QuaternionPacket<F>(
+			Select(quat0.x, quat1.x, select1), Select(quat0.y, quat1.y, select1),
+			Select(quat0.z, quat1.z, select1), Select(quat0.w, quat1.w, select1));
+	}
+
+	template <class F>
+	inline QuaternionPacket<F> QuaternionPacket<F>::operator*(const QuaternionPacket& quat) const
+	{
+		return Normalize(MulNoNormalize(quat));
+	}
+
+	/** Column-major like Matrix4x4: m[column][row], translation in m[3]. */
+	template <class F>
+	struct Matrix4x4Packet
+	{
+		static constexpr int Width = F::Width;
+		using Mask = typename F::Mask;
+
+		F m[4][4];
+
+		Matrix4x4Packet() = default;
+
+		/**
+		 * Constructs a packet with every lane set to mat.
+		 * @param mat The value of all lanes.
+		 */
+		explicit Matrix4x4Packet(const Matrix4x4& mat)
+		{
+			for (int c = 0; c < 4; ++c)
+				for (int r = 0; r < 4; ++r)
+					m[c][r] = F(mat.m[c][r]);
+		}
+
+		/**
+		 * Loads Width matrices.
+		 * @param in Pointer to the first matrix.
+		 */
+		NODISCARD static Matrix4x4Packet Load(const Matrix4x4* in)
+		{
+			Matrix4x4Packet result;
+			float lanes[Width];
+			for (int e = 0; e < 16; ++e)
+			{
+				for (int i = 0; i < Width; ++i)
+					lanes[i] = in[i].elem[e];
+				result.m[e / 4][e % 4] = F::Load(lanes);
+			}
+			return result;
+		}
+
+		/**
+		 * Stores the lanes as Width matrices.
+		 * @param out Pointer to the first matrix.
+		 */
+		void Store(Matrix4x4* out) const
+		{
+			float lanes[Width];
+			for (int e = 0; e < 16; ++e)
+			{
+				m[e / 4][e % 4].Store(lanes);
+				for (int i = 0; i < Width; ++i)
+					out[i].elem[e] = lanes[i];
+			}
+		}
+
+		NODISCARD Matrix4x4 GetLane(int lane) const
+		{
+			Matrix4x4 result;
+			for (int e = 0; e < 16; ++e)
+				result.elem[e] = m[e / 4][e % 4].GetLane(lane);
+			return result;
+		}
+
+		void SetLane(int lane, const Matrix4x4& mat)
+		{
+			for (int e = 0; e < 16; ++e)
+				m[e / 4][e % 4].SetLane(lane, mat.elem[e]);
+		}
+
+		NODISCARD Matrix4x4Packet Transpose() const
+		{
+			Matrix4x4Packet result;
+			for (int c = 0; c < 4; ++c)
+				for (int r = 0; r < 4; ++r)
+					result.m[c][r] = m[r][c];
+			return result;
+		}
+
+		/** (m * vec4(v, 1)).xyz, the translation applies. */
+		NODISCARD Vector3Packet<F> TransformPoint(const Vector3Packet<F>& v) const
+		{
+			return Vector3Packet<F>(
+				MulAdd(m[2][0], v.z, MulAdd(m[1][0], v.y, MulAdd(m[0][0], v.x, m[3][0]))),
+				MulAdd(m[2][1], v.z, MulAdd(m[1][1], v.y, MulAdd(m[0][1], v.x, m[3][1]))),
+				MulAdd(m[2][2], v.z, MulAdd(m[1][2], v.y, MulAdd(m[0][2], v.x, m[3][2]))));
+		}
+
+		/** (m * vec4(v, 0)).xyz, the translation is ignored. */
+		NODISCARD Vector3Packet<F> TransformVector(const Vector3Packet<F>& v) const
+		{
+			return Vector3Packet<F>(
+				MulAdd(m[2][0], v.z, MulAdd(m[1][0], v.y, m[0][0] * v.x)),
+				MulAdd(m[2][1], v.z, MulAdd(m[1][1], v.y, m[0][1] * v.x)),
+				MulAdd(m[2][2], v.z, MulAdd(m[1][2], v.y, m[0][2] * v.x)));
+		}
+
+		/** Matrix product lane for lane. */
+		Matrix4x4Packet operator*(const Matrix4x4Packet& rhs) const
+		{
+			Matrix4x4Packet result;
+			for (int c = 0; c < 4; ++c)
+				for (int r = 0; r < 4; ++r)
+					result.m[c][r] = MulAdd(m[3][r], rhs.m[c][3], MulAdd(m[2][r], rhs.m[c][2], MulAdd(m[1][r], rhs.m[c][1], m[0][r] * rhs.m[c][0])));
+			return result;
+		}
+
+		/** m * vec4(v, 1) divided by its w, like Matrix4x4::operator*(const vec3&). */
+		Vector3Packet<F> operator*(const Vector3Packet<F>& v) const
+		{
+			const F invW = F(1.0f) / MulAdd(m[2][3], v.z, MulAdd(m[1][3], v.y, MulAdd(m[0][3], v.x, m[3][3])));
+			return TransformPoint(v) * invW;
+		}
+	};
+
+	template <class F>
+	inline Matrix4x4Packet<F> Select(const Matrix4x4Packet<F>& a, const Matrix4x4Packet<F>& b, const typename F::Mask& mask)
+	{
+		Matrix4x4Packet<F> result;
+		for (int c = 0; c < 4; ++c)
+			for (int r = 0; r < 4; ++r)
+				result.m[c][r] = Select(a.m[c][r], b.m[c][r], mask);
+		return result;
+	}
+
+	typedef Vector3Packet<floatx4> vec3x4;
+	typedef Vector3Packet<floatx8> vec3x8;
+	typedef QuaternionPacket<floatx4> quatx4;
+	typedef QuaternionPacket<floatx8> quatx8;
+	typedef Matrix4x4Packet<floatx8> mat4x8;
+}
+
+#endif /* end of include guard: _PACKET_MATH_H_ */
@@ -4,9 +4,18 @@
 #define QUATERNION_H
 
 #include "Vector4f.h"
+#include "Mat4x4.h"
 
 namespace odm
 {
+	/** How products of unit quaternions are brought back to unit length. */
+	enum class QuatRenormalize
+	{
+		Never,		// Keep the raw product; normalize once at the end of a chain of multiplications.
+		Fast,		// Reciprocal square root estimate refined by one Newton-Raphson step.
+		Exact		// Square root and divide, as operator* does.
+	};
+
 	struct Quaternion
 	{
 		float x, y, z, w;
@@ -26,12 +35,25 @@ namespace odm
 
 		vec3 GetAxis() const;
 		vec3 ToEulerAngles() const;
+
+		/**
+		 * Builds the rotation matrix of a unit quaternion without trigonometry.
+		 * The translation is zero and the fourth row is (0, 0, 0, 1).
+		 */
+		Matrix4x4 ToMatrix() const;
 		
 		Quaternion& operator=(const Quaternion& quaternion) = default;
 
 		const Quaternion operator+(const Quaternion& Quaternion) const;
 		const Quaternion operator-(const Quaternion& Quaternion) const;
 		const Quaternion operator*(const Quaternion& Quaternion) const;
+
+		/**
+		 * Calculates the Hamilton product without normalizing it, unlike operator*.
+		 * Rounding makes long chains drift from unit length; see Renormalize.
+		 * @param quat The right hand side rotation, applied first.
+		 */
+		Quaternion MulNoNormalize(const Quaternion& quat) const;
 		const Quaternion operator*(float scalar) const;
 		const Quaternion operator/(float scalar) const;
 		float operator[](int idx) const;
@@ -68,6 +90,12 @@ namespace odm
 		static Quaternion Identity();
 		static Quaternion FromEulerAngles(const vec3& angles);
 
+		/**
+		 * Extracts the rotation from the upper 3x3 block of a matrix (Shepperd's method).
+		 * @param mat A matrix whose upper 3x3 block is a pure rotation; scale must be removed beforehand.
+		 */
+		static Quaternion FromMatrix(const Matrix4x4& mat);
+
 		static vec3 Rotate(const Quaternion& quat, const vec3& vec);
 
 		static const Quaternion Rotation(const vec3& unitVec0, const vec3& unitVec1);
@@ -136,6 +164,44 @@ namespace odm
 		return pitch * yaw * roll;
 	}
 
+	inline Matrix4x4 Quaternion::ToMatrix() const {
+		const float x2 = x + x, y2 = y + y, z2 = z + z;
+		const float xx = x * x2, yy = y * y2, zz = z * z2;
+		const float xy = x * y2, xz = x * z2, yz = y * z2;
+		const float wx = w * x2, wy = w * y2, wz = w * z2;
+
+		Matrix4x4 result;
+		result.m[0] = Vector4f(1.0f - (yy + zz), xy + wz, xz - wy, 0.0f);
+		result.m[1] = Vector4f(xy - wz, 1.0f - (xx + zz), yz + wx, 0.0f);
+		result.m[2] = Vector4f(xz + wy, yz - wx, 1.0f - (xx + yy), 0.0f);
+		result.m[3] = Vector4f(0.0f, 0.0f, 0.0f, 1.0f);
+		return result;
+	}
+
+	inline Quaternion Quaternion::FromMatrix(const Matrix4x4& mat) {
+		// Columns are stored first, so mat.m[col][row]; take the square root of the largest diagonal term to stay well conditioned.
+		const float m00 = mat.m[0].x, m11 = mat.m[1].y, m22 = mat.m[2].z;
+		const float trace = m00 + m11 + m22;
+		if (trace > 0.0f) {
+			const float s = std::sqrt(trace + 1.0f) * 2.0f;
+			const float invS = 1.0f / s;
+			return Quaternion((mat.m[1].z - mat.m[2].y) * invS, (mat.m[2].x - mat.m[0].z) * invS, (mat.m[0].y - mat.m[1].x) * invS, 0.25f * s);
+		}
+		if (m00 > m11 && m00 > m22) {
+			const float s = std::sqrt(1.0f + m00 - m11 - m22) * 2.0f;
+			const float invS = 1.0f / s;
+			return Quaternion(0.25f * s, (mat.m[1].x + mat.m[0].y) * invS, (mat.m[2].x + mat.m[0].z) * invS, (mat.m[1].z - mat.m[2].y) * invS);
+		}
+		if (m11 > m22) {
+			const float s = std::sqrt(1.0f + m11 - m00 - m22) * 2.0f;
+			const float invS = 1.0f / s;
+			return Quaternion((mat.m[1].x + mat.m[0].y) * invS, 0.25f * s, (mat.m[2].y + mat.m[1].z) * invS, (mat.m[2].x - mat.m[0].z) * invS);
+		}
+		const float s = std::sqrt(1.0f + m22 - m00 - m11) * 2.0f;
+		const float invS = 1.0f / s;
+		return Quaternion((mat.m[2].x + mat.m[0].z) * invS, (mat.m[2].y + mat.m[1].z) * invS, 0.25f * s, (mat.m[0].y - mat.m[1].x) * invS);
+	}
+
 	inline Quaternion& Quaternion::SetXYZ(const vec3& vec) {
 		x = vec.x;
 		y = vec.y;
@@ -224,7 +290,13 @@ namespace odm
 
 	inline const Quaternion NormalizeEst(const Quaternion& quaternion) {
 		const float lenSqr = Norm(quaternion);
+#if ODM_SIMD_SSE
+		// rsqrtss is accurate to 12 bits; one Newton-Raphson step brings it close to full precision.
+		const float est = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(lenSqr)));
+		const float lenInv = est * (1.5f - 0.5f * lenSqr * est * est);
+#else
 		const float lenInv = 1 / sqrt(lenSqr);
+#endif
 		return quaternion * lenInv;
 	}
 
@@ -239,13 +311,31 @@ namespace odm
 		return Quaternion((unitVec * sin(angle)), cos(angle));
 	}
 
-	inline const Quaternion Quaternion::operator*(const Quaternion& quat) const {
-		return Normalize(Quaternion(
+	inline Quaternion Quaternion::MulNoNormalize(const Quaternion& quat) const {
+		return Quaternion(
 			(((w * quat.x) + (x * quat.w)) + (y * quat.z)) - (z * quat.y),
 			(((w * quat.y) + (y * quat.w)) + (z * quat.x)) - (x * quat.z),
 			(((w * quat.z) + (z * quat.w)) + (x * quat.y)) - (y * quat.x),
 			(((w * quat.w) - (x * quat.x)) - (y * quat.y)) - (z * quat.z)
-		));
+		);
+	}
+
+	inline const Quaternion Quaternion::operator*(const Quaternion& quat) const {
+		return Normalize(MulNoNormalize(quat));
+	}
+
+	/**
+	 * Brings a quaternion back to unit length.
+	 * @param quaternion The quaternion, e.g. the result of a chain of MulNoNormalize.
+	 * @param policy QuatRenormalize::Never returns the quaternion as it is.
+	 */
+	inline const Quaternion Renormalize(const Quaternion& quaternion, QuatRenormalize policy) {
+		switch (policy)
+		{
+		case QuatRenormalize::Never:	return quaternion;
+		case QuatRenormalize::Fast:		return NormalizeEst(quaternion);
+		default:						return Normalize(quaternion);
+		}
 	}
 
 	inline vec3 Quaternion::Rotate(const Quaternion& quat, const vec3& vec) {
@@ -276,6 +366,65 @@ namespace odm
 		return result;
 	}
 
+	/**
+	 * Spherical linear interpolation along the shorter arc, at constant angular velocity.
+	 * Falls back to linear interpolation once the quaternions are closer than VECTORMATH_SLERP_TOL.
+	 * @param quat0 The rotation at t = 0.
+	 * @param quat1 The rotation at t = 1.
+	 * @param t Interpolation parameter, usually in [0, 1].
+	 */
+	inline const Quaternion Slerp(const Quaternion& quat0, const Quaternion& quat1, float t) {
+		float cosAngle = quat0.Dot(quat1);
+		Quaternion start = quat0;
+		if (cosAngle < 0.0f) {
+			cosAngle = -cosAngle;
+			start = -quat0;
+		}
+
+		float scale0, scale1;
+		if (cosAngle < VECTORMATH_SLERP_TOL) {
+			const float angle = acosf(cosAngle);
+			const float recipSinAngle = 1.0f / sinf(angle);
+			scale0 = sinf((1.0f - t) * angle) * recipSinAngle;
+			scale1 = sinf(t * angle) * recipSinAngle;
+		}
+		else {
+			scale0 = 1.0f - t;
+			scale1 = t;
+		}
+		return start * scale0 + quat1 * scale1;
+	}
+
+	/**
+	 * Normalized linear interpolation along the shorter arc.
+	 * Follows the same path as Slerp but speeds up towards the middle of wide arcs.
+	 * @param quat0 The rotation at t = 0.
+	 * @param quat1 The rotation at t = 1.
+	 * @param t Interpolation parameter, usually in [0, 1].
+	 */
+	inline const Quaternion Nlerp(const Quaternion& quat0, const Quaternion& quat1, float t) {
+		const Quaternion end = quat0.Dot(quat1) < 0.0f ? -quat1 : quat1;
+		return Normalize(quat0 * (1.0f - t) + end * t);
+	}
+
+	/**
+	 * Approximates Slerp without acos or sin: Nlerp with t reshaped by a polynomial in t and the cosine
+	 * of the arc (Kapoulkine, "Approximating slerp"). The result stays within 1e-3 radians of Slerp for t in [0, 1].
+	 * @param quat0 The rotation at t = 0.
+	 * @param quat1 The rotation at t = 1.
+	 * @param t Interpolation parameter in [0, 1].
+	 */
+	inline const Quaternion SlerpFast(const Quaternion& quat0, const Quaternion& quat1, float t) {
+		const float cosAngle = quat0.Dot(quat1);
+		const float d = fabsf(cosAngle);
+		const float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+		const float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+		const float k = a * (t - 0.5f) * (t - 0.5f) + b;
+		const float ot = t + t * (t - 0.5f) * (t - 1.0f) * k;
+		const Quaternion end = cosAngle < 0.0f ? -quat1 : quat1;
+		return Normalize(quat0 * (1.0f - ot) + end * ot);
+	}
+
 }
 
 #endif /* end of include guard: QUATERNION_H */
@@ -0,0 +1,571 @@
+#include "Quaternion_batch.h"
+
+#include <cassert>
+#include "Simd.h"
+#include "Simd_soa.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	static void MultiplyScalar(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t first, size_t count, QuatRenormalize policy)
+	{
+		for (size_t i = first; i < count; ++i)
+			out[i] = Renormalize(a[i].MulNoNormalize(b[i]), policy);
+	}
+
+	static void ConjugateScalar(const Quaternion* in, Quaternion* out, size_t first, size_t count)
+	{
+		for (size_t i = first; i < count; ++i)
+			out[i] = in[i].Conjugate();
+	}
+
+	static void NormalizeScalar(const Quaternion* in, Quaternion* out, size_t first, size_t count, QuatRenormalize policy)
+	{
+		for (size_t i = first; i < count; ++i)
+			out[i] = Renormalize(in[i], policy);
+	}
+
+	static void RotateScalar(const Quaternion* q, size_t qStride, const Vector3f* v, Vector3f* out, size_t first, size_t count)
+	{
+		for (size_t i = first; i < count; ++i)
+			out[i] = Quaternion::Rotate(q[i * qStride], v[i]);
+	}
+
+	static void NlerpScalar(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t first, size_t count)
+	{
+		for (size_t i = first; i < count; ++i)
+			out[i] = Nlerp(a[i], b[i], t[i * tStride]);
+	}
+
+	static void SlerpFastScalar(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t first, size_t count)
+	{
+		for (size_t i = first; i < count; ++i)
+			out[i] = SlerpFast(a[i], b[i], t[i * tStride]);
+	}
+
+	/** Exact slerp needs acos and sin per pair, so every tier runs it element by element; SlerpFast is the wide path. */
+	static void SlerpScalar(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = Slerp(a[i], b[i], t[i * tStride]);
+	}
+
+#if ODM_SIMD_SSE
+
+	using MultiplyFn = void (*)(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count);
+	using NormalizeFn = void (*)(const Quaternion* in, Quaternion* out, size_t count);
+
+	template <QuatRenormalize Policy>
+	static inline void Renormalize4(__m128& x, __m128& y, __m128& z, __m128& w)
+	{
+		if (Policy == QuatRenormalize::Never)
+			return;
+
+		const __m128 norm = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+		__m128 invLength;
+		if (Policy == QuatRenormalize::Fast)
+		{
+			const __m128 est = _mm_rsqrt_ps(norm);
+			invLength = _mm_mul_ps(est, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), norm), _mm_mul_ps(est, est))));
+		}
+		else
+		{
+			invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(norm));
+		}
+		x = _mm_mul_ps(x, invLength);
+		y = _mm_mul_ps(y, invLength);
+		z = _mm_mul_ps(z, invLength);
+		w = _mm_mul_ps(w, invLength);
+	}
+
+	template <QuatRenormalize Policy>
+	static void MultiplySSE(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 ax, ay, az, aw, bx, by, bz, bw;
+			LoadQuats4(&a[i].x, ax, ay, az, aw);
+			LoadQuats4(&b[i].x, bx, by, bz, bw);
+
+			__m128 x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bx), _mm_mul_ps(ax, bw)), _mm_mul_ps(ay, bz)), _mm_mul_ps(az, by));
+			__m128 y = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, by), _mm_mul_ps(ay, bw)), _mm_mul_ps(az, bx)), _mm_mul_ps(ax, bz));
+			__m128 z = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bz), _mm_mul_ps(az, bw)), _mm_mul_ps(ax, by)), _mm_mul_ps(ay, bx));
+			__m128 w = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(aw, bw), _mm_mul_ps(ax, bx)), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+			Renormalize4<Policy>(x, y, z, w);
+
+			StoreQuats4(&out[i].x, x, y, z, w);
+		}
+		MultiplyScalar(a, b, out, i, count, Policy);
+	}
+
+	template <QuatRenormalize Policy>
+	static void NormalizeSSE(const Quaternion* in, Quaternion* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x, y, z, w;
+			LoadQuats4(&in[i].x, x, y, z, w);
+			Renormalize4<Policy>(x, y, z, w);
+			StoreQuats4(&out[i].x, x, y, z, w);
+		}
+		NormalizeScalar(in, out, i, count, Policy);
+	}
+
+	static void MultiplyBaseline(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count, QuatRenormalize policy)
+	{
+		static const MultiplyFn kernels[3] = { &MultiplySSE<QuatRenormalize::Never>, &MultiplySSE<QuatRenormalize::Fast>, &MultiplySSE<QuatRenormalize::Exact> };
+		kernels[static_cast<int>(policy)](a, b, out, count);
+	}
+
+	static void ConjugateBaseline(const Quaternion* in, Quaternion* out, size_t count)
+	{
+		// Conjugation only flips the sign bits of x, y and z, no transpose needed.
+		const __m128 signs = _mm_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f);
+		size_t i = 0;
+		for (; i + 2 <= count; i += 2)
+		{
+			const __m128 q0 = _mm_loadu_ps(&in[i].x);
+			const __m128 q1 = _mm_loadu_ps(&in[i + 1].x);
+			_mm_storeu_ps(&out[i].x, _mm_xor_ps(q0, signs));
+			_mm_storeu_ps(&out[i + 1].x, _mm_xor_ps(q1, signs));
+		}
+		ConjugateScalar(in, out, i, count);
+	}
+
+	static void NormalizeBaseline(const Quaternion* in, Quaternion* out, size_t count, QuatRenormalize policy)
+	{
+		static const NormalizeFn kernels[3] = { nullptr, &NormalizeSSE<QuatRenormalize::Fast>, &NormalizeSSE<QuatRenormalize::Exact> };
+		if (policy == QuatRenormalize::Never)
+		{
+			NormalizeScalar(in, out, 0, count, policy);
+			return;
+		}
+		kernels[static_cast<int>(policy)](in, out, count);
+	}
+
+	static void RotateBaseline(const Quaternion* q, size_t qStride, const Vector3f* v, Vector3f* out, size_t count)
+	{
+		if (count == 0)
+			return;
+
+		__m128 qx = _mm_set1_ps(q->x), qy = _mm_set1_ps(q->y), qz = _mm_set1_ps(q->z), qw = _mm_set1_ps(q->w);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			if (qStride != 0)
+				LoadQuats4(&q[i].x, qx, qy, qz, qw);
+
+			__m128 vx, vy, vz;
+			LoadPoints4(&v[i].x, vx, vy, vz);
+
+			const __m128 tmpX = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(qw, vx), _mm_mul_ps(qy, vz)), _mm_mul_ps(qz, vy));
+			const __m128 tmpY = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(qw, vy), _mm_mul_ps(qz, vx)), _mm_mul_ps(qx, vz));
+			const __m128 tmpZ = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(qw, vz), _mm_mul_ps(qx, vy)), _mm_mul_ps(qy, vx));
+			const __m128 tmpW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, vx), _mm_mul_ps(qy, vy)), _mm_mul_ps(qz, vz));
+
+			const __m128 rx = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(tmpW, qx), _mm_mul_ps(tmpX, qw)), _mm_mul_ps(tmpY, qz)), _mm_mul_ps(tmpZ, qy));
+			const __m128 ry = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(tmpW, qy), _mm_mul_ps(tmpY, qw)), _mm_mul_ps(tmpZ, qx)), _mm_mul_ps(tmpX, qz));
+			const __m128 rz = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(tmpW, qz), _mm_mul_ps(tmpZ, qw)), _mm_mul_ps(tmpX, qy)), _mm_mul_ps(tmpY, qx));
+
+			__m128 a, b, c;
+			PackPoints4(rx, ry, rz, a, b, c);
+			float* f = &out[i].x;
+			_mm_storeu_ps(f, a);
+			_mm_storeu_ps(f + 4, b);
+			_mm_storeu_ps(f + 8, c);
+		}
+		RotateScalar(q, qStride, v, out, i, count);
+	}
+
+	/** Nlerp, or SlerpFast when Fast is set, of four pairs. */
+	template <bool Fast>
+	static void InterpolateSSE(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t count)
+	{
+		if (count == 0)
+			return;
+
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		__m128 tt = _mm_set1_ps(*t);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			if (tStride != 0)
+				tt = _mm_loadu_ps(t + i);
+
+			__m128 ax, ay, az, aw, bx, by, bz, bw;
+			LoadQuats4(&a[i].x, ax, ay, az, aw);
+			LoadQuats4(&b[i].x, bx, by, bz, bw);
+			const __m128 cosAngle = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+
+			// Negate b where the arc is longer than half a turn, copying the sign of the cosine onto it.
+			const __m128 flip = _mm_and_ps(cosAngle, signMask);
+			bx = _mm_xor_ps(bx, flip);
+			by = _mm_xor_ps(by, flip);
+			bz = _mm_xor_ps(bz, flip);
+			bw = _mm_xor_ps(bw, flip);
+
+			__m128 ot = tt;
+			if (Fast)
+			{
+				const __m128 d = _mm_andnot_ps(signMask, cosAngle);
+				const __m128 ka = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f),
+					_mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+				const __m128 kb = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+				const __m128 h = _mm_sub_ps(tt, half);
+				const __m128 k = _mm_add_ps(_mm_mul_ps(ka, _mm_mul_ps(h, h)), kb);
+				ot = _mm_add_ps(tt, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(tt, h), _mm_sub_ps(tt, one)), k));
+			}
+
+			const __m128 st = _mm_sub_ps(one, ot);
+			__m128 x = _mm_add_ps(_mm_mul_ps(ax, st), _mm_mul_ps(bx, ot));
+			__m128 y = _mm_add_ps(_mm_mul_ps(ay, st), _mm_mul_ps(by, ot));
+			__m128 z = _mm_add_ps(_mm_mul_ps(az, st), _mm_mul_ps(bz, ot));
+			__m128 w = _mm_add_ps(_mm_mul_ps(aw, st), _mm_mul_ps(bw, ot));
+			Renormalize4<QuatRenormalize::Exact>(x, y, z, w);
+
+			StoreQuats4(&out[i].x, x, y, z, w);
+		}
+
+		if (Fast)
+			SlerpFastScalar(a, b, t, tStride, out, i, count);
+		else
+			NlerpScalar(a, b, t, tStride, out, i, count);
+	}
+
+#else
+
+	static void MultiplyBaseline(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count, QuatRenormalize policy)
+	{
+		MultiplyScalar(a, b, out, 0, count, policy);
+	}
+
+	static void ConjugateBaseline(const Quaternion* in, Quaternion* out, size_t count)
+	{
+		ConjugateScalar(in, out, 0, count);
+	}
+
+	static void NormalizeBaseline(const Quaternion* in, Quaternion* out, size_t count, QuatRenormalize policy)
+	{
+		NormalizeScalar(in, out, 0, count, policy);
+	}
+
+	static void RotateBaseline(const Quaternion* q, size_t qStride, const Vector3f* v, Vector3f* out, size_t count)
+	{
+		RotateScalar(q, qStride, v, out, 0, count);
+	}
+
+	static void NlerpBaseline(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t count)
+	{
+		NlerpScalar(a, b, t, tStride, out, 0, count);
+	}
+
+	static void SlerpFastBaseline(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t count)
+	{
+		SlerpFastScalar(a, b, t, tStride, out, 0, count);
+	}
+
+#endif
+
+#if ODM_SIMD_SSE
+	static const QuaternionKernels s_BaselineKernels = {
+		SimdLevel::Baseline, &MultiplyBaseline, &ConjugateBaseline, &NormalizeBaseline, &RotateBaseline,
+		&InterpolateSSE<false>, &InterpolateSSE<true>, &SlerpScalar
+	};
+#else
+	static const QuaternionKernels s_BaselineKernels = {
+		SimdLevel::Baseline, &MultiplyBaseline, &ConjugateBaseline, &NormalizeBaseline, &RotateBaseline,
+		&NlerpBaseline, &SlerpFastBaseline, &SlerpScalar
+	};
+#endif
+
+#if ODM_SIMD_SSE
+
+#pragma region AVX2
+
+	template <QuatRenormalize Policy>
+	ODM_TARGET("avx2,fma")
+	static inline void Renormalize8(__m256& x, __m256& y, __m256& z, __m256& w)
+	{
+		if (Policy == QuatRenormalize::Never)
+			return;
+
+		const __m256 norm = _mm256_fmadd_ps(w, w, _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x))));
+		__m256 invLength;
+		if (Policy == QuatRenormalize::Fast)
+		{
+			const __m256 est = _mm256_rsqrt_ps(norm);
+			const __m256 halfNormEst = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), norm), est);
+			invLength = _mm256_mul_ps(est, _mm256_fnmadd_ps(halfNormEst, est, _mm256_set1_ps(1.5f)));
+		}
+		else
+		{
+			invLength = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(norm));
+		}
+		x = _mm256_mul_ps(x, invLength);
+		y = _mm256_mul_ps(y, invLength);
+		z = _mm256_mul_ps(z, invLength);
+		w = _mm256_mul_ps(w, invLength);
+	}
+
+	template <QuatRenormalize Policy>
+	ODM_TARGET("avx2,fma")
+	static void MultiplyAVX2(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 ax, ay, az, aw, bx, by, bz, bw;
+			LoadQuats8(&a[i].x, ax, ay, az, aw);
+			LoadQuats8(&b[i].x, bx, by, bz, bw);
+
+			__m256 x = _mm256_fnmadd_ps(az, by, _mm256_fmadd_ps(ay, bz, _mm256_fmadd_ps(ax, bw, _mm256_mul_ps(aw, bx))));
+			__m256 y = _mm256_fnmadd_ps(ax, bz, _mm256_fmadd_ps(az, bx, _mm256_fmadd_ps(ay, bw, _mm256_mul_ps(aw, by))));
+			__m256 z = _mm256_fnmadd_ps(ay, bx, _mm256_fmadd_ps(ax, by, _mm256_fmadd_ps(az, bw, _mm256_mul_ps(aw, bz))));
+			__m256 w = _mm256_fnmadd_ps(az, bz, _mm256_fnmadd_ps(ay, by, _mm256_fnmadd_ps(ax, bx, _mm256_mul_ps(aw, bw))));
+			Renormalize8<Policy>(x, y, z, w);
+
+			StoreQuats8(&out[i].x, x, y, z, w);
+		}
+		MultiplyScalar(a, b, out, i, count, Policy);
+	}
+
+	template <QuatRenormalize Policy>
+	ODM_TARGET("avx2,fma")
+	static void NormalizeAVX2(const Quaternion* in, Quaternion* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z, w;
+			LoadQuats8(&in[i].x, x, y, z, w);
+			Renormalize8<Policy>(x, y, z, w);
+			StoreQuats8(&out[i].x, x, y, z, w);
+		}
+		NormalizeScalar(in, out, i, count, Policy);
+	}
+
+	static void MultiplyAVX2Dispatch(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count, QuatRenormalize policy)
+	{
+		static const MultiplyFn kernels[3] = { &MultiplyAVX2<QuatRenormalize::Never>, &MultiplyAVX2<QuatRenormalize::Fast>, &MultiplyAVX2<QuatRenormalize::Exact> };
+		kernels[static_cast<int>(policy)](a, b, out, count);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void ConjugateAVX2(const Quaternion* in, Quaternion* out, size_t count)
+	{
+		const __m256 signs = _mm256_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f, -0.0f, -0.0f, -0.0f, 0.0f);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m256 q01 = _mm256_loadu_ps(&in[i].x);
+			const __m256 q23 = _mm256_loadu_ps(&in[i + 2].x);
+			_mm256_storeu_ps(&out[i].x, _mm256_xor_ps(q01, signs));
+			_mm256_storeu_ps(&out[i + 2].x, _mm256_xor_ps(q23, signs));
+		}
+		ConjugateScalar(in, out, i, count);
+	}
+
+	static void NormalizeAVX2Dispatch(const Quaternion* in, Quaternion* out, size_t count, QuatRenormalize policy)
+	{
+		static const NormalizeFn kernels[3] = { nullptr, &NormalizeAVX2<QuatRenormalize::Fast>, &NormalizeAVX2<QuatRenormalize::Exact> };
+		if (policy == QuatRenormalize::Never)
+		{
+			NormalizeScalar(in, out, 0, count, policy);
+			return;
+		}
+		kernels[static_cast<int>(policy)](in, out, count);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void RotateAVX2(const Quaternion* q, size_t qStride, const Vector3f* v, Vector3f* out, size_t count)
+	{
+		if (count == 0)
+			return;
+
+		__m256 qx = _mm256_set1_ps(q->x), qy = _mm256_set1_ps(q->y), qz = _mm256_set1_ps(q->z), qw = _mm256_set1_ps(q->w);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			if (qStride != 0)
+				LoadQuats8(&q[i].x, qx, qy, qz, qw);
+
+			__m256 vx, vy, vz;
+			LoadPoints8(&v[i].x, vx, vy, vz);
+
+			const __m256 tmpX = _mm256_fnmadd_ps(qz, vy, _mm256_fmadd_ps(qy, vz, _mm256_mul_ps(qw, vx)));
+			const __m256 tmpY = _mm256_fnmadd_ps(qx, vz, _mm256_fmadd_ps(qz, vx, _mm256_mul_ps(qw, vy)));
+			const __m256 tmpZ = _mm256_fnmadd_ps(qy, vx, _mm256_fmadd_ps(qx, vy, _mm256_mul_ps(qw, vz)));
+			const __m256 tmpW = _mm256_fmadd_ps(qz, vz, _mm256_fmadd_ps(qy, vy, _mm256_mul_ps(qx, vx)));
+
+			const __m256 rx = _mm256_fmadd_ps(tmpZ, qy, _mm256_fnmadd_ps(tmpY, qz, _mm256_fmadd_ps(tmpX, qw, _mm256_mul_ps(tmpW, qx))));
+			const __m256 ry = _mm256_fmadd_ps(tmpX, qz, _mm256_fnmadd_ps(tmpZ, qx, _mm256_fmadd_ps(tmpY, qw, _mm256_mul_ps(tmpW, qy))));
+			const __m256 rz = _mm256_fmadd_ps(tmpY, qx, _mm256_fnmadd_ps(tmpX, qy, _mm256_fmadd_ps(tmpZ, qw, _mm256_mul_ps(tmpW, qz))));
+
+			__m256 l0, l1, l2;
+			PackPoints8(rx, ry, rz, l0, l1, l2);
+			float* f = &out[i].x;
+			_mm256_storeu_ps(f, l0);
+			_mm256_storeu_ps(f + 8, l1);
+			_mm256_storeu_ps(f + 16, l2);
+		}
+		RotateScalar(q, qStride, v, out, i, count);
+	}
+
+	template <bool Fast>
+	ODM_TARGET("avx2,fma")
+	static void InterpolateAVX2(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t count)
+	{
+		if (count == 0)
+			return;
+
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 half = _mm256_set1_ps(0.5f);
+		__m256 tt = _mm256_set1_ps(*t);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			if (tStride != 0)
+				tt = _mm256_loadu_ps(t + i);
+
+			__m256 ax, ay, az, aw, bx, by, bz, bw;
+			LoadQuats8(&a[i].x, ax, ay, az, aw);
+			LoadQuats8(&b[i].x, bx, by, bz, bw);
+			const __m256 cosAngle = _mm256_fmadd_ps(aw, bw, _mm256_fmadd_ps(az, bz, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(ax, bx))));
+
+			const __m256 flip = _mm256_and_ps(cosAngle, signMask);
+			bx = _mm256_xor_ps(bx, flip);
+			by = _mm256_xor_ps(by, flip);
+			bz = _mm256_xor_ps(bz, flip);
+			bw = _mm256_xor_ps(bw, flip);
+
+			__m256 ot = tt;
+			if (Fast)
+			{
+				const __m256 d = _mm256_andnot_ps(signMask, cosAngle);
+				const __m256 ka = _mm256_fmadd_ps(d, _mm256_fmadd_ps(d, _mm256_fnmadd_ps(d, _mm256_set1_ps(1.43519f), _mm256_set1_ps(3.55645f)), _mm256_set1_ps(-3.2452f)), _mm256_set1_ps(1.0904f));
+				const __m256 kb = _mm256_fmadd_ps(d, _mm256_fmadd_ps(d, _mm256_set1_ps(0.215638f), _mm256_set1_ps(-1.06021f)), _mm256_set1_ps(0.848013f));
+				const __m256 h = _mm256_sub_ps(tt, half);
+				const __m256 k = _mm256_fmadd_ps(ka, _mm256_mul_ps(h, h), kb);
+				ot = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_mul_ps(tt, h), _mm256_sub_ps(tt, one)), k, tt);
+			}
+
+			const __m256 st = _mm256_sub_ps(one, ot);
+			__m256 x = _mm256_fmadd_ps(bx, ot, _mm256_mul_ps(ax, st));
+			__m256 y = _mm256_fmadd_ps(by, ot, _mm256_mul_ps(ay, st));
+			__m256 z = _mm256_fmadd_ps(bz, ot, _mm256_mul_ps(az, st));
+			__m256 w = _mm256_fmadd_ps(bw, ot, _mm256_mul_ps(aw, st));
+			Renormalize8<QuatRenormalize::Exact>(x, y, z, w);
+
+			StoreQuats8(&out[i].x, x, y, z, w);
+		}
+
+		if (Fast)
+			SlerpFastScalar(a, b, t, tStride, out, i, count);
+		else
+			NlerpScalar(a, b, t, tStride, out, i, count);
+	}
+
+	// AVX-512 shares these kernels; quaternion streams are too short per call to amortize 16-lane transposes.
+	static const QuaternionKernels s_AVX2Kernels = {
+		SimdLevel::AVX2, &MultiplyAVX2Dispatch, &ConjugateAVX2, &NormalizeAVX2Dispatch, &RotateAVX2,
+		&InterpolateAVX2<false>, &InterpolateAVX2<true>, &SlerpScalar
+	};
+
+#pragma endregion
+
+#endif
+
+	const QuaternionKernels& GetQuaternionKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:	return s_AVX2Kernels;
+		default:				break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const QuaternionKernels& GetQuaternionKernels()
+	{
+		static const QuaternionKernels& kernels = GetQuaternionKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	void Multiply(Span<const Quaternion> a, Span<const Quaternion> b, Span<Quaternion> out, QuatRenormalize policy)
+	{
+		assert(a.size() == b.size() && a.size() == out.size());
+		GetQuaternionKernels().Multiply(a.data(), b.data(), out.data(), out.size(), policy);
+	}
+
+	void Conjugate(Span<const Quaternion> in, Span<Quaternion> out)
+	{
+		assert(in.size() == out.size());
+		GetQuaternionKernels().Conjugate(in.data(), out.data(), out.size());
+	}
+
+	void Normalize(Span<const Quaternion> in, Span<Quaternion> out, QuatRenormalize policy)
+	{
+		assert(in.size() == out.size());
+		GetQuaternionKernels().Normalize(in.data(), out.data(), out.size(), policy);
+	}
+
+	void Rotate(Span<const Quaternion> q, Span<const Vector3f> v, Span<Vector3f> out)
+	{
+		assert(q.size() == v.size() && v.size() == out.size());
+		GetQuaternionKernels().Rotate(q.data(), 1, v.data(), out.data(), out.size());
+	}
+
+	void Rotate(const Quaternion& q, Span<const Vector3f> v, Span<Vector3f> out)
+	{
+		assert(v.size() == out.size());
+		GetQuaternionKernels().Rotate(&q, 0, v.data(), out.data(), out.size());
+	}
+
+	void Nlerp(Span<const Quaternion> a, Span<const Quaternion> b, Span<const float> t, Span<Quaternion> out)
+	{
+		assert(a.size() == b.size() && a.size() == t.size() && a.size() == out.size());
+		GetQuaternionKernels().Nlerp(a.data(), b.data(), t.data(), 1, out.data(), out.size());
+	}
+
+	void Nlerp(Span<const Quaternion> a, Span<const Quaternion> b, float t, Span<Quaternion> out)
+	{
+		assert(a.size() == b.size() && a.size() == out.size());
+		GetQuaternionKernels().Nlerp(a.data(), b.data(), &t, 0, out.data(), out.size());
+	}
+
+	void SlerpFast(Span<const Quaternion> a, Span<const Quaternion> b, Span<const float> t, Span<Quaternion> out)
+	{
+		assert(a.size() == b.size() && a.size() == t.size() && a.size() == out.size());
+		GetQuaternionKernels().SlerpFast(a.data(), b.data(), t.data(), 1, out.data(), out.size());
+	}
+
+	void SlerpFast(Span<const Quaternion> a, Span<const Quaternion> b, float t, Span<Quaternion> out)
+	{
+		assert(a.size() == b.size() && a.size() == out.size());
+		GetQuaternionKernels().SlerpFast(a.data(), b.data(), &t, 0, out.data(), out.size());
+	}
+
+	void Slerp(Span<const Quaternion> a, Span<const Quaternion> b, Span<const float> t, Span<Quaternion> out)
+	{
+		assert(a.size() == b.size() && a.size() == t.size() && a.size() == out.size());
+		GetQuaternionKernels().Slerp(a.data(), b.data(), t.data(), 1, out.data(), out.size());
+	}
+
+	void Slerp(Span<const Quaternion> a, Span<const Quaternion> b, float t, Span<Quaternion> out)
+	{
+		assert(a.size() == b.size() && a.size() == out.size());
+		GetQuaternionKernels().Slerp(a.data(), b.data(), &t, 0, out.data(), out.size());
+	}
+}
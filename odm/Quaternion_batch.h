@@ -0,0 +1,151 @@
+#pragma once
+
+#ifndef _QUATERNION_BATCH_H_
+#define _QUATERNION_BATCH_H_
+
+#include <cstddef>
+#include "Quaternion.h"
+#include "Cpu.h"
+#include "Span.h"
+
+namespace odm
+{
+	/**
+	 * Table of quaternion kernels compiled for one instruction set tier.
+	 * Every kernel accepts an output that aliases its input element for element.
+	 */
+	struct QuaternionKernels
+	{
+		SimdLevel level;
+
+		/** out[i] = Renormalize(a[i].MulNoNormalize(b[i]), policy) */
+		void (*Multiply)(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count, QuatRenormalize policy);
+
+		/** out[i] = in[i].Conjugate() */
+		void (*Conjugate)(const Quaternion* in, Quaternion* out, size_t count);
+
+		/** out[i] = Renormalize(in[i], policy) */
+		void (*Normalize)(const Quaternion* in, Quaternion* out, size_t count, QuatRenormalize policy);
+
+		/** out[i] = Quaternion::Rotate(q[i * qStride], v[i]); a qStride of 0 applies one rotation to every vector */
+		void (*Rotate)(const Quaternion* q, size_t qStride, const Vector3f* v, Vector3f* out, size_t count);
+
+		/** out[i] = Nlerp(a[i], b[i], t[i * tStride]); a tStride of 0 shares one parameter */
+		void (*Nlerp)(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t count);
+
+		/** out[i] = SlerpFast(a[i], b[i], t[i * tStride]); a tStride of 0 shares one parameter */
+		void (*SlerpFast)(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t count);
+
+		/** out[i] = Slerp(a[i], b[i], t[i * tStride]); a tStride of 0 shares one parameter */
+		void (*Slerp)(const Quaternion* a, const Quaternion* b, const float* t, size_t tStride, Quaternion* out, size_t count);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const QuaternionKernels& GetQuaternionKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const QuaternionKernels& GetQuaternionKernels(SimdLevel level);
+
+	/**
+	 * Multiplies quaternions pairwise.
+	 * @param a Left hand side rotations.
+	 * @param b Right hand side rotations, applied first, as many as in a.
+	 * @param out Receives a[i] * b[i]; may alias a or b.
+	 * @param policy QuatRenormalize::Exact matches Quaternion::operator*, Never matches MulNoNormalize.
+	 */
+	void Multiply(Span<const Quaternion> a, Span<const Quaternion> b, Span<Quaternion> out, QuatRenormalize policy = QuatRenormalize::Exact);
+
+	/**
+	 * Conjugates quaternions, which inverts unit quaternions.
+	 * @param in Quaternions to be conjugated.
+	 * @param out Receives in[i].Conjugate(); may alias in.
+	 */
+	void Conjugate(Span<const Quaternion> in, Span<Quaternion> out);
+
+	/**
+	 * Normalizes quaternions.
+	 * @param in Quaternions to be normalized.
+	 * @param out Receives the unit quaternions; may alias in.
+	 * @param policy QuatRenormalize::Fast trades the last bits of precision for a reciprocal square root estimate.
+	 */
+	void Normalize(Span<const Quaternion> in, Span<Quaternion> out, QuatRenormalize policy = QuatRenormalize::Exact);
+
+	/**
+	 * Rotates vectors pairwise.
+	 * @param q Unit quaternions, one per vector.
+	 * @param v Vectors to be rotated.
+	 * @param out Receives Quaternion::Rotate(q[i], v[i]); may alias v.
+	 */
+	void Rotate(Span<const Quaternion> q, Span<const Vector3f> v, Span<Vector3f> out);
+
+	/**
+	 * Rotates vectors by one quaternion.
+	 * @param q The unit quaternion applied to every vector.
+	 * @param v Vectors to be rotated.
+	 * @param out Receives Quaternion::Rotate(q, v[i]); may alias v.
+	 */
+	void Rotate(const Quaternion& q, Span<const Vector3f> v, Span<Vector3f> out);
+
+	/**
+	 * Normalized-lerps quaternion pairs, each with its own parameter.
+	 * @param a The rotations at t = 0.
+	 * @param b The rotations at t = 1, as many as in a.
+	 * @param t Interpolation parameters, one per pair.
+	 * @param out Receives Nlerp(a[i], b[i], t[i]); may alias a or b.
+	 */
+	void Nlerp(Span<const Quaternion> a, Span<const Quaternion> b, Span<const float> t, Span<Quaternion> out);
+
+	/**
+	 * Normalized-lerps quaternion pairs with one shared parameter, e.g. a blend weight.
+	 * @param a The rotations at t = 0.
+	 * @param b The rotations at t = 1, as many as in a.
+	 * @param t Interpolation parameter applied to every pair.
+	 * @param out Receives Nlerp(a[i], b[i], t); may alias a or b.
+	 */
+	void Nlerp(Span<const Quaternion> a, Span<const Quaternion> b, float t, Span<Quaternion> out);
+
+	/**
+	 * Approximately slerps quaternion pairs, each with its own parameter, within 1e-3 radians of Slerp.
+	 * @param a The rotations at t = 0.
+	 * @param b The rotations at t = 1, as many as in a.
+	 * @param t Interpolation parameters, one per pair.
+	 * @param out Receives SlerpFast(a[i], b[i], t[i]); may alias a or b.
+	 */
+	void SlerpFast(Span<const Quaternion> a, Span<const Quaternion> b, Span<const float> t, Span<Quaternion> out);
+
+	/**
+	 * Approximately slerps quaternion pairs with one shared parameter, within 1e-3 radians of Slerp.
+	 * @param a The rotations at t = 0.
+	 * @param b The rotations at t = 1, as many as in a.
+	 * @param t Interpolation parameter applied to every pair.
+	 * @param out Receives SlerpFast(a[i], b[i], t); may alias a or b.
+	 */
+	void SlerpFast(Span<const Quaternion> a, Span<const Quaternion> b, float t, Span<Quaternion> out);
+
+	/**
+	 * Spherically interpolates quaternion pairs, each with its own parameter.
+	 * Every tier evaluates acos and sin per pair; prefer SlerpFast for wide throughput.
+	 * @param a The rotations at t = 0.
+	 * @param b The rotations at t = 1, as many as in a.
+	 * @param t Interpolation parameters, one per pair.
+	 * @param out Receives Slerp(a[i], b[i], t[i]); may alias a or b.
+	 */
+	void Slerp(Span<const Quaternion> a, Span<const Quaternion> b, Span<const float> t, Span<Quaternion> out);
+
+	/**
+	 * Spherically interpolates quaternion pairs with one shared parameter, e.g. a blend weight.
+	 * @param a The rotations at t = 0.
+	 * @param b The rotations at t = 1, as many as in a.
+	 * @param t Interpolation parameter applied to every pair.
+	 * @param out Receives Slerp(a[i], b[i], t); may alias a or b.
+	 */
+	void Slerp(Span<const Quaternion> a, Span<const Quaternion> b, float t, Span<Quaternion> out);
+}
+
+#endif /* end of include guard: _QUATERNION_BATCH_H_ */
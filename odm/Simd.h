@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+/*
+ * Compile-time SIMD backend selection.
+ * ODM_SIMD_SSE is 1 when the target guarantees SSE2 (every x64 build, /arch:SSE2 or -msse2 on x86)
+ * and 0 otherwise. Define ODM_FORCE_SCALAR to build the plain float code on any target.
+ */
+#if !defined(ODM_FORCE_SCALAR) && (defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+	#define ODM_SIMD_SSE 1
+#else
+	#define ODM_SIMD_SSE 0
+#endif
+
+#if ODM_SIMD_SSE
+	#include <emmintrin.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define ODM_ARCH_X86 1
+#else
+	#define ODM_ARCH_X86 0
+#endif
+
+/*
+ * Marks a function as compiled for an instruction set above the build baseline, e.g. ODM_TARGET("avx2,fma").
+ * Such functions may only be reached through the runtime dispatch in Cpu.h.
+ * MSVC exposes every intrinsic without a per-function switch, so the macro is empty there.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+	#define ODM_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define ODM_TARGET(isa)
+#endif
+
+/** Builds the immediate for _mm_shuffle_ps, lanes listed in memory order (x, y, z, w). */
+#define ODM_SHUFFLE(x, y, z, w) (((w) << 6) | ((z) << 4) | ((y) << 2) | (x))
+
+#endif /* end of include guard: _SIMD_H_ */
@@ -0,0 +1,193 @@
+#pragma once
+
+#ifndef _SIMD_SOA_H_
+#define _SIMD_SOA_H_
+
+/*
+ * Register transposes between packed records (Vector3f, Quaternion, AABB arrays) and one register per component.
+ * Internal to the kernel translation units; AVX2 helpers may only be reached through the runtime dispatch in Cpu.h.
+ */
+
+#include "Simd.h"
+
+#if ODM_SIMD_SSE
+
+#include <immintrin.h>
+
+namespace odm
+{
+	/** Loads four packed points (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) into x, y and z registers. */
+	inline void LoadPoints4(const float* f, __m128& x, __m128& y, __m128& z)
+	{
+		const __m128 a = _mm_loadu_ps(f);
+		const __m128 b = _mm_loadu_ps(f + 4);
+		const __m128 c = _mm_loadu_ps(f + 8);
+		const __m128 t = _mm_shuffle_ps(b, c, ODM_SHUFFLE(2, 3, 1, 2));
+		const __m128 u = _mm_shuffle_ps(a, b, ODM_SHUFFLE(1, 2, 0, 1));
+		x = _mm_shuffle_ps(a, t, ODM_SHUFFLE(0, 3, 0, 2));
+		y = _mm_shuffle_ps(u, t, ODM_SHUFFLE(0, 2, 1, 3));
+		z = _mm_shuffle_ps(u, c, ODM_SHUFFLE(1, 3, 0, 3));
+	}
+
+	/** Inverse of LoadPoints4: interleaves x, y and z registers back into three registers of packed points. */
+	inline void PackPoints4(__m128 x, __m128 y, __m128 z, __m128& a, __m128& b, __m128& c)
+	{
+		a = _mm_shuffle_ps(_mm_shuffle_ps(x, y, ODM_SHUFFLE(0, 1, 0, 1)), _mm_shuffle_ps(z, x, ODM_SHUFFLE(0, 1, 1, 2)), ODM_SHUFFLE(0, 2, 0, 2));
+		b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, ODM_SHUFFLE(1, 2, 1, 2)), _mm_shuffle_ps(x, y, ODM_SHUFFLE(2, 3, 2, 3)), ODM_SHUFFLE(0, 2, 0, 2));
+		c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, ODM_SHUFFLE(2, 3, 3, 3)), _mm_shuffle_ps(y, z, ODM_SHUFFLE(3, 3, 3, 3)), ODM_SHUFFLE(0, 2, 0, 2));
+	}
+
+	/** Loads four 4-float records such as Quaternion and transposes them into one register per component. */
+	inline void LoadQuats4(const float* f, __m128& x, __m128& y, __m128& z, __m128& w)
+	{
+		x = _mm_loadu_ps(f);
+		y = _mm_loadu_ps(f + 4);
+		z = _mm_loadu_ps(f + 8);
+		w = _mm_loadu_ps(f + 12);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+	}
+
+	/** LoadQuats4 over four records at arbitrary addresses, e.g. bones picked by index. */
+	inline void GatherQuats4(const float* const* f, __m128& x, __m128& y, __m128& z, __m128& w)
+	{
+		x = _mm_loadu_ps(f[0]);
+		y = _mm_loadu_ps(f[1]);
+		z = _mm_loadu_ps(f[2]);
+		w = _mm_loadu_ps(f[3]);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+	}
+
+	/** Loads four AABB records (min then max, six floats each) into one register per bound component. */
+	inline void LoadAABBs4(const float* f, __m128& minX, __m128& minY, __m128& minZ, __m128& maxX, __m128& maxY, __m128& maxZ)
+	{
+		// Each record is two packed points; split the eight points into even (min) and odd (max) lanes.
+		__m128 x0, y0, z0, x1, y1, z1;
+		LoadPoints4(f, x0, y0, z0);
+		LoadPoints4(f + 12, x1, y1, z1);
+		minX = _mm_shuffle_ps(x0, x1, ODM_SHUFFLE(0, 2, 0, 2));
+		minY = _mm_shuffle_ps(y0, y1, ODM_SHUFFLE(0, 2, 0, 2));
+		minZ = _mm_shuffle_ps(z0, z1, ODM_SHUFFLE(0, 2, 0, 2));
+		maxX = _mm_shuffle_ps(x0, x1, ODM_SHUFFLE(1, 3, 1, 3));
+		maxY = _mm_shuffle_ps(y0, y1, ODM_SHUFFLE(1, 3, 1, 3));
+		maxZ = _mm_shuffle_ps(z0, z1, ODM_SHUFFLE(1, 3, 1, 3));
+	}
+
+	/** Inverse of LoadQuats4. */
+	inline void StoreQuats4(float* f, __m128 x, __m128 y, __m128 z, __m128 w)
+	{
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(f, x);
+		_mm_storeu_ps(f + 4, y);
+		_mm_storeu_ps(f + 8, z);
+		_mm_storeu_ps(f + 12, w);
+	}
+
+	/** Eight-point LoadPoints4: points 0-3 land in the low 128-bit half, points 4-7 in the high one. */
+	ODM_TARGET("avx2,fma")
+	inline void LoadPoints8(const float* f, __m256& x, __m256& y, __m256& z)
+	{
+		const __m256 l0 = _mm256_loadu_ps(f);
+		const __m256 l1 = _mm256_loadu_ps(f + 8);
+		const __m256 l2 = _mm256_loadu_ps(f + 16);
+		const __m256 a = _mm256_permute2f128_ps(l0, l1, 0x30);
+		const __m256 b = _mm256_permute2f128_ps(l0, l2, 0x21);
+		const __m256 c = _mm256_permute2f128_ps(l1, l2, 0x30);
+
+		const __m256 t = _mm256_shuffle_ps(b, c, ODM_SHUFFLE(2, 3, 1, 2));
+		const __m256 u = _mm256_shuffle_ps(a, b, ODM_SHUFFLE(1, 2, 0, 1));
+		x = _mm256_shuffle_ps(a, t, ODM_SHUFFLE(0, 3, 0, 2));
+		y = _mm256_shuffle_ps(u, t, ODM_SHUFFLE(0, 2, 1, 3));
+		z = _mm256_shuffle_ps(u, c, ODM_SHUFFLE(1, 3, 0, 3));
+	}
+
+	/** Inverse of LoadPoints8, producing the three 256-bit blocks in memory order. */
+	ODM_TARGET("avx2,fma")
+	inline void PackPoints8(__m256 x, __m256 y, __m256 z, __m256& l0, __m256& l1, __m256& l2)
+	{
+		const __m256 a = _mm256_shuffle_ps(_mm256_shuffle_ps(x, y, ODM_SHUFFLE(0, 1, 0, 1)), _mm256_shuffle_ps(z, x, ODM_SHUFFLE(0, 1, 1, 2)), ODM_SHUFFLE(0, 2, 0, 2));
+		const __m256 b = _mm256_shuffle_ps(_mm256_shuffle_ps(y, z, ODM_SHUFFLE(1, 2, 1, 2)), _mm256_shuffle_ps(x, y, ODM_SHUFFLE(2, 3, 2, 3)), ODM_SHUFFLE(0, 2, 0, 2));
+		const __m256 c = _mm256_shuffle_ps(_mm256_shuffle_ps(z, x, ODM_SHUFFLE(2, 3, 3, 3)), _mm256_shuffle_ps(y, z, ODM_SHUFFLE(3, 3, 3, 3)), ODM_SHUFFLE(0, 2, 0, 2));
+		l0 = _mm256_permute2f128_ps(a, b, 0x20);
+		l1 = _mm256_permute2f128_ps(c, a, 0x30);
+		l2 = _mm256_permute2f128_ps(b, c, 0x31);
+	}
+
+	/** _MM_TRANSPOSE4_PS applied to both 128-bit halves independently. */
+	ODM_TARGET("avx2,fma")
+	inline void TransposeHalves4(__m256& a, __m256& b, __m256& c, __m256& d)
+	{
+		const __m256 t0 = _mm256_unpacklo_ps(a, b);
+		const __m256 t1 = _mm256_unpacklo_ps(c, d);
+		const __m256 t2 = _mm256_unpackhi_ps(a, b);
+		const __m256 t3 = _mm256_unpackhi_ps(c, d);
+		a = _mm256_shuffle_ps(t0, t1, ODM_SHUFFLE(0, 1, 0, 1));
+		b = _mm256_shuffle_ps(t0, t1, ODM_SHUFFLE(2, 3, 2, 3));
+		c = _mm256_shuffle_ps(t2, t3, ODM_SHUFFLE(0, 1, 0, 1));
+		d = _mm256_shuffle_ps(t2, t3, ODM_SHUFFLE(2, 3, 2, 3));
+	}
+
+	/** Eight-record LoadQuats4, lanes in record order. */
+	ODM_TARGET("avx2,fma")
+	inline void LoadQuats8(const float* f, __m256& x, __m256& y, __m256& z, __m256& w)
+	{
+		// Record i goes to the low half and record i + 4 to the high half so the transpose keeps lane order.
+		x = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f)), _mm_loadu_ps(f + 16), 1);
+		y = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f + 4)), _mm_loadu_ps(f + 20), 1);
+		z = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f + 8)), _mm_loadu_ps(f + 24), 1);
+		w = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f + 12)), _mm_loadu_ps(f + 28), 1);
+		TransposeHalves4(x, y, z, w);
+	}
+
+	/** Eight-record GatherQuats4, lanes in record order. */
+	ODM_TARGET("avx2,fma")
+	inline void GatherQuats8(const float* const* f, __m256& x, __m256& y, __m256& z, __m256& w)
+	{
+		x = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f[0])), _mm_loadu_ps(f[4]), 1);
+		y = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f[1])), _mm_loadu_ps(f[5]), 1);
+		z = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f[2])), _mm_loadu_ps(f[6]), 1);
+		w = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f[3])), _mm_loadu_ps(f[7]), 1);
+		TransposeHalves4(x, y, z, w);
+	}
+
+	/** Eight-record LoadAABBs4, lanes in record order. */
+	ODM_TARGET("avx2,fma")
+	inline void LoadAABBs8(const float* f, __m256& minX, __m256& minY, __m256& minZ, __m256& maxX, __m256& maxY, __m256& maxZ)
+	{
+		__m256 x0, y0, z0, x1, y1, z1;
+		LoadPoints8(f, x0, y0, z0);
+		LoadPoints8(f + 24, x1, y1, z1);
+
+		// In-lane shuffles leave records ordered 0 1 4 5 | 2 3 6 7; swapping the middle 64-bit pairs restores the order.
+		minX = _mm256_shuffle_ps(x0, x1, ODM_SHUFFLE(0, 2, 0, 2));
+		minY = _mm256_shuffle_ps(y0, y1, ODM_SHUFFLE(0, 2, 0, 2));
+		minZ = _mm256_shuffle_ps(z0, z1, ODM_SHUFFLE(0, 2, 0, 2));
+		maxX = _mm256_shuffle_ps(x0, x1, ODM_SHUFFLE(1, 3, 1, 3));
+		maxY = _mm256_shuffle_ps(y0, y1, ODM_SHUFFLE(1, 3, 1, 3));
+		maxZ = _mm256_shuffle_ps(z0, z1, ODM_SHUFFLE(1, 3, 1, 3));
+		minX = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(minX), _MM_SHUFFLE(3, 1, 2, 0)));
+		minY = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(minY), _MM_SHUFFLE(3, 1, 2, 0)));
+		minZ = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(minZ), _MM_SHUFFLE(3, 1, 2, 0)));
+		maxX = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(maxX), _MM_SHUFFLE(3, 1, 2, 0)));
+		maxY = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(maxY), _MM_SHUFFLE(3, 1, 2, 0)));
+		maxZ = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(maxZ), _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+
+	/** Inverse of LoadQuats8. */
+	ODM_TARGET("avx2,fma")
+	inline void StoreQuats8(float* f, __m256 x, __m256 y, __m256 z, __m256 w)
+	{
+		TransposeHalves4(x, y, z, w);
+		_mm_storeu_ps(f, _mm256_castps256_ps128(x));
+		_mm_storeu_ps(f + 4, _mm256_castps256_ps128(y));
+		_mm_storeu_ps(f + 8, _mm256_castps256_ps128(z));
+		_mm_storeu_ps(f + 12, _mm256_castps256_ps128(w));
+		_mm_storeu_ps(f + 16, _mm256_extractf128_ps(x, 1));
+		_mm_storeu_ps(f + 20, _mm256_extractf128_ps(y, 1));
+		_mm_storeu_ps(f + 24, _mm256_extractf128_ps(z, 1));
+		_mm_storeu_ps(f + 28, _mm256_extractf128_ps(w, 1));
+	}
+}
+
+#endif
+
+#endif /* end of include guard: _SIMD_SOA_H_ */
@@ -0,0 +1,358 @@
+#include "Skinning.h"
+
+#include <cassert>
+#include "Simd.h"
+#include "Simd_soa.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	/** Weighted sum of the bones influencing vertex i, each flipped into the hemisphere of the first. */
+	static inline DualQuaternion BlendInfluences(const DualQuaternion* bones, const SkinInfluences& influences, size_t i)
+	{
+		const DualQuaternion& first = bones[influences.indices[0][i]];
+		DualQuaternion sum = first * influences.weights[0][i];
+		for (size_t k = 1; k < MaxBoneInfluences; ++k)
+		{
+			const DualQuaternion& bone = bones[influences.indices[k][i]];
+			const float weight = influences.weights[k][i];
+			sum = sum + bone * (first.real.Dot(bone.real) < 0.0f ? -weight : weight);
+		}
+		return sum;
+	}
+
+	static void SkinDualQuaternionScalar(const DualQuaternion* bones, const SkinInfluences& influences, Vec3SoASpan<const float> positions,
+		Vec3SoASpan<const float> normals, Vec3SoASpan<float> outPositions, Vec3SoASpan<float> outNormals, size_t first)
+	{
+		const bool hasNormals = !normals.empty();
+		for (size_t i = first; i < positions.size(); ++i)
+		{
+			const DualQuaternion dq = Normalize(BlendInfluences(bones, influences, i));
+			outPositions.Set(i, dq.TransformPoint(positions.Get(i)));
+			if (hasNormals)
+				outNormals.Set(i, dq.TransformVector(normals.Get(i)));
+		}
+	}
+
+#if ODM_SIMD_SSE
+
+	/** out = a * b for affine matrices: the fourth rows are (0, 0, 0, 1), so only a's translation column needs adding. */
+	static inline void MulAffineSSE(const Matrix4x4& a, const Matrix4x4& b, Matrix4x4& out)
+	{
+		const __m128 a0 = a.m[0].simd, a1 = a.m[1].simd, a2 = a.m[2].simd, a3 = a.m[3].simd;
+		__m128 r[4];
+		for (int col = 0; col < 4; ++col)
+		{
+			const __m128 c = b.m[col].simd;
+			r[col] = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(a0, _mm_shuffle_ps(c, c, ODM_SHUFFLE(0, 0, 0, 0))),
+				_mm_mul_ps(a1, _mm_shuffle_ps(c, c, ODM_SHUFFLE(1, 1, 1, 1)))),
+				_mm_mul_ps(a2, _mm_shuffle_ps(c, c, ODM_SHUFFLE(2, 2, 2, 2))));
+		}
+		out.m[0].simd = r[0];
+		out.m[1].simd = r[1];
+		out.m[2].simd = r[2];
+		out.m[3].simd = _mm_add_ps(r[3], a3);
+	}
+
+	static void BuildPaletteSSE(const JointPose* local, const Matrix4x4* bindInverse, const int32_t* parents, Matrix4x4* model, Matrix4x4* palette, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			assert(parents[i] < static_cast<int64_t>(i));
+			if (parents[i] < 0)
+				model[i] = local[i].ToMatrix();
+			else
+				MulAffineSSE(model[parents[i]], local[i].ToMatrix(), model[i]);
+			MulAffineSSE(model[i], bindInverse[i], palette[i]);
+		}
+	}
+
+	/** Gathers the bones of influence slot k of four vertices; c receives the real x, y, z, w then the dual x, y, z, w components. */
+	static inline void GatherInfluence4(const DualQuaternion* bones, const SkinInfluences& influences, size_t k, size_t first, __m128 c[8])
+	{
+		const uint16_t* idx = influences.indices[k] + first;
+		const float* real[4] = { &bones[idx[0]].real.x, &bones[idx[1]].real.x, &bones[idx[2]].real.x, &bones[idx[3]].real.x };
+		const float* dual[4] = { &bones[idx[0]].dual.x, &bones[idx[1]].dual.x, &bones[idx[2]].dual.x, &bones[idx[3]].dual.x };
+		GatherQuats4(real, c[0], c[1], c[2], c[3]);
+		GatherQuats4(dual, c[4], c[5], c[6], c[7]);
+	}
+
+	/** BlendInfluences for four vertices; dq receives the real x, y, z, w then the dual x, y, z, w components. */
+	static inline void BlendInfluences4(const DualQuaternion* bones, const SkinInfluences& influences, size_t first, __m128 dq[8])
+	{
+		__m128 c[8];
+		GatherInfluence4(bones, influences, 0, first, c);
+		const __m128 firstWeight = _mm_loadu_ps(influences.weights[0] + first);
+		for (int j = 0; j < 8; ++j)
+			dq[j] = _mm_mul_ps(c[j], firstWeight);
+
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 fx = c[0], fy = c[1], fz = c[2], fw = c[3];
+		for (size_t k = 1; k < MaxBoneInfluences; ++k)
+		{
+			GatherInfluence4(bones, influences, k, first, c);
+			const __m128 cosAngle = _mm_add_ps(_mm_add_ps(_mm_mul_ps(fx, c[0]), _mm_mul_ps(fy, c[1])), _mm_add_ps(_mm_mul_ps(fz, c[2]), _mm_mul_ps(fw, c[3])));
+			const __m128 weight = _mm_xor_ps(_mm_loadu_ps(influences.weights[k] + first), _mm_and_ps(cosAngle, signMask));
+			for (int j = 0; j < 8; ++j)
+				dq[j] = _mm_add_ps(dq[j], _mm_mul_ps(c[j], weight));
+		}
+	}
+
+	/** out = v + s * r x (r x v + w v) */
+	static inline void RotateByUnnormalized4(__m128 rx, __m128 ry, __m128 rz, __m128 rw, __m128 s, __m128& x, __m128& y, __m128& z)
+	{
+		const __m128 cx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(ry, z), _mm_mul_ps(rz, y)), _mm_mul_ps(rw, x));
+		const __m128 cy = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rz, x), _mm_mul_ps(rx, z)), _mm_mul_ps(rw, y));
+		const __m128 cz = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rx, y), _mm_mul_ps(ry, x)), _mm_mul_ps(rw, z));
+		x = _mm_add_ps(x, _mm_mul_ps(s, _mm_sub_ps(_mm_mul_ps(ry, cz), _mm_mul_ps(rz, cy))));
+		y = _mm_add_ps(y, _mm_mul_ps(s, _mm_sub_ps(_mm_mul_ps(rz, cx), _mm_mul_ps(rx, cz))));
+		z = _mm_add_ps(z, _mm_mul_ps(s, _mm_sub_ps(_mm_mul_ps(rx, cy), _mm_mul_ps(ry, cx))));
+	}
+
+	static void SkinDualQuaternionSSE(const DualQuaternion* bones, const SkinInfluences& influences, Vec3SoASpan<const float> positions,
+		Vec3SoASpan<const float> normals, Vec3SoASpan<float> outPositions, Vec3SoASpan<float> outNormals)
+	{
+		const bool hasNormals = !normals.empty();
+		const __m128 two = _mm_set1_ps(2.0f);
+		size_t i = 0;
+		for (; i + 4 <= positions.size(); i += 4)
+		{
+			__m128 dq[8];
+			BlendInfluences4(bones, influences, i, dq);
+			const __m128 rx = dq[0], ry = dq[1], rz = dq[2], rw = dq[3];
+			const __m128 dx = dq[4], dy = dq[5], dz = dq[6], dw = dq[7];
+
+			// Both the rotation and the translation scale with the squared length of the blend, so one divide normalizes them.
+			const __m128 norm = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw)));
+			const __m128 s = _mm_div_ps(two, norm);
+
+			// Translation: 2 (w d - dw r + r x d) / |r|^2.
+			const __m128 tx = _mm_mul_ps(s, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dx), _mm_mul_ps(dw, rx)), _mm_sub_ps(_mm_mul_ps(ry, dz), _mm_mul_ps(rz, dy))));
+			const __m128 ty = _mm_mul_ps(s, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dy), _mm_mul_ps(dw, ry)), _mm_sub_ps(_mm_mul_ps(rz, dx), _mm_mul_ps(rx, dz))));
+			const __m128 tz = _mm_mul_ps(s, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dz), _mm_mul_ps(dw, rz)), _mm_sub_ps(_mm_mul_ps(rx, dy), _mm_mul_ps(ry, dx))));
+
+			__m128 px = _mm_loadu_ps(positions.X() + i);
+			__m128 py = _mm_loadu_ps(positions.Y() + i);
+			__m128 pz = _mm_loadu_ps(positions.Z() + i);
+			RotateByUnnormalized4(rx, ry, rz, rw, s, px, py, pz);
+			_mm_storeu_ps(outPositions.X() + i, _mm_add_ps(px, tx));
+			_mm_storeu_ps(outPositions.Y() + i, _mm_add_ps(py, ty));
+			_mm_storeu_ps(outPositions.Z() + i, _mm_add_ps(pz, tz));
+
+			if (hasNormals)
+			{
+				__m128 nx = _mm_loadu_ps(normals.X() + i);
+				__m128 ny = _mm_loadu_ps(normals.Y() + i);
+				__m128 nz = _mm_loadu_ps(normals.Z() + i);
+				RotateByUnnormalized4(rx, ry, rz, rw, s, nx, ny, nz);
+				_mm_storeu_ps(outNormals.X() + i, nx);
+				_mm_storeu_ps(outNormals.Y() + i, ny);
+				_mm_storeu_ps(outNormals.Z() + i, nz);
+			}
+		}
+		SkinDualQuaternionScalar(bones, influences, positions, normals, outPositions, outNormals, i);
+	}
+
+#else
+
+	static void BuildPaletteBaseline(const JointPose* local, const Matrix4x4* bindInverse, const int32_t* parents, Matrix4x4* model, Matrix4x4* palette, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			assert(parents[i] < static_cast<int64_t>(i));
+			model[i] = parents[i] < 0 ? local[i].ToMatrix() : model[parents[i]] * local[i].ToMatrix();
+			palette[i] = model[i] * bindInverse[i];
+		}
+	}
+
+	static void SkinDualQuaternionBaseline(const DualQuaternion* bones, const SkinInfluences& influences, Vec3SoASpan<const float> positions,
+		Vec3SoASpan<const float> normals, Vec3SoASpan<float> outPositions, Vec3SoASpan<float> outNormals)
+	{
+		SkinDualQuaternionScalar(bones, influences, positions, normals, outPositions, outNormals, 0);
+	}
+
+#endif
+
+#if ODM_SIMD_SSE
+	static const SkinningKernels s_BaselineKernels = { SimdLevel::Baseline, &BuildPaletteSSE, &SkinDualQuaternionSSE };
+#else
+	static const SkinningKernels s_BaselineKernels = { SimdLevel::Baseline, &BuildPaletteBaseline, &SkinDualQuaternionBaseline };
+#endif
+
+#if ODM_SIMD_SSE
+#pragma region AVX2
+
+	/** MulAffineSSE with two columns per register: columns 0 and 1 share one, 2 and 3 the other. */
+	ODM_TARGET("avx2,fma")
+	static inline void MulAffineAVX2(const Matrix4x4& a, const Matrix4x4& b, Matrix4x4& out)
+	{
+		const __m256 a0 = _mm256_broadcast_ps(&a.m[0].simd);
+		const __m256 a1 = _mm256_broadcast_ps(&a.m[1].simd);
+		const __m256 a2 = _mm256_broadcast_ps(&a.m[2].simd);
+		const __m256 a3 = _mm256_insertf128_ps(_mm256_setzero_ps(), a.m[3].simd, 1);
+
+		const __m256 b01 = _mm256_loadu_ps(&b.elem[0]);
+		const __m256 b23 = _mm256_loadu_ps(&b.elem[8]);
+
+		const __m256 r01 = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b01, b01, ODM_SHUFFLE(2, 2, 2, 2)),
+			_mm256_fmadd_ps(a1, _mm256_shuffle_ps(b01, b01, ODM_SHUFFLE(1, 1, 1, 1)),
+			_mm256_mul_ps(a0, _mm256_shuffle_ps(b01, b01, ODM_SHUFFLE(0, 0, 0, 0)))));
+		const __m256 r23 = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b23, b23, ODM_SHUFFLE(2, 2, 2, 2)),
+			_mm256_fmadd_ps(a1, _mm256_shuffle_ps(b23, b23, ODM_SHUFFLE(1, 1, 1, 1)),
+			_mm256_fmadd_ps(a0, _mm256_shuffle_ps(b23, b23, ODM_SHUFFLE(0, 0, 0, 0)), a3)));
+
+		_mm256_storeu_ps(&out.elem[0], r01);
+		_mm256_storeu_ps(&out.elem[8], r23);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void BuildPaletteAVX2(const JointPose* local, const Matrix4x4* bindInverse, const int32_t* parents, Matrix4x4* model, Matrix4x4* palette, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			assert(parents[i] < static_cast<int64_t>(i));
+			if (parents[i] < 0)
+				model[i] = local[i].ToMatrix();
+			else
+				MulAffineAVX2(model[parents[i]], local[i].ToMatrix(), model[i]);
+			MulAffineAVX2(model[i], bindInverse[i], palette[i]);
+		}
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline void GatherInfluence8(const DualQuaternion* bones, const SkinInfluences& influences, size_t k, size_t first, __m256 c[8])
+	{
+		const uint16_t* idx = influences.indices[k] + first;
+		const float* real[8];
+		const float* dual[8];
+		for (int j = 0; j < 8; ++j)
+		{
+			real[j] = &bones[idx[j]].real.x;
+			dual[j] = &bones[idx[j]].dual.x;
+		}
+		GatherQuats8(real, c[0], c[1], c[2], c[3]);
+		GatherQuats8(dual, c[4], c[5], c[6], c[7]);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline void BlendInfluences8(const DualQuaternion* bones, const SkinInfluences& influences, size_t first, __m256 dq[8])
+	{
+		__m256 c[8];
+		GatherInfluence8(bones, influences, 0, first, c);
+		const __m256 firstWeight = _mm256_loadu_ps(influences.weights[0] + first);
+		for (int j = 0; j < 8; ++j)
+			dq[j] = _mm256_mul_ps(c[j], firstWeight);
+
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 fx = c[0], fy = c[1], fz = c[2], fw = c[3];
+		for (size_t k = 1; k < MaxBoneInfluences; ++k)
+		{
+			GatherInfluence8(bones, influences, k, first, c);
+			const __m256 cosAngle = _mm256_fmadd_ps(fw, c[3], _mm256_fmadd_ps(fz, c[2], _mm256_fmadd_ps(fy, c[1], _mm256_mul_ps(fx, c[0]))));
+			const __m256 weight = _mm256_xor_ps(_mm256_loadu_ps(influences.weights[k] + first), _mm256_and_ps(cosAngle, signMask));
+			for (int j = 0; j < 8; ++j)
+				dq[j] = _mm256_fmadd_ps(c[j], weight, dq[j]);
+		}
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline void RotateByUnnormalized8(__m256 rx, __m256 ry, __m256 rz, __m256 rw, __m256 s, __m256& x, __m256& y, __m256& z)
+	{
+		const __m256 cx = _mm256_fmadd_ps(rw, x, _mm256_fmsub_ps(ry, z, _mm256_mul_ps(rz, y)));
+		const __m256 cy = _mm256_fmadd_ps(rw, y, _mm256_fmsub_ps(rz, x, _mm256_mul_ps(rx, z)));
+		const __m256 cz = _mm256_fmadd_ps(rw, z, _mm256_fmsub_ps(rx, y, _mm256_mul_ps(ry, x)));
+		x = _mm256_fmadd_ps(s, _mm256_fmsub_ps(ry, cz, _mm256_mul_ps(rz, cy)), x);
+		y = _mm256_fmadd_ps(s, _mm256_fmsub_ps(rz, cx, _mm256_mul_ps(rx, cz)), y);
+		z = _mm256_fmadd_ps(s, _mm256_fmsub_ps(rx, cy, _mm256_mul_ps(ry, cx)), z);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void SkinDualQuaternionAVX2(const DualQuaternion* bones, const SkinInfluences& influences, Vec3SoASpan<const float> positions,
+		Vec3SoASpan<const float> normals, Vec3SoASpan<float> outPositions, Vec3SoASpan<float> outNormals)
+	{
+		const bool hasNormals = !normals.empty();
+		const __m256 two = _mm256_set1_ps(2.0f);
+		size_t i = 0;
+		for (; i + 8 <= positions.size(); i += 8)
+		{
+			__m256 dq[8];
+			BlendInfluences8(bones, influences, i, dq);
+			const __m256 rx = dq[0], ry = dq[1], rz = dq[2], rw = dq[3];
+			const __m256 dx = dq[4], dy = dq[5], dz = dq[6], dw = dq[7];
+
+			const __m256 norm = _mm256_fmadd_ps(rw, rw, _mm256_fmadd_ps(rz, rz, _mm256_fmadd_ps(ry, ry, _mm256_mul_ps(rx, rx))));
+			const __m256 s = _mm256_div_ps(two, norm);
+
+			const __m256 tx = _mm256_mul_ps(s, _mm256_fmadd_ps(rw, dx, _mm256_fmsub_ps(ry, dz, _mm256_fmadd_ps(dw, rx, _mm256_mul_ps(rz, dy)))));
+			const __m256 ty = _mm256_mul_ps(s, _mm256_fmadd_ps(rw, dy, _mm256_fmsub_ps(rz, dx, _mm256_fmadd_ps(dw, ry, _mm256_mul_ps(rx, dz)))));
+			const __m256 tz = _mm256_mul_ps(s, _mm256_fmadd_ps(rw, dz, _mm256_fmsub_ps(rx, dy, _mm256_fmadd_ps(dw, rz, _mm256_mul_ps(ry, dx)))));
+
+			__m256 px = _mm256_loadu_ps(positions.X() + i);
+			__m256 py = _mm256_loadu_ps(positions.Y() + i);
+			__m256 pz = _mm256_loadu_ps(positions.Z() + i);
+			RotateByUnnormalized8(rx, ry, rz, rw, s, px, py, pz);
+			_mm256_storeu_ps(outPositions.X() + i, _mm256_add_ps(px, tx));
+			_mm256_storeu_ps(outPositions.Y() + i, _mm256_add_ps(py, ty));
+			_mm256_storeu_ps(outPositions.Z() + i, _mm256_add_ps(pz, tz));
+
+			if (hasNormals)
+			{
+				__m256 nx = _mm256_loadu_ps(normals.X() + i);
+				__m256 ny = _mm256_loadu_ps(normals.Y() + i);
+				__m256 nz = _mm256_loadu_ps(normals.Z() + i);
+				RotateByUnnormalized8(rx, ry, rz, rw, s, nx, ny, nz);
+				_mm256_storeu_ps(outNormals.X() + i, nx);
+				_mm256_storeu_ps(outNormals.Y() + i, ny);
+				_mm256_storeu_ps(outNormals.Z() + i, nz);
+			}
+		}
+		SkinDualQuaternionScalar(bones, influences, positions, normals, outPositions, outNormals, i);
+	}
+
+	// AVX-512 shares these kernels: joints wait on their parents, and skinning is bound by the bone gathers rather than the arithmetic.
+	static const SkinningKernels s_AVX2Kernels = { SimdLevel::AVX2, &BuildPaletteAVX2, &SkinDualQuaternionAVX2 };
+
+#pragma endregion
+#endif
+
+	const SkinningKernels& GetSkinningKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:	return s_AVX2Kernels;
+		default:				break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const SkinningKernels& GetSkinningKernels()
+	{
+		static const SkinningKernels& kernels = GetSkinningKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	void BuildSkinningPalette(Span<const JointPose> localPose, Span<const Matrix4x4> bindInverse, Span<const int32_t> parentIndices,
+		Span<Matrix4x4> modelPose, Span<Matrix4x4> palette)
+	{
+		assert(localPose.size() == bindInverse.size() && localPose.size() == parentIndices.size());
+		assert(localPose.size() == modelPose.size() && localPose.size() == palette.size());
+		GetSkinningKernels().BuildPalette(localPose.data(), bindInverse.data(), parentIndices.data(), modelPose.data(), palette.data(), palette.size());
+	}
+
+	void SkinDualQuaternion(Span<const DualQuaternion> bones, const SkinInfluences& influences, Vec3SoASpan<const float> positions,
+		Vec3SoASpan<const float> normals, Vec3SoASpan<float> outPositions, Vec3SoASpan<float> outNormals)
+	{
+		assert(!bones.empty() || positions.empty());
+		assert(positions.size() == outPositions.size());
+		assert(normals.size() == outNormals.size() && (normals.empty() || normals.size() == positions.size()));
+		GetSkinningKernels().SkinDualQuaternion(bones.data(), influences, positions, normals, outPositions, outNormals);
+	}
+}
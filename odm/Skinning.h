@@ -0,0 +1,127 @@
+#pragma once
+
+#ifndef _SKINNING_H_
+#define _SKINNING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "Quaternion.h"
+#include "DualQuaternion.h"
+#include "Mat4x4.h"
+#include "Vec3SoA.h"
+#include "Cpu.h"
+#include "Span.h"
+
+namespace odm
+{
+	/** Transform of a joint relative to its parent, applied as scale, then rotation, then translation. */
+	struct JointPose
+	{
+		Quaternion rotation;
+		Vector3f translation;
+		Vector3f scale;
+
+		/** Constructs the identity pose. */
+		JointPose();
+
+		/**
+		 * Constructs a pose.
+		 * @param rotation Unit quaternion of the joint.
+		 * @param translation Offset from the parent joint.
+		 * @param scale Scale along the joint's own axes.
+		 */
+		JointPose(const Quaternion& rotation, const Vector3f& translation, const Vector3f& scale = Vector3f::One);
+
+		/** Builds the affine matrix translate * rotate * scale without trigonometry. */
+		Matrix4x4 ToMatrix() const;
+	};
+
+	inline JointPose::JointPose()
+		: rotation(), translation(Vector3f::Zero), scale(Vector3f::One)
+	{}
+
+	inline JointPose::JointPose(const Quaternion& rotation, const Vector3f& translation, const Vector3f& scale)
+		: rotation(rotation), translation(translation), scale(scale)
+	{}
+
+	inline Matrix4x4 JointPose::ToMatrix() const
+	{
+		Matrix4x4 result = rotation.ToMatrix();
+		result.m[0] = result.m[0] * scale.x;
+		result.m[1] = result.m[1] * scale.y;
+		result.m[2] = result.m[2] * scale.z;
+		result.m[3] = Vector4f(translation, 1.0f);
+		return result;
+	}
+
+	/** Number of bones that can influence one vertex in dual quaternion skinning. */
+	constexpr size_t MaxBoneInfluences = 4;
+
+	/**
+	 * Bone influences of a vertex stream with one index array and one weight array per slot, so a slot loads as a vector.
+	 * Vertices with fewer influences give the unused slots weight 0 and any valid bone index.
+	 */
+	struct SkinInfluences
+	{
+		const uint16_t* indices[MaxBoneInfluences];
+		const float* weights[MaxBoneInfluences];
+	};
+
+	/**
+	 * Table of skinning kernels compiled for one instruction set tier.
+	 */
+	struct SkinningKernels
+	{
+		SimdLevel level;
+
+		/**
+		 * model[i] = model[parents[i]] * local[i].ToMatrix(), or the local matrix alone for a root,
+		 * then palette[i] = model[i] * bindInverse[i]. Both products assume affine matrices.
+		 */
+		void (*BuildPalette)(const JointPose* local, const Matrix4x4* bindInverse, const int32_t* parents, Matrix4x4* model, Matrix4x4* palette, size_t count);
+
+		/**
+		 * Blends the influencing bones of each vertex with dual quaternion linear blending and transforms
+		 * positions[i] into outPositions[i] and, unless normals is empty, normals[i] into outNormals[i].
+		 */
+		void (*SkinDualQuaternion)(const DualQuaternion* bones, const SkinInfluences& influences, Vec3SoASpan<const float> positions,
+			Vec3SoASpan<const float> normals, Vec3SoASpan<float> outPositions, Vec3SoASpan<float> outNormals);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const SkinningKernels& GetSkinningKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const SkinningKernels& GetSkinningKernels(SimdLevel level);
+
+	/**
+	 * Builds the matrix palette a skinning shader consumes, in one pass over the skeleton.
+	 * @param localPose Pose of each joint relative to its parent.
+	 * @param bindInverse Inverse of each joint's model space bind matrix; must be affine.
+	 * @param parentIndices Parent of each joint, or a negative value for a root. Parents must precede their children.
+	 * @param modelPose Receives each joint's model space matrix; children read their parent from it.
+	 * @param palette Receives modelPose[i] * bindInverse[i], contiguous and ready for upload.
+	 */
+	void BuildSkinningPalette(Span<const JointPose> localPose, Span<const Matrix4x4> bindInverse, Span<const int32_t> parentIndices,
+		Span<Matrix4x4> modelPose, Span<Matrix4x4> palette);
+
+	/**
+	 * Skins a vertex stream with dual quaternion linear blending, which keeps the volume that blending matrices loses at twisted joints.
+	 * @param bones Skinning transforms, e.g. DualQuaternion::FromMatrix of a rigid palette.
+	 * @param influences Bone indices and weights, as many per slot as there are positions.
+	 * @param positions Bind pose positions.
+	 * @param normals Bind pose normals, as many as positions, or an empty span to skip them.
+	 * @param outPositions Receives the skinned positions; may alias positions.
+	 * @param outNormals Receives the skinned normals, as many as normals; may alias normals.
+	 */
+	void SkinDualQuaternion(Span<const DualQuaternion> bones, const SkinInfluences& influences, Vec3SoASpan<const float> positions,
+		Vec3SoASpan<const float> normals, Vec3SoASpan<float> outPositions, Vec3SoASpan<float> outNormals);
+}
+
+#endif /* end of include guard: _SKINNING_H_ */
@@ -0,0 +1,100 @@
+#pragma once
+
+#ifndef _SPAN_H_
+#define _SPAN_H_
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "Defines.h"
+
+namespace odm
+{
+	/**
+	 * Non-owning view over a contiguous run of elements, used by every batch API.
+	 * Stands in for std::span while the library targets C++17, so it keeps the std spelling.
+	 */
+	template <class T>
+	class Span
+	{
+	public:
+		using element_type = T;
+		using value_type = std::remove_cv_t<T>;
+		using size_type = size_t;
+		using pointer = T*;
+		using reference = T&;
+		using iterator = T*;
+
+		/** Constructs an empty span. */
+		constexpr Span() noexcept = default;
+
+		/**
+		 * Constructs a span over count elements.
+		 * @param data Pointer to the first element.
+		 * @param count Number of elements in the span.
+		 */
+		constexpr Span(T* data, size_t count) noexcept
+			: m_Data(data), m_Size(count)
+		{}
+
+		/**
+		 * Constructs a span over a fixed-size array.
+		 * @param array The array to be viewed.
+		 */
+		template <size_t N>
+		constexpr Span(T (&array)[N]) noexcept
+			: m_Data(array), m_Size(N)
+		{}
+
+		/**
+		 * Constructs a span over any contiguous container exposing data() and size(), e.g. std::vector.
+		 * @param container The container to be viewed; it must outlive the span.
+		 */
+		template <class Container, class = std::enable_if_t<
+			!std::is_same_v<std::remove_cv_t<Container>, Span> &&
+			std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>>
+		constexpr Span(Container& container) noexcept
+			: m_Data(container.data()), m_Size(container.size())
+		{}
+
+		/**
+		 * Converts a span of mutable elements into a span of const elements.
+		 * @param other The span to be viewed.
+		 */
+		template <class U, class = std::enable_if_t<!std::is_same_v<U, T> && std::is_convertible_v<U(*)[], T(*)[]>>>
+		constexpr Span(const Span<U>& other) noexcept
+			: m_Data(other.data()), m_Size(other.size())
+		{}
+
+		NODISCARD constexpr T* data() const noexcept { return m_Data; }
+		NODISCARD constexpr size_t size() const noexcept { return m_Size; }
+		NODISCARD constexpr bool empty() const noexcept { return m_Size == 0; }
+
+		constexpr T* begin() const noexcept { return m_Data; }
+		constexpr T* end() const noexcept { return m_Data + m_Size; }
+
+		constexpr T& operator[](size_t index) const
+		{
+			assert(index < m_Size);
+			return m_Data[index];
+		}
+
+		/**
+		 * Gets a view over a part of this span.
+		 * @param offset Index of the first element of the view.
+		 * @param count Number of elements in the view.
+		 */
+		NODISCARD constexpr Span subspan(size_t offset, size_t count) const
+		{
+			assert(offset + count <= m_Size);
+			return Span(m_Data + offset, count);
+		}
+
+	private:
+		T* m_Data = nullptr;
+		size_t m_Size = 0;
+	};
+}
+
+#endif /* end of include guard: _SPAN_H_ */
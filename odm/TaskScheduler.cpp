@@ -0,0 +1,128 @@
+#include "TaskScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace odm
+{
+	/** The tasks of one ParallelFor call; lives on the stack of the calling thread. */
+	struct ThreadPool::Batch
+	{
+		const std::function<void(uint32_t)>* task;
+		uint32_t count;
+		std::atomic<uint32_t> next{ 0 };
+		std::atomic<uint32_t> finished{ 0 };
+	};
+
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+		m_Workers.reserve(threadCount - 1);
+		for (uint32_t i = 1; i < threadCount; ++i)
+			m_Workers.emplace_back([this] { WorkerLoop(); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_Wake.notify_all();
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task)
+	{
+		if (m_Workers.empty() || count <= 1)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+				task(i);
+			return;
+		}
+
+		Batch batch;
+		batch.task = &task;
+		batch.count = count;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Queue.push_back(&batch);
+		}
+		m_Wake.notify_all();
+
+		for (uint32_t i = batch.next.fetch_add(1); i < count; i = batch.next.fetch_add(1))
+		{
+			task(i);
+			batch.finished.fetch_add(1, std::memory_order_release);
+		}
+
+		// Every task is claimed; the batch must leave the queue before it goes out of scope.
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		const auto it = std::find(m_Queue.begin(), m_Queue.end(), &batch);
+		if (it != m_Queue.end())
+			m_Queue.erase(it);
+
+		while (batch.finished.load(std::memory_order_acquire) < count)
+		{
+			if (!RunQueuedTask(lock))
+			{
+				lock.unlock();
+				std::this_thread::yield();
+				lock.lock();
+			}
+		}
+	}
+
+	bool ThreadPool::RunQueuedTask(std::unique_lock<std::mutex>& lock)
+	{
+		while (!m_Queue.empty())
+		{
+			Batch* batch = m_Queue.front();
+			const uint32_t index = batch->next.fetch_add(1);
+			if (index >= batch->count)
+			{
+				m_Queue.pop_front();
+				continue;
+			}
+
+			lock.unlock();
+			(*batch->task)(index);
+			batch->finished.fetch_add(1, std::memory_order_release);
+			lock.lock();
+			return true;
+		}
+		return false;
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		for (;;)
+		{
+			m_Wake.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+			if (m_Queue.empty())
+				return;
+			RunQueuedTask(lock);
+		}
+	}
+
+	void ParallelForChunks(TaskScheduler* scheduler, size_t count, size_t chunkSize, const std::function<void(uint32_t, size_t, size_t)>& body)
+	{
+		const uint32_t chunkCount = static_cast<uint32_t>((count + chunkSize - 1) / chunkSize);
+		const auto run = [&](uint32_t chunk) {
+			const size_t begin = chunk * chunkSize;
+			body(chunk, begin, std::min(begin + chunkSize, count));
+		};
+
+		if (scheduler != nullptr && chunkCount > 1)
+			scheduler->ParallelFor(chunkCount, run);
+		else
+		{
+			for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+				run(chunk);
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef _TASK_SCHEDULER_H_
+#define _TASK_SCHEDULER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Defines.h"
+
+namespace odm
+{
+	/**
+	 * Interface through which the parallel builders hand out work, so an engine can route it into its own job system.
+	 * Results never depend on the scheduler: builders split work into pieces of fixed size and merge them in a fixed order.
+	 */
+	class TaskScheduler
+	{
+	public:
+		virtual ~TaskScheduler() = default;
+
+		/** Gets the number of threads that execute tasks, the calling thread included. */
+		NODISCARD virtual uint32_t GetThreadCount() const = 0;
+
+		/**
+		 * Runs task(i) for every i in [0, count) in any order and on any thread, and returns once all of them finished.
+		 * Tasks may call ParallelFor themselves.
+		 * @param count Number of tasks.
+		 * @param task The work of one task.
+		 */
+		virtual void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task) = 0;
+	};
+
+	/**
+	 * A TaskScheduler backed by its own worker threads.
+	 * A thread waiting in ParallelFor executes queued tasks meanwhile, which keeps nested calls from deadlocking.
+	 */
+	class ThreadPool final : public TaskScheduler
+	{
+	public:
+		/**
+		 * Starts the worker threads.
+		 * @param threadCount Threads that execute tasks, the calling thread included; 0 uses one per hardware thread.
+		 */
+		explicit ThreadPool(uint32_t threadCount = 0);
+		~ThreadPool() override;
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		NODISCARD uint32_t GetThreadCount() const override { return static_cast<uint32_t>(m_Workers.size()) + 1; }
+
+		void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task) override;
+
+	private:
+		struct Batch;
+
+		bool RunQueuedTask(std::unique_lock<std::mutex>& lock);
+		void WorkerLoop();
+
+		std::vector<std::thread> m_Workers;
+		std::deque<Batch*> m_Queue;
+		std::mutex m_Mutex;
+		std::condition_variable m_Wake;
+		bool m_Stopping = false;
+	};
+
+	/**
+	 * Splits [0, count) into pieces of chunkSize elements and calls body(chunk, begin, end) for each of them.
+	 * @param scheduler Runs the pieces in parallel when given; nullptr runs them in order on the calling thread.
+	 */
+	void ParallelForChunks(TaskScheduler* scheduler, size_t count, size_t chunkSize, const std::function<void(uint32_t, size_t, size_t)>& body);
+}
+
+#endif /* end of include guard: _TASK_SCHEDULER_H_ */
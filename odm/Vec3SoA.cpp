@@ -0,0 +1,617 @@
+#include "Vec3SoA.h"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <new>
+#include "Simd.h"
+#include "Simd_soa.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+#pragma region Vec3SoA
+
+	/** Rounds an element count up so that every component array fills whole Alignment blocks. */
+	static size_t PaddedCapacity(size_t count)
+	{
+		constexpr size_t floatsPerBlock = Vec3SoA::Alignment / sizeof(float);
+		return (count + floatsPerBlock - 1) / floatsPerBlock * floatsPerBlock;
+	}
+
+	Vec3SoA::Vec3SoA(size_t count)
+	{
+		Resize(count);
+	}
+
+	Vec3SoA::Vec3SoA(Span<const Vector3f> points)
+	{
+		FromAoS(points);
+	}
+
+	Vec3SoA::Vec3SoA(const Vec3SoA& other)
+	{
+		*this = other;
+	}
+
+	Vec3SoA::Vec3SoA(Vec3SoA&& other) noexcept
+		: m_Data(other.m_Data), m_Size(other.m_Size), m_Capacity(other.m_Capacity)
+	{
+		other.m_Data = nullptr;
+		other.m_Size = other.m_Capacity = 0;
+	}
+
+	Vec3SoA& Vec3SoA::operator=(const Vec3SoA& other)
+	{
+		if (this != &other)
+		{
+			m_Size = 0;
+			Reserve(other.m_Size);
+			m_Size = other.m_Size;
+			// An empty source may have no storage at all, and memcpy must not be given a null pointer even for zero bytes.
+			if (m_Size != 0)
+			{
+				std::memcpy(X(), other.X(), m_Size * sizeof(float));
+				std::memcpy(Y(), other.Y(), m_Size * sizeof(float));
+				std::memcpy(Z(), other.Z(), m_Size * sizeof(float));
+			}
+		}
+		return *this;
+	}
+
+	Vec3SoA& Vec3SoA::operator=(Vec3SoA&& other) noexcept
+	{
+		if (this != &other)
+		{
+			::operator delete(m_Data, std::align_val_t(Alignment));
+			m_Data = other.m_Data;
+			m_Size = other.m_Size;
+			m_Capacity = other.m_Capacity;
+			other.m_Data = nullptr;
+			other.m_Size = other.m_Capacity = 0;
+		}
+		return *this;
+	}
+
+	Vec3SoA::~Vec3SoA()
+	{
+		::operator delete(m_Data, std::align_val_t(Alignment));
+	}
+
+	void Vec3SoA::PushBack(const Vector3f& v)
+	{
+		if (m_Size == m_Capacity)
+			Reallocate(m_Capacity * 2 > m_Size + 1 ? m_Capacity * 2 : m_Size + 1);
+		++m_Size;
+		Set(m_Size - 1, v);
+	}
+
+	void Vec3SoA::Resize(size_t count)
+	{
+		Reserve(count);
+		if (count > m_Size)
+		{
+			const size_t added = (count - m_Size) * sizeof(float);
+			std::memset(X() + m_Size, 0, added);
+			std::memset(Y() + m_Size, 0, added);
+			std::memset(Z() + m_Size, 0, added);
+		}
+		m_Size = count;
+	}
+
+	void Vec3SoA::Reserve(size_t capacity)
+	{
+		if (capacity > m_Capacity)
+			Reallocate(capacity);
+	}
+
+	void Vec3SoA::Reallocate(size_t capacity)
+	{
+		capacity = PaddedCapacity(capacity);
+		float* data = static_cast<float*>(::operator new(3 * capacity * sizeof(float), std::align_val_t(Alignment)));
+		if (m_Data)
+		{
+			std::memcpy(data, X(), m_Size * sizeof(float));
+			std::memcpy(data + capacity, Y(), m_Size * sizeof(float));
+			std::memcpy(data + 2 * capacity, Z(), m_Size * sizeof(float));
+			::operator delete(m_Data, std::align_val_t(Alignment));
+		}
+		m_Data = data;
+		m_Capacity = capacity;
+	}
+
+	void Vec3SoA::FromAoS(Span<const Vector3f> points)
+	{
+		m_Size = 0;
+		Reserve(points.size());
+		m_Size = points.size();
+		odm::ToSoA(points, AsSpan());
+	}
+
+	void Vec3SoA::ToAoS(Span<Vector3f> out) const
+	{
+		odm::ToAoS(AsSpan(), out);
+	}
+
+#pragma endregion
+
+	// Scalar reference kernels, also used for the tails of the SIMD ones.
+
+	static void ToSoAScalar(const Vector3f* in, Vec3SoASpan<float> out, size_t first)
+	{
+		for (size_t i = first; i < out.size(); ++i)
+			out.Set(i, in[i]);
+	}
+
+	static void ToAoSScalar(Vec3SoASpan<const float> in, Vector3f* out, size_t first)
+	{
+		for (size_t i = first; i < in.size(); ++i)
+			out[i] = in.Get(i);
+	}
+
+	static void AddScalar(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out, size_t first)
+	{
+		for (size_t i = first; i < a.size(); ++i)
+		{
+			out.X()[i] = a.X()[i] + b.X()[i];
+			out.Y()[i] = a.Y()[i] + b.Y()[i];
+			out.Z()[i] = a.Z()[i] + b.Z()[i];
+		}
+	}
+
+	static void ScaleScalar(Vec3SoASpan<const float> a, float s, Vec3SoASpan<float> out, size_t first)
+	{
+		for (size_t i = first; i < a.size(); ++i)
+		{
+			out.X()[i] = a.X()[i] * s;
+			out.Y()[i] = a.Y()[i] * s;
+			out.Z()[i] = a.Z()[i] * s;
+		}
+	}
+
+	static void DotScalar(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, float* out, size_t first)
+	{
+		for (size_t i = first; i < a.size(); ++i)
+			out[i] = a.X()[i] * b.X()[i] + a.Y()[i] * b.Y()[i] + a.Z()[i] * b.Z()[i];
+	}
+
+	static void CrossScalar(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out, size_t first)
+	{
+		for (size_t i = first; i < a.size(); ++i)
+			out.Set(i, Vector3f::Cross(a.Get(i), b.Get(i)));
+	}
+
+	static void NormalizeScalar(Vec3SoASpan<const float> a, Vec3SoASpan<float> out, size_t first)
+	{
+		for (size_t i = first; i < a.size(); ++i)
+		{
+			const Vector3f v = a.Get(i);
+			const float lengthSquared = v.LengthSquared();
+			out.Set(i, lengthSquared > 0.0f ? v * (1.0f / std::sqrt(lengthSquared)) : v);
+		}
+	}
+
+	static void LengthScalar(Vec3SoASpan<const float> a, float* out, size_t first)
+	{
+		for (size_t i = first; i < a.size(); ++i)
+			out[i] = std::sqrt(a.X()[i] * a.X()[i] + a.Y()[i] * a.Y()[i] + a.Z()[i] * a.Z()[i]);
+	}
+
+	static void MinMaxScalar(Vec3SoASpan<const float> a, Vector3f& outMin, Vector3f& outMax, size_t first)
+	{
+		for (size_t i = first; i < a.size(); ++i)
+		{
+			outMin.x = MathF::Min(outMin.x, a.X()[i]);
+			outMin.y = MathF::Min(outMin.y, a.Y()[i]);
+			outMin.z = MathF::Min(outMin.z, a.Z()[i]);
+			outMax.x = MathF::Max(outMax.x, a.X()[i]);
+			outMax.y = MathF::Max(outMax.y, a.Y()[i]);
+			outMax.z = MathF::Max(outMax.z, a.Z()[i]);
+		}
+	}
+
+#if ODM_SIMD_SSE
+
+	static void ToSoABaseline(const Vector3f* in, Vec3SoASpan<float> out)
+	{
+		size_t i = 0;
+		for (; i + 4 <= out.size(); i += 4)
+		{
+			__m128 x, y, z;
+			LoadPoints4(&in[i].x, x, y, z);
+			_mm_storeu_ps(out.X() + i, x);
+			_mm_storeu_ps(out.Y() + i, y);
+			_mm_storeu_ps(out.Z() + i, z);
+		}
+		ToSoAScalar(in, out, i);
+	}
+
+	static void ToAoSBaseline(Vec3SoASpan<const float> in, Vector3f* out)
+	{
+		size_t i = 0;
+		for (; i + 4 <= in.size(); i += 4)
+		{
+			__m128 a, b, c;
+			PackPoints4(_mm_loadu_ps(in.X() + i), _mm_loadu_ps(in.Y() + i), _mm_loadu_ps(in.Z() + i), a, b, c);
+			float* f = &out[i].x;
+			_mm_storeu_ps(f, a);
+			_mm_storeu_ps(f + 4, b);
+			_mm_storeu_ps(f + 8, c);
+		}
+		ToAoSScalar(in, out, i);
+	}
+
+	static void AddBaseline(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out)
+	{
+		size_t i = 0;
+		for (; i + 4 <= a.size(); i += 4)
+		{
+			_mm_storeu_ps(out.X() + i, _mm_add_ps(_mm_loadu_ps(a.X() + i), _mm_loadu_ps(b.X() + i)));
+			_mm_storeu_ps(out.Y() + i, _mm_add_ps(_mm_loadu_ps(a.Y() + i), _mm_loadu_ps(b.Y() + i)));
+			_mm_storeu_ps(out.Z() + i, _mm_add_ps(_mm_loadu_ps(a.Z() + i), _mm_loadu_ps(b.Z() + i)));
+		}
+		AddScalar(a, b, out, i);
+	}
+
+	static void ScaleBaseline(Vec3SoASpan<const float> a, float s, Vec3SoASpan<float> out)
+	{
+		const __m128 scale = _mm_set1_ps(s);
+		size_t i = 0;
+		for (; i + 4 <= a.size(); i += 4)
+		{
+			_mm_storeu_ps(out.X() + i, _mm_mul_ps(_mm_loadu_ps(a.X() + i), scale));
+			_mm_storeu_ps(out.Y() + i, _mm_mul_ps(_mm_loadu_ps(a.Y() + i), scale));
+			_mm_storeu_ps(out.Z() + i, _mm_mul_ps(_mm_loadu_ps(a.Z() + i), scale));
+		}
+		ScaleScalar(a, s, out, i);
+	}
+
+	static void DotBaseline(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, float* out)
+	{
+		size_t i = 0;
+		for (; i + 4 <= a.size(); i += 4)
+		{
+			const __m128 x = _mm_mul_ps(_mm_loadu_ps(a.X() + i), _mm_loadu_ps(b.X() + i));
+			const __m128 y = _mm_mul_ps(_mm_loadu_ps(a.Y() + i), _mm_loadu_ps(b.Y() + i));
+			const __m128 z = _mm_mul_ps(_mm_loadu_ps(a.Z() + i), _mm_loadu_ps(b.Z() + i));
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(x, y), z));
+		}
+		DotScalar(a, b, out, i);
+	}
+
+	static void CrossBaseline(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out)
+	{
+		size_t i = 0;
+		for (; i + 4 <= a.size(); i += 4)
+		{
+			const __m128 ax = _mm_loadu_ps(a.X() + i), ay = _mm_loadu_ps(a.Y() + i), az = _mm_loadu_ps(a.Z() + i);
+			const __m128 bx = _mm_loadu_ps(b.X() + i), by = _mm_loadu_ps(b.Y() + i), bz = _mm_loadu_ps(b.Z() + i);
+			_mm_storeu_ps(out.X() + i, _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(by, az)));
+			_mm_storeu_ps(out.Y() + i, _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(bz, ax)));
+			_mm_storeu_ps(out.Z() + i, _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(bx, ay)));
+		}
+		CrossScalar(a, b, out, i);
+	}
+
+	static void NormalizeBaseline(Vec3SoASpan<const float> a, Vec3SoASpan<float> out)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		size_t i = 0;
+		for (; i + 4 <= a.size(); i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(a.X() + i), y = _mm_loadu_ps(a.Y() + i), z = _mm_loadu_ps(a.Z() + i);
+			const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+			// Zero vectors scale by 1 instead of by 1/0.
+			const __m128 nonZero = _mm_cmpgt_ps(lengthSquared, zero);
+			const __m128 invLength = _mm_or_ps(
+				_mm_and_ps(nonZero, _mm_div_ps(one, _mm_sqrt_ps(lengthSquared))),
+				_mm_andnot_ps(nonZero, one));
+			_mm_storeu_ps(out.X() + i, _mm_mul_ps(x, invLength));
+			_mm_storeu_ps(out.Y() + i, _mm_mul_ps(y, invLength));
+			_mm_storeu_ps(out.Z() + i, _mm_mul_ps(z, invLength));
+		}
+		NormalizeScalar(a, out, i);
+	}
+
+	static void LengthBaseline(Vec3SoASpan<const float> a, float* out)
+	{
+		size_t i = 0;
+		for (; i + 4 <= a.size(); i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(a.X() + i), y = _mm_loadu_ps(a.Y() + i), z = _mm_loadu_ps(a.Z() + i);
+			_mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z))));
+		}
+		LengthScalar(a, out, i);
+	}
+
+	static float HorizontalMin(__m128 v)
+	{
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, ODM_SHUFFLE(2, 3, 0, 1)));
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, ODM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(v);
+	}
+
+	static float HorizontalMax(__m128 v)
+	{
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, ODM_SHUFFLE(2, 3, 0, 1)));
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, ODM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(v);
+	}
+
+	static void MinMaxBaseline(Vec3SoASpan<const float> a, Vector3f& outMin, Vector3f& outMax)
+	{
+		__m128 minX = _mm_set1_ps(outMin.x), minY = _mm_set1_ps(outMin.y), minZ = _mm_set1_ps(outMin.z);
+		__m128 maxX = _mm_set1_ps(outMax.x), maxY = _mm_set1_ps(outMax.y), maxZ = _mm_set1_ps(outMax.z);
+		size_t i = 0;
+		for (; i + 4 <= a.size(); i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(a.X() + i), y = _mm_loadu_ps(a.Y() + i), z = _mm_loadu_ps(a.Z() + i);
+			minX = _mm_min_ps(minX, x);
+			minY = _mm_min_ps(minY, y);
+			minZ = _mm_min_ps(minZ, z);
+			maxX = _mm_max_ps(maxX, x);
+			maxY = _mm_max_ps(maxY, y);
+			maxZ = _mm_max_ps(maxZ, z);
+		}
+		outMin = Vector3f(HorizontalMin(minX), HorizontalMin(minY), HorizontalMin(minZ));
+		outMax = Vector3f(HorizontalMax(maxX), HorizontalMax(maxY), HorizontalMax(maxZ));
+		MinMaxScalar(a, outMin, outMax, i);
+	}
+
+#else
+
+	static void ToSoABaseline(const Vector3f* in, Vec3SoASpan<float> out) { ToSoAScalar(in, out, 0); }
+	static void ToAoSBaseline(Vec3SoASpan<const float> in, Vector3f* out) { ToAoSScalar(in, out, 0); }
+	static void AddBaseline(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out) { AddScalar(a, b, out, 0); }
+	static void ScaleBaseline(Vec3SoASpan<const float> a, float s, Vec3SoASpan<float> out) { ScaleScalar(a, s, out, 0); }
+	static void DotBaseline(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, float* out) { DotScalar(a, b, out, 0); }
+	static void CrossBaseline(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out) { CrossScalar(a, b, out, 0); }
+	static void NormalizeBaseline(Vec3SoASpan<const float> a, Vec3SoASpan<float> out) { NormalizeScalar(a, out, 0); }
+	static void LengthBaseline(Vec3SoASpan<const float> a, float* out) { LengthScalar(a, out, 0); }
+	static void MinMaxBaseline(Vec3SoASpan<const float> a, Vector3f& outMin, Vector3f& outMax) { MinMaxScalar(a, outMin, outMax, 0); }
+
+#endif
+
+	static const Vec3SoAKernels s_BaselineKernels = {
+		SimdLevel::Baseline, &ToSoABaseline, &ToAoSBaseline, &AddBaseline, &ScaleBaseline, &DotBaseline,
+		&CrossBaseline, &NormalizeBaseline, &LengthBaseline, &MinMaxBaseline
+	};
+
+#if ODM_SIMD_SSE
+
+#pragma region AVX2
+
+	ODM_TARGET("avx2,fma")
+	static void ToSoAAVX2(const Vector3f* in, Vec3SoASpan<float> out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= out.size(); i += 8)
+		{
+			__m256 x, y, z;
+			LoadPoints8(&in[i].x, x, y, z);
+			_mm256_storeu_ps(out.X() + i, x);
+			_mm256_storeu_ps(out.Y() + i, y);
+			_mm256_storeu_ps(out.Z() + i, z);
+		}
+		ToSoAScalar(in, out, i);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void ToAoSAVX2(Vec3SoASpan<const float> in, Vector3f* out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= in.size(); i += 8)
+		{
+			__m256 l0, l1, l2;
+			PackPoints8(_mm256_loadu_ps(in.X() + i), _mm256_loadu_ps(in.Y() + i), _mm256_loadu_ps(in.Z() + i), l0, l1, l2);
+			float* f = &out[i].x;
+			_mm256_storeu_ps(f, l0);
+			_mm256_storeu_ps(f + 8, l1);
+			_mm256_storeu_ps(f + 16, l2);
+		}
+		ToAoSScalar(in, out, i);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void AddAVX2(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= a.size(); i += 8)
+		{
+			_mm256_storeu_ps(out.X() + i, _mm256_add_ps(_mm256_loadu_ps(a.X() + i), _mm256_loadu_ps(b.X() + i)));
+			_mm256_storeu_ps(out.Y() + i, _mm256_add_ps(_mm256_loadu_ps(a.Y() + i), _mm256_loadu_ps(b.Y() + i)));
+			_mm256_storeu_ps(out.Z() + i, _mm256_add_ps(_mm256_loadu_ps(a.Z() + i), _mm256_loadu_ps(b.Z() + i)));
+		}
+		AddScalar(a, b, out, i);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void ScaleAVX2(Vec3SoASpan<const float> a, float s, Vec3SoASpan<float> out)
+	{
+		const __m256 scale = _mm256_set1_ps(s);
+		size_t i = 0;
+		for (; i + 8 <= a.size(); i += 8)
+		{
+			_mm256_storeu_ps(out.X() + i, _mm256_mul_ps(_mm256_loadu_ps(a.X() + i), scale));
+			_mm256_storeu_ps(out.Y() + i, _mm256_mul_ps(_mm256_loadu_ps(a.Y() + i), scale));
+			_mm256_storeu_ps(out.Z() + i, _mm256_mul_ps(_mm256_loadu_ps(a.Z() + i), scale));
+		}
+		ScaleScalar(a, s, out, i);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void DotAVX2(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, float* out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= a.size(); i += 8)
+		{
+			__m256 r = _mm256_mul_ps(_mm256_loadu_ps(a.X() + i), _mm256_loadu_ps(b.X() + i));
+			r = _mm256_fmadd_ps(_mm256_loadu_ps(a.Y() + i), _mm256_loadu_ps(b.Y() + i), r);
+			r = _mm256_fmadd_ps(_mm256_loadu_ps(a.Z() + i), _mm256_loadu_ps(b.Z() + i), r);
+			_mm256_storeu_ps(out + i, r);
+		}
+		DotScalar(a, b, out, i);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void CrossAVX2(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= a.size(); i += 8)
+		{
+			const __m256 ax = _mm256_loadu_ps(a.X() + i), ay = _mm256_loadu_ps(a.Y() + i), az = _mm256_loadu_ps(a.Z() + i);
+			const __m256 bx = _mm256_loadu_ps(b.X() + i), by = _mm256_loadu_ps(b.Y() + i), bz = _mm256_loadu_ps(b.Z() + i);
+			_mm256_storeu_ps(out.X() + i, _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(by, az)));
+			_mm256_storeu_ps(out.Y() + i, _mm256_fmsub_ps(az, bx, _mm256_mul_ps(bz, ax)));
+			_mm256_storeu_ps(out.Z() + i, _mm256_fmsub_ps(ax, by, _mm256_mul_ps(bx, ay)));
+		}
+		CrossScalar(a, b, out, i);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void NormalizeAVX2(Vec3SoASpan<const float> a, Vec3SoASpan<float> out)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		size_t i = 0;
+		for (; i + 8 <= a.size(); i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(a.X() + i), y = _mm256_loadu_ps(a.Y() + i), z = _mm256_loadu_ps(a.Z() + i);
+			const __m256 lengthSquared = _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+			const __m256 nonZero = _mm256_cmp_ps(lengthSquared, zero, _CMP_GT_OQ);
+			const __m256 invLength = _mm256_blendv_ps(one, _mm256_div_ps(one, _mm256_sqrt_ps(lengthSquared)), nonZero);
+			_mm256_storeu_ps(out.X() + i, _mm256_mul_ps(x, invLength));
+			_mm256_storeu_ps(out.Y() + i, _mm256_mul_ps(y, invLength));
+			_mm256_storeu_ps(out.Z() + i, _mm256_mul_ps(z, invLength));
+		}
+		NormalizeScalar(a, out, i);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void LengthAVX2(Vec3SoASpan<const float> a, float* out)
+	{
+		size_t i = 0;
+		for (; i + 8 <= a.size(); i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(a.X() + i), y = _mm256_loadu_ps(a.Y() + i), z = _mm256_loadu_ps(a.Z() + i);
+			_mm256_storeu_ps(out + i, _mm256_sqrt_ps(_mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)))));
+		}
+		LengthScalar(a, out, i);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void MinMaxAVX2(Vec3SoASpan<const float> a, Vector3f& outMin, Vector3f& outMax)
+	{
+		__m256 minX = _mm256_set1_ps(outMin.x), minY = _mm256_set1_ps(outMin.y), minZ = _mm256_set1_ps(outMin.z);
+		__m256 maxX = _mm256_set1_ps(outMax.x), maxY = _mm256_set1_ps(outMax.y), maxZ = _mm256_set1_ps(outMax.z);
+		size_t i = 0;
+		for (; i + 8 <= a.size(); i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(a.X() + i), y = _mm256_loadu_ps(a.Y() + i), z = _mm256_loadu_ps(a.Z() + i);
+			minX = _mm256_min_ps(minX, x);
+			minY = _mm256_min_ps(minY, y);
+			minZ = _mm256_min_ps(minZ, z);
+			maxX = _mm256_max_ps(maxX, x);
+			maxY = _mm256_max_ps(maxY, y);
+			maxZ = _mm256_max_ps(maxZ, z);
+		}
+		outMin = Vector3f(
+			HorizontalMin(_mm_min_ps(_mm256_castps256_ps128(minX), _mm256_extractf128_ps(minX, 1))),
+			HorizontalMin(_mm_min_ps(_mm256_castps256_ps128(minY), _mm256_extractf128_ps(minY, 1))),
+			HorizontalMin(_mm_min_ps(_mm256_castps256_ps128(minZ), _mm256_extractf128_ps(minZ, 1))));
+		outMax = Vector3f(
+			HorizontalMax(_mm_max_ps(_mm256_castps256_ps128(maxX), _mm256_extractf128_ps(maxX, 1))),
+			HorizontalMax(_mm_max_ps(_mm256_castps256_ps128(maxY), _mm256_extractf128_ps(maxY, 1))),
+			HorizontalMax(_mm_max_ps(_mm256_castps256_ps128(maxZ), _mm256_extractf128_ps(maxZ, 1))));
+		MinMaxScalar(a, outMin, outMax, i);
+	}
+
+	// AVX-512 shares these kernels: the SoA loops are bound by memory bandwidth well before 8 lanes.
+	static const Vec3SoAKernels s_AVX2Kernels = {
+		SimdLevel::AVX2, &ToSoAAVX2, &ToAoSAVX2, &AddAVX2, &ScaleAVX2, &DotAVX2,
+		&CrossAVX2, &NormalizeAVX2, &LengthAVX2, &MinMaxAVX2
+	};
+
+#pragma endregion
+
+#endif
+
+	const Vec3SoAKernels& GetVec3SoAKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:	return s_AVX2Kernels;
+		default:				break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const Vec3SoAKernels& GetVec3SoAKernels()
+	{
+		static const Vec3SoAKernels& kernels = GetVec3SoAKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	void ToSoA(Span<const Vector3f> in, Vec3SoASpan<float> out)
+	{
+		assert(in.size() == out.size());
+		GetVec3SoAKernels().ToSoA(in.data(), out);
+	}
+
+	void ToAoS(Vec3SoASpan<const float> in, Span<Vector3f> out)
+	{
+		assert(in.size() == out.size());
+		GetVec3SoAKernels().ToAoS(in, out.data());
+	}
+
+	void Add(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out)
+	{
+		assert(a.size() == b.size() && a.size() == out.size());
+		GetVec3SoAKernels().Add(a, b, out);
+	}
+
+	void Scale(Vec3SoASpan<const float> a, float s, Vec3SoASpan<float> out)
+	{
+		assert(a.size() == out.size());
+		GetVec3SoAKernels().Scale(a, s, out);
+	}
+
+	void Dot(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Span<float> out)
+	{
+		assert(a.size() == b.size() && a.size() == out.size());
+		GetVec3SoAKernels().Dot(a, b, out.data());
+	}
+
+	void Cross(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out)
+	{
+		assert(a.size() == b.size() && a.size() == out.size());
+		GetVec3SoAKernels().Cross(a, b, out);
+	}
+
+	void Normalize(Vec3SoASpan<const float> a, Vec3SoASpan<float> out)
+	{
+		assert(a.size() == out.size());
+		GetVec3SoAKernels().Normalize(a, out);
+	}
+
+	void Length(Vec3SoASpan<const float> a, Span<float> out)
+	{
+		assert(a.size() == out.size());
+		GetVec3SoAKernels().Length(a, out.data());
+	}
+
+	void MinMax(Vec3SoASpan<const float> a, Vector3f& outMin, Vector3f& outMax)
+	{
+		outMin = Vector3f(std::numeric_limits<float>::max());
+		outMax = Vector3f(-std::numeric_limits<float>::max());
+		GetVec3SoAKernels().MinMax(a, outMin, outMax);
+	}
+}
@@ -0,0 +1,315 @@
+#pragma once
+
+#ifndef _VEC3_SOA_H_
+#define _VEC3_SOA_H_
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include "Vector3f.h"
+#include "Cpu.h"
+#include "Span.h"
+
+namespace odm
+{
+	/**
+	 * Non-owning view over three parallel component arrays, the structure-of-arrays counterpart of Span<Vector3f>.
+	 * Element i is (X()[i], Y()[i], Z()[i]).
+	 */
+	template <class T>
+	class Vec3SoASpan
+	{
+	public:
+		/** Constructs an empty span. */
+		constexpr Vec3SoASpan() noexcept = default;
+
+		/**
+		 * Constructs a span over count elements.
+		 * @param x Pointer to the first x component.
+		 * @param y Pointer to the first y component.
+		 * @param z Pointer to the first z component.
+		 * @param count Number of elements in the span.
+		 */
+		constexpr Vec3SoASpan(T* x, T* y, T* z, size_t count) noexcept
+			: m_X(x), m_Y(y), m_Z(z), m_Size(count)
+		{}
+
+		/**
+		 * Converts a span of mutable components into a span of const components.
+		 * @param other The span to be viewed.
+		 */
+		template <class U, class = std::enable_if_t<!std::is_same_v<U, T> && std::is_convertible_v<U(*)[], T(*)[]>>>
+		constexpr Vec3SoASpan(const Vec3SoASpan<U>& other) noexcept
+			: m_X(other.X()), m_Y(other.Y()), m_Z(other.Z()), m_Size(other.size())
+		{}
+
+		NODISCARD constexpr T* X() const noexcept { return m_X; }
+		NODISCARD constexpr T* Y() const noexcept { return m_Y; }
+		NODISCARD constexpr T* Z() const noexcept { return m_Z; }
+
+		NODISCARD constexpr size_t size() const noexcept { return m_Size; }
+		NODISCARD constexpr bool empty() const noexcept { return m_Size == 0; }
+
+		/**
+		 * Gathers one element.
+		 * @param index Index of the element.
+		 */
+		NODISCARD Vector3f Get(size_t index) const
+		{
+			assert(index < m_Size);
+			return Vector3f(m_X[index], m_Y[index], m_Z[index]);
+		}
+
+		/**
+		 * Scatters one element; only available on spans of mutable components.
+		 * @param index Index of the element.
+		 * @param v The new value.
+		 */
+		void Set(size_t index, const Vector3f& v) const
+		{
+			assert(index < m_Size);
+			m_X[index] = v.x;
+			m_Y[index] = v.y;
+			m_Z[index] = v.z;
+		}
+
+		/**
+		 * Gets a view over a part of this span, e.g. the share of one worker thread.
+		 * @param offset Index of the first element of the view.
+		 * @param count Number of elements in the view.
+		 */
+		NODISCARD constexpr Vec3SoASpan subspan(size_t offset, size_t count) const
+		{
+			assert(offset + count <= m_Size);
+			return Vec3SoASpan(m_X + offset, m_Y + offset, m_Z + offset, count);
+		}
+
+	private:
+		T* m_X = nullptr;
+		T* m_Y = nullptr;
+		T* m_Z = nullptr;
+		size_t m_Size = 0;
+	};
+
+	/**
+	 * Growable array of 3D vectors stored as three separate float arrays.
+	 * Each component array starts on an Alignment boundary and is padded to a multiple of Alignment bytes,
+	 * so full-width vector loads never straddle two arrays.
+	 */
+	class Vec3SoA
+	{
+	public:
+		/** Alignment of each component array in bytes, one cache line. */
+		static constexpr size_t Alignment = 64;
+
+		/** Constructs an empty container without allocating. */
+		Vec3SoA() = default;
+
+		/**
+		 * Constructs count zero vectors.
+		 * @param count Number of elements.
+		 */
+		explicit Vec3SoA(size_t count);
+
+		/**
+		 * Constructs from packed vectors.
+		 * @param points Vectors to be copied and split into components.
+		 */
+		explicit Vec3SoA(Span<const Vector3f> points);
+
+		Vec3SoA(const Vec3SoA& other);
+		Vec3SoA(Vec3SoA&& other) noexcept;
+		Vec3SoA& operator=(const Vec3SoA& other);
+		Vec3SoA& operator=(Vec3SoA&& other) noexcept;
+		~Vec3SoA();
+
+		NODISCARD size_t Size() const { return m_Size; }
+		NODISCARD size_t Capacity() const { return m_Capacity; }
+		NODISCARD bool IsEmpty() const { return m_Size == 0; }
+
+		NODISCARD float* X() { return m_Data; }
+		NODISCARD float* Y() { return m_Data + m_Capacity; }
+		NODISCARD float* Z() { return m_Data + 2 * m_Capacity; }
+		NODISCARD const float* X() const { return m_Data; }
+		NODISCARD const float* Y() const { return m_Data + m_Capacity; }
+		NODISCARD const float* Z() const { return m_Data + 2 * m_Capacity; }
+
+		/**
+		 * Gathers one element.
+		 * @param index Index of the element.
+		 */
+		NODISCARD Vector3f Get(size_t index) const { return AsSpan().Get(index); }
+
+		/**
+		 * Scatters one element.
+		 * @param index Index of the element.
+		 * @param v The new value.
+		 */
+		void Set(size_t index, const Vector3f& v) { AsSpan().Set(index, v); }
+
+		/**
+		 * Appends one element, growing the storage geometrically.
+		 * @param v The value to be appended.
+		 */
+		void PushBack(const Vector3f& v);
+
+		/**
+		 * Changes the number of elements; new elements are zero vectors.
+		 * @param count The new number of elements.
+		 */
+		void Resize(size_t count);
+
+		/**
+		 * Makes room for at least capacity elements without changing Size().
+		 * @param capacity Number of elements to be allocated.
+		 */
+		void Reserve(size_t capacity);
+
+		/** Removes every element, keeping the allocation. */
+		void Clear() { m_Size = 0; }
+
+		/**
+		 * Replaces the content with packed vectors.
+		 * @param points Vectors to be copied and split into components.
+		 */
+		void FromAoS(Span<const Vector3f> points);
+
+		/**
+		 * Copies the content out as packed vectors.
+		 * @param out Receives the elements; must hold Size() vectors.
+		 */
+		void ToAoS(Span<Vector3f> out) const;
+
+		NODISCARD Vec3SoASpan<float> AsSpan() { return Vec3SoASpan<float>(X(), Y(), Z(), m_Size); }
+		NODISCARD Vec3SoASpan<const float> AsSpan() const { return Vec3SoASpan<const float>(X(), Y(), Z(), m_Size); }
+
+		operator Vec3SoASpan<float>() { return AsSpan(); }
+		operator Vec3SoASpan<const float>() const { return AsSpan(); }
+
+	private:
+		void Reallocate(size_t capacity);
+
+		float* m_Data = nullptr;
+		size_t m_Size = 0;
+		size_t m_Capacity = 0;
+	};
+
+	/**
+	 * Table of structure-of-arrays kernels compiled for one instruction set tier.
+	 * Every kernel accepts an output that aliases its input element for element.
+	 */
+	struct Vec3SoAKernels
+	{
+		SimdLevel level;
+
+		/** out[i] = in[i], splitting packed vectors into components */
+		void (*ToSoA)(const Vector3f* in, Vec3SoASpan<float> out);
+
+		/** out[i] = in[i], interleaving components into packed vectors */
+		void (*ToAoS)(Vec3SoASpan<const float> in, Vector3f* out);
+
+		/** out[i] = a[i] + b[i] */
+		void (*Add)(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out);
+
+		/** out[i] = a[i] * s */
+		void (*Scale)(Vec3SoASpan<const float> a, float s, Vec3SoASpan<float> out);
+
+		/** out[i] = Dot(a[i], b[i]) */
+		void (*Dot)(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, float* out);
+
+		/** out[i] = Cross(a[i], b[i]) */
+		void (*Cross)(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out);
+
+		/** out[i] = a[i].Normalize() */
+		void (*Normalize)(Vec3SoASpan<const float> a, Vec3SoASpan<float> out);
+
+		/** out[i] = a[i].Length() */
+		void (*Length)(Vec3SoASpan<const float> a, float* out);
+
+		/** Component-wise minimum and maximum over every element of a */
+		void (*MinMax)(Vec3SoASpan<const float> a, Vector3f& outMin, Vector3f& outMax);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const Vec3SoAKernels& GetVec3SoAKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const Vec3SoAKernels& GetVec3SoAKernels(SimdLevel level);
+
+	/**
+	 * Splits packed vectors into components.
+	 * @param in Vectors to be converted.
+	 * @param out Receives in[i]; must hold as many elements as in.
+	 */
+	void ToSoA(Span<const Vector3f> in, Vec3SoASpan<float> out);
+
+	/**
+	 * Interleaves components into packed vectors.
+	 * @param in Vectors to be converted.
+	 * @param out Receives in[i]; must hold as many elements as in.
+	 */
+	void ToAoS(Vec3SoASpan<const float> in, Span<Vector3f> out);
+
+	/**
+	 * Adds vectors pairwise.
+	 * @param a Left hand side vectors.
+	 * @param b Right hand side vectors, as many as in a.
+	 * @param out Receives a[i] + b[i]; may alias a or b.
+	 */
+	void Add(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out);
+
+	/**
+	 * Scales vectors by one factor.
+	 * @param a Vectors to be scaled.
+	 * @param s The factor applied to every vector.
+	 * @param out Receives a[i] * s; may alias a.
+	 */
+	void Scale(Vec3SoASpan<const float> a, float s, Vec3SoASpan<float> out);
+
+	/**
+	 * Calculates dot products pairwise.
+	 * @param a Left hand side vectors.
+	 * @param b Right hand side vectors, as many as in a.
+	 * @param out Receives Dot(a[i], b[i]).
+	 */
+	void Dot(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Span<float> out);
+
+	/**
+	 * Calculates cross products pairwise.
+	 * @param a Left hand side vectors.
+	 * @param b Right hand side vectors, as many as in a.
+	 * @param out Receives Cross(a[i], b[i]); may alias a or b.
+	 */
+	void Cross(Vec3SoASpan<const float> a, Vec3SoASpan<const float> b, Vec3SoASpan<float> out);
+
+	/**
+	 * Normalizes vectors, leaving zero vectors untouched as Vector3f::Normalize does.
+	 * @param a Vectors to be normalized.
+	 * @param out Receives the unit vectors; may alias a.
+	 */
+	void Normalize(Vec3SoASpan<const float> a, Vec3SoASpan<float> out);
+
+	/**
+	 * Calculates vector lengths.
+	 * @param a Vectors to be measured.
+	 * @param out Receives a[i].Length().
+	 */
+	void Length(Vec3SoASpan<const float> a, Span<float> out);
+
+	/**
+	 * Reduces vectors to their component-wise bounds.
+	 * An empty input yields outMin = +FLT_MAX and outMax = -FLT_MAX.
+	 * @param a Vectors to be reduced.
+	 * @param outMin Receives the smallest x, y and z.
+	 * @param outMax Receives the largest x, y and z.
+	 */
+	void MinMax(Vec3SoASpan<const float> a, Vector3f& outMin, Vector3f& outMax);
+}
+
+#endif /* end of include guard: _VEC3_SOA_H_ */
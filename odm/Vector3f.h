@@ -272,7 +272,7 @@ namespace odm
 	inline Vector3f Vector3f::Min(const Vector3f& a, const Vector3f& b)
 	{
 		return Vector3f(
-			MathF::Max(a.x, b.x),
+			MathF::Min(a.x, b.x),
 			MathF::Min(a.y, b.y),
 			MathF::Min(a.z, b.z)
 		);
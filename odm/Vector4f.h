@@ -4,6 +4,7 @@
 #define _VECTOR4_H_
 
 #include <cassert>
+#include "Simd.h"
 #include "Vector3f.h"
 #include "Vector2f.h"
 
@@ -11,7 +12,7 @@ namespace odm
 {
 	struct Vector3f;
 
-	struct Vector4f
+	struct alignas(16) Vector4f
 	{
 		union
 		{
@@ -23,6 +24,9 @@ namespace odm
 				float w;
 			};
 			Vector2f v[2];
+#if ODM_SIMD_SSE
+			__m128 simd;
+#endif
 		};
 
 		/**
@@ -66,6 +70,14 @@ namespace odm
 		*/
 		Vector4f(const Vector3f& v);
 
+#if ODM_SIMD_SSE
+		/**
+		 * Constructs from an SSE register.
+		 * @param v Register holding x, y, z, w in lanes 0 to 3.
+		*/
+		explicit Vector4f(__m128 v);
+#endif
+
 
 		/** Default Destructor. */
 		~Vector4f() = default;
@@ -109,9 +121,30 @@ namespace odm
 
 	inline Vector4f::Vector4f()
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_setzero_ps();
+#else
 		x = y = z = w = 0;
+#endif
 	}
 
+#if ODM_SIMD_SSE
+	inline Vector4f::Vector4f(const Vector4f& vector)
+		: simd(vector.simd)
+	{}
+
+	inline Vector4f::Vector4f(float f)
+		: simd(_mm_set1_ps(f))
+	{}
+
+	inline Vector4f::Vector4f(float x, float y, float z, float w)
+		: simd(_mm_setr_ps(x, y, z, w))
+	{}
+
+	inline Vector4f::Vector4f(__m128 v)
+		: simd(v)
+	{}
+#else
 	inline Vector4f::Vector4f(const Vector4f& vector)
 		: x(vector.x), y(vector.y), z(vector.z), w(vector.w)
 	{}
@@ -124,6 +157,7 @@ namespace odm
 	inline Vector4f::Vector4f(float x, float y, float z, float w)
 		: x(x), y(y), z(z), w(w)
 	{}
+#endif
 
 	inline Vector4f::Vector4f(const Vector3f& v, float z)
 		: x(v.x), y(v.y), z(v.z), w(z)
@@ -135,13 +169,21 @@ namespace odm
 
 	inline Vector4f& Vector4f::operator=(const Vector4f& v)
 	{
+#if ODM_SIMD_SSE
+		simd = v.simd;
+#else
 		x = v.x, y = v.y, z = v.z, w = v.w;
+#endif
 		return *this;
 	}
 
 	inline bool Vector4f::operator==(const Vector4f& v) const
 	{
+#if ODM_SIMD_SSE
+		return _mm_movemask_ps(_mm_cmpeq_ps(simd, v.simd)) == 0xF;
+#else
 		return (this->x == v.x && this->y == v.y && this->z == v.z && this->w == v.w);
+#endif
 	}
 
 	inline bool Vector4f::operator!=(const Vector4f& v) const
@@ -151,134 +193,198 @@ namespace odm
 
 	inline Vector4f Vector4f::operator+(const Vector4f& v) const
 	{
+#if ODM_SIMD_SSE
+		return Vector4f(_mm_add_ps(simd, v.simd));
+#else
 		return Vector4f(x + v.x, y + v.y, z + v.z, w + v.w);
+#endif
 	}
 
 	inline Vector4f Vector4f::operator-(const Vector4f& v) const
 	{
+#if ODM_SIMD_SSE
+		return Vector4f(_mm_sub_ps(simd, v.simd));
+#else
 		return Vector4f(
 			x - v.x,
 			y - v.y,
 			z - v.z,
 			w - v.w
 		);
+#endif
 	}
 
 	inline Vector4f Vector4f::operator*(const Vector4f& v) const
 	{
+#if ODM_SIMD_SSE
+		return Vector4f(_mm_mul_ps(simd, v.simd));
+#else
 		return Vector4f(
 			x * v.x,
 			y * v.y,
 			z * v.z,
 			w * v.w
 		);
+#endif
 	}
 
 	inline Vector4f Vector4f::operator/(const Vector4f& v) const
 	{
+#if ODM_SIMD_SSE
+		return Vector4f(_mm_div_ps(simd, v.simd));
+#else
 		return Vector4f(
 			x / v.x,
 			y / v.y,
 			z / v.z,
 			w / v.w
 		);
+#endif
 	}
 
 	inline Vector4f Vector4f::operator+(float f) const
 	{
+#if ODM_SIMD_SSE
+		return Vector4f(_mm_add_ps(simd, _mm_set1_ps(f)));
+#else
 		return Vector4f(x + f, y + f, z + f, w + f);
+#endif
 	}
 
 	inline Vector4f Vector4f::operator-(float f) const
 	{
+#if ODM_SIMD_SSE
+		return Vector4f(_mm_sub_ps(simd, _mm_set1_ps(f)));
+#else
 		return Vector4f(x - f, y - f, z - f, w - f);
+#endif
 	}
 
 	inline Vector4f Vector4f::operator*(const float f) const
 	{
+#if ODM_SIMD_SSE
+		return Vector4f(_mm_mul_ps(simd, _mm_set1_ps(f)));
+#else
 		return Vector4f(x * f, y * f, z * f, w * f);
+#endif
 	}
 
 	inline Vector4f Vector4f::operator/(const float f) const
 	{
 		assert(f != 0);
+#if ODM_SIMD_SSE
+		return Vector4f(_mm_div_ps(simd, _mm_set1_ps(f)));
+#else
 		return Vector4f(
 			x / f,
 			y / f,
 			z / f,
 			w / f
 		);
+#endif
 	}
 
 	inline Vector4f Vector4f::operator+=(const Vector4f& v)
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_add_ps(simd, v.simd);
+#else
 		x += v.x;
 		y += v.y;
 		z += v.z;
 		w += v.w;
+#endif
 		return *this;
 	}
 
 	inline Vector4f Vector4f::operator-=(const Vector4f& v)
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_sub_ps(simd, v.simd);
+#else
 		x -= v.x;
 		y -= v.y;
 		z -= v.z;
 		w -= v.w;
+#endif
 		return *this;
 	}
 
 	inline Vector4f Vector4f::operator*=(const Vector4f& v)
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_mul_ps(simd, v.simd);
+#else
 		x *= v.x;
 		y *= v.y;
 		z *= v.z;
 		w *= v.w;
+#endif
 		return *this;
 	}
 
 	inline Vector4f Vector4f::operator/=(const Vector4f& v)
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_div_ps(simd, v.simd);
+#else
 		x /= v.x;
 		y /= v.y;
 		z /= v.z;
 		w /= v.w;
+#endif
 		return *this;
 	}
 
 	inline Vector4f Vector4f::operator+=(float f)
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_add_ps(simd, _mm_set1_ps(f));
+#else
 		x += f;
 		y += f;
 		z += f;
 		w += f;
+#endif
 		return *this;
 	}
 
 	inline Vector4f Vector4f::operator-=(float f)
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_sub_ps(simd, _mm_set1_ps(f));
+#else
 		x -= f;
 		y -= f;
 		z -= f;
 		w -= f;
+#endif
 		return *this;
 	}
 
 	inline Vector4f Vector4f::operator*=(float f)
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_mul_ps(simd, _mm_set1_ps(f));
+#else
 		x *= f;
 		y *= f;
 		z *= f;
 		w *= f;
+#endif
 		return *this;
 	}
 	
 	inline Vector4f Vector4f::operator/=(float f)
 	{
+#if ODM_SIMD_SSE
+		simd = _mm_div_ps(simd, _mm_set1_ps(f));
+#else
 		x /= f;
 		y /= f;
 		z /= f;
 		w /= f;
+#endif
 		return *this;
 	}
 
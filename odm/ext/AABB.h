@@ -33,6 +33,7 @@ namespace odm
 		NODISCARD bool Intersects(const AABB& other) const;
 		NODISCARD bool Contains(const vec2& point, float tolerance = 0.0f) const;
 		NODISCARD bool Contains(const vec3& point, float tolerance = 0.0f) const;
+		NODISCARD bool Contains(const AABB& other) const;	// Whether other lies inside this box, touching faces included.
 
 		void Add(const AABB& bb);
 		void ClipToBox(AABB const& bb);
@@ -42,6 +43,7 @@ namespace odm
 		NODISCARD vec3 GetSize() const;
 		NODISCARD vec3 GetExtents() const;	// Distance from the center to each side.
 		NODISCARD vec3 Center() const;		// Center of the box.
+		NODISCARD float GetSurfaceArea() const;	// Area of the six faces, the cost measure of hierarchy builders.
 
 		NODISCARD vec3 GetMin() const;
 		NODISCARD vec3 GetMax() const;
@@ -91,6 +93,10 @@ namespace odm
 		return point + tolerance > min && point - tolerance < max;
 	}
 
+	inline bool AABB::Contains(const AABB& other) const {
+		return min <= other.min && other.max <= max;
+	}
+
 	inline void AABB::Add(const AABB& bb)
 	{
 		min = Vector3f::Min(min, bb.min);
@@ -105,19 +111,14 @@ namespace odm
 
 	inline AABB AABB::TransformToAABB(const Matrix4x4& transform) const
 	{
-		return AABB(
-			(transform * Center()) - vec3 (
-			(abs(transform.m[0][0]) * (GetSize() * 0.5f).x) + (abs(transform.m[0][1]) * (GetSize() * 0.5f).y) + (abs(transform.m[0][2]) * (GetSize() * 0.5f).z),
-			(abs(transform.m[1][0]) * (GetSize() * 0.5f).x) + (abs(transform.m[1][1]) * (GetSize() * 0.5f).y) + (abs(transform.m[1][2]) * (GetSize() * 0.5f).z),
-			(abs(transform.m[2][0]) * (GetSize() * 0.5f).x) + (abs(transform.m[2][1]) * (GetSize() * 0.5f).y) + (abs(transform.m[2][2]) * (GetSize() * 0.5f).z)
-			),
+		const vec3 center = transform * Center();
+		const vec3 extents = GetExtents();
+		const vec3 worldExtents(
+			(std::abs(transform.m[0][0]) * extents.x) + (std::abs(transform.m[1][0]) * extents.y) + (std::abs(transform.m[2][0]) * extents.z),
+			(std::abs(transform.m[0][1]) * extents.x) + (std::abs(transform.m[1][1]) * extents.y) + (std::abs(transform.m[2][1]) * extents.z),
+			(std::abs(transform.m[0][2]) * extents.x) + (std::abs(transform.m[1][2]) * extents.y) + (std::abs(transform.m[2][2]) * extents.z));
 
-			(transform * Center()) + 
-			vec3(
-			(abs(transform.m[0][0]) * (GetSize() * 0.5f).x) + (abs(transform.m[0][1]) * (GetSize() * 0.5f).y) + (abs(transform.m[0][2]) * (GetSize() * 0.5f).z),
-			(abs(transform.m[1][0]) * (GetSize() * 0.5f).x) + (abs(transform.m[1][1]) * (GetSize() * 0.5f).y) + (abs(transform.m[1][2]) * (GetSize() * 0.5f).z),
-			(abs(transform.m[2][0]) * (GetSize() * 0.5f).x) + (abs(transform.m[2][1]) * (GetSize() * 0.5f).y) + (abs(transform.m[2][2]) * (GetSize() * 0.5f).z)
-		));
+		return AABB(center - worldExtents, center + worldExtents);
 	}
 
 	inline vec3 AABB::GetSize() const
@@ -133,6 +134,12 @@ namespace odm
 		return (max + min) * 0.5f;
 	}
 
+	inline float AABB::GetSurfaceArea() const
+	{
+		const vec3 size = max - min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
 	inline vec3 AABB::GetMin() const
 	{
 		return min;
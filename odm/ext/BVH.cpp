@@ -0,0 +1,545 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+namespace odm
+{
+	/** Number of centroid bins the builder evaluates per axis. */
+	static constexpr uint32_t BinCount = 16;
+
+	/** Primitives per piece of the chunked build passes; a constant, so the pieces never depend on the thread count. */
+	static constexpr uint32_t BuildChunkSize = 16384;
+
+	/** Smallest subtree the builder hands to the scheduler as a task of its own. */
+	static constexpr uint32_t ParallelSubtreeThreshold = 4096;
+
+	/** A box that any union replaces, the starting point of bound accumulation. */
+	static inline AABB EmptyAABB()
+	{
+		return AABB(vec3(FLT_MAX), vec3(-FLT_MAX));
+	}
+
+	static inline bool Overlaps(const AABB& a, const AABB& b)
+	{
+		return a.min.x <= b.max.x && b.min.x <= a.max.x
+			&& a.min.y <= b.max.y && b.min.y <= a.max.y
+			&& a.min.z <= b.max.z && b.min.z <= a.max.z;
+	}
+
+	static inline bool ContainsPoint(const AABB& box, const vec3& point)
+	{
+		return box.min.x <= point.x && point.x <= box.max.x
+			&& box.min.y <= point.y && point.y <= box.max.y
+			&& box.min.z <= point.z && point.z <= box.max.z;
+	}
+
+	/** Entry distance of a ray into a box; INFINITY when it misses or enters beyond tMax. */
+	static inline float IntersectSlab(const AABB& box, const Ray& ray, float tMax)
+	{
+		float tNear, tFar;
+		return ray.Intersect(box, tNear, tFar, tMax) ? tNear : INFINITY;
+	}
+
+	/** Shared state of one Build call. */
+	struct BVH::BuildContext
+	{
+		TaskScheduler* scheduler;
+		std::vector<vec3> centroids;	// By original primitive index.
+		std::vector<BVHNode> nodes;		// Worst case of 2 * count - 1 slots; every subtree owns a disjoint range of them.
+		std::vector<uint32_t> scratch;	// Target of the chunked partition.
+	};
+
+	/** Bounds of the boxes in a node and of their centroids. */
+	struct NodeBounds
+	{
+		AABB bounds = EmptyAABB();
+		AABB centroidBounds = EmptyAABB();
+	};
+
+	/**
+	 * Maps centroids of a node to bins along each axis; an axis along which all centroids coincide is skipped.
+	 * So is one whose spread overflows, or is so small that BinCount over it does: the bins would come out inf or NaN before their conversion.
+	 */
+	struct BinGrid
+	{
+		float lo[3];
+		float scale[3];
+		bool valid[3];
+
+		explicit BinGrid(const AABB& centroidBounds)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+				lo[axis] = centroidBounds.min[axis];
+				scale[axis] = extent > 0.0f ? BinCount / extent : 0.0f;
+				valid[axis] = scale[axis] > 0.0f && std::isfinite(scale[axis]);
+				if (!valid[axis])
+					scale[axis] = 0.0f;
+			}
+		}
+
+		NODISCARD uint32_t GetBin(const vec3& centroid, int axis) const
+		{
+			return std::min(BinCount - 1, static_cast<uint32_t>((centroid[axis] - lo[axis]) * scale[axis]));
+		}
+	};
+
+	struct Bins
+	{
+		AABB bounds[3][BinCount];
+		uint32_t counts[3][BinCount];
+
+		Bins()
+		{
+			std::fill(&bounds[0][0], &bounds[0][0] + 3 * BinCount, EmptyAABB());
+			std::fill(&counts[0][0], &counts[0][0] + 3 * BinCount, 0u);
+		}
+
+		void Merge(const Bins& other)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				for (uint32_t b = 0; b < BinCount; ++b)
+				{
+					if (other.counts[axis][b] == 0)
+						continue;
+					bounds[axis][b].Add(other.bounds[axis][b]);
+					counts[axis][b] += other.counts[axis][b];
+				}
+			}
+		}
+	};
+
+	static inline uint32_t GetChunkCount(uint32_t count)
+	{
+		return (count + BuildChunkSize - 1) / BuildChunkSize;
+	}
+
+	/** Calls body(chunk, begin, end) for every BuildChunkSize piece of [first, first + count). */
+	static void ForEachChunk(TaskScheduler* scheduler, uint32_t first, uint32_t count, const std::function<void(uint32_t, uint32_t, uint32_t)>& body)
+	{
+		ParallelForChunks(scheduler, count, BuildChunkSize, [&](uint32_t chunk, size_t begin, size_t end) {
+			body(chunk, first + static_cast<uint32_t>(begin), first + static_cast<uint32_t>(end));
+		});
+	}
+
+	static void AccumulateBounds(NodeBounds& result, const AABB* boxes, const uint32_t* indices, const vec3* centroids, uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const vec3& c = centroids[indices[i]];
+			result.bounds.Add(boxes[indices[i]]);
+			result.centroidBounds.Add(AABB(c, c));
+		}
+	}
+
+	static void AccumulateBins(Bins& result, const BinGrid& grid, const AABB* boxes, const uint32_t* indices, const vec3* centroids, uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const vec3& c = centroids[indices[i]];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (!grid.valid[axis])
+					continue;
+				const uint32_t bin = grid.GetBin(c, axis);
+				result.bounds[axis][bin].Add(boxes[indices[i]]);
+				++result.counts[axis][bin];
+			}
+		}
+	}
+
+	BVH::BVH(Span<const AABB> bounds, TaskScheduler* scheduler)
+	{
+		Build(bounds, scheduler);
+	}
+
+	void BVH::Build(Span<const AABB> bounds, TaskScheduler* scheduler)
+	{
+		Clear();
+		if (bounds.empty())
+			return;
+
+		const uint32_t count = static_cast<uint32_t>(bounds.size());
+		BuildContext context;
+		context.scheduler = scheduler;
+		context.centroids.resize(count);
+		context.nodes.resize(2 * static_cast<size_t>(count) - 1);
+		if (count > BuildChunkSize)
+			context.scratch.resize(count);
+
+		m_Bounds.assign(bounds.begin(), bounds.end());
+		m_Indices.resize(count);
+		ForEachChunk(scheduler, 0, count, [&](uint32_t, uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				m_Indices[i] = i;
+				context.centroids[i] = m_Bounds[i].Center();
+			}
+		});
+
+		BuildNode(context, 0, 1, 0, count, 0);
+
+		// Gather the used slots depth first, keeping siblings side by side, so the layout depends on the tree alone.
+		m_Nodes.push_back(context.nodes[0]);
+		std::vector<std::pair<uint32_t, uint32_t>> pending{ { 0u, 0u } };
+		while (!pending.empty())
+		{
+			const auto [source, target] = pending.back();
+			pending.pop_back();
+			if (m_Nodes[target].IsLeaf())
+				continue;
+
+			const uint32_t child = context.nodes[source].leftFirst;
+			const uint32_t movedChild = static_cast<uint32_t>(m_Nodes.size());
+			m_Nodes[target].leftFirst = movedChild;
+			m_Nodes.push_back(context.nodes[child]);
+			m_Nodes.push_back(context.nodes[child + 1]);
+			pending.emplace_back(child + 1, movedChild + 1);
+			pending.emplace_back(child, movedChild);
+		}
+
+		// Store the boxes in leaf order so every leaf reads a contiguous run.
+		std::vector<AABB> ordered(count);
+		ForEachChunk(scheduler, 0, count, [&](uint32_t, uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i)
+				ordered[i] = m_Bounds[m_Indices[i]];
+		});
+		m_Bounds.swap(ordered);
+	}
+
+	void BVH::BuildNode(BuildContext& context, uint32_t nodeIndex, uint32_t childBase, uint32_t first, uint32_t count, uint32_t depth)
+	{
+		const AABB* boxes = m_Bounds.data();
+		uint32_t* indices = m_Indices.data();
+		const vec3* centroids = context.centroids.data();
+
+		// Nodes larger than one chunk are reduced chunk by chunk; min and max are exact, so the result matches a serial pass.
+		const bool chunked = count > BuildChunkSize;
+		const uint32_t chunkCount = GetChunkCount(count);
+		TaskScheduler* scheduler = context.scheduler;
+
+		NodeBounds nodeBounds;
+		if (chunked)
+		{
+			std::vector<NodeBounds> partial(chunkCount);
+			ForEachChunk(scheduler, first, count, [&](uint32_t chunk, uint32_t begin, uint32_t end) {
+				AccumulateBounds(partial[chunk], boxes, indices, centroids, begin, end);
+			});
+			for (const NodeBounds& p : partial)
+			{
+				nodeBounds.bounds.Add(p.bounds);
+				nodeBounds.centroidBounds.Add(p.centroidBounds);
+			}
+		}
+		else
+			AccumulateBounds(nodeBounds, boxes, indices, centroids, first, first + count);
+
+		BVHNode& node = context.nodes[nodeIndex];
+		node.bounds = nodeBounds.bounds;
+		node.leftFirst = first;
+		node.count = count;
+		if (count == 1 || depth + 1 >= MaxBVHDepth)
+			return;
+
+		const BinGrid grid(nodeBounds.centroidBounds);
+		Bins bins;
+		if (chunked)
+		{
+			std::vector<Bins> partial(chunkCount);
+			ForEachChunk(scheduler, first, count, [&](uint32_t chunk, uint32_t begin, uint32_t end) {
+				AccumulateBins(partial[chunk], grid, boxes, indices, centroids, begin, end);
+			});
+			for (const Bins& p : partial)
+				bins.Merge(p);
+		}
+		else
+			AccumulateBins(bins, grid, boxes, indices, centroids, first, first + count);
+
+		// Evaluate the surface area heuristic at every bin boundary of every axis.
+		int bestAxis = -1;
+		uint32_t bestSplit = 0;
+		float bestCost = FLT_MAX;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (!grid.valid[axis])
+				continue;
+
+			float leftArea[BinCount - 1];
+			uint32_t leftCount[BinCount - 1];
+			AABB accumulated = EmptyAABB();
+			uint32_t sum = 0;
+			for (uint32_t b = 0; b < BinCount - 1; ++b)
+			{
+				sum += bins.counts[axis][b];
+				if (bins.counts[axis][b] != 0)
+					accumulated.Add(bins.bounds[axis][b]);
+				leftCount[b] = sum;
+				leftArea[b] = sum != 0 ? accumulated.GetSurfaceArea() : 0.0f;
+			}
+
+			accumulated = EmptyAABB();
+			sum = 0;
+			for (uint32_t b = BinCount - 1; b > 0; --b)
+			{
+				sum += bins.counts[axis][b];
+				if (bins.counts[axis][b] != 0)
+					accumulated.Add(bins.bounds[axis][b]);
+				if (sum == 0 || leftCount[b - 1] == 0)
+					continue;
+
+				const float cost = leftCount[b - 1] * leftArea[b - 1] + sum * accumulated.GetSurfaceArea();
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+
+		// Splitting costs a traversal step plus the children weighted by area; a leaf costs one test per primitive.
+		const float leafCost = count * nodeBounds.bounds.GetSurfaceArea();
+		if (count <= MaxLeafSize && (bestAxis < 0 || bestCost + nodeBounds.bounds.GetSurfaceArea() >= leafCost))
+			return;
+
+		uint32_t leftCount = count / 2;
+		if (bestAxis >= 0)
+		{
+			const auto goesLeft = [&](uint32_t index) { return grid.GetBin(centroids[index], bestAxis) < bestSplit; };
+			if (chunked)
+			{
+				// Stable partition: count each chunk's left side, then scatter both sides to their offsets.
+				std::vector<uint32_t> leftOffsets(chunkCount + 1, 0);
+				ForEachChunk(scheduler, first, count, [&](uint32_t chunk, uint32_t begin, uint32_t end) {
+					leftOffsets[chunk + 1] = static_cast<uint32_t>(std::count_if(indices + begin, indices + end, goesLeft));
+				});
+				for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+					leftOffsets[chunk + 1] += leftOffsets[chunk];
+				leftCount = leftOffsets[chunkCount];
+
+				uint32_t* scratch = context.scratch.data();
+				ForEachChunk(scheduler, first, count, [&](uint32_t chunk, uint32_t begin, uint32_t end) {
+					uint32_t left = first + leftOffsets[chunk];
+					uint32_t right = first + leftCount + (begin - first) - leftOffsets[chunk];
+					for (uint32_t i = begin; i < end; ++i)
+						scratch[goesLeft(indices[i]) ? left++ : right++] = indices[i];
+				});
+				ForEachChunk(scheduler, first, count, [&](uint32_t, uint32_t begin, uint32_t end) {
+					std::copy(scratch + begin, scratch + end, indices + begin);
+				});
+			}
+			else
+				leftCount = static_cast<uint32_t>(std::partition(indices + first, indices + first + count, goesLeft) - (indices + first));
+		}
+		// Coincident centroids leave nothing to bin; any halving is as good as another.
+		if (leftCount == 0 || leftCount == count)
+			leftCount = count / 2;
+
+		// A subtree over n primitives needs at most 2 * n - 1 nodes; the children take the pair at childBase
+		// and the descendants of each child get a range of that worst-case size less the child itself.
+		const uint32_t rightCount = count - leftCount;
+		const uint32_t leftChildBase = childBase + 2;
+		const uint32_t rightChildBase = leftChildBase + 2 * (leftCount - 1);
+		node.leftFirst = childBase;
+		node.count = 0;
+
+		if (scheduler != nullptr && count >= ParallelSubtreeThreshold)
+		{
+			scheduler->ParallelFor(2, [&](uint32_t child) {
+				if (child == 0)
+					BuildNode(context, childBase, leftChildBase, first, leftCount, depth + 1);
+				else
+					BuildNode(context, childBase + 1, rightChildBase, first + leftCount, rightCount, depth + 1);
+			});
+		}
+		else
+		{
+			BuildNode(context, childBase, leftChildBase, first, leftCount, depth + 1);
+			BuildNode(context, childBase + 1, rightChildBase, first + leftCount, rightCount, depth + 1);
+		}
+	}
+
+	void BVH::Clear()
+	{
+		m_Nodes.clear();
+		m_Indices.clear();
+		m_Bounds.clear();
+		m_Parents.clear();
+		m_EntryLeaves.clear();
+		m_Entries.clear();
+		m_Heights.clear();
+		m_Dirty.clear();
+	}
+
+	AABB BVH::GetBounds() const
+	{
+		return m_Nodes.empty() ? AABB() : m_Nodes[0].bounds;
+	}
+
+	bool BVH::RaycastClosest(const Ray& ray, BVHRayHit& hit, float maxT) const
+	{
+		if (m_Nodes.empty())
+			return false;
+
+		float best = maxT;
+		uint32_t bestPrimitive = UINT32_MAX;
+
+		struct Entry
+		{
+			uint32_t node;
+			float t;
+		};
+		Entry stack[MaxBVHDepth];
+		size_t top = 0;
+		if (IntersectSlab(m_Nodes[0].bounds, ray, best) != INFINITY)
+			stack[top++] = { 0, 0.0f };
+
+		while (top != 0)
+		{
+			const Entry entry = stack[--top];
+			if (entry.t > best)
+				continue;
+
+			// Descend into the nearer child and defer the farther one, so hits found early prune the rest.
+			uint32_t nodeIndex = entry.node;
+			while (!m_Nodes[nodeIndex].IsLeaf())
+			{
+				const uint32_t left = m_Nodes[nodeIndex].leftFirst;
+				float tLeft = IntersectSlab(m_Nodes[left].bounds, ray, best);
+				float tRight = IntersectSlab(m_Nodes[left + 1].bounds, ray, best);
+				uint32_t nearChild = left, farChild = left + 1;
+				if (tRight < tLeft)
+				{
+					std::swap(tLeft, tRight);
+					std::swap(nearChild, farChild);
+				}
+				if (tLeft == INFINITY)
+				{
+					nodeIndex = UINT32_MAX;
+					break;
+				}
+				if (tRight != INFINITY)
+				{
+					assert(top < MaxBVHDepth);
+					stack[top++] = { farChild, tRight };
+				}
+				nodeIndex = nearChild;
+			}
+			if (nodeIndex == UINT32_MAX)
+				continue;
+
+			const BVHNode& leaf = m_Nodes[nodeIndex];
+			for (uint32_t i = leaf.leftFirst; i < leaf.leftFirst + leaf.count; ++i)
+			{
+				const float t = IntersectSlab(m_Bounds[i], ray, best);
+				if (t < best || (t == best && bestPrimitive == UINT32_MAX))
+				{
+					best = t;
+					bestPrimitive = m_Indices[i];
+				}
+			}
+		}
+
+		if (bestPrimitive == UINT32_MAX)
+			return false;
+		hit.primitive = bestPrimitive;
+		hit.t = best;
+		return true;
+	}
+
+	bool BVH::RaycastAny(const Ray& ray, float maxT) const
+	{
+		if (m_Nodes.empty())
+			return false;
+
+		uint32_t stack[MaxBVHDepth];
+		size_t top = 0;
+		stack[top++] = 0;
+		while (top != 0)
+		{
+			const BVHNode& node = m_Nodes[stack[--top]];
+			if (IntersectSlab(node.bounds, ray, maxT) == INFINITY)
+				continue;
+
+			if (!node.IsLeaf())
+			{
+				assert(top + 2 <= MaxBVHDepth);
+				stack[top++] = node.leftFirst + 1;
+				stack[top++] = node.leftFirst;
+				continue;
+			}
+
+			for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+			{
+				if (IntersectSlab(m_Bounds[i], ray, maxT) != INFINITY)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	void BVH::QueryOverlap(const AABB& box, std::vector<uint32_t>& results) const
+	{
+		if (m_Nodes.empty())
+			return;
+
+		uint32_t stack[MaxBVHDepth];
+		size_t top = 0;
+		stack[top++] = 0;
+		while (top != 0)
+		{
+			const BVHNode& node = m_Nodes[stack[--top]];
+			if (!Overlaps(node.bounds, box))
+				continue;
+
+			if (!node.IsLeaf())
+			{
+				assert(top + 2 <= MaxBVHDepth);
+				stack[top++] = node.leftFirst + 1;
+				stack[top++] = node.leftFirst;
+				continue;
+			}
+
+			for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+			{
+				if (Overlaps(m_Bounds[i], box))
+					results.push_back(m_Indices[i]);
+			}
+		}
+	}
+
+	void BVH::QueryPoint(const vec3& point, std::vector<uint32_t>& results) const
+	{
+		if (m_Nodes.empty())
+			return;
+
+		uint32_t stack[MaxBVHDepth];
+		size_t top = 0;
+		stack[top++] = 0;
+		while (top != 0)
+		{
+			const BVHNode& node = m_Nodes[stack[--top]];
+			if (!ContainsPoint(node.bounds, point))
+				continue;
+
+			if (!node.IsLeaf())
+			{
+				assert(top + 2 <= MaxBVHDepth);
+				stack[top++] = node.leftFirst + 1;
+				stack[top++] = node.leftFirst;
+				continue;
+			}
+
+			for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+			{
+				if (ContainsPoint(m_Bounds[i], point))
+					results.push_back(m_Indices[i]);
+			}
+		}
+	}
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#ifndef _BVH_H_
+#define _BVH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BVHNode.h"
+#include "Morton.h"
+#include "Ray.h"
+#include "../Span.h"
+#include "../TaskScheduler.h"
+
+namespace odm
+{
+	/** Result of BVH::RaycastClosest. */
+	struct BVHRayHit
+	{
+		uint32_t primitive = UINT32_MAX;	// Index of the box that was hit, into the span the hierarchy was built from.
+		float t = INFINITY;					// Distance along the ray in units of Ray::GetDirection(); 0 at the start, 1 at the end.
+	};
+
+	/**
+	 * Bounding volume hierarchy over a set of boxes, built with the binned surface area heuristic.
+	 * Nodes live in one flattened array with siblings side by side, and the boxes are stored in leaf order
+	 * so a leaf reads one contiguous run of them.
+	 */
+	class BVH
+	{
+	public:
+		/** Primitives a leaf may hold before the builder keeps splitting regardless of cost. */
+		static constexpr uint32_t MaxLeafSize = 4;
+
+		/** Constructs an empty hierarchy. */
+		BVH() = default;
+
+		/**
+		 * Constructs the hierarchy of a set of boxes.
+		 * @param bounds The boxes, e.g. static colliders; the hierarchy keeps its own copy.
+		 * @param scheduler Runs the build on several threads when given; see Build.
+		 */
+		explicit BVH(Span<const AABB> bounds, TaskScheduler* scheduler = nullptr);
+
+		/**
+		 * Rebuilds the hierarchy from scratch.
+		 * Large nodes are binned and partitioned in fixed-size chunks and large subtrees are built as separate tasks.
+		 * The tree is the same for the same boxes whatever the scheduler and its thread count, or without one.
+		 * @param bounds The boxes; an empty span clears the hierarchy.
+		 * @param scheduler Runs the build on several threads when given; nullptr builds on the calling thread.
+		 */
+		void Build(Span<const AABB> bounds, TaskScheduler* scheduler = nullptr);
+
+		/**
+		 * Rebuilds the hierarchy as a linear BVH: boxes sorted by the Morton code of their centroid, with one box per leaf.
+		 * Much faster to build than Build and somewhat slower to query, which suits scenes rebuilt every frame.
+		 * Every step runs in fixed-size chunks, so the tree is the same whatever the scheduler.
+		 * Falls back to Build in the rare case the code prefixes would nest deeper than MaxBVHDepth.
+		 * @param bounds The boxes; an empty span clears the hierarchy.
+		 * @param scheduler Runs the build on several threads when given; nullptr builds on the calling thread.
+		 * @param width Width of the Morton codes; Bits63 separates crowded scenes better at twice the sort cost.
+		 */
+		void BuildLinear(Span<const AABB> bounds, TaskScheduler* scheduler = nullptr, MortonCodeWidth width = MortonCodeWidth::Bits30);
+
+		/**
+		 * Replaces the box of one primitive without touching the tree; the next Refit grows or shrinks the nodes above it.
+		 * @param primitive Index of the box in the span the hierarchy was built from.
+		 * @param bounds The new box.
+		 */
+		void SetPrimitiveBounds(uint32_t primitive, const AABB& bounds);
+
+		/**
+		 * Refits the nodes above the boxes changed by SetPrimitiveBounds, bottom-up, leaving every other subtree alone.
+		 * Nodes keep their children, so the tree degrades as objects drift away from where it was built; rotations slow that down.
+		 * @param scheduler Refits separate dirty subtrees on several threads when given.
+		 * @param rotate Whether each refitted node may swap a child with a grandchild when that shrinks the surface area of the
+		 *               child receiving the swapped one (Kopta et al., "Fast, Effective BVH Updates for Animated Scenes").
+		 */
+		void Refit(TaskScheduler* scheduler = nullptr, bool rotate = false);
+
+		/**
+		 * Replaces every box and refits the whole tree.
+		 * @param bounds The new boxes, one per primitive in the order the hierarchy was built from.
+		 * @param scheduler Refits separate subtrees on several threads when given.
+		 * @param rotate Whether refitted nodes may rotate; see the other overload.
+		 */
+		void Refit(Span<const AABB> bounds, TaskScheduler* scheduler = nullptr, bool rotate = false);
+
+		/** Releases the nodes and boxes. */
+		void Clear();
+
+		NODISCARD bool IsEmpty() const { return m_Nodes.empty(); }
+		NODISCARD size_t GetNodeCount() const { return m_Nodes.size(); }
+		NODISCARD size_t GetPrimitiveCount() const { return m_Indices.size(); }
+
+		/** Gets the nodes, root first, e.g. for CullHierarchy. */
+		NODISCARD Span<const BVHNode> GetNodes() const { return Span<const BVHNode>(m_Nodes.data(), m_Nodes.size()); }
+
+		/** Gets the original index of each primitive in leaf order; leaf ranges index this array. */
+		NODISCARD Span<const uint32_t> GetPrimitiveIndices() const { return Span<const uint32_t>(m_Indices.data(), m_Indices.size()); }
+
+		/** Gets the bounds of the whole set. */
+		NODISCARD AABB GetBounds() const;
+
+		/**
+		 * Finds the first box along a ray.
+		 * @param ray The ray; a ray starting inside a box hits it at t = 0.
+		 * @param hit Receives the nearest box and its distance; left untouched on a miss.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored; 1 stops at the ray's end.
+		 * @returns Whether a box was hit.
+		 */
+		bool RaycastClosest(const Ray& ray, BVHRayHit& hit, float maxT = 1.0f) const;
+
+		/**
+		 * Tests whether any box blocks a ray, e.g. for line of sight; stops at the first hit found.
+		 * @param ray The ray.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored; 1 stops at the ray's end.
+		 */
+		NODISCARD bool RaycastAny(const Ray& ray, float maxT = 1.0f) const;
+
+		/**
+		 * Finds the boxes that overlap a box, touching included.
+		 * @param box The query box.
+		 * @param results Receives the indices of the overlapping boxes; appended to, not cleared.
+		 */
+		void QueryOverlap(const AABB& box, std::vector<uint32_t>& results) const;
+
+		/**
+		 * Finds the boxes that contain a point, boundary included.
+		 * @param point The query point.
+		 * @param results Receives the indices of the containing boxes; appended to, not cleared.
+		 */
+		void QueryPoint(const vec3& point, std::vector<uint32_t>& results) const;
+
+		/**
+		 * Finds the boxes along a ray, nearest first.
+		 * @param ray The ray.
+		 * @param hits Receives the nearest hits.size() hits by ascending distance, ties by ascending primitive.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored; 1 stops at the ray's end.
+		 * @returns The number of boxes the ray hits, which may be more than were stored.
+		 */
+		uint32_t RaycastAll(const Ray& ray, Span<BVHRayHit> hits, float maxT = 1.0f) const;
+
+		/**
+		 * RaycastClosest for a batch of rays. Rays are traced grouped by the octant of their direction, so rays that run alike
+		 * traverse the tree one after another and find its nodes in cache.
+		 * @param rays The rays.
+		 * @param hits Receives the nearest hit of each ray, or a default BVHRayHit when it misses; as many as rays.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored.
+		 * @param scheduler Traces separate groups of rays on several threads when given.
+		 */
+		void RaycastClosest(Span<const Ray> rays, Span<BVHRayHit> hits, float maxT = 1.0f, TaskScheduler* scheduler = nullptr) const;
+
+		/**
+		 * RaycastAny for a batch of rays, e.g. shadow or line of sight rays; each ray stops at the first box it finds.
+		 * @param rays The rays.
+		 * @param blocked Receives 1 for each ray that hits a box, else 0; as many as rays.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored.
+		 * @param scheduler Traces separate groups of rays on several threads when given.
+		 */
+		void RaycastAny(Span<const Ray> rays, Span<uint8_t> blocked, float maxT = 1.0f, TaskScheduler* scheduler = nullptr) const;
+
+		/**
+		 * RaycastAll for a batch of rays, with a fixed number of hit slots per ray.
+		 * @param rays The rays.
+		 * @param hits Receives the hits of ray i in slots [i * capacity, (i + 1) * capacity), where capacity = hits.size() / rays.size().
+		 * @param hitCounts Receives the number of boxes each ray hits; when above capacity, only the nearest were stored.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored.
+		 * @param scheduler Traces separate groups of rays on several threads when given.
+		 */
+		void RaycastAll(Span<const Ray> rays, Span<BVHRayHit> hits, Span<uint32_t> hitCounts, float maxT = 1.0f, TaskScheduler* scheduler = nullptr) const;
+
+	private:
+		struct BuildContext;
+
+		void BuildNode(BuildContext& context, uint32_t nodeIndex, uint32_t childBase, uint32_t first, uint32_t count, uint32_t depth);
+
+		template <class Key>
+		bool EmitLinear(const std::vector<Key>& codes, TaskScheduler* scheduler);
+
+		void PrepareRefit();
+		void RefitSubtree(uint32_t root, uint32_t rootDepth, bool rotate);
+		void Rotate(uint32_t nodeIndex, uint32_t depth);
+
+		std::vector<BVHNode> m_Nodes;
+		std::vector<uint32_t> m_Indices;	// Original primitive index of each entry of m_Bounds.
+		std::vector<AABB> m_Bounds;			// Primitive boxes in leaf order.
+
+		// Built by the first refit after a build.
+		std::vector<uint32_t> m_Parents;		// Parent of each node; UINT32_MAX for the root.
+		std::vector<uint32_t> m_EntryLeaves;	// Leaf node holding each entry of m_Bounds.
+		std::vector<uint32_t> m_Entries;		// Entry of m_Bounds holding each original primitive.
+		std::vector<uint8_t> m_Heights;			// Levels of the subtree under each node, 1 for a leaf.
+		std::vector<uint8_t> m_Dirty;			// Nodes above a box changed since the last refit.
+	};
+}
+
+#endif /* end of include guard: _BVH_H_ */
@@ -0,0 +1,30 @@
+#pragma once
+
+#ifndef _BVH_NODE_H_
+#define _BVH_NODE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "AABB.h"
+
+namespace odm
+{
+	/** Deepest hierarchy the traversals accept; their stacks are fixed arrays of this many entries. */
+	constexpr size_t MaxBVHDepth = 64;
+
+	/**
+	 * Node of a flattened bounding volume hierarchy; node 0 is the root.
+	 * An interior node's children are stored next to each other at leftFirst and leftFirst + 1.
+	 * A leaf references count entries of the primitive index array, starting at leftFirst.
+	 */
+	struct BVHNode
+	{
+		AABB bounds;
+		uint32_t leftFirst = 0;
+		uint32_t count = 0;
+
+		NODISCARD bool IsLeaf() const { return count != 0; }
+	};
+}
+
+#endif /* end of include guard: _BVH_NODE_H_ */
@@ -0,0 +1,214 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cfloat>
+#include "Morton_batch.h"
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace odm
+{
+	/** Elements per piece of the chunked passes of the linear build. */
+	static constexpr size_t LinearChunkSize = 16384;
+
+	static inline int CountLeadingZeros(uint32_t v)
+	{
+		assert(v != 0);
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse(&index, v);
+		return 31 - static_cast<int>(index);
+#else
+		return __builtin_clz(v);
+#endif
+	}
+
+	static inline int CountLeadingZeros(uint64_t v)
+	{
+		assert(v != 0);
+#if defined(_MSC_VER)
+		const uint32_t high = static_cast<uint32_t>(v >> 32);
+		return high != 0 ? CountLeadingZeros(high) : 32 + CountLeadingZeros(static_cast<uint32_t>(v));
+#else
+		return __builtin_clzll(v);
+#endif
+	}
+
+	/**
+	 * Length of the common prefix of the keys at i and j, or -1 when j lies outside the array.
+	 * Equal keys are told apart by their positions, so runs of duplicates still split into a binary tree.
+	 */
+	template <class Key>
+	static inline int CommonPrefix(const Key* keys, int64_t count, int64_t i, int64_t j)
+	{
+		if (j < 0 || j >= count)
+			return -1;
+		const Key diff = keys[i] ^ keys[j];
+		if (diff != 0)
+			return CountLeadingZeros(diff);
+		return static_cast<int>(sizeof(Key) * 8) + CountLeadingZeros(static_cast<uint32_t>(i ^ j));
+	}
+
+	void BVH::BuildLinear(Span<const AABB> bounds, TaskScheduler* scheduler, MortonCodeWidth width)
+	{
+		Clear();
+		if (bounds.empty())
+			return;
+
+		const uint32_t count = static_cast<uint32_t>(bounds.size());
+		const uint32_t chunkCount = static_cast<uint32_t>((count + LinearChunkSize - 1) / LinearChunkSize);
+		std::vector<vec3> centroids(count);
+		std::vector<AABB> partial(chunkCount, AABB(vec3(FLT_MAX), vec3(-FLT_MAX)));
+		m_Indices.resize(count);
+		ParallelForChunks(scheduler, count, LinearChunkSize, [&](uint32_t chunk, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				m_Indices[i] = static_cast<uint32_t>(i);
+				centroids[i] = bounds[i].Center();
+				partial[chunk].Add(AABB(centroids[i], centroids[i]));
+			}
+		});
+		AABB centroidBounds(vec3(FLT_MAX), vec3(-FLT_MAX));
+		for (const AABB& p : partial)
+			centroidBounds.Add(p);
+
+		const auto gatherBounds = [&] {
+			m_Bounds.resize(count);
+			ParallelForChunks(scheduler, count, LinearChunkSize, [&](uint32_t, size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i)
+					m_Bounds[i] = bounds[m_Indices[i]];
+			});
+		};
+
+		bool emitted;
+		if (width == MortonCodeWidth::Bits30)
+		{
+			std::vector<uint32_t> codes(count);
+			ParallelForChunks(scheduler, count, LinearChunkSize, [&](uint32_t, size_t begin, size_t end) {
+				EncodeMorton30(Span<const vec3>(centroids.data() + begin, end - begin), centroidBounds, Span<uint32_t>(codes.data() + begin, end - begin));
+			});
+			SortMortonCodes(Span<uint32_t>(codes.data(), count), Span<uint32_t>(m_Indices.data(), count), scheduler);
+			gatherBounds();
+			emitted = EmitLinear(codes, scheduler);
+		}
+		else
+		{
+			std::vector<uint64_t> codes(count);
+			ParallelForChunks(scheduler, count, LinearChunkSize, [&](uint32_t, size_t begin, size_t end) {
+				EncodeMorton63(Span<const vec3>(centroids.data() + begin, end - begin), centroidBounds, Span<uint64_t>(codes.data() + begin, end - begin));
+			});
+			SortMortonCodes(Span<uint64_t>(codes.data(), count), Span<uint32_t>(m_Indices.data(), count), scheduler);
+			gatherBounds();
+			emitted = EmitLinear(codes, scheduler);
+		}
+
+		if (!emitted)
+			Build(bounds, scheduler);
+	}
+
+	/**
+	 * Emits the hierarchy of sorted codes following Karras, "Maximizing Parallelism in the Construction of BVHs, Octrees, and k-d Trees".
+	 * Internal node i finds its key range and split on its own; then every leaf climbs to the root, and the second child to reach
+	 * a node computes its bounds.
+	 * @returns False when the tree is deeper than MaxBVHDepth.
+	 */
+	template <class Key>
+	bool BVH::EmitLinear(const std::vector<Key>& codes, TaskScheduler* scheduler)
+	{
+		const int64_t count = static_cast<int64_t>(codes.size());
+		const size_t nodeCount = 2 * codes.size() - 1;
+		m_Nodes.resize(nodeCount);
+		if (count == 1)
+		{
+			m_Nodes[0].bounds = m_Bounds[0];
+			m_Nodes[0].leftFirst = 0;
+			m_Nodes[0].count = 1;
+			return true;
+		}
+
+		// The node that splits between keys gamma and gamma + 1 puts its children at slots 2 * gamma + 1 and 2 * gamma + 2.
+		// Each split belongs to exactly one node, so the slots are known without coordination and siblings stay side by side.
+		const Key* keys = codes.data();
+		std::vector<uint32_t> parents(nodeCount);
+		ParallelForChunks(scheduler, static_cast<size_t>(count - 1), LinearChunkSize, [&](uint32_t, size_t begin, size_t end) {
+			for (int64_t i = static_cast<int64_t>(begin); i < static_cast<int64_t>(end); ++i)
+			{
+				const int64_t d = CommonPrefix(keys, count, i, i + 1) > CommonPrefix(keys, count, i, i - 1) ? 1 : -1;
+
+				// Grow the range away from the neighbour with the shorter common prefix, then binary search its far end.
+				const int minPrefix = CommonPrefix(keys, count, i, i - d);
+				int64_t maxLength = 2;
+				while (CommonPrefix(keys, count, i, i + maxLength * d) > minPrefix)
+					maxLength *= 2;
+				int64_t length = 0;
+				for (int64_t t = maxLength / 2; t >= 1; t /= 2)
+				{
+					if (CommonPrefix(keys, count, i, i + (length + t) * d) > minPrefix)
+						length += t;
+				}
+				const int64_t j = i + length * d;
+
+				// The split is the last key that still shares more than the range's common prefix with key i.
+				const int nodePrefix = CommonPrefix(keys, count, i, j);
+				int64_t split = 0;
+				int64_t step = length;
+				do
+				{
+					step = (step + 1) / 2;
+					if (CommonPrefix(keys, count, i, i + (split + step) * d) > nodePrefix)
+						split += step;
+				} while (step > 1);
+				const int64_t gamma = i + split * d + std::min<int64_t>(d, 0);
+
+				// A range starting at i is the right child of the split before it; one ending at i is the left child of split i.
+				const uint32_t slot = static_cast<uint32_t>(d > 0 ? 2 * i : 2 * i + 1);
+				const uint32_t left = static_cast<uint32_t>(2 * gamma + 1);
+				m_Nodes[slot].leftFirst = left;
+				m_Nodes[slot].count = 0;
+				parents[left] = slot;
+				parents[left + 1] = slot;
+				if (std::min(i, j) == gamma)
+				{
+					m_Nodes[left].bounds = m_Bounds[gamma];
+					m_Nodes[left].leftFirst = static_cast<uint32_t>(gamma);
+					m_Nodes[left].count = 1;
+				}
+				if (std::max(i, j) == gamma + 1)
+				{
+					m_Nodes[left + 1].bounds = m_Bounds[gamma + 1];
+					m_Nodes[left + 1].leftFirst = static_cast<uint32_t>(gamma + 1);
+					m_Nodes[left + 1].count = 1;
+				}
+			}
+		});
+
+		std::vector<std::atomic<uint32_t>> arrivals(nodeCount);
+		std::vector<uint8_t> heights(nodeCount);
+		ParallelForChunks(scheduler, nodeCount, LinearChunkSize, [&](uint32_t, size_t begin, size_t end) {
+			for (size_t slot = begin; slot < end; ++slot)
+			{
+				if (!m_Nodes[slot].IsLeaf())
+					continue;
+
+				heights[slot] = 1;
+				for (uint32_t current = static_cast<uint32_t>(slot); current != 0;)
+				{
+					current = parents[current];
+					if (arrivals[current].fetch_add(1, std::memory_order_acq_rel) == 0)
+						break;
+
+					BVHNode& node = m_Nodes[current];
+					node.bounds = m_Nodes[node.leftFirst].bounds;
+					node.bounds.Add(m_Nodes[node.leftFirst + 1].bounds);
+					const uint32_t height = 1u + std::max(heights[node.leftFirst], heights[node.leftFirst + 1]);
+					heights[current] = static_cast<uint8_t>(std::min(height, 255u));
+				}
+			}
+		});
+		return heights[0] <= MaxBVHDepth;
+	}
+}
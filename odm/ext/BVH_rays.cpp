@@ -0,0 +1,126 @@
+#include "BVH.h"
+
+#include <cassert>
+
+namespace odm
+{
+	/** Rays per task of a batched query. */
+	static constexpr size_t RayChunkSize = 64;
+
+	static inline bool IsNearer(const BVHRayHit& a, const BVHRayHit& b)
+	{
+		return a.t < b.t || (a.t == b.t && a.primitive < b.primitive);
+	}
+
+	/** Gets the rays in order of the octant their direction points into, keeping their order within an octant. */
+	static std::vector<uint32_t> SortByOctant(Span<const Ray> rays)
+	{
+		const auto octantOf = [](const Ray& ray) {
+			return ray.GetSign(0) | (ray.GetSign(1) << 1) | (ray.GetSign(2) << 2);
+		};
+
+		uint32_t offsets[8] = {};
+		for (const Ray& ray : rays)
+			++offsets[octantOf(ray)];
+		for (uint32_t octant = 0, offset = 0; octant < 8; ++octant)
+		{
+			const uint32_t count = offsets[octant];
+			offsets[octant] = offset;
+			offset += count;
+		}
+
+		std::vector<uint32_t> order(rays.size());
+		for (uint32_t i = 0; i < rays.size(); ++i)
+			order[offsets[octantOf(rays[i])]++] = i;
+		return order;
+	}
+
+	/** Calls trace(rayIndex) for every ray, in octant order and in chunks. */
+	template <class Trace>
+	static void TraceBatch(Span<const Ray> rays, TaskScheduler* scheduler, const Trace& trace)
+	{
+		assert(rays.size() <= UINT32_MAX);
+		const std::vector<uint32_t> order = SortByOctant(rays);
+		ParallelForChunks(scheduler, order.size(), RayChunkSize, [&](uint32_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				trace(order[i]);
+		});
+	}
+
+	uint32_t BVH::RaycastAll(const Ray& ray, Span<BVHRayHit> hits, float maxT) const
+	{
+		if (m_Nodes.empty())
+			return 0;
+
+		const size_t capacity = hits.size();
+		size_t kept = 0;
+		uint32_t found = 0;
+		float tNear, tFar;
+
+		uint32_t stack[MaxBVHDepth];
+		size_t top = 0;
+		stack[top++] = 0;
+		while (top != 0)
+		{
+			const BVHNode& node = m_Nodes[stack[--top]];
+			if (!ray.Intersect(node.bounds, tNear, tFar, maxT))
+				continue;
+
+			if (!node.IsLeaf())
+			{
+				assert(top + 2 <= MaxBVHDepth);
+				stack[top++] = node.leftFirst + 1;
+				stack[top++] = node.leftFirst;
+				continue;
+			}
+
+			for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+			{
+				if (!ray.Intersect(m_Bounds[i], tNear, tFar, maxT))
+					continue;
+
+				// Insertion into the sorted run of kept hits; once it is full, the farthest drops out.
+				++found;
+				const BVHRayHit hit{ m_Indices[i], tNear };
+				if (kept == capacity && (capacity == 0 || !IsNearer(hit, hits[capacity - 1])))
+					continue;
+
+				size_t slot = kept < capacity ? kept++ : capacity - 1;
+				for (; slot > 0 && IsNearer(hit, hits[slot - 1]); --slot)
+					hits[slot] = hits[slot - 1];
+				hits[slot] = hit;
+			}
+		}
+		return found;
+	}
+
+	void BVH::RaycastClosest(Span<const Ray> rays, Span<BVHRayHit> hits, float maxT, TaskScheduler* scheduler) const
+	{
+		assert(hits.size() == rays.size());
+		TraceBatch(rays, scheduler, [&](uint32_t i) {
+			BVHRayHit hit;
+			RaycastClosest(rays[i], hit, maxT);
+			hits[i] = hit;
+		});
+	}
+
+	void BVH::RaycastAny(Span<const Ray> rays, Span<uint8_t> blocked, float maxT, TaskScheduler* scheduler) const
+	{
+		assert(blocked.size() == rays.size());
+		TraceBatch(rays, scheduler, [&](uint32_t i) {
+			blocked[i] = RaycastAny(rays[i], maxT) ? 1 : 0;
+		});
+	}
+
+	void BVH::RaycastAll(Span<const Ray> rays, Span<BVHRayHit> hits, Span<uint32_t> hitCounts, float maxT, TaskScheduler* scheduler) const
+	{
+		assert(hitCounts.size() == rays.size());
+		if (rays.empty())
+			return;
+
+		const size_t capacity = hits.size() / rays.size();
+		TraceBatch(rays, scheduler, [&](uint32_t i) {
+			hitCounts[i] = RaycastAll(rays[i], Span<BVHRayHit>(hits.data() + i * capacity, capacity), maxT);
+		});
+	}
+}
@@ -0,0 +1,232 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace odm
+{
+	/** Depth whose dirty nodes the refit hands to the scheduler as separate tasks; up to 64 of them. */
+	static constexpr uint32_t ParallelRefitDepth = 6;
+
+	/** Elements per piece of the chunked copy of a full refit. */
+	static constexpr size_t RefitChunkSize = 16384;
+
+	static inline AABB Union(const AABB& a, const AABB& b)
+	{
+		AABB result = a;
+		result.Add(b);
+		return result;
+	}
+
+	void BVH::PrepareRefit()
+	{
+		if (!m_Parents.empty() || m_Nodes.empty())
+			return;
+
+		const size_t nodeCount = m_Nodes.size();
+		m_Parents.assign(nodeCount, UINT32_MAX);
+		m_EntryLeaves.resize(m_Bounds.size());
+		m_Entries.resize(m_Indices.size());
+		m_Heights.assign(nodeCount, 1);
+		m_Dirty.assign(nodeCount, 0);
+
+		for (uint32_t entry = 0; entry < m_Indices.size(); ++entry)
+			m_Entries[m_Indices[entry]] = entry;
+
+		// Children do not always follow their parent in memory (see BuildLinear), so walk the tree to get an order that does.
+		std::vector<uint32_t> preorder;
+		preorder.reserve(nodeCount);
+		preorder.push_back(0);
+		for (size_t i = 0; i < preorder.size(); ++i)
+		{
+			const uint32_t nodeIndex = preorder[i];
+			const BVHNode& node = m_Nodes[nodeIndex];
+			if (node.IsLeaf())
+			{
+				for (uint32_t entry = node.leftFirst; entry < node.leftFirst + node.count; ++entry)
+					m_EntryLeaves[entry] = nodeIndex;
+				continue;
+			}
+			m_Parents[node.leftFirst] = nodeIndex;
+			m_Parents[node.leftFirst + 1] = nodeIndex;
+			preorder.push_back(node.leftFirst);
+			preorder.push_back(node.leftFirst + 1);
+		}
+
+		for (size_t i = preorder.size(); i-- > 0;)
+		{
+			const BVHNode& node = m_Nodes[preorder[i]];
+			if (!node.IsLeaf())
+				m_Heights[preorder[i]] = static_cast<uint8_t>(1 + std::max(m_Heights[node.leftFirst], m_Heights[node.leftFirst + 1]));
+		}
+	}
+
+	void BVH::SetPrimitiveBounds(uint32_t primitive, const AABB& bounds)
+	{
+		assert(primitive < m_Indices.size());
+		PrepareRefit();
+
+		const uint32_t entry = m_Entries[primitive];
+		m_Bounds[entry] = bounds;
+		for (uint32_t nodeIndex = m_EntryLeaves[entry]; nodeIndex != UINT32_MAX && !m_Dirty[nodeIndex]; nodeIndex = m_Parents[nodeIndex])
+			m_Dirty[nodeIndex] = 1;
+	}
+
+	void BVH::Refit(Span<const AABB> bounds, TaskScheduler* scheduler, bool rotate)
+	{
+		assert(bounds.size() == m_Indices.size());
+		if (m_Nodes.empty())
+			return;
+
+		PrepareRefit();
+		ParallelForChunks(scheduler, m_Bounds.size(), RefitChunkSize, [&](uint32_t, size_t begin, size_t end) {
+			for (size_t entry = begin; entry < end; ++entry)
+				m_Bounds[entry] = bounds[m_Indices[entry]];
+		});
+		std::fill(m_Dirty.begin(), m_Dirty.end(), static_cast<uint8_t>(1));
+		Refit(scheduler, rotate);
+	}
+
+	void BVH::Refit(TaskScheduler* scheduler, bool rotate)
+	{
+		if (m_Nodes.empty() || m_Dirty.empty() || !m_Dirty[0])
+			return;
+
+		// Dirty subtrees below ParallelRefitDepth are independent; refit them first, then the levels above them on this thread.
+		if (scheduler != nullptr)
+		{
+			std::vector<uint32_t> level{ 0 };
+			std::vector<uint32_t> next;
+			for (uint32_t depth = 0; depth < ParallelRefitDepth && !level.empty(); ++depth)
+			{
+				next.clear();
+				for (const uint32_t nodeIndex : level)
+				{
+					const BVHNode& node = m_Nodes[nodeIndex];
+					if (node.IsLeaf())
+						continue;
+					for (uint32_t child = node.leftFirst; child < node.leftFirst + 2; ++child)
+					{
+						if (m_Dirty[child])
+							next.push_back(child);
+					}
+				}
+				level.swap(next);
+			}
+
+			if (level.size() > 1)
+			{
+				scheduler->ParallelFor(static_cast<uint32_t>(level.size()), [&](uint32_t task) {
+					RefitSubtree(level[task], ParallelRefitDepth, rotate);
+				});
+			}
+		}
+		RefitSubtree(0, 0, rotate);
+	}
+
+	void BVH::RefitSubtree(uint32_t root, uint32_t rootDepth, bool rotate)
+	{
+		struct Entry
+		{
+			uint32_t node;
+			uint32_t depth;
+			bool childrenDone;
+		};
+
+		// Post-order over the dirty nodes; every level holds at most a node and its unvisited sibling.
+		Entry stack[2 * MaxBVHDepth];
+		size_t top = 0;
+		if (m_Dirty[root])
+			stack[top++] = { root, rootDepth, false };
+
+		while (top != 0)
+		{
+			const Entry entry = stack[--top];
+			BVHNode& node = m_Nodes[entry.node];
+			if (node.IsLeaf())
+			{
+				AABB bounds = m_Bounds[node.leftFirst];
+				for (uint32_t i = node.leftFirst + 1; i < node.leftFirst + node.count; ++i)
+					bounds.Add(m_Bounds[i]);
+				node.bounds = bounds;
+				m_Dirty[entry.node] = 0;
+				continue;
+			}
+
+			if (!entry.childrenDone)
+			{
+				stack[top++] = { entry.node, entry.depth, true };
+				for (uint32_t child = node.leftFirst; child < node.leftFirst + 2; ++child)
+				{
+					if (m_Dirty[child])
+					{
+						assert(top < 2 * MaxBVHDepth);
+						stack[top++] = { child, entry.depth + 1, false };
+					}
+				}
+				continue;
+			}
+
+			if (rotate)
+				Rotate(entry.node, entry.depth);
+			node.bounds = Union(m_Nodes[node.leftFirst].bounds, m_Nodes[node.leftFirst + 1].bounds);
+			m_Heights[entry.node] = static_cast<uint8_t>(1 + std::max(m_Heights[node.leftFirst], m_Heights[node.leftFirst + 1]));
+			m_Dirty[entry.node] = 0;
+		}
+	}
+
+	void BVH::Rotate(uint32_t nodeIndex, uint32_t depth)
+	{
+		const uint32_t first = m_Nodes[nodeIndex].leftFirst;
+
+		// Candidates swap one child with a grandchild under the other child; that other child's area is what changes.
+		uint32_t bestChild = UINT32_MAX, bestGrandchild = UINT32_MAX;
+		float bestGain = 0.0f;
+		for (uint32_t child = first; child < first + 2; ++child)
+		{
+			const uint32_t sibling = child ^ first ^ (first + 1);
+			const BVHNode& siblingNode = m_Nodes[sibling];
+			// The child moves one level down, which must not take its subtree below MaxBVHDepth.
+			if (siblingNode.IsLeaf() || depth + 2 + m_Heights[child] > MaxBVHDepth)
+				continue;
+
+			const float area = siblingNode.bounds.GetSurfaceArea();
+			for (uint32_t grandchild = siblingNode.leftFirst; grandchild < siblingNode.leftFirst + 2; ++grandchild)
+			{
+				const uint32_t kept = grandchild ^ siblingNode.leftFirst ^ (siblingNode.leftFirst + 1);
+				const float gain = area - Union(m_Nodes[child].bounds, m_Nodes[kept].bounds).GetSurfaceArea();
+				if (gain > bestGain)
+				{
+					bestGain = gain;
+					bestChild = child;
+					bestGrandchild = grandchild;
+				}
+			}
+		}
+		if (bestChild == UINT32_MAX)
+			return;
+
+		// Swapping the records moves whole subtrees; only the links back up from their children need fixing.
+		std::swap(m_Nodes[bestChild], m_Nodes[bestGrandchild]);
+		std::swap(m_Heights[bestChild], m_Heights[bestGrandchild]);
+		for (const uint32_t slot : { bestChild, bestGrandchild })
+		{
+			const BVHNode& moved = m_Nodes[slot];
+			if (moved.IsLeaf())
+			{
+				for (uint32_t entry = moved.leftFirst; entry < moved.leftFirst + moved.count; ++entry)
+					m_EntryLeaves[entry] = slot;
+			}
+			else
+			{
+				m_Parents[moved.leftFirst] = slot;
+				m_Parents[moved.leftFirst + 1] = slot;
+			}
+		}
+
+		const uint32_t parent = m_Parents[bestGrandchild];
+		BVHNode& parentNode = m_Nodes[parent];
+		parentNode.bounds = Union(m_Nodes[parentNode.leftFirst].bounds, m_Nodes[parentNode.leftFirst + 1].bounds);
+		m_Heights[parent] = static_cast<uint8_t>(1 + std::max(m_Heights[parentNode.leftFirst], m_Heights[parentNode.leftFirst + 1]));
+	}
+}
@@ -0,0 +1,130 @@
+#include "BroadPhase.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace odm
+{
+	/** Moved proxies per task of the pair search. */
+	static constexpr size_t QueryChunkSize = 256;
+
+	static inline uint64_t MakePairKey(uint32_t a, uint32_t b)
+	{
+		return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+	}
+
+	static inline ProxyPair GetPair(uint64_t key)
+	{
+		return { static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key) };
+	}
+
+	BroadPhase::BroadPhase(float margin)
+		: m_Tree(margin)
+	{}
+
+	void BroadPhase::Flag(uint32_t proxy, ProxyFlags flag)
+	{
+		if (proxy >= m_Flags.size())
+			m_Flags.resize(static_cast<size_t>(proxy) + 1, 0);
+		if (m_Flags[proxy] == 0)
+			m_Touched.push_back(proxy);
+		m_Flags[proxy] |= flag;
+	}
+
+	uint32_t BroadPhase::CreateProxy(const AABB& bounds)
+	{
+		const uint32_t proxy = m_Tree.CreateProxy(bounds);
+		Flag(proxy, Moved);
+		return proxy;
+	}
+
+	void BroadPhase::DestroyProxy(uint32_t proxy)
+	{
+		m_Tree.DestroyProxy(proxy);
+		Flag(proxy, Destroyed);
+		// Moved marks a live proxy to be queried; a proxy created and destroyed within one step has nothing to query.
+		m_Flags[proxy] &= ~Moved;
+	}
+
+	void BroadPhase::MoveProxy(uint32_t proxy, const AABB& bounds, const vec3& displacement)
+	{
+		if (m_Tree.MoveProxy(proxy, bounds, displacement))
+			Flag(proxy, Moved);
+	}
+
+	void BroadPhase::UpdatePairs(std::vector<ProxyPair>& added, std::vector<ProxyPair>& removed, TaskScheduler* scheduler)
+	{
+		added.clear();
+		removed.clear();
+
+		const auto flagsOf = [this](uint32_t proxy) -> uint8_t {
+			return proxy < m_Flags.size() ? m_Flags[proxy] : 0;
+		};
+
+		std::vector<uint32_t> moved;
+		for (const uint32_t proxy : m_Touched)
+		{
+			if (m_Flags[proxy] & Moved)
+				moved.push_back(proxy);
+		}
+		std::sort(moved.begin(), moved.end());
+
+		// Every current pair with a moved proxy turns up in that proxy's query; a pair of two moved proxies is kept from the smaller one's.
+		std::vector<std::vector<uint64_t>> partial((moved.size() + QueryChunkSize - 1) / QueryChunkSize);
+		ParallelForChunks(scheduler, moved.size(), QueryChunkSize, [&](uint32_t chunk, size_t begin, size_t end) {
+			std::vector<uint64_t>& found = partial[chunk];
+			for (size_t i = begin; i < end; ++i)
+			{
+				const uint32_t proxy = moved[i];
+				m_Tree.Query(m_Tree.GetFatBounds(proxy), [&](uint32_t other) {
+					if (other != proxy && !(other < proxy && (flagsOf(other) & Moved)))
+						found.push_back(MakePairKey(proxy, other));
+					return true;
+				});
+			}
+		});
+
+		std::vector<uint64_t> current;
+		for (const std::vector<uint64_t>& found : partial)
+			current.insert(current.end(), found.begin(), found.end());
+		std::sort(current.begin(), current.end());
+
+		// Pairs of untouched proxies stand; pairs that lost a proxy end; pairs of moved proxies end unless found again.
+		std::vector<uint64_t> kept;
+		kept.reserve(m_Pairs.size());
+		for (const uint64_t key : m_Pairs)
+		{
+			const ProxyPair pair = GetPair(key);
+			const uint8_t flags = flagsOf(pair.a) | flagsOf(pair.b);
+			if (flags == 0)
+				kept.push_back(key);
+			else if ((flags & Destroyed) || !std::binary_search(current.begin(), current.end(), key))
+				removed.push_back(pair);
+		}
+
+		for (const uint64_t key : current)
+		{
+			const ProxyPair pair = GetPair(key);
+			const bool survived = !((flagsOf(pair.a) | flagsOf(pair.b)) & Destroyed) && std::binary_search(m_Pairs.begin(), m_Pairs.end(), key);
+			if (!survived)
+				added.push_back(pair);
+		}
+
+		m_Pairs.clear();
+		m_Pairs.reserve(kept.size() + current.size());
+		std::merge(kept.begin(), kept.end(), current.begin(), current.end(), std::back_inserter(m_Pairs));
+
+		for (const uint32_t proxy : m_Touched)
+			m_Flags[proxy] = 0;
+		m_Touched.clear();
+	}
+
+	std::vector<ProxyPair> BroadPhase::GetPairs() const
+	{
+		std::vector<ProxyPair> pairs;
+		pairs.reserve(m_Pairs.size());
+		for (const uint64_t key : m_Pairs)
+			pairs.push_back(GetPair(key));
+		return pairs;
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef _BROAD_PHASE_H_
+#define _BROAD_PHASE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DynamicAABBTree.h"
+#include "ProxyPair.h"
+#include "../TaskScheduler.h"
+
+namespace odm
+{
+	/**
+	 * Broadphase over a DynamicAABBTree that keeps the set of overlapping pairs from step to step.
+	 * Only proxies whose fat box changed are queried, so a step costs in proportion to what moved, not to the number of objects.
+	 */
+	class BroadPhase
+	{
+	public:
+		/**
+		 * Constructs an empty broadphase.
+		 * @param margin Distance each fat box extends beyond its object on every side; see DynamicAABBTree.
+		 */
+		explicit BroadPhase(float margin = 0.1f);
+
+		/** Adds an object; see DynamicAABBTree::CreateProxy. */
+		uint32_t CreateProxy(const AABB& bounds);
+
+		/**
+		 * Removes an object; its pairs are reported as removed by the next UpdatePairs.
+		 * Its id may be handed out again before that; UpdatePairs then reports the old pairs removed and the new ones added.
+		 */
+		void DestroyProxy(uint32_t proxy);
+
+		/** Updates the bounds of an object; see DynamicAABBTree::MoveProxy. */
+		void MoveProxy(uint32_t proxy, const AABB& bounds, const vec3& displacement = vec3());
+
+		/**
+		 * Brings the pair set up to date with the proxies created, moved and destroyed since the last call.
+		 * @param added Receives the pairs that started overlapping, in ascending order; cleared first.
+		 * @param removed Receives the pairs that stopped overlapping or lost a proxy, in ascending order; cleared first.
+		 * @param scheduler Runs the tree queries of the moved proxies on several threads when given; the result does not depend on it.
+		 */
+		void UpdatePairs(std::vector<ProxyPair>& added, std::vector<ProxyPair>& removed, TaskScheduler* scheduler = nullptr);
+
+		/** Gets the number of overlapping pairs as of the last UpdatePairs. */
+		NODISCARD size_t GetPairCount() const { return m_Pairs.size(); }
+
+		/** Gets the overlapping pairs as of the last UpdatePairs, in ascending order. */
+		NODISCARD std::vector<ProxyPair> GetPairs() const;
+
+		NODISCARD const DynamicAABBTree& GetTree() const { return m_Tree; }
+
+	private:
+		enum ProxyFlags : uint8_t
+		{
+			Moved = 1,
+			Destroyed = 2
+		};
+
+		void Flag(uint32_t proxy, ProxyFlags flag);
+
+		DynamicAABBTree m_Tree;
+		std::vector<uint64_t> m_Pairs;			// Pairs as (a << 32) | b, sorted.
+		std::vector<uint32_t> m_Touched;		// Proxies flagged since the last UpdatePairs.
+		std::vector<uint8_t> m_Flags;			// ProxyFlags of each proxy id.
+	};
+}
+
+#endif /* end of include guard: _BROAD_PHASE_H_ */
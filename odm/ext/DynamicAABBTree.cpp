@@ -0,0 +1,262 @@
+#include "DynamicAABBTree.h"
+
+#include <algorithm>
+
+namespace odm
+{
+	/** How far ahead of a moving object its fat box reaches, in steps of its current displacement. */
+	static constexpr float DisplacementMultiplier = 4.0f;
+
+	static inline AABB Union(const AABB& a, const AABB& b)
+	{
+		AABB result = a;
+		result.Add(b);
+		return result;
+	}
+
+	DynamicAABBTree::DynamicAABBTree(float margin)
+		: m_Margin(margin)
+	{}
+
+	uint32_t DynamicAABBTree::AllocateNode()
+	{
+		if (m_FreeList == NullNode)
+		{
+			m_Nodes.emplace_back();
+			return static_cast<uint32_t>(m_Nodes.size() - 1);
+		}
+
+		const uint32_t nodeIndex = m_FreeList;
+		m_FreeList = m_Nodes[nodeIndex].parent;
+		m_Nodes[nodeIndex] = Node();
+		return nodeIndex;
+	}
+
+	void DynamicAABBTree::FreeNode(uint32_t nodeIndex)
+	{
+		Node& node = m_Nodes[nodeIndex];
+		node.parent = m_FreeList;
+		node.child1 = NullNode;
+		node.child2 = NullNode;
+		node.height = -1;
+		m_FreeList = nodeIndex;
+	}
+
+	uint32_t DynamicAABBTree::CreateProxy(const AABB& bounds)
+	{
+		const uint32_t proxy = AllocateNode();
+		const vec3 margin(m_Margin);
+		m_Nodes[proxy].bounds = AABB(bounds.min - margin, bounds.max + margin);
+		m_Nodes[proxy].height = 0;
+		InsertLeaf(proxy);
+		++m_ProxyCount;
+		return proxy;
+	}
+
+	void DynamicAABBTree::DestroyProxy(uint32_t proxy)
+	{
+		assert(proxy < m_Nodes.size() && m_Nodes[proxy].height == 0);
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		--m_ProxyCount;
+	}
+
+	bool DynamicAABBTree::MoveProxy(uint32_t proxy, const AABB& bounds, const vec3& displacement)
+	{
+		assert(proxy < m_Nodes.size() && m_Nodes[proxy].height == 0);
+
+		const vec3 margin(m_Margin);
+		AABB fat(bounds.min - margin, bounds.max + margin);
+		const vec3 reach = displacement * DisplacementMultiplier;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (reach[axis] < 0.0f)
+				fat.min[axis] += reach[axis];
+			else
+				fat.max[axis] += reach[axis];
+		}
+
+		// Keep the current fat box while it still holds the object, unless the object has shrunk to a fraction of it.
+		const AABB& current = m_Nodes[proxy].bounds;
+		if (current.Contains(bounds))
+		{
+			const vec3 slack(4.0f * m_Margin);
+			if (AABB(fat.min - slack, fat.max + slack).Contains(current))
+				return false;
+		}
+
+		RemoveLeaf(proxy);
+		m_Nodes[proxy].bounds = fat;
+		InsertLeaf(proxy);
+		return true;
+	}
+
+	void DynamicAABBTree::InsertLeaf(uint32_t leaf)
+	{
+		if (m_Root == NullNode)
+		{
+			m_Root = leaf;
+			m_Nodes[leaf].parent = NullNode;
+			return;
+		}
+
+		// Descend towards the sibling whose union with the leaf costs the least area, counting the growth of every ancestor on the way;
+		// stop once pairing with the current node is cheaper than any descent.
+		const AABB leafBounds = m_Nodes[leaf].bounds;
+		uint32_t sibling = m_Root;
+		while (!m_Nodes[sibling].IsLeaf())
+		{
+			const Node& node = m_Nodes[sibling];
+			const float area = node.bounds.GetSurfaceArea();
+			const float combinedArea = Union(node.bounds, leafBounds).GetSurfaceArea();
+			const float cost = 2.0f * combinedArea;
+			const float inheritedCost = 2.0f * (combinedArea - area);
+
+			float childCosts[2];
+			const uint32_t children[2] = { node.child1, node.child2 };
+			for (int i = 0; i < 2; ++i)
+			{
+				const Node& child = m_Nodes[children[i]];
+				const float unionArea = Union(child.bounds, leafBounds).GetSurfaceArea();
+				childCosts[i] = (child.IsLeaf() ? unionArea : unionArea - child.bounds.GetSurfaceArea()) + inheritedCost;
+			}
+
+			if (cost < childCosts[0] && cost < childCosts[1])
+				break;
+			sibling = childCosts[0] < childCosts[1] ? children[0] : children[1];
+		}
+
+		const uint32_t oldParent = m_Nodes[sibling].parent;
+		const uint32_t newParent = AllocateNode();
+		Node& parent = m_Nodes[newParent];
+		parent.parent = oldParent;
+		parent.bounds = Union(leafBounds, m_Nodes[sibling].bounds);
+		parent.height = m_Nodes[sibling].height + 1;
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+		m_Nodes[sibling].parent = newParent;
+		m_Nodes[leaf].parent = newParent;
+
+		if (oldParent == NullNode)
+			m_Root = newParent;
+		else if (m_Nodes[oldParent].child1 == sibling)
+			m_Nodes[oldParent].child1 = newParent;
+		else
+			m_Nodes[oldParent].child2 = newParent;
+
+		UpdateUpwards(m_Nodes[leaf].parent);
+	}
+
+	void DynamicAABBTree::RemoveLeaf(uint32_t leaf)
+	{
+		if (leaf == m_Root)
+		{
+			m_Root = NullNode;
+			return;
+		}
+
+		const uint32_t parent = m_Nodes[leaf].parent;
+		const uint32_t grandParent = m_Nodes[parent].parent;
+		const uint32_t sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+		m_Nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+		if (grandParent == NullNode)
+		{
+			m_Root = sibling;
+			return;
+		}
+
+		if (m_Nodes[grandParent].child1 == parent)
+			m_Nodes[grandParent].child1 = sibling;
+		else
+			m_Nodes[grandParent].child2 = sibling;
+		UpdateUpwards(grandParent);
+	}
+
+	/** Rebalances and refits every node from nodeIndex up to the root. */
+	void DynamicAABBTree::UpdateUpwards(uint32_t nodeIndex)
+	{
+		while (nodeIndex != NullNode)
+		{
+			nodeIndex = Balance(nodeIndex);
+			Node& node = m_Nodes[nodeIndex];
+			const Node& child1 = m_Nodes[node.child1];
+			const Node& child2 = m_Nodes[node.child2];
+			node.height = 1 + std::max(child1.height, child2.height);
+			node.bounds = Union(child1.bounds, child2.bounds);
+			nodeIndex = node.parent;
+		}
+	}
+
+	/**
+	 * Rotates the taller child of a node up when its children differ in height by more than one.
+	 * @returns The node now in the place of nodeIndex.
+	 */
+	uint32_t DynamicAABBTree::Balance(uint32_t iA)
+	{
+		Node& a = m_Nodes[iA];
+		if (a.IsLeaf() || a.height < 2)
+			return iA;
+
+		const int32_t balance = m_Nodes[a.child2].height - m_Nodes[a.child1].height;
+		if (balance >= -1 && balance <= 1)
+			return iA;
+
+		// The taller child rises into A's place; A keeps the other child and takes the shorter grandchild.
+		const bool rightHeavy = balance > 1;
+		const uint32_t iB = rightHeavy ? a.child2 : a.child1;	// Rises.
+		const uint32_t iC = rightHeavy ? a.child1 : a.child2;	// Stays under A.
+		Node& b = m_Nodes[iB];
+		const uint32_t iD = b.child1;
+		const uint32_t iE = b.child2;
+		const bool dTaller = m_Nodes[iD].height > m_Nodes[iE].height;
+		const uint32_t iTall = dTaller ? iD : iE;
+		const uint32_t iShort = dTaller ? iE : iD;
+
+		b.child1 = iA;
+		b.child2 = iTall;
+		b.parent = a.parent;
+		a.parent = iB;
+		if (b.parent == NullNode)
+			m_Root = iB;
+		else if (m_Nodes[b.parent].child1 == iA)
+			m_Nodes[b.parent].child1 = iB;
+		else
+			m_Nodes[b.parent].child2 = iB;
+
+		if (rightHeavy)
+			a.child2 = iShort;
+		else
+			a.child1 = iShort;
+		m_Nodes[iShort].parent = iA;
+
+		a.bounds = Union(m_Nodes[iC].bounds, m_Nodes[iShort].bounds);
+		a.height = 1 + std::max(m_Nodes[iC].height, m_Nodes[iShort].height);
+		b.bounds = Union(a.bounds, m_Nodes[iTall].bounds);
+		b.height = 1 + std::max(a.height, m_Nodes[iTall].height);
+		return iB;
+	}
+
+	float DynamicAABBTree::GetAreaRatio() const
+	{
+		if (m_Root == NullNode)
+			return 0.0f;
+
+		float total = 0.0f;
+		for (const Node& node : m_Nodes)
+		{
+			if (node.height >= 0)
+				total += node.bounds.GetSurfaceArea();
+		}
+		return total / m_Nodes[m_Root].bounds.GetSurfaceArea();
+	}
+
+	void DynamicAABBTree::QueryOverlap(const AABB& box, std::vector<uint32_t>& results) const
+	{
+		Query(box, [&](uint32_t proxy) {
+			results.push_back(proxy);
+			return true;
+		});
+	}
+}
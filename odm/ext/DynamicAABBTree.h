@@ -0,0 +1,137 @@
+#pragma once
+
+#ifndef _DYNAMIC_AABB_TREE_H_
+#define _DYNAMIC_AABB_TREE_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BVHNode.h"
+
+namespace odm
+{
+	/**
+	 * Bounding volume tree for objects that come, go and move, in the manner of Box2D's b2DynamicTree.
+	 * Every object is a proxy whose leaf stores a fat box: its bounds grown by a margin, so small moves leave the tree alone.
+	 * Leaves are inserted where they grow the surface area least, and AVL rotations keep the tree balanced.
+	 */
+	class DynamicAABBTree
+	{
+	public:
+		static constexpr uint32_t NullNode = UINT32_MAX;
+
+		/**
+		 * Constructs an empty tree.
+		 * @param margin Distance each fat box extends beyond its object on every side.
+		 */
+		explicit DynamicAABBTree(float margin = 0.1f);
+
+		/**
+		 * Adds an object.
+		 * @param bounds Bounds of the object.
+		 * @returns The proxy of the object, stable until it is destroyed; the ids of destroyed proxies are reused.
+		 */
+		uint32_t CreateProxy(const AABB& bounds);
+
+		/**
+		 * Removes an object.
+		 * @param proxy The proxy returned by CreateProxy.
+		 */
+		void DestroyProxy(uint32_t proxy);
+
+		/**
+		 * Updates the bounds of an object.
+		 * @param proxy The proxy returned by CreateProxy.
+		 * @param bounds New bounds of the object.
+		 * @param displacement Movement of the object this step; the fat box is stretched along it to anticipate the next steps.
+		 * @returns Whether the fat box changed, which happens when the object left it or has become much smaller than it.
+		 */
+		bool MoveProxy(uint32_t proxy, const AABB& bounds, const vec3& displacement = vec3());
+
+		/** Gets the fat box of a proxy. */
+		NODISCARD const AABB& GetFatBounds(uint32_t proxy) const
+		{
+			assert(proxy < m_Nodes.size() && m_Nodes[proxy].IsLeaf());
+			return m_Nodes[proxy].bounds;
+		}
+
+		NODISCARD float GetMargin() const { return m_Margin; }
+		NODISCARD uint32_t GetProxyCount() const { return m_ProxyCount; }
+
+		/** Gets the number of levels of the tree, 0 when empty. */
+		NODISCARD uint32_t GetHeight() const { return m_Root == NullNode ? 0 : static_cast<uint32_t>(m_Nodes[m_Root].height) + 1; }
+
+		/** Gets the summed area of all nodes over the area of the root, a measure of tree quality; lower is better. */
+		NODISCARD float GetAreaRatio() const;
+
+		/**
+		 * Calls callback(proxy) for every proxy whose fat box overlaps a box.
+		 * @param box The query box.
+		 * @param callback Returns false to stop the query.
+		 */
+		template <class Callback>
+		void Query(const AABB& box, Callback&& callback) const
+		{
+			if (m_Root == NullNode)
+				return;
+
+			uint32_t stack[MaxBVHDepth];
+			size_t top = 0;
+			stack[top++] = m_Root;
+			while (top != 0)
+			{
+				const uint32_t nodeIndex = stack[--top];
+				const Node& node = m_Nodes[nodeIndex];
+				if (!node.bounds.Intersects(box))
+					continue;
+
+				if (node.IsLeaf())
+				{
+					if (!callback(nodeIndex))
+						return;
+				}
+				else
+				{
+					assert(top + 2 <= MaxBVHDepth);
+					stack[top++] = node.child1;
+					stack[top++] = node.child2;
+				}
+			}
+		}
+
+		/**
+		 * Finds the proxies whose fat box overlaps a box.
+		 * @param box The query box.
+		 * @param results Receives the proxies; appended to, not cleared.
+		 */
+		void QueryOverlap(const AABB& box, std::vector<uint32_t>& results) const;
+
+	private:
+		struct Node
+		{
+			AABB bounds;
+			uint32_t parent = NullNode;		// Next entry of the free list while the node is free.
+			uint32_t child1 = NullNode;
+			uint32_t child2 = NullNode;
+			int32_t height = -1;			// 0 for a leaf, -1 while free.
+
+			NODISCARD bool IsLeaf() const { return child1 == NullNode; }
+		};
+
+		uint32_t AllocateNode();
+		void FreeNode(uint32_t nodeIndex);
+		void InsertLeaf(uint32_t leaf);
+		void RemoveLeaf(uint32_t leaf);
+		void UpdateUpwards(uint32_t nodeIndex);
+		uint32_t Balance(uint32_t nodeIndex);
+
+		std::vector<Node> m_Nodes;
+		uint32_t m_Root = NullNode;
+		uint32_t m_FreeList = NullNode;
+		uint32_t m_ProxyCount = 0;
+		float m_Margin;
+	};
+}
+
+#endif /* end of include guard: _DYNAMIC_AABB_TREE_H_ */
@@ -1 +1,129 @@
 #pragma once
+
+#ifndef _FRUSTUM_H_
+#define _FRUSTUM_H_
+
+#include <cmath>
+#include "../Mat4x4.h"
+#include "Plane.h"
+#include "AABB.h"
+#include "Sphere.h"
+
+namespace odm
+{
+	/** Depth range of clip space; perspective() and orthographic() map to NegativeOneToOne. */
+	enum class ClipDepth
+	{
+		NegativeOneToOne,	// OpenGL convention, -w <= z <= w.
+		ZeroToOne			// Direct3D and Vulkan convention, 0 <= z <= w.
+	};
+
+	/** Index of each plane in Frustum::planes. */
+	enum class FrustumPlane
+	{
+		Left, Right, Bottom, Top, Near, Far
+	};
+
+	/**
+	 * Convex volume bounded by six planes whose normals point inside.
+	 * A point is inside when Plane::Distance is non-negative for every plane.
+	 */
+	struct Frustum
+	{
+		static const size_t PLANE_COUNT = 6;
+
+		Plane planes[PLANE_COUNT];
+
+		/** Constructs a frustum that contains everything. */
+		Frustum() = default;
+
+		/**
+		 * Constructs from six planes with inward normals, in FrustumPlane order.
+		 */
+		Frustum(const Plane& left, const Plane& right, const Plane& bottom, const Plane& top, const Plane& nearPlane, const Plane& farPlane);
+
+		/**
+		 * Extracts the planes of a view-projection matrix (Gribb and Hartmann) in world space.
+		 * @param viewProjection Projection times view; a projection alone gives view space planes.
+		 * @param depth Clip space depth range the projection maps to.
+		 */
+		NODISCARD static Frustum FromMatrix(const Matrix4x4& viewProjection, ClipDepth depth = ClipDepth::NegativeOneToOne);
+
+		NODISCARD const Plane& GetPlane(FrustumPlane plane) const;
+
+		NODISCARD bool Contains(const vec3& point) const;
+
+		/** Tests whether a box is at least partly inside; boxes near a corner may be kept although outside. */
+		NODISCARD bool Intersects(const AABB& box) const;
+
+		/** Tests whether a sphere is at least partly inside; spheres near a corner may be kept although outside. */
+		NODISCARD bool Intersects(const Sphere& sphere) const;
+	};
+
+	inline Frustum::Frustum(const Plane& left, const Plane& right, const Plane& bottom, const Plane& top, const Plane& nearPlane, const Plane& farPlane)
+		: planes{ left, right, bottom, top, nearPlane, farPlane }
+	{}
+
+	inline Frustum Frustum::FromMatrix(const Matrix4x4& viewProjection, ClipDepth depth)
+	{
+		// Row r of the column-major matrix; a clip space bound such as -w <= x becomes (row3 + row0) . (p, 1) >= 0.
+		const auto row = [&viewProjection](int r) {
+			return Vector4f(viewProjection.m[0][r], viewProjection.m[1][r], viewProjection.m[2][r], viewProjection.m[3][r]);
+		};
+		const Vector4f r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+		// Plane::Distance is normal . p - d, so the constant term enters negated.
+		const auto plane = [](const Vector4f& v) {
+			return Plane(v.x, v.y, v.z, -v.w).Normalized();
+		};
+
+		return Frustum(
+			plane(r3 + r0),
+			plane(r3 - r0),
+			plane(r3 + r1),
+			plane(r3 - r1),
+			plane(depth == ClipDepth::ZeroToOne ? r2 : r3 + r2),
+			plane(r3 - r2));
+	}
+
+	inline const Plane& Frustum::GetPlane(FrustumPlane plane) const
+	{
+		return planes[static_cast<size_t>(plane)];
+	}
+
+	inline bool Frustum::Contains(const vec3& point) const
+	{
+		for (const Plane& plane : planes)
+		{
+			if (plane.Distance(point) < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	inline bool Frustum::Intersects(const AABB& box) const
+	{
+		const vec3 center = box.Center();
+		const vec3 extents = box.GetExtents();
+		for (const Plane& plane : planes)
+		{
+			// Distance of the box corner furthest along the normal.
+			const float radius = std::abs(plane.normal.x) * extents.x + std::abs(plane.normal.y) * extents.y + std::abs(plane.normal.z) * extents.z;
+			if (plane.Distance(center) + radius < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	inline bool Frustum::Intersects(const Sphere& sphere) const
+	{
+		for (const Plane& plane : planes)
+		{
+			if (plane.Distance(sphere.Center) + sphere.Radius < 0.0f)
+				return false;
+		}
+		return true;
+	}
+}
+
+#endif /* end of include guard: _FRUSTUM_H_ */
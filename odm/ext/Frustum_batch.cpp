@@ -0,0 +1,382 @@
+#include "Frustum_batch.h"
+
+#include <algorithm>
+#include <cassert>
+#include "../Simd.h"
+#include "../Simd_soa.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	/** Visibility bits of objects [first, end) of the word that starts at object wordStart. */
+	template <class T>
+	static uint32_t CullScalar(const Frustum& frustum, const T* objects, size_t first, size_t end, size_t wordStart)
+	{
+		uint32_t bits = 0;
+		for (size_t i = first; i < end; ++i)
+			bits |= static_cast<uint32_t>(frustum.Intersects(objects[i])) << (i - wordStart);
+		return bits;
+	}
+
+	/** Culls in chunks small enough for a bitmask on the stack, then compacts the set bits without a branch per object. */
+	template <class T>
+	static size_t CullToIndices(const Frustum& frustum, const T* objects, size_t count, uint32_t* visibleIndices,
+		void (*cull)(const Frustum&, const T*, size_t, uint32_t*))
+	{
+		constexpr size_t ChunkSize = 1024;
+		uint32_t bits[ChunkSize / 32];
+		size_t written = 0;
+		for (size_t first = 0; first < count; first += ChunkSize)
+		{
+			const size_t n = std::min(ChunkSize, count - first);
+			cull(frustum, objects + first, n, bits);
+			for (size_t w = 0; w < GetVisibilityWordCount(n); ++w)
+			{
+				// Every index is stored and the cursor only advances past visible ones; writes stay below first + n.
+				const uint32_t base = static_cast<uint32_t>(first + w * 32);
+				for (uint32_t word = bits[w], j = 0; word != 0; word >>= 1, ++j)
+				{
+					visibleIndices[written] = base + j;
+					written += word & 1;
+				}
+			}
+		}
+		return written;
+	}
+
+#if ODM_SIMD_SSE
+
+	static_assert(sizeof(AABB) == 6 * sizeof(float), "LoadAABBs4 expects tightly packed boxes");
+	static_assert(sizeof(Sphere) == 4 * sizeof(float), "LoadQuats4 expects tightly packed spheres");
+
+	/** Frustum planes with every coefficient splatted across a register; a, the absolute normal, projects box extents. */
+	struct FrustumPlanes4
+	{
+		__m128 nx[Frustum::PLANE_COUNT], ny[Frustum::PLANE_COUNT], nz[Frustum::PLANE_COUNT], d[Frustum::PLANE_COUNT];
+		__m128 ax[Frustum::PLANE_COUNT], ay[Frustum::PLANE_COUNT], az[Frustum::PLANE_COUNT];
+
+		explicit FrustumPlanes4(const Frustum& frustum)
+		{
+			for (size_t p = 0; p < Frustum::PLANE_COUNT; ++p)
+			{
+				const Plane& plane = frustum.planes[p];
+				nx[p] = _mm_set1_ps(plane.normal.x);
+				ny[p] = _mm_set1_ps(plane.normal.y);
+				nz[p] = _mm_set1_ps(plane.normal.z);
+				d[p] = _mm_set1_ps(plane.d);
+				ax[p] = _mm_set1_ps(std::abs(plane.normal.x));
+				ay[p] = _mm_set1_ps(std::abs(plane.normal.y));
+				az[p] = _mm_set1_ps(std::abs(plane.normal.z));
+			}
+		}
+	};
+
+	static inline uint32_t CullAABBs4(const FrustumPlanes4& planes, const AABB* boxes)
+	{
+		__m128 minX, minY, minZ, maxX, maxY, maxZ;
+		LoadAABBs4(&boxes->min.x, minX, minY, minZ, maxX, maxY, maxZ);
+
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+		const __m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+		const __m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+		const __m128 ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+		const __m128 ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+		const __m128 ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+		__m128 outside = _mm_setzero_ps();
+		for (size_t p = 0; p < Frustum::PLANE_COUNT; ++p)
+		{
+			const __m128 dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.nx[p], cx), _mm_mul_ps(planes.ny[p], cy)), _mm_mul_ps(planes.nz[p], cz)), planes.d[p]);
+			const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.ax[p], ex), _mm_mul_ps(planes.ay[p], ey)), _mm_mul_ps(planes.az[p], ez));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+		}
+		return static_cast<uint32_t>(~_mm_movemask_ps(outside)) & 0xF;
+	}
+
+	static inline uint32_t CullSpheres4(const FrustumPlanes4& planes, const Sphere* spheres)
+	{
+		__m128 cx, cy, cz, r;
+		LoadQuats4(&spheres->Center.x, cx, cy, cz, r);
+
+		__m128 outside = _mm_setzero_ps();
+		for (size_t p = 0; p < Frustum::PLANE_COUNT; ++p)
+		{
+			const __m128 dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.nx[p], cx), _mm_mul_ps(planes.ny[p], cy)), _mm_mul_ps(planes.nz[p], cz)), planes.d[p]);
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, r), _mm_setzero_ps()));
+		}
+		return static_cast<uint32_t>(~_mm_movemask_ps(outside)) & 0xF;
+	}
+
+	static void CullAABBsSSE(const Frustum& frustum, const AABB* boxes, size_t count, uint32_t* visibleBits)
+	{
+		const FrustumPlanes4 planes(frustum);
+		for (size_t first = 0; first < count; first += 32)
+		{
+			const size_t end = std::min(count, first + 32);
+			uint32_t bits = 0;
+			size_t i = first;
+			for (; i + 4 <= end; i += 4)
+				bits |= CullAABBs4(planes, boxes + i) << (i - first);
+			visibleBits[first / 32] = bits | CullScalar(frustum, boxes, i, end, first);
+		}
+	}
+
+	static void CullSpheresSSE(const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visibleBits)
+	{
+		const FrustumPlanes4 planes(frustum);
+		for (size_t first = 0; first < count; first += 32)
+		{
+			const size_t end = std::min(count, first + 32);
+			uint32_t bits = 0;
+			size_t i = first;
+			for (; i + 4 <= end; i += 4)
+				bits |= CullSpheres4(planes, spheres + i) << (i - first);
+			visibleBits[first / 32] = bits | CullScalar(frustum, spheres, i, end, first);
+		}
+	}
+
+#else
+
+	template <class T>
+	static void CullBaseline(const Frustum& frustum, const T* objects, size_t count, uint32_t* visibleBits)
+	{
+		for (size_t first = 0; first < count; first += 32)
+			visibleBits[first / 32] = CullScalar(frustum, objects, first, std::min(count, first + 32), first);
+	}
+
+#endif
+
+#if ODM_SIMD_SSE
+	static const FrustumKernels s_BaselineKernels = { SimdLevel::Baseline, &CullAABBsSSE, &CullSpheresSSE };
+#else
+	static const FrustumKernels s_BaselineKernels = { SimdLevel::Baseline, &CullBaseline<AABB>, &CullBaseline<Sphere> };
+#endif
+
+#if ODM_SIMD_SSE
+#pragma region AVX2
+
+	struct FrustumPlanes8
+	{
+		__m256 nx[Frustum::PLANE_COUNT], ny[Frustum::PLANE_COUNT], nz[Frustum::PLANE_COUNT], d[Frustum::PLANE_COUNT];
+		__m256 ax[Frustum::PLANE_COUNT], ay[Frustum::PLANE_COUNT], az[Frustum::PLANE_COUNT];
+	};
+
+	ODM_TARGET("avx2,fma")
+	static inline void SplatPlanes8(const Frustum& frustum, FrustumPlanes8& planes)
+	{
+		for (size_t p = 0; p < Frustum::PLANE_COUNT; ++p)
+		{
+			const Plane& plane = frustum.planes[p];
+			planes.nx[p] = _mm256_set1_ps(plane.normal.x);
+			planes.ny[p] = _mm256_set1_ps(plane.normal.y);
+			planes.nz[p] = _mm256_set1_ps(plane.normal.z);
+			planes.d[p] = _mm256_set1_ps(plane.d);
+			planes.ax[p] = _mm256_set1_ps(std::abs(plane.normal.x));
+			planes.ay[p] = _mm256_set1_ps(std::abs(plane.normal.y));
+			planes.az[p] = _mm256_set1_ps(std::abs(plane.normal.z));
+		}
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline uint32_t CullAABBs8(const FrustumPlanes8& planes, const AABB* boxes)
+	{
+		__m256 minX, minY, minZ, maxX, maxY, maxZ;
+		LoadAABBs8(&boxes->min.x, minX, minY, minZ, maxX, maxY, maxZ);
+
+		const __m256 half = _mm256_set1_ps(0.5f);
+		const __m256 cx = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half);
+		const __m256 cy = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half);
+		const __m256 cz = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half);
+		const __m256 ex = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+		const __m256 ey = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+		const __m256 ez = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+
+		__m256 outside = _mm256_setzero_ps();
+		for (size_t p = 0; p < Frustum::PLANE_COUNT; ++p)
+		{
+			const __m256 dist = _mm256_fmadd_ps(planes.nz[p], cz, _mm256_fmadd_ps(planes.ny[p], cy, _mm256_fmsub_ps(planes.nx[p], cx, planes.d[p])));
+			const __m256 reach = _mm256_fmadd_ps(planes.az[p], ez, _mm256_fmadd_ps(planes.ay[p], ey, _mm256_fmadd_ps(planes.ax[p], ex, dist)));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(reach, _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+		return static_cast<uint32_t>(~_mm256_movemask_ps(outside)) & 0xFF;
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline uint32_t CullSpheres8(const FrustumPlanes8& planes, const Sphere* spheres)
+	{
+		__m256 cx, cy, cz, r;
+		LoadQuats8(&spheres->Center.x, cx, cy, cz, r);
+
+		__m256 outside = _mm256_setzero_ps();
+		for (size_t p = 0; p < Frustum::PLANE_COUNT; ++p)
+		{
+			const __m256 dist = _mm256_fmadd_ps(planes.nz[p], cz, _mm256_fmadd_ps(planes.ny[p], cy, _mm256_fmsub_ps(planes.nx[p], cx, planes.d[p])));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(dist, r), _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+		return static_cast<uint32_t>(~_mm256_movemask_ps(outside)) & 0xFF;
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void CullAABBsAVX2(const Frustum& frustum, const AABB* boxes, size_t count, uint32_t* visibleBits)
+	{
+		FrustumPlanes8 planes;
+		SplatPlanes8(frustum, planes);
+		for (size_t first = 0; first < count; first += 32)
+		{
+			const size_t end = std::min(count, first + 32);
+			uint32_t bits = 0;
+			size_t i = first;
+			for (; i + 8 <= end; i += 8)
+				bits |= CullAABBs8(planes, boxes + i) << (i - first);
+			visibleBits[first / 32] = bits | CullScalar(frustum, boxes, i, end, first);
+		}
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void CullSpheresAVX2(const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visibleBits)
+	{
+		FrustumPlanes8 planes;
+		SplatPlanes8(frustum, planes);
+		for (size_t first = 0; first < count; first += 32)
+		{
+			const size_t end = std::min(count, first + 32);
+			uint32_t bits = 0;
+			size_t i = first;
+			for (; i + 8 <= end; i += 8)
+				bits |= CullSpheres8(planes, spheres + i) << (i - first);
+			visibleBits[first / 32] = bits | CullScalar(frustum, spheres, i, end, first);
+		}
+	}
+
+	// AVX-512 shares these kernels; culling streams the bounds from memory, and 16 lanes would not fetch them any faster.
+	static const FrustumKernels s_AVX2Kernels = { SimdLevel::AVX2, &CullAABBsAVX2, &CullSpheresAVX2 };
+
+#pragma endregion
+#endif
+
+	const FrustumKernels& GetFrustumKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:	return s_AVX2Kernels;
+		default:				break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const FrustumKernels& GetFrustumKernels()
+	{
+		static const FrustumKernels& kernels = GetFrustumKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	void CullAABBs(const Frustum& frustum, Span<const AABB> boxes, Span<uint32_t> visibleBits)
+	{
+		assert(visibleBits.size() == GetVisibilityWordCount(boxes.size()));
+		GetFrustumKernels().CullAABBs(frustum, boxes.data(), boxes.size(), visibleBits.data());
+	}
+
+	size_t CullAABBsToIndices(const Frustum& frustum, Span<const AABB> boxes, Span<uint32_t> visibleIndices)
+	{
+		assert(visibleIndices.size() >= boxes.size());
+		return CullToIndices(frustum, boxes.data(), boxes.size(), visibleIndices.data(), GetFrustumKernels().CullAABBs);
+	}
+
+	void CullSpheres(const Frustum& frustum, Span<const Sphere> spheres, Span<uint32_t> visibleBits)
+	{
+		assert(visibleBits.size() == GetVisibilityWordCount(spheres.size()));
+		GetFrustumKernels().CullSpheres(frustum, spheres.data(), spheres.size(), visibleBits.data());
+	}
+
+	size_t CullSpheresToIndices(const Frustum& frustum, Span<const Sphere> spheres, Span<uint32_t> visibleIndices)
+	{
+		assert(visibleIndices.size() >= spheres.size());
+		return CullToIndices(frustum, spheres.data(), spheres.size(), visibleIndices.data(), GetFrustumKernels().CullSpheres);
+	}
+
+	/** Mask with one bit per plane of a frustum. */
+	constexpr uint32_t AllPlanesMask = (1u << Frustum::PLANE_COUNT) - 1;
+
+	/**
+	 * Tests a box against the planes set in mask, starting with the plane cached for it.
+	 * @returns False when a plane rejects the box, which then becomes the cached plane; otherwise clears the planes the box is fully inside of.
+	 */
+	static inline bool ClassifyAABB(const Frustum& frustum, const AABB& box, uint32_t& mask, uint8_t& cachedPlane)
+	{
+		const vec3 center = box.Center();
+		const vec3 extents = box.GetExtents();
+		const uint32_t first = cachedPlane;
+		for (uint32_t k = 0; k < Frustum::PLANE_COUNT; ++k)
+		{
+			// Visit the cached plane first, then the others in order.
+			const uint32_t p = k == 0 ? first : (k <= first ? k - 1 : k);
+			if ((mask & (1u << p)) == 0)
+				continue;
+
+			const Plane& plane = frustum.planes[p];
+			const float dist = plane.Distance(center);
+			const float radius = std::abs(plane.normal.x) * extents.x + std::abs(plane.normal.y) * extents.y + std::abs(plane.normal.z) * extents.z;
+			if (dist + radius < 0.0f)
+			{
+				cachedPlane = static_cast<uint8_t>(p);
+				return false;
+			}
+			if (dist - radius >= 0.0f)
+				mask &= ~(1u << p);
+		}
+		return true;
+	}
+
+	size_t CullHierarchy(const Frustum& frustum, Span<const BVHNode> nodes, Span<const uint32_t> primitiveIndices, Span<const AABB> primitiveBounds,
+		Span<uint8_t> planeCache, Span<uint32_t> visibleIndices)
+	{
+		assert(planeCache.size() == nodes.size());
+		assert(visibleIndices.size() >= primitiveIndices.size());
+		if (nodes.empty())
+			return 0;
+
+		struct Entry
+		{
+			uint32_t node;
+			uint32_t mask;
+		};
+		Entry stack[MaxBVHDepth];
+		size_t top = 0;
+		stack[top++] = { 0, AllPlanesMask };
+
+		size_t written = 0;
+		while (top != 0)
+		{
+			Entry entry = stack[--top];
+			const BVHNode& node = nodes[entry.node];
+			if (entry.mask != 0 && !ClassifyAABB(frustum, node.bounds, entry.mask, planeCache[entry.node]))
+				continue;
+
+			if (!node.IsLeaf())
+			{
+				assert(top + 2 <= MaxBVHDepth);
+				stack[top++] = { node.leftFirst + 1, entry.mask };
+				stack[top++] = { node.leftFirst, entry.mask };
+				continue;
+			}
+
+			for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+			{
+				const uint32_t primitive = primitiveIndices[i];
+				uint32_t mask = entry.mask;
+				uint8_t rejectingPlane = 0;
+				if (mask == 0 || ClassifyAABB(frustum, primitiveBounds[primitive], mask, rejectingPlane))
+					visibleIndices[written++] = primitive;
+			}
+		}
+		return written;
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#ifndef _FRUSTUM_BATCH_H_
+#define _FRUSTUM_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "Frustum.h"
+#include "BVHNode.h"
+#include "../Cpu.h"
+#include "../Span.h"
+
+namespace odm
+{
+	/**
+	 * Table of culling kernels compiled for one instruction set tier.
+	 * Visibility bitmasks hold bit i % 32 of word i / 32 for object i; bits past the last object are cleared.
+	 */
+	struct FrustumKernels
+	{
+		SimdLevel level;
+
+		/** Sets the bit of every box that frustum.Intersects. */
+		void (*CullAABBs)(const Frustum& frustum, const AABB* boxes, size_t count, uint32_t* visibleBits);
+
+		/** Sets the bit of every sphere that frustum.Intersects. */
+		void (*CullSpheres)(const Frustum& frustum, const Sphere* spheres, size_t count, uint32_t* visibleBits);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const FrustumKernels& GetFrustumKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const FrustumKernels& GetFrustumKernels(SimdLevel level);
+
+	/**
+	 * Gets the number of words a visibility bitmask over count objects needs.
+	 * @param count Number of objects.
+	 */
+	constexpr size_t GetVisibilityWordCount(size_t count)
+	{
+		return (count + 31) / 32;
+	}
+
+	/**
+	 * Culls boxes against a frustum into a bitmask.
+	 * @param frustum The view volume.
+	 * @param boxes World space bounds of the objects.
+	 * @param visibleBits Receives one bit per box, set when the box may be visible; GetVisibilityWordCount(boxes.size()) words.
+	 */
+	void CullAABBs(const Frustum& frustum, Span<const AABB> boxes, Span<uint32_t> visibleBits);
+
+	/**
+	 * Culls boxes against a frustum into a compacted list.
+	 * @param frustum The view volume.
+	 * @param boxes World space bounds of the objects.
+	 * @param visibleIndices Receives the indices of the boxes that may be visible, in increasing order; as many as boxes.
+	 * @returns The number of indices written.
+	 */
+	size_t CullAABBsToIndices(const Frustum& frustum, Span<const AABB> boxes, Span<uint32_t> visibleIndices);
+
+	/**
+	 * Culls spheres against a frustum into a bitmask.
+	 * @param frustum The view volume.
+	 * @param spheres World space bounds of the objects.
+	 * @param visibleBits Receives one bit per sphere, set when the sphere may be visible; GetVisibilityWordCount(spheres.size()) words.
+	 */
+	void CullSpheres(const Frustum& frustum, Span<const Sphere> spheres, Span<uint32_t> visibleBits);
+
+	/**
+	 * Culls spheres against a frustum into a compacted list.
+	 * @param frustum The view volume.
+	 * @param spheres World space bounds of the objects.
+	 * @param visibleIndices Receives the indices of the spheres that may be visible, in increasing order; as many as spheres.
+	 * @returns The number of indices written.
+	 */
+	size_t CullSpheresToIndices(const Frustum& frustum, Span<const Sphere> spheres, Span<uint32_t> visibleIndices);
+
+	/**
+	 * Culls the primitives of a bounding volume hierarchy top-down.
+	 * Every node passes on the mask of planes its bounds straddle, so subtrees fully inside a plane never test it again
+	 * and fully visible subtrees are emitted without a single plane test.
+	 * @param frustum The view volume.
+	 * @param nodes Flattened hierarchy, root first, at most MaxBVHDepth levels deep.
+	 * @param primitiveIndices Object indices the leaf ranges refer to.
+	 * @param primitiveBounds Bounds of every object, tested in leaves that straddle the frustum.
+	 * @param planeCache One entry per node holding the plane that last rejected it, which is tested first on the next call.
+	 *                   Zero it once and keep it across frames, one cache per view.
+	 * @param visibleIndices Receives the indices of the objects that may be visible, in traversal order; as many as primitiveIndices.
+	 * @returns The number of indices written.
+	 */
+	size_t CullHierarchy(const Frustum& frustum, Span<const BVHNode> nodes, Span<const uint32_t> primitiveIndices, Span<const AABB> primitiveBounds,
+		Span<uint8_t> planeCache, Span<uint32_t> visibleIndices);
+}
+
+#endif /* end of include guard: _FRUSTUM_BATCH_H_ */
@@ -0,0 +1,183 @@
+#include "LooseOctree.h"
+
+#include <algorithm>
+
+namespace odm
+{
+	LooseOctree::LooseOctree(const AABB& worldBounds, uint32_t maxDepth, float looseness)
+		: m_Center(worldBounds.Center()), m_Looseness(looseness), m_MaxDepth(std::min(maxDepth, MaxDepth))
+	{
+		assert(looseness > 1.0f);
+		const vec3 extents = worldBounds.GetExtents();
+		m_HalfSize = std::max(std::max(extents.x, extents.y), extents.z);
+	}
+
+	uint32_t LooseOctree::AllocateNode(uint32_t parent, const vec3& center, float halfSize)
+	{
+		uint32_t nodeIndex = m_FreeNode;
+		if (nodeIndex == NullIndex)
+		{
+			m_Nodes.emplace_back();
+			nodeIndex = static_cast<uint32_t>(m_Nodes.size() - 1);
+		}
+		else
+		{
+			m_FreeNode = m_Nodes[nodeIndex].parent;
+		}
+
+		Node& node = m_Nodes[nodeIndex];
+		const vec3 looseExtents(halfSize * m_Looseness);
+		node.bounds = AABB(center - looseExtents, center + looseExtents);
+		node.center = center;
+		node.halfSize = halfSize;
+		node.parent = parent;
+		node.firstObject = NullIndex;
+		node.childMask = 0;
+		++m_NodeCount;
+		return nodeIndex;
+	}
+
+	void LooseOctree::FreeNode(uint32_t nodeIndex)
+	{
+		m_Nodes[nodeIndex].parent = m_FreeNode;
+		m_FreeNode = nodeIndex;
+		--m_NodeCount;
+	}
+
+	/** Gets the node an object belongs in, creating the nodes on the way down that do not exist yet. */
+	uint32_t LooseOctree::FindNode(const AABB& bounds)
+	{
+		if (m_Root == NullIndex)
+			m_Root = AllocateNode(NullIndex, m_Center, m_HalfSize);
+
+		const vec3 center = bounds.Center();
+		const vec3 extents = bounds.GetExtents();
+		const float radius = std::max(std::max(extents.x, extents.y), extents.z);
+		const vec3 offset = center - m_Center;
+		if (std::abs(offset.x) > m_HalfSize || std::abs(offset.y) > m_HalfSize || std::abs(offset.z) > m_HalfSize)
+			return m_Root;
+
+		// A cell holds the center, so the loose cell holds the whole object while it reaches no further than the loosening.
+		const float slack = m_Looseness - 1.0f;
+		uint32_t nodeIndex = m_Root;
+		for (uint32_t depth = 0; depth < m_MaxDepth; ++depth)
+		{
+			const Node& node = m_Nodes[nodeIndex];
+			const float childHalfSize = 0.5f * node.halfSize;
+			if (radius > slack * childHalfSize)
+				break;
+
+			const uint32_t octant = (center.x >= node.center.x ? 1u : 0u) | (center.y >= node.center.y ? 2u : 0u) | (center.z >= node.center.z ? 4u : 0u);
+			if (node.childMask & (1u << octant))
+			{
+				nodeIndex = node.children[octant];
+				continue;
+			}
+
+			const vec3 childCenter(node.center.x + (octant & 1 ? childHalfSize : -childHalfSize), node.center.y + (octant & 2 ? childHalfSize : -childHalfSize),
+				node.center.z + (octant & 4 ? childHalfSize : -childHalfSize));
+			const uint32_t child = AllocateNode(nodeIndex, childCenter, childHalfSize);
+			m_Nodes[nodeIndex].children[octant] = child;
+			m_Nodes[nodeIndex].childMask |= static_cast<uint8_t>(1u << octant);
+			nodeIndex = child;
+		}
+		return nodeIndex;
+	}
+
+	void LooseOctree::Link(uint32_t object, uint32_t nodeIndex)
+	{
+		Object& entry = m_Objects[object];
+		Node& node = m_Nodes[nodeIndex];
+		entry.node = nodeIndex;
+		entry.previous = NullIndex;
+		entry.next = node.firstObject;
+		if (node.firstObject != NullIndex)
+			m_Objects[node.firstObject].previous = object;
+		node.firstObject = object;
+	}
+
+	void LooseOctree::Unlink(uint32_t object)
+	{
+		Object& entry = m_Objects[object];
+		if (entry.previous != NullIndex)
+			m_Objects[entry.previous].next = entry.next;
+		else
+			m_Nodes[entry.node].firstObject = entry.next;
+		if (entry.next != NullIndex)
+			m_Objects[entry.next].previous = entry.previous;
+		entry.node = NullIndex;
+	}
+
+	/** Returns empty leaves to the pool, from nodeIndex up; the root stays. */
+	void LooseOctree::Prune(uint32_t nodeIndex)
+	{
+		while (nodeIndex != m_Root && m_Nodes[nodeIndex].firstObject == NullIndex && m_Nodes[nodeIndex].childMask == 0)
+		{
+			const uint32_t parent = m_Nodes[nodeIndex].parent;
+			Node& parentNode = m_Nodes[parent];
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				if ((parentNode.childMask & (1u << octant)) && parentNode.children[octant] == nodeIndex)
+					parentNode.childMask &= static_cast<uint8_t>(~(1u << octant));
+			}
+			FreeNode(nodeIndex);
+			nodeIndex = parent;
+		}
+	}
+
+	uint32_t LooseOctree::Insert(const AABB& bounds)
+	{
+		uint32_t object = m_FreeObject;
+		if (object == NullIndex)
+		{
+			m_Objects.emplace_back();
+			object = static_cast<uint32_t>(m_Objects.size() - 1);
+		}
+		else
+		{
+			m_FreeObject = m_Objects[object].next;
+		}
+
+		m_Objects[object].bounds = bounds;
+		Link(object, FindNode(bounds));
+		++m_ObjectCount;
+		return object;
+	}
+
+	void LooseOctree::Remove(uint32_t object)
+	{
+		assert(object < m_Objects.size() && m_Objects[object].node != NullIndex);
+		const uint32_t nodeIndex = m_Objects[object].node;
+		Unlink(object);
+		Prune(nodeIndex);
+		m_Objects[object].next = m_FreeObject;
+		m_FreeObject = object;
+		--m_ObjectCount;
+	}
+
+	void LooseOctree::Update(uint32_t object, const AABB& bounds)
+	{
+		assert(object < m_Objects.size() && m_Objects[object].node != NullIndex);
+		m_Objects[object].bounds = bounds;
+
+		const uint32_t current = m_Objects[object].node;
+		const uint32_t target = FindNode(bounds);
+		if (target == current)
+			return;
+
+		Unlink(object);
+		Link(object, target);
+		Prune(current);
+	}
+
+	void LooseOctree::Clear()
+	{
+		m_Nodes.clear();
+		m_Objects.clear();
+		m_Root = NullIndex;
+		m_FreeNode = NullIndex;
+		m_FreeObject = NullIndex;
+		m_NodeCount = 0;
+		m_ObjectCount = 0;
+	}
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#ifndef _LOOSE_OCTREE_H_
+#define _LOOSE_OCTREE_H_
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "AABB.h"
+#include "Frustum.h"
+#include "Ray.h"
+
+namespace odm
+{
+	/**
+	 * Octree whose cells are grown by a looseness factor, after Ulrich's loose octrees, for scenes mixing objects of very different sizes.
+	 * An object lives in exactly one node: the deepest whose loose cell is sure to hold it, chosen from its size and center alone.
+	 * Nodes never split or rebalance, so inserting, moving and removing an object costs a walk down the tree and nothing more.
+	 */
+	class LooseOctree
+	{
+	public:
+		static constexpr uint32_t NullIndex = UINT32_MAX;
+
+		/** Deepest level a tree may be given; 2^MaxDepth cells per axis is far beyond what floats place reliably. */
+		static constexpr uint32_t MaxDepth = 20;
+
+		/**
+		 * Constructs an empty tree.
+		 * @param worldBounds Region the tree covers; it is extended to a cube about its center. Objects outside go to the root.
+		 * @param maxDepth Number of levels below the root; the smallest cells are 2^maxDepth times smaller than the world.
+		 * @param looseness How far each cell's bounds are grown, as a multiple of its size; above 1, 2 is the common choice.
+		 */
+		explicit LooseOctree(const AABB& worldBounds, uint32_t maxDepth = 8, float looseness = 2.0f);
+
+		/**
+		 * Adds an object.
+		 * @param bounds Bounds of the object.
+		 * @returns The handle of the object, stable until it is removed; the handles of removed objects are reused.
+		 */
+		uint32_t Insert(const AABB& bounds);
+
+		/**
+		 * Removes an object; nodes left empty are returned to the pool.
+		 * @param object The handle returned by Insert.
+		 */
+		void Remove(uint32_t object);
+
+		/**
+		 * Updates the bounds of an object, moving it to another node only when its placement changes.
+		 * @param object The handle returned by Insert.
+		 * @param bounds New bounds of the object.
+		 */
+		void Update(uint32_t object, const AABB& bounds);
+
+		/** Removes every object and node, keeping the allocations. */
+		void Clear();
+
+		NODISCARD const AABB& GetBounds(uint32_t object) const
+		{
+			assert(object < m_Objects.size() && m_Objects[object].node != NullIndex);
+			return m_Objects[object].bounds;
+		}
+
+		NODISCARD uint32_t GetObjectCount() const { return m_ObjectCount; }
+		NODISCARD uint32_t GetNodeCount() const { return m_NodeCount; }
+		NODISCARD uint32_t GetMaxDepth() const { return m_MaxDepth; }
+		NODISCARD float GetLooseness() const { return m_Looseness; }
+
+		/**
+		 * Calls visitor(object) for every object whose bounds overlap a box, in the sense of AABB::Intersects.
+		 * @param box The query box.
+		 * @param visitor Returns false to stop the query.
+		 */
+		template <class Visitor>
+		void QueryBox(const AABB& box, Visitor&& visitor) const
+		{
+			Traverse([&](const Node& node, bool) { return node.bounds.Intersects(box); }, [&](uint32_t object, bool) {
+				return !m_Objects[object].bounds.Intersects(box) || visitor(object);
+			});
+		}
+
+		/**
+		 * Calls visitor(object) for every object whose bounds pass Frustum::Intersects.
+		 * Objects under a node that lies wholly inside the frustum are reported without testing them.
+		 * @param frustum The query frustum.
+		 * @param visitor Returns false to stop the query.
+		 */
+		template <class Visitor>
+		void QueryFrustum(const Frustum& frustum, Visitor&& visitor) const
+		{
+			Traverse([&](const Node& node, bool& inside) {
+				const FrustumSide side = Classify(frustum, node.bounds);
+				inside = side == FrustumSide::Inside;
+				return side != FrustumSide::Outside;
+			}, [&](uint32_t object, bool inside) {
+				return !(inside || frustum.Intersects(m_Objects[object].bounds)) || visitor(object);
+			});
+		}
+
+		/**
+		 * Calls visitor(object, t) for every object whose bounds a ray passes through, in no particular order.
+		 * t is the entry distance in Ray::GetDirection() lengths, 0 when the ray starts inside the bounds.
+		 * @param ray The ray.
+		 * @param visitor Returns false to stop the query.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored; 1 stops at the ray's end.
+		 */
+		template <class Visitor>
+		void QueryRay(const Ray& ray, Visitor&& visitor, float maxT = 1.0f) const
+		{
+			float tNear, tFar;
+			Traverse([&](const Node& node, bool) { return ray.Intersect(node.bounds, tNear, tFar, maxT); }, [&](uint32_t object, bool) {
+				return !ray.Intersect(m_Objects[object].bounds, tNear, tFar, maxT) || visitor(object, tNear);
+			});
+		}
+
+	private:
+		enum class FrustumSide
+		{
+			Outside,
+			Intersecting,
+			Inside
+		};
+
+		struct Node
+		{
+			AABB bounds;							// Loose bounds.
+			vec3 center;
+			float halfSize;							// Half the edge of the cell before loosening.
+			uint32_t parent = NullIndex;			// Next entry of the free list while the node is free.
+			uint32_t children[8];					// By octant: bit 0 set for +x, bit 1 for +y, bit 2 for +z.
+			uint32_t firstObject = NullIndex;
+			uint8_t childMask = 0;
+		};
+
+		struct Object
+		{
+			AABB bounds;
+			uint32_t node = NullIndex;				// NullIndex while the handle is free.
+			uint32_t previous = NullIndex;			// Neighbours in the node's list; next is the next free handle while free.
+			uint32_t next = NullIndex;
+		};
+
+		/**
+		 * Walks the nodes that pass a test, then their objects.
+		 * @param testNode bool(const Node&, bool& inside); may set inside, which then holds for the whole subtree.
+		 * @param visitObject bool(uint32_t object, bool inside); returns false to stop.
+		 */
+		template <class TestNode, class VisitObject>
+		void Traverse(const TestNode& testNode, const VisitObject& visitObject) const
+		{
+			if (m_Root == NullIndex)
+				return;
+
+			struct Entry
+			{
+				uint32_t node;
+				bool inside;
+			};
+
+			// The root keeps the objects that do not fit the world, so it is visited whatever its bounds.
+			Entry stack[7 * MaxDepth + 1];
+			size_t top = 0;
+			stack[top++] = { m_Root, false };
+			while (top != 0)
+			{
+				const Entry entry = stack[--top];
+				const Node& node = m_Nodes[entry.node];
+				bool inside = entry.inside;
+				if (!inside && entry.node != m_Root && !testNode(node, inside))
+					continue;
+
+				for (uint32_t object = node.firstObject; object != NullIndex; object = m_Objects[object].next)
+				{
+					if (!visitObject(object, inside))
+						return;
+				}
+				for (uint32_t octant = 0; octant < 8; ++octant)
+				{
+					if (node.childMask & (1u << octant))
+					{
+						assert(top < sizeof(stack) / sizeof(stack[0]));
+						stack[top++] = { node.children[octant], inside };
+					}
+				}
+			}
+		}
+
+		static FrustumSide Classify(const Frustum& frustum, const AABB& box)
+		{
+			const vec3 center = box.Center();
+			const vec3 extents = box.GetExtents();
+			FrustumSide side = FrustumSide::Inside;
+			for (const Plane& plane : frustum.planes)
+			{
+				const float radius = std::abs(plane.normal.x) * extents.x + std::abs(plane.normal.y) * extents.y + std::abs(plane.normal.z) * extents.z;
+				const float distance = plane.Distance(center);
+				if (distance + radius < 0.0f)
+					return FrustumSide::Outside;
+				if (distance - radius < 0.0f)
+					side = FrustumSide::Intersecting;
+			}
+			return side;
+		}
+
+		uint32_t AllocateNode(uint32_t parent, const vec3& center, float halfSize);
+		void FreeNode(uint32_t nodeIndex);
+		uint32_t FindNode(const AABB& bounds);
+		void Link(uint32_t object, uint32_t nodeIndex);
+		void Unlink(uint32_t object);
+		void Prune(uint32_t nodeIndex);
+
+		std::vector<Node> m_Nodes;
+		std::vector<Object> m_Objects;
+		vec3 m_Center;
+		float m_HalfSize;
+		float m_Looseness;
+		uint32_t m_MaxDepth;
+		uint32_t m_Root = NullIndex;
+		uint32_t m_FreeNode = NullIndex;
+		uint32_t m_FreeObject = NullIndex;
+		uint32_t m_NodeCount = 0;
+		uint32_t m_ObjectCount = 0;
+	};
+}
+
+#endif /* end of include guard: _LOOSE_OCTREE_H_ */
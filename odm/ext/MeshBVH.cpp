@@ -0,0 +1,454 @@
+#include "MeshBVH.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "BVH.h"
+#include "MeshBVH_batch.h"
+
+namespace odm
+{
+	/** Triangles per task when computing their bounds. */
+	static constexpr size_t BoundsChunkSize = 16384;
+
+	/** Triangles one leaf slot can reference, as its packet count is a byte. */
+	static constexpr uint32_t MaxSlotTriangles = UINT8_MAX * TrianglePacket4::Width;
+
+	/**
+	 * Levels CollapseRun may add under a binary leaf too large for one slot, e.g. one the binary build forced at MaxBVHDepth.
+	 * Each level splits a run eight ways, so eight levels cover any run of fewer than 2^32 triangles.
+	 */
+	static constexpr size_t MaxRunDepth = 8;
+
+	/** Entries the traversal stacks need: every level of the tree defers at most seven children. */
+	static constexpr size_t MaxStackSize = 7 * (MaxBVHDepth + MaxRunDepth) + 1;
+
+	static inline uint32_t IntersectChildren(const MeshBVHKernels& kernels, const Ray& ray, const MeshBVHNode8& node, float maxT, float* tNear)
+	{
+		return kernels.IntersectChildren8(ray, node, maxT, tNear);
+	}
+
+	static inline uint32_t IntersectChildren(const MeshBVHKernels& kernels, const Ray& ray, const MeshBVHNode16& node, float maxT, float* tNear)
+	{
+		return kernels.IntersectChildren16(ray, node, maxT, tNear);
+	}
+
+	static inline bool Overlaps(const AABB& a, const AABB& b)
+	{
+		return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y && a.min.z <= b.max.z && a.max.z >= b.min.z;
+	}
+
+	/** Picks the step of a node's child coordinates along one axis: the smallest power of two that spans the node in MaxQuantized steps. */
+	template <class Node>
+	static int8_t ChooseExponent(float origin, float max)
+	{
+		int exponent = -126;
+		if (max - origin > 0.0f)
+		{
+			std::frexp((max - origin) / static_cast<float>(Node::MaxQuantized), &exponent);
+			exponent = std::max(exponent, -126);
+		}
+		while (exponent < 127 && origin + static_cast<float>(Node::MaxQuantized) * std::ldexp(1.0f, exponent) < max)
+			++exponent;
+		return static_cast<int8_t>(exponent);
+	}
+
+	/** Sets a node's box: its children are coded relative to the minimum corner, in steps that span the box. */
+	template <class Node>
+	static void SetNodeBounds(Node& node, const AABB& bounds)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			node.origin[axis] = bounds.min[axis];
+			node.exponent[axis] = ChooseExponent<Node>(bounds.min[axis], bounds.max[axis]);
+		}
+	}
+
+	/** Codes the box of a child, rounded outwards, then nudged until the decoded value (as the traversal computes it) really encloses it. */
+	template <class Node>
+	static void SetChildBounds(Node& node, uint32_t slot, const AABB& bounds)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float origin = node.origin[axis], scale = node.GetScale(axis);
+			const auto decode = [&](uint32_t q) { return origin + static_cast<float>(q) * scale; };
+			const float maxQuantized = static_cast<float>(Node::MaxQuantized);
+			uint32_t lo = static_cast<uint32_t>(std::min(std::max(std::floor((bounds.min[axis] - origin) / scale), 0.0f), maxQuantized));
+			uint32_t hi = static_cast<uint32_t>(std::min(std::max(std::ceil((bounds.max[axis] - origin) / scale), 0.0f), maxQuantized));
+			while (lo > 0 && decode(lo) > bounds.min[axis])
+				--lo;
+			while (hi < Node::MaxQuantized && decode(hi) < bounds.max[axis])
+				++hi;
+			node.lo[axis][slot] = static_cast<typename Node::QuantizedType>(lo);
+			node.hi[axis][slot] = static_cast<typename Node::QuantizedType>(hi);
+		}
+	}
+
+	/** The binary hierarchy being collapsed, with the run of leaf-ordered triangles under each of its nodes. */
+	struct MeshBVH::BuildContext
+	{
+		Span<const BVHNode> nodes;
+		Span<const uint32_t> indices;
+		Span<const Triangle> triangles;
+		std::vector<uint32_t> firsts;
+		std::vector<uint32_t> counts;
+
+		BuildContext(const BVH& binary, Span<const Triangle> meshTriangles)
+			: nodes(binary.GetNodes()), indices(binary.GetPrimitiveIndices()), triangles(meshTriangles), firsts(nodes.size()), counts(nodes.size())
+		{
+			MeasureSubtree(0);
+		}
+
+		/** Subtrees small enough for one packet become a single leaf, however the binary build split them. */
+		NODISCARD bool IsLeaf(uint32_t node) const { return nodes[node].IsLeaf() || counts[node] <= TrianglePacket4::Width; }
+
+		/** Whether a node becomes a leaf slot; larger leaves are spread over nodes of their own by CollapseRun. */
+		NODISCARD bool FitsSlot(uint32_t node) const { return IsLeaf(node) && counts[node] <= MaxSlotTriangles; }
+
+		/** Gets the bounds of a run of leaf-ordered triangles. */
+		NODISCARD AABB GetRunBounds(uint32_t first, uint32_t count) const
+		{
+			AABB bounds = triangles[indices[first]].GetBounds();
+			for (uint32_t i = first + 1; i < first + count; ++i)
+				bounds.Add(triangles[indices[i]].GetBounds());
+			return bounds;
+		}
+
+	private:
+		// The binary build partitions its index array in place, so every subtree covers one contiguous run of it.
+		void MeasureSubtree(uint32_t node)
+		{
+			if (nodes[node].IsLeaf())
+			{
+				firsts[node] = nodes[node].leftFirst;
+				counts[node] = nodes[node].count;
+				return;
+			}
+
+			const uint32_t left = nodes[node].leftFirst;
+			MeasureSubtree(left);
+			MeasureSubtree(left + 1);
+			firsts[node] = std::min(firsts[left], firsts[left + 1]);
+			counts[node] = counts[left] + counts[left + 1];
+		}
+	};
+
+	MeshBVH::MeshBVH(Span<const Triangle> triangles, MeshBVHPrecision precision, TaskScheduler* scheduler)
+	{
+		Build(triangles, precision, scheduler);
+	}
+
+	void MeshBVH::Build(Span<const vec3> vertices, Span<const uint32_t> indices, MeshBVHPrecision precision, TaskScheduler* scheduler)
+	{
+		assert(indices.size() % 3 == 0);
+		std::vector<Triangle> triangles(indices.size() / 3);
+		for (size_t i = 0; i < triangles.size(); ++i)
+		{
+			assert(indices[3 * i] < vertices.size() && indices[3 * i + 1] < vertices.size() && indices[3 * i + 2] < vertices.size());
+			triangles[i] = Triangle(vertices[indices[3 * i]], vertices[indices[3 * i + 1]], vertices[indices[3 * i + 2]]);
+		}
+		Build(Span<const Triangle>(triangles.data(), triangles.size()), precision, scheduler);
+	}
+
+	void MeshBVH::Build(Span<const Triangle> triangles, MeshBVHPrecision precision, TaskScheduler* scheduler)
+	{
+		Clear();
+		m_Precision = precision;
+		if (triangles.empty())
+			return;
+
+		assert(triangles.size() < UINT32_MAX);
+		std::vector<AABB> bounds(triangles.size());
+		ParallelForChunks(scheduler, triangles.size(), BoundsChunkSize, [&](uint32_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				bounds[i] = triangles[i].GetBounds();
+		});
+
+		// The binary tree decides the grouping; collapsing it drops levels and merges small subtrees, so the SAH build is reused as it is.
+		const BVH binary(Span<const AABB>(bounds.data(), bounds.size()), scheduler);
+		BuildContext context(binary, triangles);
+		m_Bounds = binary.GetBounds();
+		m_TriangleCount = triangles.size();
+		if (precision == MeshBVHPrecision::Bits8)
+		{
+			m_Nodes8.emplace_back();
+			Collapse(context, m_Nodes8, 0, 0);
+		}
+		else
+		{
+			m_Nodes16.emplace_back();
+			Collapse(context, m_Nodes16, 0, 0);
+		}
+	}
+
+	template <class Node>
+	void MeshBVH::Collapse(const BuildContext& context, std::vector<Node>& nodes, uint32_t nodeIndex, uint32_t binaryIndex)
+	{
+		// Gather up to eight descendants, opening the largest interior one first since rays enter it most often.
+		uint32_t slots[8];
+		uint32_t slotCount = 0;
+		const BVHNode& source = context.nodes[binaryIndex];
+		if (context.IsLeaf(binaryIndex))
+		{
+			slots[slotCount++] = binaryIndex;
+		}
+		else
+		{
+			slots[slotCount++] = source.leftFirst;
+			slots[slotCount++] = source.leftFirst + 1;
+			while (slotCount < 8)
+			{
+				uint32_t opened = slotCount;
+				float largestArea = -1.0f;
+				for (uint32_t slot = 0; slot < slotCount; ++slot)
+				{
+					const float area = context.nodes[slots[slot]].bounds.GetSurfaceArea();
+					if (!context.IsLeaf(slots[slot]) && area > largestArea)
+					{
+						opened = slot;
+						largestArea = area;
+					}
+				}
+				if (opened == slotCount)
+					break;
+
+				const uint32_t left = context.nodes[slots[opened]].leftFirst;
+				slots[opened] = left;
+				slots[slotCount++] = left + 1;
+			}
+		}
+
+		Node node = {};
+		SetNodeBounds(node, source.bounds);
+		node.firstChild = static_cast<uint32_t>(nodes.size());
+		node.firstPacket = static_cast<uint32_t>(m_Packets.size());
+
+		uint32_t innerCount = 0;
+		for (uint32_t slot = 0; slot < slotCount; ++slot)
+		{
+			SetChildBounds(node, slot, context.nodes[slots[slot]].bounds);
+			if (!context.FitsSlot(slots[slot]))
+			{
+				node.innerMask |= static_cast<uint8_t>(1u << slot);
+				++innerCount;
+				continue;
+			}
+
+			const uint32_t count = context.counts[slots[slot]];
+			node.packetCounts[slot] = static_cast<uint8_t>((count + TrianglePacket4::Width - 1) / TrianglePacket4::Width);
+			EmitPackets(context, context.firsts[slots[slot]], count);
+		}
+
+		// The inner children take consecutive nodes, so the parent only needs the first.
+		nodes.resize(nodes.size() + innerCount);
+		nodes[nodeIndex] = node;
+		for (uint32_t slot = 0, child = node.firstChild; slot < slotCount; ++slot)
+		{
+			if (!(node.innerMask & (1u << slot)))
+				continue;
+
+			if (context.IsLeaf(slots[slot]))
+				CollapseRun(context, nodes, child++, context.firsts[slots[slot]], context.counts[slots[slot]]);
+			else
+				Collapse(context, nodes, child++, slots[slot]);
+		}
+	}
+
+	template <class Node>
+	void MeshBVH::CollapseRun(const BuildContext& context, std::vector<Node>& nodes, uint32_t nodeIndex, uint32_t first, uint32_t count)
+	{
+		// Up to eight pieces of whole packets, in leaf order; a piece still too large for a slot gets a node of its own.
+		const uint32_t pieceSize = ((count + 7) / 8 + TrianglePacket4::Width - 1) / TrianglePacket4::Width * TrianglePacket4::Width;
+		Node node = {};
+		SetNodeBounds(node, context.GetRunBounds(first, count));
+		node.firstChild = static_cast<uint32_t>(nodes.size());
+		node.firstPacket = static_cast<uint32_t>(m_Packets.size());
+
+		uint32_t innerCount = 0;
+		for (uint32_t slot = 0, offset = 0; offset < count; ++slot, offset += pieceSize)
+		{
+			const uint32_t pieceCount = std::min(pieceSize, count - offset);
+			SetChildBounds(node, slot, context.GetRunBounds(first + offset, pieceCount));
+			if (pieceCount > MaxSlotTriangles)
+			{
+				node.innerMask |= static_cast<uint8_t>(1u << slot);
+				++innerCount;
+				continue;
+			}
+
+			node.packetCounts[slot] = static_cast<uint8_t>((pieceCount + TrianglePacket4::Width - 1) / TrianglePacket4::Width);
+			EmitPackets(context, first + offset, pieceCount);
+		}
+
+		nodes.resize(nodes.size() + innerCount);
+		nodes[nodeIndex] = node;
+		for (uint32_t slot = 0, offset = 0, child = node.firstChild; offset < count; ++slot, offset += pieceSize)
+		{
+			if (node.innerMask & (1u << slot))
+				CollapseRun(context, nodes, child++, first + offset, std::min(pieceSize, count - offset));
+		}
+	}
+
+	void MeshBVH::EmitPackets(const BuildContext& context, uint32_t first, uint32_t count)
+	{
+		for (uint32_t offset = 0; offset < count; offset += TrianglePacket4::Width)
+		{
+			Triangle packet[TrianglePacket4::Width];
+			const uint32_t packed = std::min<uint32_t>(count - offset, TrianglePacket4::Width);
+			for (uint32_t lane = 0; lane < TrianglePacket4::Width; ++lane)
+			{
+				const uint32_t triangle = lane < packed ? context.indices[first + offset + lane] : UINT32_MAX;
+				if (lane < packed)
+					packet[lane] = context.triangles[triangle];
+				m_TriangleIndices.push_back(triangle);
+			}
+			m_Packets.emplace_back(Span<const Triangle>(packet, packed));
+		}
+	}
+
+	void MeshBVH::Clear()
+	{
+		m_Nodes8.clear();
+		m_Nodes16.clear();
+		m_Packets.clear();
+		m_TriangleIndices.clear();
+		m_Bounds = AABB();
+		m_TriangleCount = 0;
+	}
+
+	template <class Node>
+	bool MeshBVH::Raycast(const std::vector<Node>& nodes, const Ray& ray, MeshRayHit* hit, float maxT) const
+	{
+		const MeshBVHKernels& kernels = GetMeshBVHKernels();
+		const TriangleKernels& triangleKernels = GetTriangleKernels();
+		const RayShear shear(ray);
+		MeshRayHit best;
+		best.t = maxT;
+
+		// A node entry has no packets; a leaf entry references a run of them.
+		struct Entry
+		{
+			uint32_t index;
+			uint32_t packetCount;
+			float t;
+		};
+		Entry stack[MaxStackSize];
+		size_t top = 0;
+		stack[top++] = { 0, 0, 0.0f };
+
+		while (top != 0)
+		{
+			const Entry entry = stack[--top];
+			if (entry.t > best.t)
+				continue;
+
+			if (entry.packetCount != 0)
+			{
+				for (uint32_t packet = entry.index; packet < entry.index + entry.packetCount; ++packet)
+				{
+					TrianglePacketHits4 hits;
+					const uint32_t mask = triangleKernels.IntersectWatertight4(ray, shear, m_Packets[packet], best.t, hits);
+					for (uint32_t lane = 0; lane < 4; ++lane)
+					{
+						if (!(mask & (1u << lane)))
+							continue;
+						if (hit == nullptr)
+							return true;
+
+						const uint32_t triangle = m_TriangleIndices[4 * packet + lane];
+						if (hits.t[lane] < best.t || (hits.t[lane] == best.t && triangle < best.triangle))
+							best = MeshRayHit{ triangle, hits.t[lane], hits.u[lane], hits.v[lane] };
+					}
+				}
+				continue;
+			}
+
+			const Node& node = nodes[entry.index];
+			float tNear[8];
+			const uint32_t mask = IntersectChildren(kernels, ray, node, best.t, tNear);
+
+			// Push the hit children farthest first, so the nearest is visited next and its hits prune the rest.
+			Entry children[8];
+			uint32_t childCount = 0;
+			for (uint32_t slot = 0, child = node.firstChild, packet = node.firstPacket; slot < 8; ++slot)
+			{
+				const bool inner = (node.innerMask & (1u << slot)) != 0;
+				if (mask & (1u << slot))
+				{
+					Entry next{ inner ? child : packet, node.packetCounts[slot], tNear[slot] };
+					uint32_t position = childCount++;
+					for (; position > 0 && children[position - 1].t < next.t; --position)
+						children[position] = children[position - 1];
+					children[position] = next;
+				}
+				child += inner ? 1 : 0;
+				packet += node.packetCounts[slot];
+			}
+
+			assert(top + childCount <= MaxStackSize);
+			for (uint32_t i = 0; i < childCount; ++i)
+				stack[top++] = children[i];
+		}
+
+		if (hit == nullptr || best.triangle == UINT32_MAX)
+			return false;
+		*hit = best;
+		return true;
+	}
+
+	bool MeshBVH::RaycastClosest(const Ray& ray, MeshRayHit& hit, float maxT) const
+	{
+		if (IsEmpty())
+			return false;
+		return m_Precision == MeshBVHPrecision::Bits8 ? Raycast(m_Nodes8, ray, &hit, maxT) : Raycast(m_Nodes16, ray, &hit, maxT);
+	}
+
+	bool MeshBVH::RaycastAny(const Ray& ray, float maxT) const
+	{
+		if (IsEmpty())
+			return false;
+		return m_Precision == MeshBVHPrecision::Bits8 ? Raycast(m_Nodes8, ray, nullptr, maxT) : Raycast(m_Nodes16, ray, nullptr, maxT);
+	}
+
+	template <class Node>
+	void MeshBVH::QueryOverlap(const std::vector<Node>& nodes, const AABB& box, std::vector<uint32_t>& results) const
+	{
+		uint32_t stack[MaxStackSize];
+		size_t top = 0;
+		stack[top++] = 0;
+		while (top != 0)
+		{
+			const Node& node = nodes[stack[--top]];
+			for (uint32_t slot = 0, child = node.firstChild, packet = node.firstPacket; slot < 8; ++slot)
+			{
+				const bool inner = (node.innerMask & (1u << slot)) != 0;
+				const uint32_t packetCount = node.packetCounts[slot];
+				if ((inner || packetCount != 0) && Overlaps(node.GetChildBounds(slot), box))
+				{
+					if (inner)
+					{
+						assert(top < MaxStackSize);
+						stack[top++] = child;
+					}
+					for (uint32_t entry = 4 * packet; entry < 4 * (packet + packetCount); ++entry)
+					{
+						if (m_TriangleIndices[entry] != UINT32_MAX && Overlaps(m_Packets[entry / 4].GetTriangle(entry % 4).GetBounds(), box))
+							results.push_back(m_TriangleIndices[entry]);
+					}
+				}
+				child += inner ? 1 : 0;
+				packet += packetCount;
+			}
+		}
+	}
+
+	void MeshBVH::QueryOverlap(const AABB& box, std::vector<uint32_t>& results) const
+	{
+		if (IsEmpty())
+			return;
+		if (m_Precision == MeshBVHPrecision::Bits8)
+			QueryOverlap(m_Nodes8, box, results);
+		else
+			QueryOverlap(m_Nodes16, box, results);
+	}
+}
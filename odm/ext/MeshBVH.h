@@ -0,0 +1,207 @@
+#pragma once
+
+#ifndef _MESH_BVH_H_
+#define _MESH_BVH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "BVHNode.h"
+#include "Triangle_batch.h"
+#include "../Span.h"
+#include "../TaskScheduler.h"
+
+namespace odm
+{
+	/** Width of the child coordinates of a MeshBVH node. */
+	enum class MeshBVHPrecision
+	{
+		Bits8,		// 80-byte nodes; children may come out up to 1/255 of their parent larger on each side.
+		Bits16		// 128-byte nodes; for meshes whose long thin triangles make the coarser boxes overlap much.
+	};
+
+	/**
+	 * Node of a MeshBVH with up to eight children, whose boxes are stored relative to the node's own box.
+	 * Coordinates step in powers of two, so origin + q * 2^exponent is exact up to the final addition, and children are
+	 * rounded outwards to whole steps; a decoded child therefore always contains the child it stands for.
+	 */
+	template <class Quantized>
+	struct MeshBVHNode
+	{
+		using QuantizedType = Quantized;
+		static constexpr uint32_t MaxQuantized = std::numeric_limits<Quantized>::max();
+
+		float origin[3];				// Minimum corner of the node's box.
+		int8_t exponent[3];				// Child coordinates count steps of 2^exponent along each axis.
+		uint8_t innerMask;				// Bit i set when child i is a node.
+		uint32_t firstChild;			// Node of the first inner child; the others follow in slot order.
+		uint32_t firstPacket;			// Packet of the first leaf child; the packets of the others follow in slot order.
+		uint8_t packetCounts[8];		// Packets of each leaf child; 0 for inner and unused slots.
+		Quantized lo[3][8];				// Minimum corner of each child, indexed [axis][slot].
+		Quantized hi[3][8];				// Maximum corner of each child.
+
+		/** Gets the step of the child coordinates along an axis. */
+		NODISCARD float GetScale(int axis) const
+		{
+			const uint32_t bits = static_cast<uint32_t>(exponent[axis] + 127) << 23;
+			float scale;
+			std::memcpy(&scale, &bits, sizeof(scale));
+			return scale;
+		}
+
+		/** Gets the slots holding a child, as a mask. */
+		NODISCARD uint32_t GetChildMask() const
+		{
+			uint32_t mask = innerMask;
+			for (uint32_t slot = 0; slot < 8; ++slot)
+				mask |= packetCounts[slot] != 0 ? 1u << slot : 0u;
+			return mask;
+		}
+
+		/** Gets the decoded box of a child, which contains the child's true box. */
+		NODISCARD AABB GetChildBounds(uint32_t slot) const
+		{
+			vec3 min, max;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				min[axis] = origin[axis] + static_cast<float>(lo[axis][slot]) * GetScale(axis);
+				max[axis] = origin[axis] + static_cast<float>(hi[axis][slot]) * GetScale(axis);
+			}
+			return AABB(min, max);
+		}
+	};
+
+	using MeshBVHNode8 = MeshBVHNode<uint8_t>;
+	using MeshBVHNode16 = MeshBVHNode<uint16_t>;
+
+	static_assert(sizeof(MeshBVHNode8) == 80, "MeshBVHNode8 is expected to pack into 80 bytes");
+	static_assert(sizeof(MeshBVHNode16) == 128, "MeshBVHNode16 is expected to pack into 128 bytes");
+
+	/** Result of MeshBVH::RaycastClosest. */
+	struct MeshRayHit
+	{
+		uint32_t triangle = UINT32_MAX;		// Index of the triangle that was hit, into the mesh the hierarchy was built from.
+		float t = INFINITY;					// Distance along the ray in units of Ray::GetDirection().
+		float u = 0.0f;						// Barycentric weight of the triangle's v1.
+		float v = 0.0f;						// Barycentric weight of the triangle's v2.
+	};
+
+	/**
+	 * Bounding volume hierarchy over the triangles of a static mesh, for ray casts and overlap queries against level geometry.
+	 * It is built as a binary SAH hierarchy and collapsed into nodes of up to eight children whose boxes are quantized to
+	 * 8 or 16 bits, which cuts the node memory read per step of a traversal by a factor of three or more. Leaves hold
+	 * TrianglePacket4 blocks, which the ray casts test four triangles at a time with the watertight test.
+	 */
+	class MeshBVH
+	{
+	public:
+		/** Constructs an empty hierarchy. */
+		MeshBVH() = default;
+
+		/**
+		 * Constructs the hierarchy of a triangle soup.
+		 * @param triangles The triangles; the hierarchy keeps its own copy in its packets.
+		 * @param precision Width of the quantized child boxes.
+		 * @param scheduler Runs the binary build on several threads when given.
+		 */
+		explicit MeshBVH(Span<const Triangle> triangles, MeshBVHPrecision precision = MeshBVHPrecision::Bits8, TaskScheduler* scheduler = nullptr);
+
+		/**
+		 * Rebuilds the hierarchy from a triangle soup.
+		 * The tree is the same for the same triangles whatever the scheduler and its thread count, or without one.
+		 * @param triangles The triangles; an empty span clears the hierarchy.
+		 * @param precision Width of the quantized child boxes.
+		 * @param scheduler Runs the binary build on several threads when given.
+		 */
+		void Build(Span<const Triangle> triangles, MeshBVHPrecision precision = MeshBVHPrecision::Bits8, TaskScheduler* scheduler = nullptr);
+
+		/**
+		 * Rebuilds the hierarchy from an indexed mesh; triangle i is made of the vertices at indices 3i, 3i + 1 and 3i + 2.
+		 * @param vertices The vertex positions.
+		 * @param indices Three vertex indices per triangle.
+		 * @param precision Width of the quantized child boxes.
+		 * @param scheduler Runs the binary build on several threads when given.
+		 */
+		void Build(Span<const vec3> vertices, Span<const uint32_t> indices, MeshBVHPrecision precision = MeshBVHPrecision::Bits8,
+			TaskScheduler* scheduler = nullptr);
+
+		/** Releases the nodes and packets. */
+		void Clear();
+
+		NODISCARD bool IsEmpty() const { return m_Packets.empty(); }
+		NODISCARD MeshBVHPrecision GetPrecision() const { return m_Precision; }
+		NODISCARD size_t GetNodeCount() const { return m_Precision == MeshBVHPrecision::Bits8 ? m_Nodes8.size() : m_Nodes16.size(); }
+		NODISCARD size_t GetPacketCount() const { return m_Packets.size(); }
+		NODISCARD size_t GetTriangleCount() const { return m_TriangleCount; }
+
+		/** Gets the bytes taken by the nodes, the part of the hierarchy a traversal reads at every step. */
+		NODISCARD size_t GetNodeMemory() const { return m_Nodes8.size() * sizeof(MeshBVHNode8) + m_Nodes16.size() * sizeof(MeshBVHNode16); }
+
+		/** Gets the nodes, root first, when built with MeshBVHPrecision::Bits8. */
+		NODISCARD Span<const MeshBVHNode8> GetNodes8() const { return Span<const MeshBVHNode8>(m_Nodes8.data(), m_Nodes8.size()); }
+
+		/** Gets the nodes, root first, when built with MeshBVHPrecision::Bits16. */
+		NODISCARD Span<const MeshBVHNode16> GetNodes16() const { return Span<const MeshBVHNode16>(m_Nodes16.data(), m_Nodes16.size()); }
+
+		/** Gets the triangle packets the leaves reference. */
+		NODISCARD Span<const TrianglePacket4> GetPackets() const { return Span<const TrianglePacket4>(m_Packets.data(), m_Packets.size()); }
+
+		/** Gets the original index of the triangle in each lane of the packets, four per packet; UINT32_MAX for empty lanes. */
+		NODISCARD Span<const uint32_t> GetTriangleIndices() const { return Span<const uint32_t>(m_TriangleIndices.data(), m_TriangleIndices.size()); }
+
+		/** Gets the bounds of the whole mesh. */
+		NODISCARD AABB GetBounds() const { return m_Bounds; }
+
+		/**
+		 * Finds the first triangle along a ray with the watertight test, so rays cannot slip between neighbouring triangles.
+		 * @param ray The ray; both faces of a triangle are hit.
+		 * @param hit Receives the nearest triangle, its distance and barycentrics; left untouched on a miss. Ties go to the lower index.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored; 1 stops at the ray's end.
+		 * @returns Whether a triangle was hit.
+		 */
+		bool RaycastClosest(const Ray& ray, MeshRayHit& hit, float maxT = 1.0f) const;
+
+		/**
+		 * Tests whether any triangle blocks a ray, e.g. for line of sight; stops at the first hit found.
+		 * @param ray The ray.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored; 1 stops at the ray's end.
+		 */
+		NODISCARD bool RaycastAny(const Ray& ray, float maxT = 1.0f) const;
+
+		/**
+		 * Finds the triangles whose bounds overlap a box, touching included, e.g. the candidates of a narrowphase.
+		 * @param box The query box.
+		 * @param results Receives the indices of the triangles; appended to, not cleared.
+		 */
+		void QueryOverlap(const AABB& box, std::vector<uint32_t>& results) const;
+
+	private:
+		struct BuildContext;
+
+		template <class Node>
+		void Collapse(const BuildContext& context, std::vector<Node>& nodes, uint32_t nodeIndex, uint32_t binaryIndex);
+
+		template <class Node>
+		void CollapseRun(const BuildContext& context, std::vector<Node>& nodes, uint32_t nodeIndex, uint32_t first, uint32_t count);
+
+		void EmitPackets(const BuildContext& context, uint32_t first, uint32_t count);
+
+		template <class Node>
+		bool Raycast(const std::vector<Node>& nodes, const Ray& ray, MeshRayHit* hit, float maxT) const;
+
+		template <class Node>
+		void QueryOverlap(const std::vector<Node>& nodes, const AABB& box, std::vector<uint32_t>& results) const;
+
+		std::vector<MeshBVHNode8> m_Nodes8;			// Used when built with MeshBVHPrecision::Bits8.
+		std::vector<MeshBVHNode16> m_Nodes16;		// Used when built with MeshBVHPrecision::Bits16.
+		std::vector<TrianglePacket4> m_Packets;
+		std::vector<uint32_t> m_TriangleIndices;	// Original triangle index of each packet lane.
+		AABB m_Bounds;
+		size_t m_TriangleCount = 0;
+		MeshBVHPrecision m_Precision = MeshBVHPrecision::Bits8;
+	};
+}
+
+#endif /* end of include guard: _MESH_BVH_H_ */
@@ -0,0 +1,178 @@
+#include "MeshBVH_batch.h"
+
+#include <cassert>
+#include "../Simd.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	/** Sets the distance of the slots without a child to INFINITY and drops them from the mask. */
+	static inline uint32_t MaskUnusedSlots(uint32_t mask, uint32_t childMask, float* tNear)
+	{
+		for (uint32_t slot = 0; slot < 8; ++slot)
+		{
+			if (!(childMask & (1u << slot)))
+				tNear[slot] = INFINITY;
+		}
+		return mask & childMask;
+	}
+
+#if ODM_SIMD_SSE
+
+	/** Lanes of b where mask is set, else of a; SSE2 has no blend. */
+	static inline __m128 Select4(__m128 a, __m128 b, __m128 mask)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+	}
+
+	/** Widens eight quantized coordinates to two registers of four floats. */
+	static inline void LoadQuantized(const uint8_t* q, __m128& low, __m128& high)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i words = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(q)), zero);
+		low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+		high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero));
+	}
+
+	static inline void LoadQuantized(const uint16_t* q, __m128& low, __m128& high)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+		low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+		high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero));
+	}
+
+	/** Ray::Intersect against MeshBVHNode::GetChildBounds of all eight slots, in the same operations and order. */
+	template <class Quantized>
+	static uint32_t IntersectChildrenSSE(const Ray& ray, const MeshBVHNode<Quantized>& node, float maxT, float* tNear)
+	{
+		__m128 lo[3][2], hi[3][2];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const __m128 origin = _mm_set1_ps(node.origin[axis]), scale = _mm_set1_ps(node.GetScale(axis));
+			__m128 low, high;
+			LoadQuantized(node.lo[axis], low, high);
+			lo[axis][0] = _mm_add_ps(origin, _mm_mul_ps(low, scale));
+			lo[axis][1] = _mm_add_ps(origin, _mm_mul_ps(high, scale));
+			LoadQuantized(node.hi[axis], low, high);
+			hi[axis][0] = _mm_add_ps(origin, _mm_mul_ps(low, scale));
+			hi[axis][1] = _mm_add_ps(origin, _mm_mul_ps(high, scale));
+		}
+
+		const vec3& start = ray.GetStart();
+		const vec3& inverse = ray.GetInverseDirection();
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 ox = _mm_set1_ps(start.x), oy = _mm_set1_ps(start.y), oz = _mm_set1_ps(start.z);
+		const __m128 ix = _mm_set1_ps(inverse.x), iy = _mm_set1_ps(inverse.y), iz = _mm_set1_ps(inverse.z);
+		uint32_t mask = 0;
+		for (int half = 0; half < 2; ++half)
+		{
+			const __m128 x0 = _mm_mul_ps(_mm_sub_ps(ray.GetSign(0) ? hi[0][half] : lo[0][half], ox), ix);
+			const __m128 x1 = _mm_mul_ps(_mm_sub_ps(ray.GetSign(0) ? lo[0][half] : hi[0][half], ox), ix);
+			const __m128 y0 = _mm_mul_ps(_mm_sub_ps(ray.GetSign(1) ? hi[1][half] : lo[1][half], oy), iy);
+			const __m128 y1 = _mm_mul_ps(_mm_sub_ps(ray.GetSign(1) ? lo[1][half] : hi[1][half], oy), iy);
+			const __m128 z0 = _mm_mul_ps(_mm_sub_ps(ray.GetSign(2) ? hi[2][half] : lo[2][half], oz), iz);
+			const __m128 z1 = _mm_mul_ps(_mm_sub_ps(ray.GetSign(2) ? lo[2][half] : hi[2][half], oz), iz);
+			const __m128 tMin = _mm_max_ps(x0, _mm_max_ps(y0, _mm_max_ps(z0, zero)));
+			const __m128 tMax = _mm_min_ps(x1, _mm_min_ps(y1, _mm_min_ps(z1, _mm_set1_ps(maxT))));
+			const __m128 hit = _mm_cmple_ps(tMin, tMax);
+			_mm_storeu_ps(tNear + 4 * half, Select4(_mm_set1_ps(INFINITY), tMin, hit));
+			mask |= static_cast<uint32_t>(_mm_movemask_ps(hit)) << (4 * half);
+		}
+		return MaskUnusedSlots(mask, node.GetChildMask(), tNear);
+	}
+
+	static const MeshBVHKernels s_BaselineKernels = { SimdLevel::Baseline, &IntersectChildrenSSE<uint8_t>, &IntersectChildrenSSE<uint16_t> };
+
+#pragma region AVX2
+
+	ODM_TARGET("avx2,fma")
+	static inline __m256 LoadQuantizedAVX2(const uint8_t* q)
+	{
+		return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(q))));
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline __m256 LoadQuantizedAVX2(const uint16_t* q)
+	{
+		return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(q))));
+	}
+
+	// Contracting origin + q * scale into an FMA changes nothing: the product of an integer below 2^16 and a power of two is exact.
+	template <class Quantized>
+	ODM_TARGET("avx2,fma")
+	static uint32_t IntersectChildrenAVX2(const Ray& ray, const MeshBVHNode<Quantized>& node, float maxT, float* tNear)
+	{
+		__m256 lo[3], hi[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const __m256 origin = _mm256_set1_ps(node.origin[axis]), scale = _mm256_set1_ps(node.GetScale(axis));
+			lo[axis] = _mm256_add_ps(origin, _mm256_mul_ps(LoadQuantizedAVX2(node.lo[axis]), scale));
+			hi[axis] = _mm256_add_ps(origin, _mm256_mul_ps(LoadQuantizedAVX2(node.hi[axis]), scale));
+		}
+
+		const vec3& start = ray.GetStart();
+		const vec3& inverse = ray.GetInverseDirection();
+		const __m256 ox = _mm256_set1_ps(start.x), oy = _mm256_set1_ps(start.y), oz = _mm256_set1_ps(start.z);
+		const __m256 ix = _mm256_set1_ps(inverse.x), iy = _mm256_set1_ps(inverse.y), iz = _mm256_set1_ps(inverse.z);
+		const __m256 x0 = _mm256_mul_ps(_mm256_sub_ps(ray.GetSign(0) ? hi[0] : lo[0], ox), ix);
+		const __m256 x1 = _mm256_mul_ps(_mm256_sub_ps(ray.GetSign(0) ? lo[0] : hi[0], ox), ix);
+		const __m256 y0 = _mm256_mul_ps(_mm256_sub_ps(ray.GetSign(1) ? hi[1] : lo[1], oy), iy);
+		const __m256 y1 = _mm256_mul_ps(_mm256_sub_ps(ray.GetSign(1) ? lo[1] : hi[1], oy), iy);
+		const __m256 z0 = _mm256_mul_ps(_mm256_sub_ps(ray.GetSign(2) ? hi[2] : lo[2], oz), iz);
+		const __m256 z1 = _mm256_mul_ps(_mm256_sub_ps(ray.GetSign(2) ? lo[2] : hi[2], oz), iz);
+		const __m256 tMin = _mm256_max_ps(x0, _mm256_max_ps(y0, _mm256_max_ps(z0, _mm256_setzero_ps())));
+		const __m256 tMax = _mm256_min_ps(x1, _mm256_min_ps(y1, _mm256_min_ps(z1, _mm256_set1_ps(maxT))));
+		const __m256 hit = _mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ);
+		_mm256_storeu_ps(tNear, _mm256_blendv_ps(_mm256_set1_ps(INFINITY), tMin, hit));
+		return MaskUnusedSlots(static_cast<uint32_t>(_mm256_movemask_ps(hit)), node.GetChildMask(), tNear);
+	}
+
+	// AVX-512 shares these kernels; a node has eight children, which one AVX2 register already covers.
+	static const MeshBVHKernels s_AVX2Kernels = { SimdLevel::AVX2, &IntersectChildrenAVX2<uint8_t>, &IntersectChildrenAVX2<uint16_t> };
+
+#pragma endregion
+#else
+
+	template <class Quantized>
+	static uint32_t IntersectChildrenBaseline(const Ray& ray, const MeshBVHNode<Quantized>& node, float maxT, float* tNear)
+	{
+		uint32_t mask = 0;
+		for (uint32_t slot = 0; slot < 8; ++slot)
+		{
+			float tMin, tMax;
+			const bool hit = ray.Intersect(node.GetChildBounds(slot), tMin, tMax, maxT);
+			tNear[slot] = hit ? tMin : INFINITY;
+			mask |= hit ? 1u << slot : 0u;
+		}
+		return MaskUnusedSlots(mask, node.GetChildMask(), tNear);
+	}
+
+	static const MeshBVHKernels s_BaselineKernels = { SimdLevel::Baseline, &IntersectChildrenBaseline<uint8_t>, &IntersectChildrenBaseline<uint16_t> };
+#endif
+
+	const MeshBVHKernels& GetMeshBVHKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:
+			return s_AVX2Kernels;
+		default:
+			break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const MeshBVHKernels& GetMeshBVHKernels()
+	{
+		static const MeshBVHKernels& kernels = GetMeshBVHKernels(GetSimdLevel());
+		return kernels;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef _MESH_BVH_BATCH_H_
+#define _MESH_BVH_BATCH_H_
+
+#include <cstdint>
+#include "MeshBVH.h"
+#include "../Cpu.h"
+
+namespace odm
+{
+	/**
+	 * Table of MeshBVH node kernels compiled for one instruction set tier.
+	 * Both decode the eight child boxes of a node and test one ray against them, returning a mask with bit i set when child i
+	 * is hit between 0 and maxT, and storing each child's entry distance or INFINITY for children missed and slots unused.
+	 * Every lane gives the same answer as Ray::Intersect against MeshBVHNode::GetChildBounds.
+	 */
+	struct MeshBVHKernels
+	{
+		SimdLevel level;
+
+		uint32_t (*IntersectChildren8)(const Ray& ray, const MeshBVHNode8& node, float maxT, float* tNear);
+		uint32_t (*IntersectChildren16)(const Ray& ray, const MeshBVHNode16& node, float maxT, float* tNear);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const MeshBVHKernels& GetMeshBVHKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const MeshBVHKernels& GetMeshBVHKernels(SimdLevel level);
+}
+
+#endif /* end of include guard: _MESH_BVH_BATCH_H_ */
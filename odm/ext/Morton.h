@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef _MORTON_H_
+#define _MORTON_H_
+
+#include <algorithm>
+#include <cstdint>
+#include "AABB.h"
+
+namespace odm
+{
+	/** Width of the Morton codes a linear hierarchy is sorted by. */
+	enum class MortonCodeWidth
+	{
+		Bits30,		// 10 bits per axis in a uint32_t; a 1024^3 grid.
+		Bits63		// 21 bits per axis in a uint64_t; for scenes whose objects crowd into few cells of the smaller grid.
+	};
+
+	constexpr uint32_t Morton30AxisBits = 10;
+	constexpr uint32_t Morton63AxisBits = 21;
+
+	/** Spreads the low 10 bits of v so that bit i lands on bit 3 * i. */
+	constexpr uint32_t ExpandBits10(uint32_t v)
+	{
+		v &= 0x3FF;
+		v = (v | (v << 16)) & 0x030000FF;
+		v = (v | (v << 8)) & 0x0300F00F;
+		v = (v | (v << 4)) & 0x030C30C3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	/** Spreads the low 21 bits of v so that bit i lands on bit 3 * i. */
+	constexpr uint64_t ExpandBits21(uint64_t v)
+	{
+		v &= 0x1FFFFF;
+		v = (v | (v << 32)) & 0x001F00000000FFFFull;
+		v = (v | (v << 16)) & 0x001F0000FF0000FFull;
+		v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+		v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+		v = (v | (v << 2)) & 0x1249249249249249ull;
+		return v;
+	}
+
+	/** Interleaves three 10-bit cell coordinates, x in the most significant position of each triple. */
+	constexpr uint32_t EncodeMorton30(uint32_t x, uint32_t y, uint32_t z)
+	{
+		return (ExpandBits10(x) << 2) | (ExpandBits10(y) << 1) | ExpandBits10(z);
+	}
+
+	/** Interleaves three 21-bit cell coordinates, x in the most significant position of each triple. */
+	constexpr uint64_t EncodeMorton63(uint32_t x, uint32_t y, uint32_t z)
+	{
+		return (ExpandBits21(x) << 2) | (ExpandBits21(y) << 1) | ExpandBits21(z);
+	}
+
+	/**
+	 * Maps points inside a box onto a grid of 2^axisBits cells per axis.
+	 * The batch encoders in Morton_batch.h quantize with the same operations, so they produce the same codes.
+	 */
+	struct MortonGrid
+	{
+		vec3 origin;
+		vec3 scale;			// Cells per unit along each axis; 0 for an axis along which the box is flat.
+		float maxCell;
+
+		/**
+		 * @param bounds Box the grid spans, e.g. the bounds of all centroids.
+		 * @param axisBits Bits of the cell coordinate along each axis.
+		 */
+		MortonGrid(const AABB& bounds, uint32_t axisBits)
+			: origin(bounds.min), maxCell(static_cast<float>((1u << axisBits) - 1))
+		{
+			const float cells = static_cast<float>(1u << axisBits);
+			const vec3 size = bounds.GetSize();
+			scale = vec3(size.x > 0.0f ? cells / size.x : 0.0f, size.y > 0.0f ? cells / size.y : 0.0f, size.z > 0.0f ? cells / size.z : 0.0f);
+		}
+
+		/** Cell coordinate of v along one axis, clamped to the grid; a NaN coordinate falls into cell 0. */
+		NODISCARD uint32_t Quantize(float v, float axisOrigin, float axisScale) const
+		{
+			// The clamp to 0 picks 0 unless the cell is greater, as the SSE max does, so a NaN never reaches the conversion.
+			const float cell = (v - axisOrigin) * axisScale;
+			return static_cast<uint32_t>(std::min(cell > 0.0f ? cell : 0.0f, maxCell));
+		}
+	};
+
+	/**
+	 * Computes the 30-bit Morton code of a point.
+	 * @param point The point, e.g. the centroid of an object.
+	 * @param bounds Box the codes span; points outside are clamped onto it.
+	 */
+	inline uint32_t EncodeMorton30(const vec3& point, const AABB& bounds)
+	{
+		const MortonGrid grid(bounds, Morton30AxisBits);
+		return EncodeMorton30(grid.Quantize(point.x, grid.origin.x, grid.scale.x), grid.Quantize(point.y, grid.origin.y, grid.scale.y),
+			grid.Quantize(point.z, grid.origin.z, grid.scale.z));
+	}
+
+	/**
+	 * Computes the 63-bit Morton code of a point.
+	 * @param point The point, e.g. the centroid of an object.
+	 * @param bounds Box the codes span; points outside are clamped onto it.
+	 */
+	inline uint64_t EncodeMorton63(const vec3& point, const AABB& bounds)
+	{
+		const MortonGrid grid(bounds, Morton63AxisBits);
+		return EncodeMorton63(grid.Quantize(point.x, grid.origin.x, grid.scale.x), grid.Quantize(point.y, grid.origin.y, grid.scale.y),
+			grid.Quantize(point.z, grid.origin.z, grid.scale.z));
+	}
+}
+
+#endif /* end of include guard: _MORTON_H_ */
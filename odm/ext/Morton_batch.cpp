@@ -0,0 +1,379 @@
+#include "Morton_batch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+#include "../Simd.h"
+#include "../Simd_soa.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	static void Encode30Scalar(const MortonGrid& grid, const vec3* points, size_t first, size_t end, uint32_t* codes)
+	{
+		for (size_t i = first; i < end; ++i)
+		{
+			codes[i] = EncodeMorton30(grid.Quantize(points[i].x, grid.origin.x, grid.scale.x), grid.Quantize(points[i].y, grid.origin.y, grid.scale.y),
+				grid.Quantize(points[i].z, grid.origin.z, grid.scale.z));
+		}
+	}
+
+	static void Encode63Scalar(const MortonGrid& grid, const vec3* points, size_t first, size_t end, uint64_t* codes)
+	{
+		for (size_t i = first; i < end; ++i)
+		{
+			codes[i] = EncodeMorton63(grid.Quantize(points[i].x, grid.origin.x, grid.scale.x), grid.Quantize(points[i].y, grid.origin.y, grid.scale.y),
+				grid.Quantize(points[i].z, grid.origin.z, grid.scale.z));
+		}
+	}
+
+#if ODM_SIMD_SSE
+
+	static_assert(sizeof(vec3) == 3 * sizeof(float), "LoadPoints4 expects tightly packed points");
+
+	/** MortonGrid::Quantize of four coordinates; the same operations in the same order, so the cells match. */
+	static inline __m128i Quantize4(__m128 v, __m128 origin, __m128 scale, __m128 maxCell)
+	{
+		return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(v, origin), scale), _mm_setzero_ps()), maxCell));
+	}
+
+	/** ExpandBits10 of four lanes. */
+	static inline __m128i ExpandBits10x4(__m128i v)
+	{
+		v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi32(v, 16)), _mm_set1_epi32(0x030000FF));
+		v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi32(v, 8)), _mm_set1_epi32(0x0300F00F));
+		v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi32(v, 4)), _mm_set1_epi32(0x030C30C3));
+		v = _mm_and_si128(_mm_or_si128(v, _mm_slli_epi32(v, 2)), _mm_set1_epi32(0x09249249));
+		return v;
+	}
+
+	static void Encode30SSE(const vec3* points, size_t count, const AABB& bounds, uint32_t* codes)
+	{
+		const MortonGrid grid(bounds, Morton30AxisBits);
+		const __m128 ox = _mm_set1_ps(grid.origin.x), oy = _mm_set1_ps(grid.origin.y), oz = _mm_set1_ps(grid.origin.z);
+		const __m128 sx = _mm_set1_ps(grid.scale.x), sy = _mm_set1_ps(grid.scale.y), sz = _mm_set1_ps(grid.scale.z);
+		const __m128 maxCell = _mm_set1_ps(grid.maxCell);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x, y, z;
+			LoadPoints4(&points[i].x, x, y, z);
+			const __m128i ex = ExpandBits10x4(Quantize4(x, ox, sx, maxCell));
+			const __m128i ey = ExpandBits10x4(Quantize4(y, oy, sy, maxCell));
+			const __m128i ez = ExpandBits10x4(Quantize4(z, oz, sz, maxCell));
+			const __m128i code = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ex, 2), _mm_slli_epi32(ey, 1)), ez);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(codes + i), code);
+		}
+		Encode30Scalar(grid, points, i, count, codes);
+	}
+
+	/** Only two 64-bit lanes fit a register, which makes the shift ladder no faster than scalar; only the quantization is vectorized. */
+	static void Encode63SSE(const vec3* points, size_t count, const AABB& bounds, uint64_t* codes)
+	{
+		const MortonGrid grid(bounds, Morton63AxisBits);
+		const __m128 ox = _mm_set1_ps(grid.origin.x), oy = _mm_set1_ps(grid.origin.y), oz = _mm_set1_ps(grid.origin.z);
+		const __m128 sx = _mm_set1_ps(grid.scale.x), sy = _mm_set1_ps(grid.scale.y), sz = _mm_set1_ps(grid.scale.z);
+		const __m128 maxCell = _mm_set1_ps(grid.maxCell);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x, y, z;
+			LoadPoints4(&points[i].x, x, y, z);
+			alignas(16) uint32_t qx[4], qy[4], qz[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(qx), Quantize4(x, ox, sx, maxCell));
+			_mm_store_si128(reinterpret_cast<__m128i*>(qy), Quantize4(y, oy, sy, maxCell));
+			_mm_store_si128(reinterpret_cast<__m128i*>(qz), Quantize4(z, oz, sz, maxCell));
+			for (size_t k = 0; k < 4; ++k)
+				codes[i + k] = EncodeMorton63(qx[k], qy[k], qz[k]);
+		}
+		Encode63Scalar(grid, points, i, count, codes);
+	}
+
+#else
+
+	static void Encode30Baseline(const vec3* points, size_t count, const AABB& bounds, uint32_t* codes)
+	{
+		Encode30Scalar(MortonGrid(bounds, Morton30AxisBits), points, 0, count, codes);
+	}
+
+	static void Encode63Baseline(const vec3* points, size_t count, const AABB& bounds, uint64_t* codes)
+	{
+		Encode63Scalar(MortonGrid(bounds, Morton63AxisBits), points, 0, count, codes);
+	}
+
+#endif
+
+#if ODM_SIMD_SSE
+	static const MortonKernels s_BaselineKernels = { SimdLevel::Baseline, &Encode30SSE, &Encode63SSE };
+#else
+	static const MortonKernels s_BaselineKernels = { SimdLevel::Baseline, &Encode30Baseline, &Encode63Baseline };
+#endif
+
+#if ODM_SIMD_SSE
+#pragma region AVX2
+
+	/** The grid splatted across registers. */
+	struct MortonGrid8
+	{
+		__m256 ox, oy, oz, sx, sy, sz, maxCell;
+	};
+
+	ODM_TARGET("avx2,fma")
+	static inline void SplatGrid8(const MortonGrid& grid, MortonGrid8& splat)
+	{
+		splat.ox = _mm256_set1_ps(grid.origin.x);
+		splat.oy = _mm256_set1_ps(grid.origin.y);
+		splat.oz = _mm256_set1_ps(grid.origin.z);
+		splat.sx = _mm256_set1_ps(grid.scale.x);
+		splat.sy = _mm256_set1_ps(grid.scale.y);
+		splat.sz = _mm256_set1_ps(grid.scale.z);
+		splat.maxCell = _mm256_set1_ps(grid.maxCell);
+	}
+
+	/** Quantize4 of eight coordinates; deliberately without FMA, which would round differently from the scalar path. */
+	ODM_TARGET("avx2,fma")
+	static inline __m256i Quantize8(__m256 v, __m256 origin, __m256 scale, __m256 maxCell)
+	{
+		return _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(v, origin), scale), _mm256_setzero_ps()), maxCell));
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline void QuantizePoints8(const MortonGrid8& grid, const vec3* points, __m256i& qx, __m256i& qy, __m256i& qz)
+	{
+		__m256 x, y, z;
+		LoadPoints8(&points->x, x, y, z);
+		qx = Quantize8(x, grid.ox, grid.sx, grid.maxCell);
+		qy = Quantize8(y, grid.oy, grid.sy, grid.maxCell);
+		qz = Quantize8(z, grid.oz, grid.sz, grid.maxCell);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static inline __m256i ExpandBits10x8(__m256i v)
+	{
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 16)), _mm256_set1_epi32(0x030000FF));
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 8)), _mm256_set1_epi32(0x0300F00F));
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 4)), _mm256_set1_epi32(0x030C30C3));
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 2)), _mm256_set1_epi32(0x09249249));
+		return v;
+	}
+
+	/** ExpandBits21 of four 64-bit lanes. */
+	ODM_TARGET("avx2,fma")
+	static inline __m256i ExpandBits21x4(__m256i v)
+	{
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 32)), _mm256_set1_epi64x(0x001F00000000FFFFll));
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 16)), _mm256_set1_epi64x(0x001F0000FF0000FFll));
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 8)), _mm256_set1_epi64x(0x100F00F00F00F00Fll));
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 4)), _mm256_set1_epi64x(0x10C30C30C30C30C3ll));
+		v = _mm256_and_si256(_mm256_or_si256(v, _mm256_slli_epi64(v, 2)), _mm256_set1_epi64x(0x1249249249249249ll));
+		return v;
+	}
+
+	/** Interleaves four cells whose coordinates sit in 128-bit registers of 32-bit lanes. */
+	ODM_TARGET("avx2,fma")
+	static inline __m256i Interleave63x4(__m128i qx, __m128i qy, __m128i qz)
+	{
+		const __m256i ex = ExpandBits21x4(_mm256_cvtepu32_epi64(qx));
+		const __m256i ey = ExpandBits21x4(_mm256_cvtepu32_epi64(qy));
+		const __m256i ez = ExpandBits21x4(_mm256_cvtepu32_epi64(qz));
+		return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi64(ex, 2), _mm256_slli_epi64(ey, 1)), ez);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void Encode30AVX2(const vec3* points, size_t count, const AABB& bounds, uint32_t* codes)
+	{
+		const MortonGrid grid(bounds, Morton30AxisBits);
+		MortonGrid8 splat;
+		SplatGrid8(grid, splat);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i qx, qy, qz;
+			QuantizePoints8(splat, points + i, qx, qy, qz);
+			const __m256i code = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(ExpandBits10x8(qx), 2), _mm256_slli_epi32(ExpandBits10x8(qy), 1)),
+				ExpandBits10x8(qz));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + i), code);
+		}
+		Encode30Scalar(grid, points, i, count, codes);
+	}
+
+	ODM_TARGET("avx2,fma")
+	static void Encode63AVX2(const vec3* points, size_t count, const AABB& bounds, uint64_t* codes)
+	{
+		const MortonGrid grid(bounds, Morton63AxisBits);
+		MortonGrid8 splat;
+		SplatGrid8(grid, splat);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i qx, qy, qz;
+			QuantizePoints8(splat, points + i, qx, qy, qz);
+			const __m256i lo = Interleave63x4(_mm256_castsi256_si128(qx), _mm256_castsi256_si128(qy), _mm256_castsi256_si128(qz));
+			const __m256i hi = Interleave63x4(_mm256_extracti128_si256(qx, 1), _mm256_extracti128_si256(qy, 1), _mm256_extracti128_si256(qz, 1));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + i), lo);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + i + 4), hi);
+		}
+		Encode63Scalar(grid, points, i, count, codes);
+	}
+
+#if defined(_M_X64) || defined(__x86_64__)
+	/** Deposits the three cell coordinates straight onto their bit positions; three pdep per point beat the shift ladder of Encode63AVX2. */
+	ODM_TARGET("avx2,fma,bmi2")
+	static void Encode63AVX2Pdep(const vec3* points, size_t count, const AABB& bounds, uint64_t* codes)
+	{
+		const MortonGrid grid(bounds, Morton63AxisBits);
+		MortonGrid8 splat;
+		SplatGrid8(grid, splat);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i qx, qy, qz;
+			QuantizePoints8(splat, points + i, qx, qy, qz);
+			alignas(32) uint32_t cx[8], cy[8], cz[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(cx), qx);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(cy), qy);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(cz), qz);
+			for (size_t k = 0; k < 8; ++k)
+				codes[i + k] = _pdep_u64(cx[k], 0x4924924924924924ull) | _pdep_u64(cy[k], 0x2492492492492492ull) | _pdep_u64(cz[k], 0x1249249249249249ull);
+		}
+		Encode63Scalar(grid, points, i, count, codes);
+	}
+
+	static const MortonKernels s_AVX2PdepKernels = { SimdLevel::AVX2, &Encode30AVX2, &Encode63AVX2Pdep };
+#endif
+
+	// AVX-512 shares these kernels; encoding is bound by loading the points, and 16 lanes would not fetch them any faster.
+	static const MortonKernels s_AVX2Kernels = { SimdLevel::AVX2, &Encode30AVX2, &Encode63AVX2 };
+
+#pragma endregion
+#endif
+
+	const MortonKernels& GetMortonKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:
+#if defined(_M_X64) || defined(__x86_64__)
+			if (GetCpuFeatures().fastPdep)
+				return s_AVX2PdepKernels;
+#endif
+			return s_AVX2Kernels;
+		default:
+			break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const MortonKernels& GetMortonKernels()
+	{
+		static const MortonKernels& kernels = GetMortonKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	void EncodeMorton30(Span<const vec3> points, const AABB& bounds, Span<uint32_t> codes)
+	{
+		assert(codes.size() == points.size());
+		GetMortonKernels().Encode30(points.data(), points.size(), bounds, codes.data());
+	}
+
+	void EncodeMorton63(Span<const vec3> points, const AABB& bounds, Span<uint64_t> codes)
+	{
+		assert(codes.size() == points.size());
+		GetMortonKernels().Encode63(points.data(), points.size(), bounds, codes.data());
+	}
+
+	/** Elements per piece of a radix pass; a constant, so the pieces never depend on the thread count. */
+	static constexpr size_t RadixChunkSize = 65536;
+	static constexpr uint32_t RadixDigitBits = 8;
+	static constexpr uint32_t RadixBucketCount = 1u << RadixDigitBits;
+
+	template <class Key>
+	static void RadixSort(Key* keys, uint32_t* values, size_t count, uint32_t keyBits, TaskScheduler* scheduler)
+	{
+		assert(count <= UINT32_MAX);
+		if (count <= 1)
+			return;
+
+		std::vector<Key> keyScratch(count);
+		std::vector<uint32_t> valueScratch(count);
+		Key* sourceKeys = keys;
+		uint32_t* sourceValues = values;
+		Key* targetKeys = keyScratch.data();
+		uint32_t* targetValues = valueScratch.data();
+
+		const size_t chunkCount = (count + RadixChunkSize - 1) / RadixChunkSize;
+		std::vector<uint32_t> offsets(chunkCount * RadixBucketCount);
+		for (uint32_t shift = 0; shift < keyBits; shift += RadixDigitBits)
+		{
+			ParallelForChunks(scheduler, count, RadixChunkSize, [&](uint32_t chunk, size_t begin, size_t end) {
+				uint32_t histogram[RadixBucketCount] = {};
+				for (size_t i = begin; i < end; ++i)
+					++histogram[(sourceKeys[i] >> shift) & (RadixBucketCount - 1)];
+				std::memcpy(&offsets[chunk * RadixBucketCount], histogram, sizeof(histogram));
+			});
+
+			// Bucket by bucket, chunk by chunk, so each chunk scatters its share of a bucket right after the previous chunk's share.
+			uint32_t offset = 0;
+			bool sharedDigit = false;
+			for (uint32_t bucket = 0; bucket < RadixBucketCount; ++bucket)
+			{
+				const uint32_t bucketStart = offset;
+				for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+				{
+					const uint32_t n = offsets[chunk * RadixBucketCount + bucket];
+					offsets[chunk * RadixBucketCount + bucket] = offset;
+					offset += n;
+				}
+				sharedDigit |= offset - bucketStart == count;
+			}
+			// Every key has the same digit here, e.g. the top digits of a tightly clustered scene; the pass would not move anything.
+			if (sharedDigit)
+				continue;
+
+			ParallelForChunks(scheduler, count, RadixChunkSize, [&](uint32_t chunk, size_t begin, size_t end) {
+				uint32_t* next = &offsets[chunk * RadixBucketCount];
+				for (size_t i = begin; i < end; ++i)
+				{
+					const uint32_t slot = next[(sourceKeys[i] >> shift) & (RadixBucketCount - 1)]++;
+					targetKeys[slot] = sourceKeys[i];
+					targetValues[slot] = sourceValues[i];
+				}
+			});
+			std::swap(sourceKeys, targetKeys);
+			std::swap(sourceValues, targetValues);
+		}
+
+		if (sourceKeys != keys)
+		{
+			ParallelForChunks(scheduler, count, RadixChunkSize, [&](uint32_t, size_t begin, size_t end) {
+				std::copy(sourceKeys + begin, sourceKeys + end, keys + begin);
+				std::copy(sourceValues + begin, sourceValues + end, values + begin);
+			});
+		}
+	}
+
+	void SortMortonCodes(Span<uint32_t> codes, Span<uint32_t> values, TaskScheduler* scheduler)
+	{
+		assert(values.size() == codes.size());
+		RadixSort(codes.data(), values.data(), codes.size(), 3 * Morton30AxisBits, scheduler);
+	}
+
+	void SortMortonCodes(Span<uint64_t> codes, Span<uint32_t> values, TaskScheduler* scheduler)
+	{
+		assert(values.size() == codes.size());
+		RadixSort(codes.data(), values.data(), codes.size(), 3 * Morton63AxisBits, scheduler);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef _MORTON_BATCH_H_
+#define _MORTON_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "Morton.h"
+#include "../Cpu.h"
+#include "../Span.h"
+#include "../TaskScheduler.h"
+
+namespace odm
+{
+	/** Table of Morton encoding kernels compiled for one instruction set tier. */
+	struct MortonKernels
+	{
+		SimdLevel level;
+
+		/** Writes EncodeMorton30(points[i], bounds) to codes[i]. */
+		void (*Encode30)(const vec3* points, size_t count, const AABB& bounds, uint32_t* codes);
+
+		/** Writes EncodeMorton63(points[i], bounds) to codes[i]. */
+		void (*Encode63)(const vec3* points, size_t count, const AABB& bounds, uint64_t* codes);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const MortonKernels& GetMortonKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const MortonKernels& GetMortonKernels(SimdLevel level);
+
+	/**
+	 * Computes the 30-bit Morton codes of a set of points.
+	 * @param points The points, e.g. object centroids.
+	 * @param bounds Box the codes span; points outside are clamped onto it.
+	 * @param codes Receives one code per point.
+	 */
+	void EncodeMorton30(Span<const vec3> points, const AABB& bounds, Span<uint32_t> codes);
+
+	/**
+	 * Computes the 63-bit Morton codes of a set of points.
+	 * @param points The points, e.g. object centroids.
+	 * @param bounds Box the codes span; points outside are clamped onto it.
+	 * @param codes Receives one code per point.
+	 */
+	void EncodeMorton63(Span<const vec3> points, const AABB& bounds, Span<uint64_t> codes);
+
+	/**
+	 * Sorts 30-bit Morton codes in ascending order together with a payload, keeping equal codes in their input order.
+	 * Least significant digit radix sort; every digit pass histograms and scatters fixed-size chunks, in parallel when a scheduler is given.
+	 * @param codes The codes; bits above the 30th must be clear.
+	 * @param values Payload moved along with the codes, e.g. object indices.
+	 * @param scheduler Runs the passes on several threads when given.
+	 */
+	void SortMortonCodes(Span<uint32_t> codes, Span<uint32_t> values, TaskScheduler* scheduler = nullptr);
+
+	/**
+	 * Sorts 63-bit Morton codes in ascending order together with a payload, keeping equal codes in their input order.
+	 * @param codes The codes; the top bit must be clear.
+	 * @param values Payload moved along with the codes, e.g. object indices.
+	 * @param scheduler Runs the passes on several threads when given.
+	 */
+	void SortMortonCodes(Span<uint64_t> codes, Span<uint32_t> values, TaskScheduler* scheduler = nullptr);
+}
+
+#endif /* end of include guard: _MORTON_BATCH_H_ */
@@ -0,0 +1,105 @@
+#include "OBB.h"
+
+#include <cmath>
+
+namespace odm
+{
+	/**
+	 * Separating axis test of box A against box B in the frame of A.
+	 * @param ea Half extents of A.
+	 * @param eb Half extents of B.
+	 * @param r Rotation of B in the frame of A: r[i][j] is the cosine between axis i of A and axis j of B.
+	 * @param t Center of B less the center of A, in the frame of A.
+	 */
+	static bool Overlap(const vec3& ea, const vec3& eb, const float r[3][3], const vec3& t)
+	{
+		float absR[3][3];
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+				absR[i][j] = std::abs(r[i][j]) + OBB::ParallelEpsilon;
+		}
+
+		// The face normals of A; a NaN anywhere fails every comparison, so such a box overlaps nothing.
+		for (int i = 0; i < 3; ++i)
+		{
+			const float rb = eb.x * absR[i][0] + eb.y * absR[i][1] + eb.z * absR[i][2];
+			if (!(std::abs(t[i]) <= ea[i] + rb))
+				return false;
+		}
+
+		// The face normals of B.
+		for (int j = 0; j < 3; ++j)
+		{
+			const float ra = ea.x * absR[0][j] + ea.y * absR[1][j] + ea.z * absR[2][j];
+			if (!(std::abs(t.x * r[0][j] + t.y * r[1][j] + t.z * r[2][j]) <= ra + eb[j]))
+				return false;
+		}
+
+		// The nine cross products of an edge of A with an edge of B.
+		for (int i = 0; i < 3; ++i)
+		{
+			const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+			for (int j = 0; j < 3; ++j)
+			{
+				const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+				const float ra = ea[i1] * absR[i2][j] + ea[i2] * absR[i1][j];
+				const float rb = eb[j1] * absR[i][j2] + eb[j2] * absR[i][j1];
+				if (!(std::abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) <= ra + rb))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	OBB OBB::FromAABB(const AABB& box, const Matrix4x4& transform)
+	{
+		OBB result;
+		result.center = transform * box.Center();
+		const vec3 extents = box.GetExtents();
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			// The columns carry the scale; it moves into the half extents and leaves unit axes.
+			const vec3 column(transform.m[axis].x, transform.m[axis].y, transform.m[axis].z);
+			const float scale = column.Length();
+			result.axes[axis] = scale > 0.0f ? column * (1.0f / scale) : result.axes[axis];
+			result.halfExtents[axis] = extents[axis] * scale;
+		}
+		return result;
+	}
+
+	AABB OBB::GetBounds() const
+	{
+		vec3 extents;
+		for (int k = 0; k < 3; ++k)
+			extents[k] = std::abs(axes[0][k]) * halfExtents.x + std::abs(axes[1][k]) * halfExtents.y + std::abs(axes[2][k]) * halfExtents.z;
+		return AABB(center - extents, center + extents);
+	}
+
+	bool OBB::Intersects(const OBB& other) const
+	{
+		float r[3][3];
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+				r[i][j] = axes[i].Dot(other.axes[j]);
+		}
+
+		const vec3 offset = other.center - center;
+		return Overlap(halfExtents, other.halfExtents, r, vec3(offset.Dot(axes[0]), offset.Dot(axes[1]), offset.Dot(axes[2])));
+	}
+
+	bool OBB::Intersects(const AABB& box) const
+	{
+		// The axes of the box are the world axes, so the cosines are the components of this box's axes.
+		float r[3][3];
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+				r[i][j] = axes[i][j];
+		}
+
+		const vec3 offset = box.Center() - center;
+		return Overlap(halfExtents, box.GetExtents(), r, vec3(offset.Dot(axes[0]), offset.Dot(axes[1]), offset.Dot(axes[2])));
+	}
+}
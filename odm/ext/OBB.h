@@ -1 +1,73 @@
 #pragma once
+
+#ifndef _OBB_H_
+#define _OBB_H_
+
+#include "AABB.h"
+#include "../Mat4x4.h"
+#include "../Quaternion.h"
+
+namespace odm
+{
+	/**
+	 * Oriented bounding box: a box of half extents along three orthonormal axes, centered anywhere.
+	 * Overlap tests use the separating axis theorem over the 15 candidate axes (Gottschalk et al., "OBBTree") and return at
+	 * the first axis that separates the boxes; touching boxes overlap.
+	 */
+	struct OBB
+	{
+		/**
+		 * Added to the absolute axis cosines, so that two nearly parallel edges, whose cross product is close to zero and
+		 * carries mostly rounding error, cannot report a separation that is not there.
+		 */
+		static constexpr float ParallelEpsilon = 1e-6f;
+
+		vec3 center;
+		vec3 axes[3] = { vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f) };	// Orientation; the columns of a rotation matrix.
+		vec3 halfExtents;
+
+		OBB() = default;
+
+		/**
+		 * Constructs a box from its orientation as a rotation matrix.
+		 * @param boxCenter Center of the box.
+		 * @param axisX, axisY, axisZ Orthonormal local axes of the box in world space.
+		 * @param boxHalfExtents Distance from the center to each face, along the local axes.
+		 */
+		OBB(const vec3& boxCenter, const vec3& axisX, const vec3& axisY, const vec3& axisZ, const vec3& boxHalfExtents)
+			: center(boxCenter), axes{ axisX, axisY, axisZ }, halfExtents(boxHalfExtents)
+		{}
+
+		/**
+		 * Constructs a box from its orientation as a quaternion.
+		 * @param boxCenter Center of the box.
+		 * @param orientation Unit quaternion rotating the local axes into world space.
+		 * @param boxHalfExtents Distance from the center to each face, along the local axes.
+		 */
+		OBB(const vec3& boxCenter, const Quaternion& orientation, const vec3& boxHalfExtents)
+			: center(boxCenter), halfExtents(boxHalfExtents)
+		{
+			axes[0] = Quaternion::Rotate(orientation, vec3(1.0f, 0.0f, 0.0f));
+			axes[1] = Quaternion::Rotate(orientation, vec3(0.0f, 1.0f, 0.0f));
+			axes[2] = Quaternion::Rotate(orientation, vec3(0.0f, 0.0f, 1.0f));
+		}
+
+		/**
+		 * Gets the box a transform turns an axis-aligned box into; unlike AABB::TransformToAABB it stays tight under rotation.
+		 * @param box The box in local space.
+		 * @param transform Rotation, translation and scale, possibly non-uniform; shear cannot be represented.
+		 */
+		NODISCARD static OBB FromAABB(const AABB& box, const Matrix4x4& transform);
+
+		/** Gets the smallest axis-aligned box that contains this box. */
+		NODISCARD AABB GetBounds() const;
+
+		/** Tests whether the box overlaps another, touching included. */
+		NODISCARD bool Intersects(const OBB& other) const;
+
+		/** Tests whether the box overlaps an axis-aligned box, touching included; cheaper, as the rotation between the boxes is read off the axes. */
+		NODISCARD bool Intersects(const AABB& box) const;
+	};
+}
+
+#endif /* end of include guard: _OBB_H_ */
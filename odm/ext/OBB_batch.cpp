@@ -0,0 +1,315 @@
+#include "OBB_batch.h"
+
+#include <cassert>
+#include <cmath>
+#include "../Simd.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	OBBPacket8::OBBPacket8(Span<const OBB> obbs)
+	{
+		assert(obbs.size() <= 8);
+		for (size_t lane = 0; lane < 8; ++lane)
+		{
+			OBB obb;
+			obb.halfExtents = vec3(NAN);
+			if (lane < obbs.size())
+				obb = obbs[lane];
+
+			for (int k = 0; k < 3; ++k)
+			{
+				center[k][lane] = obb.center[k];
+				halfExtents[k][lane] = obb.halfExtents[k];
+				for (int i = 0; i < 3; ++i)
+					axes[i][k][lane] = obb.axes[i][k];
+			}
+		}
+	}
+
+#if ODM_SIMD_SSE
+
+	static inline __m128 Abs4(__m128 v)
+	{
+		return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+	}
+
+	/** The separating axis test of OBB.cpp for four boxes B against one box A, in the same operations and order. */
+	static inline uint32_t Overlap4(const vec3& ea, const __m128 eb[3], const __m128 r[3][3], const __m128 t[3])
+	{
+		__m128 absR[3][3];
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+				absR[i][j] = _mm_add_ps(Abs4(r[i][j]), _mm_set1_ps(OBB::ParallelEpsilon));
+		}
+
+		__m128 overlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int i = 0; i < 3; ++i)
+		{
+			const __m128 rb = _mm_add_ps(_mm_add_ps(_mm_mul_ps(eb[0], absR[i][0]), _mm_mul_ps(eb[1], absR[i][1])), _mm_mul_ps(eb[2], absR[i][2]));
+			overlap = _mm_and_ps(overlap, _mm_cmple_ps(Abs4(t[i]), _mm_add_ps(_mm_set1_ps(ea[i]), rb)));
+		}
+		if (_mm_movemask_ps(overlap) == 0)
+			return 0;
+
+		for (int j = 0; j < 3; ++j)
+		{
+			const __m128 ra = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ea.x), absR[0][j]), _mm_mul_ps(_mm_set1_ps(ea.y), absR[1][j])),
+				_mm_mul_ps(_mm_set1_ps(ea.z), absR[2][j]));
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(t[0], r[0][j]), _mm_mul_ps(t[1], r[1][j])), _mm_mul_ps(t[2], r[2][j]));
+			overlap = _mm_and_ps(overlap, _mm_cmple_ps(Abs4(distance), _mm_add_ps(ra, eb[j])));
+		}
+		if (_mm_movemask_ps(overlap) == 0)
+			return 0;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+			for (int j = 0; j < 3; ++j)
+			{
+				const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+				const __m128 ra = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(ea[i1]), absR[i2][j]), _mm_mul_ps(_mm_set1_ps(ea[i2]), absR[i1][j]));
+				const __m128 rb = _mm_add_ps(_mm_mul_ps(eb[j1], absR[i][j2]), _mm_mul_ps(eb[j2], absR[i][j1]));
+				const __m128 distance = _mm_sub_ps(_mm_mul_ps(t[i2], r[i1][j]), _mm_mul_ps(t[i1], r[i2][j]));
+				overlap = _mm_and_ps(overlap, _mm_cmple_ps(Abs4(distance), _mm_add_ps(ra, rb)));
+			}
+		}
+		return static_cast<uint32_t>(_mm_movemask_ps(overlap));
+	}
+
+	/** Puts the offsets of four centers from obb's center into obb's frame. */
+	static inline void ToFrame4(const OBB& obb, const __m128 centers[3], __m128 t[3])
+	{
+		const __m128 dx = _mm_sub_ps(centers[0], _mm_set1_ps(obb.center.x));
+		const __m128 dy = _mm_sub_ps(centers[1], _mm_set1_ps(obb.center.y));
+		const __m128 dz = _mm_sub_ps(centers[2], _mm_set1_ps(obb.center.z));
+		for (int i = 0; i < 3; ++i)
+		{
+			t[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_set1_ps(obb.axes[i].x)), _mm_mul_ps(dy, _mm_set1_ps(obb.axes[i].y))),
+				_mm_mul_ps(dz, _mm_set1_ps(obb.axes[i].z)));
+		}
+	}
+
+	static inline uint32_t IntersectOBBs4(const OBB& obb, const OBBPacket8& obbs, size_t first)
+	{
+		__m128 r[3][3], eb[3], centers[3], t[3];
+		for (int j = 0; j < 3; ++j)
+		{
+			const __m128 bx = _mm_load_ps(obbs.axes[j][0] + first), by = _mm_load_ps(obbs.axes[j][1] + first), bz = _mm_load_ps(obbs.axes[j][2] + first);
+			for (int i = 0; i < 3; ++i)
+			{
+				r[i][j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(obb.axes[i].x), bx), _mm_mul_ps(_mm_set1_ps(obb.axes[i].y), by)),
+					_mm_mul_ps(_mm_set1_ps(obb.axes[i].z), bz));
+			}
+			eb[j] = _mm_load_ps(obbs.halfExtents[j] + first);
+			centers[j] = _mm_load_ps(obbs.center[j] + first);
+		}
+		ToFrame4(obb, centers, t);
+		return Overlap4(obb.halfExtents, eb, r, t) << first;
+	}
+
+	static inline uint32_t IntersectAABBs4(const OBB& obb, const AABBPacket8& boxes, size_t first)
+	{
+		const float* mins[3] = { boxes.minX + first, boxes.minY + first, boxes.minZ + first };
+		const float* maxs[3] = { boxes.maxX + first, boxes.maxY + first, boxes.maxZ + first };
+		__m128 r[3][3], eb[3], centers[3], t[3];
+		for (int j = 0; j < 3; ++j)
+		{
+			for (int i = 0; i < 3; ++i)
+				r[i][j] = _mm_set1_ps(obb.axes[i][j]);
+
+			const __m128 min = _mm_load_ps(mins[j]), max = _mm_load_ps(maxs[j]);
+			centers[j] = _mm_mul_ps(_mm_add_ps(max, min), _mm_set1_ps(0.5f));
+			eb[j] = _mm_mul_ps(_mm_sub_ps(max, min), _mm_set1_ps(0.5f));
+		}
+		ToFrame4(obb, centers, t);
+		return Overlap4(obb.halfExtents, eb, r, t) << first;
+	}
+
+	static uint32_t IntersectOBBs8SSE(const OBB& obb, const OBBPacket8& obbs)
+	{
+		return IntersectOBBs4(obb, obbs, 0) | IntersectOBBs4(obb, obbs, 4);
+	}
+
+	static uint32_t IntersectAABBs8SSE(const OBB& obb, const AABBPacket8& boxes)
+	{
+		return IntersectAABBs4(obb, boxes, 0) | IntersectAABBs4(obb, boxes, 4);
+	}
+
+	static const OBBKernels s_BaselineKernels = { SimdLevel::Baseline, &IntersectOBBs8SSE, &IntersectAABBs8SSE };
+
+#pragma region AVX2
+
+	// Compiled without FMA on purpose, so that a contracted sum of products cannot round a touching pair differently
+	// from OBB::Intersects; collision results then do not depend on the processor they ran on.
+	ODM_TARGET("avx2")
+	static inline __m256 Abs8(__m256 v)
+	{
+		return _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)));
+	}
+
+	ODM_TARGET("avx2")
+	static inline uint32_t Overlap8(const vec3& ea, const __m256 eb[3], const __m256 r[3][3], const __m256 t[3])
+	{
+		__m256 absR[3][3];
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+				absR[i][j] = _mm256_add_ps(Abs8(r[i][j]), _mm256_set1_ps(OBB::ParallelEpsilon));
+		}
+
+		__m256 overlap = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int i = 0; i < 3; ++i)
+		{
+			const __m256 rb = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(eb[0], absR[i][0]), _mm256_mul_ps(eb[1], absR[i][1])), _mm256_mul_ps(eb[2], absR[i][2]));
+			overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(Abs8(t[i]), _mm256_add_ps(_mm256_set1_ps(ea[i]), rb), _CMP_LE_OQ));
+		}
+		if (_mm256_movemask_ps(overlap) == 0)
+			return 0;
+
+		for (int j = 0; j < 3; ++j)
+		{
+			const __m256 ra = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(ea.x), absR[0][j]), _mm256_mul_ps(_mm256_set1_ps(ea.y), absR[1][j])),
+				_mm256_mul_ps(_mm256_set1_ps(ea.z), absR[2][j]));
+			const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(t[0], r[0][j]), _mm256_mul_ps(t[1], r[1][j])), _mm256_mul_ps(t[2], r[2][j]));
+			overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(Abs8(distance), _mm256_add_ps(ra, eb[j]), _CMP_LE_OQ));
+		}
+		if (_mm256_movemask_ps(overlap) == 0)
+			return 0;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+			for (int j = 0; j < 3; ++j)
+			{
+				const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+				const __m256 ra = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(ea[i1]), absR[i2][j]), _mm256_mul_ps(_mm256_set1_ps(ea[i2]), absR[i1][j]));
+				const __m256 rb = _mm256_add_ps(_mm256_mul_ps(eb[j1], absR[i][j2]), _mm256_mul_ps(eb[j2], absR[i][j1]));
+				const __m256 distance = _mm256_sub_ps(_mm256_mul_ps(t[i2], r[i1][j]), _mm256_mul_ps(t[i1], r[i2][j]));
+				overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(Abs8(distance), _mm256_add_ps(ra, rb), _CMP_LE_OQ));
+			}
+		}
+		return static_cast<uint32_t>(_mm256_movemask_ps(overlap));
+	}
+
+	ODM_TARGET("avx2")
+	static inline void ToFrame8(const OBB& obb, const __m256 centers[3], __m256 t[3])
+	{
+		const __m256 dx = _mm256_sub_ps(centers[0], _mm256_set1_ps(obb.center.x));
+		const __m256 dy = _mm256_sub_ps(centers[1], _mm256_set1_ps(obb.center.y));
+		const __m256 dz = _mm256_sub_ps(centers[2], _mm256_set1_ps(obb.center.z));
+		for (int i = 0; i < 3; ++i)
+		{
+			t[i] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, _mm256_set1_ps(obb.axes[i].x)), _mm256_mul_ps(dy, _mm256_set1_ps(obb.axes[i].y))),
+				_mm256_mul_ps(dz, _mm256_set1_ps(obb.axes[i].z)));
+		}
+	}
+
+	ODM_TARGET("avx2")
+	static uint32_t IntersectOBBs8AVX2(const OBB& obb, const OBBPacket8& obbs)
+	{
+		__m256 r[3][3], eb[3], centers[3], t[3];
+		for (int j = 0; j < 3; ++j)
+		{
+			const __m256 bx = _mm256_load_ps(obbs.axes[j][0]), by = _mm256_load_ps(obbs.axes[j][1]), bz = _mm256_load_ps(obbs.axes[j][2]);
+			for (int i = 0; i < 3; ++i)
+			{
+				r[i][j] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(obb.axes[i].x), bx), _mm256_mul_ps(_mm256_set1_ps(obb.axes[i].y), by)),
+					_mm256_mul_ps(_mm256_set1_ps(obb.axes[i].z), bz));
+			}
+			eb[j] = _mm256_load_ps(obbs.halfExtents[j]);
+			centers[j] = _mm256_load_ps(obbs.center[j]);
+		}
+		ToFrame8(obb, centers, t);
+		return Overlap8(obb.halfExtents, eb, r, t);
+	}
+
+	ODM_TARGET("avx2")
+	static uint32_t IntersectAABBs8AVX2(const OBB& obb, const AABBPacket8& boxes)
+	{
+		const float* mins[3] = { boxes.minX, boxes.minY, boxes.minZ };
+		const float* maxs[3] = { boxes.maxX, boxes.maxY, boxes.maxZ };
+		__m256 r[3][3], eb[3], centers[3], t[3];
+		for (int j = 0; j < 3; ++j)
+		{
+			for (int i = 0; i < 3; ++i)
+				r[i][j] = _mm256_set1_ps(obb.axes[i][j]);
+
+			const __m256 min = _mm256_load_ps(mins[j]), max = _mm256_load_ps(maxs[j]);
+			centers[j] = _mm256_mul_ps(_mm256_add_ps(max, min), _mm256_set1_ps(0.5f));
+			eb[j] = _mm256_mul_ps(_mm256_sub_ps(max, min), _mm256_set1_ps(0.5f));
+		}
+		ToFrame8(obb, centers, t);
+		return Overlap8(obb.halfExtents, eb, r, t);
+	}
+
+	static const OBBKernels s_AVX2Kernels = { SimdLevel::AVX2, &IntersectOBBs8AVX2, &IntersectAABBs8AVX2 };
+
+#pragma endregion
+#else
+
+	static uint32_t IntersectOBBs8Baseline(const OBB& obb, const OBBPacket8& obbs)
+	{
+		uint32_t mask = 0;
+		for (size_t lane = 0; lane < 8; ++lane)
+		{
+			const OBB other(vec3(obbs.center[0][lane], obbs.center[1][lane], obbs.center[2][lane]),
+				vec3(obbs.axes[0][0][lane], obbs.axes[0][1][lane], obbs.axes[0][2][lane]),
+				vec3(obbs.axes[1][0][lane], obbs.axes[1][1][lane], obbs.axes[1][2][lane]),
+				vec3(obbs.axes[2][0][lane], obbs.axes[2][1][lane], obbs.axes[2][2][lane]),
+				vec3(obbs.halfExtents[0][lane], obbs.halfExtents[1][lane], obbs.halfExtents[2][lane]));
+			mask |= obb.Intersects(other) ? 1u << lane : 0u;
+		}
+		return mask;
+	}
+
+	static uint32_t IntersectAABBs8Baseline(const OBB& obb, const AABBPacket8& boxes)
+	{
+		uint32_t mask = 0;
+		for (size_t lane = 0; lane < 8; ++lane)
+		{
+			const AABB box(vec3(boxes.minX[lane], boxes.minY[lane], boxes.minZ[lane]), vec3(boxes.maxX[lane], boxes.maxY[lane], boxes.maxZ[lane]));
+			mask |= obb.Intersects(box) ? 1u << lane : 0u;
+		}
+		return mask;
+	}
+
+	static const OBBKernels s_BaselineKernels = { SimdLevel::Baseline, &IntersectOBBs8Baseline, &IntersectAABBs8Baseline };
+#endif
+
+	const OBBKernels& GetOBBKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:
+			return s_AVX2Kernels;
+		default:
+			break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const OBBKernels& GetOBBKernels()
+	{
+		static const OBBKernels& kernels = GetOBBKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	uint32_t IntersectOBBs8(const OBB& obb, const OBBPacket8& obbs)
+	{
+		return GetOBBKernels().IntersectOBBs8(obb, obbs);
+	}
+
+	uint32_t IntersectAABBs8(const OBB& obb, const AABBPacket8& boxes)
+	{
+		return GetOBBKernels().IntersectAABBs8(obb, boxes);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef _OBB_BATCH_H_
+#define _OBB_BATCH_H_
+
+#include <cstdint>
+#include "OBB.h"
+#include "Ray_batch.h"
+#include "../Cpu.h"
+#include "../Span.h"
+
+namespace odm
+{
+	/** Eight oriented boxes in structure-of-arrays form, indexed [component][lane], for testing them together against one box. */
+	struct OBBPacket8
+	{
+		alignas(32) float center[3][8];
+		alignas(32) float axes[3][3][8];		// Component k of axis i of each box at [i][k].
+		alignas(32) float halfExtents[3][8];
+
+		/**
+		 * Packs up to eight boxes; the lanes past the last box hold NaN half extents, which overlap nothing.
+		 * @param obbs The boxes.
+		 */
+		explicit OBBPacket8(Span<const OBB> obbs);
+	};
+
+	/**
+	 * Table of separating axis kernels compiled for one instruction set tier.
+	 * Both return a mask with bit i set when lane i overlaps the box, giving the same answer as OBB::Intersects in every lane.
+	 * A packet stops early once every lane has found a separating axis.
+	 */
+	struct OBBKernels
+	{
+		SimdLevel level;
+
+		/** Tests one oriented box against the eight of a packet. */
+		uint32_t (*IntersectOBBs8)(const OBB& obb, const OBBPacket8& obbs);
+
+		/** Tests one oriented box against the eight axis-aligned boxes of a packet. */
+		uint32_t (*IntersectAABBs8)(const OBB& obb, const AABBPacket8& boxes);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const OBBKernels& GetOBBKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const OBBKernels& GetOBBKernels(SimdLevel level);
+
+	/**
+	 * Tests one oriented box against eight, e.g. a vehicle against the props a broadphase paired it with.
+	 * @param obb The box.
+	 * @param obbs The boxes to test it against.
+	 * @returns A mask with bit i set when box i overlaps, touching included.
+	 */
+	uint32_t IntersectOBBs8(const OBB& obb, const OBBPacket8& obbs);
+
+	/**
+	 * Tests one oriented box against eight axis-aligned boxes, e.g. against static world geometry.
+	 * @param obb The box.
+	 * @param boxes The boxes to test it against.
+	 * @returns A mask with bit i set when box i overlaps, touching included.
+	 */
+	uint32_t IntersectAABBs8(const OBB& obb, const AABBPacket8& boxes);
+}
+
+#endif /* end of include guard: _OBB_BATCH_H_ */
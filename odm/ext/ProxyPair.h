@@ -0,0 +1,21 @@
+#pragma once
+
+#ifndef _PROXY_PAIR_H_
+#define _PROXY_PAIR_H_
+
+#include <cstdint>
+
+namespace odm
+{
+	/** Two objects whose bounds overlap, as found by a broadphase; a < b. */
+	struct ProxyPair
+	{
+		uint32_t a;
+		uint32_t b;
+
+		bool operator==(const ProxyPair& other) const { return a == other.a && b == other.b; }
+		bool operator!=(const ProxyPair& other) const { return !(*this == other); }
+	};
+}
+
+#endif /* end of include guard: _PROXY_PAIR_H_ */
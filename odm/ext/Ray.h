@@ -1,10 +1,17 @@
 #pragma once
 
+#include <cmath>
+#include <cstdint>
 #include "../Vector3f.h"
+#include "../MathUtil.h"
 #include "AABB.h"
 
 namespace odm
 {
+	/**
+	 * Segment from a start to an end point. Distances along it are measured in lengths of GetDirection(), so t = 1 is the end.
+	 * The inverse direction and its signs are computed once here, which makes box tests a handful of multiplies and no divides.
+	 */
 	class Ray
 	{
 	public:
@@ -12,8 +19,19 @@ namespace odm
 		Ray(const vec3f &start, const vec3f &end);
 		~Ray() = default;
 
+		/** Gets the distance at which the ray enters a box, 0 from inside and INFINITY when it misses; not limited to the segment. */
 		NODISCARD float HitDistance(const AABB& box) const;
 
+		/**
+		 * Slab test against a box (Williams et al.) without branches: the signs pick which face of each slab is entered first.
+		 * @param box The box.
+		 * @param tMin Receives the distance at which the ray enters the box, clamped to 0.
+		 * @param tMax Receives the distance at which the ray leaves the box, clamped to maxT.
+		 * @param maxT Distance beyond which the box is not looked for.
+		 * @returns Whether the ray passes through the box between 0 and maxT, i.e. tMin <= tMax.
+		 */
+		bool Intersect(const AABB& box, float& tMin, float& tMax, float maxT = INFINITY) const;
+
 		/// Gets the <b>starting position</b> of this ray.
 		NODISCARD const vec3f &GetStart() const { return m_Start; }
 
@@ -26,11 +44,36 @@ namespace odm
 		/// Gets the <b>direction</b> of this ray.
 		NODISCARD const vec3f &GetDirection() const { return m_Direction; }
 
+		/// Gets the <b>component-wise reciprocal of the direction</b>; infinite along axes the ray does not move along.
+		NODISCARD const vec3f &GetInverseDirection() const { return m_InverseDirection; }
+
+		/// Gets 1 when the direction is <b>negative</b> along an axis, else 0.
+		NODISCARD uint32_t GetSign(int axis) const { return m_Sign[axis]; }
+
 	private:
 		vec3f m_Start;
 		vec3f m_End;
 		vec3f m_Direction;
+		vec3f m_InverseDirection;
 		
-		float m_Length;
+		float m_Length = 0.0f;
+		uint8_t m_Sign[3] = {};
 	};
-}
\ No newline at end of file
+
+	inline bool Ray::Intersect(const AABB& box, float& tMin, float& tMax, float maxT) const
+	{
+		const float x0 = ((m_Sign[0] ? box.max.x : box.min.x) - m_Start.x) * m_InverseDirection.x;
+		const float x1 = ((m_Sign[0] ? box.min.x : box.max.x) - m_Start.x) * m_InverseDirection.x;
+		const float y0 = ((m_Sign[1] ? box.max.y : box.min.y) - m_Start.y) * m_InverseDirection.y;
+		const float y1 = ((m_Sign[1] ? box.min.y : box.max.y) - m_Start.y) * m_InverseDirection.y;
+		const float z0 = ((m_Sign[2] ? box.max.z : box.min.z) - m_Start.z) * m_InverseDirection.z;
+		const float z1 = ((m_Sign[2] ? box.min.z : box.max.z) - m_Start.z) * m_InverseDirection.z;
+		// A ray that does not move along an axis and starts on one of the box's faces on it gets 0 * inf = NaN there.
+		// Max and Min return their second operand when either is NaN, so the slabs go first and the running bound
+		// second: such a slab is skipped, as the ray stays on the face along that axis, and the others still count.
+		// The packet kernels in Ray_batch.cpp and MeshBVH_batch.cpp use the same order.
+		tMin = MathF::Max(x0, MathF::Max(y0, MathF::Max(z0, 0.0f)));
+		tMax = MathF::Min(x1, MathF::Min(y1, MathF::Min(z1, maxT)));
+		return tMin <= tMax;
+	}
+}
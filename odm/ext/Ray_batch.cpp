@@ -0,0 +1,250 @@
+#include "Ray_batch.h"
+
+#include <cassert>
+#include <cmath>
+#include "../Simd.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	RayPacket8::RayPacket8(Span<const Ray> rays, float maxTValue)
+	{
+		assert(rays.size() <= 8);
+		for (size_t i = 0; i < 8; ++i)
+		{
+			const bool used = i < rays.size();
+			const vec3 origin = used ? rays[i].GetStart() : vec3();
+			const vec3 inverse = used ? rays[i].GetInverseDirection() : vec3(1.0f);
+			originX[i] = origin.x;
+			originY[i] = origin.y;
+			originZ[i] = origin.z;
+			inverseX[i] = inverse.x;
+			inverseY[i] = inverse.y;
+			inverseZ[i] = inverse.z;
+			maxT[i] = used ? maxTValue : -1.0f;
+		}
+	}
+
+	AABBPacket8::AABBPacket8(Span<const AABB> boxes)
+	{
+		assert(boxes.size() <= 8);
+		for (size_t i = 0; i < 8; ++i)
+		{
+			// An inverted box: every ray enters it only after leaving it.
+			const AABB box = i < boxes.size() ? boxes[i] : AABB(vec3(INFINITY), vec3(-INFINITY));
+			minX[i] = box.min.x;
+			minY[i] = box.min.y;
+			minZ[i] = box.min.z;
+			maxX[i] = box.max.x;
+			maxY[i] = box.max.y;
+			maxZ[i] = box.max.z;
+		}
+	}
+
+#if ODM_SIMD_SSE
+
+	/** Lanes of b where mask is set, else of a; SSE2 has no blend. */
+	static inline __m128 Select4(__m128 a, __m128 b, __m128 mask)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+	}
+
+	/** Ray::Intersect of four rays against one box, in the same operations and order. */
+	static inline uint32_t IntersectRays4(const RayPacket8& rays, size_t first, const AABB& box, float* tNear)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 ix = _mm_load_ps(rays.inverseX + first), iy = _mm_load_ps(rays.inverseY + first), iz = _mm_load_ps(rays.inverseZ + first);
+		const __m128 ox = _mm_load_ps(rays.originX + first), oy = _mm_load_ps(rays.originY + first), oz = _mm_load_ps(rays.originZ + first);
+		const __m128 signX = _mm_cmplt_ps(ix, zero), signY = _mm_cmplt_ps(iy, zero), signZ = _mm_cmplt_ps(iz, zero);
+		const __m128 minX = _mm_set1_ps(box.min.x), minY = _mm_set1_ps(box.min.y), minZ = _mm_set1_ps(box.min.z);
+		const __m128 maxX = _mm_set1_ps(box.max.x), maxY = _mm_set1_ps(box.max.y), maxZ = _mm_set1_ps(box.max.z);
+
+		const __m128 x0 = _mm_mul_ps(_mm_sub_ps(Select4(minX, maxX, signX), ox), ix);
+		const __m128 x1 = _mm_mul_ps(_mm_sub_ps(Select4(maxX, minX, signX), ox), ix);
+		const __m128 y0 = _mm_mul_ps(_mm_sub_ps(Select4(minY, maxY, signY), oy), iy);
+		const __m128 y1 = _mm_mul_ps(_mm_sub_ps(Select4(maxY, minY, signY), oy), iy);
+		const __m128 z0 = _mm_mul_ps(_mm_sub_ps(Select4(minZ, maxZ, signZ), oz), iz);
+		const __m128 z1 = _mm_mul_ps(_mm_sub_ps(Select4(maxZ, minZ, signZ), oz), iz);
+		const __m128 tMin = _mm_max_ps(x0, _mm_max_ps(y0, _mm_max_ps(z0, zero)));
+		const __m128 tMax = _mm_min_ps(x1, _mm_min_ps(y1, _mm_min_ps(z1, _mm_load_ps(rays.maxT + first))));
+		const __m128 hit = _mm_cmple_ps(tMin, tMax);
+		_mm_storeu_ps(tNear + first, Select4(_mm_set1_ps(INFINITY), tMin, hit));
+		return static_cast<uint32_t>(_mm_movemask_ps(hit));
+	}
+
+	static uint32_t IntersectRays8SSE(const RayPacket8& rays, const AABB& box, float* tNear)
+	{
+		return IntersectRays4(rays, 0, box, tNear) | (IntersectRays4(rays, 4, box, tNear) << 4);
+	}
+
+	/** Ray::Intersect of one ray against four boxes; the ray's signs pick the face arrays once for all lanes. */
+	static inline uint32_t IntersectBoxes4(const Ray& ray, const AABBPacket8& boxes, size_t first, float maxT, float* tNear)
+	{
+		const vec3& origin = ray.GetStart();
+		const vec3& inverse = ray.GetInverseDirection();
+		const float* nearX = ray.GetSign(0) ? boxes.maxX : boxes.minX;
+		const float* farX = ray.GetSign(0) ? boxes.minX : boxes.maxX;
+		const float* nearY = ray.GetSign(1) ? boxes.maxY : boxes.minY;
+		const float* farY = ray.GetSign(1) ? boxes.minY : boxes.maxY;
+		const float* nearZ = ray.GetSign(2) ? boxes.maxZ : boxes.minZ;
+		const float* farZ = ray.GetSign(2) ? boxes.minZ : boxes.maxZ;
+
+		const __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+		const __m128 ix = _mm_set1_ps(inverse.x), iy = _mm_set1_ps(inverse.y), iz = _mm_set1_ps(inverse.z);
+		const __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(nearX + first), ox), ix);
+		const __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(farX + first), ox), ix);
+		const __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(nearY + first), oy), iy);
+		const __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(farY + first), oy), iy);
+		const __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(nearZ + first), oz), iz);
+		const __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(farZ + first), oz), iz);
+		const __m128 tMin = _mm_max_ps(x0, _mm_max_ps(y0, _mm_max_ps(z0, _mm_setzero_ps())));
+		const __m128 tMax = _mm_min_ps(x1, _mm_min_ps(y1, _mm_min_ps(z1, _mm_set1_ps(maxT))));
+		const __m128 hit = _mm_cmple_ps(tMin, tMax);
+		_mm_storeu_ps(tNear + first, Select4(_mm_set1_ps(INFINITY), tMin, hit));
+		return static_cast<uint32_t>(_mm_movemask_ps(hit));
+	}
+
+	static uint32_t IntersectBoxes8SSE(const Ray& ray, const AABBPacket8& boxes, float maxT, float* tNear)
+	{
+		return IntersectBoxes4(ray, boxes, 0, maxT, tNear) | (IntersectBoxes4(ray, boxes, 4, maxT, tNear) << 4);
+	}
+
+#else
+
+	static uint32_t IntersectRays8Baseline(const RayPacket8& rays, const AABB& box, float* tNear)
+	{
+		uint32_t mask = 0;
+		for (size_t i = 0; i < 8; ++i)
+		{
+			const float x0 = ((rays.inverseX[i] < 0.0f ? box.max.x : box.min.x) - rays.originX[i]) * rays.inverseX[i];
+			const float x1 = ((rays.inverseX[i] < 0.0f ? box.min.x : box.max.x) - rays.originX[i]) * rays.inverseX[i];
+			const float y0 = ((rays.inverseY[i] < 0.0f ? box.max.y : box.min.y) - rays.originY[i]) * rays.inverseY[i];
+			const float y1 = ((rays.inverseY[i] < 0.0f ? box.min.y : box.max.y) - rays.originY[i]) * rays.inverseY[i];
+			const float z0 = ((rays.inverseZ[i] < 0.0f ? box.max.z : box.min.z) - rays.originZ[i]) * rays.inverseZ[i];
+			const float z1 = ((rays.inverseZ[i] < 0.0f ? box.min.z : box.max.z) - rays.originZ[i]) * rays.inverseZ[i];
+			const float tMin = MathF::Max(x0, MathF::Max(y0, MathF::Max(z0, 0.0f)));
+			const float tMax = MathF::Min(x1, MathF::Min(y1, MathF::Min(z1, rays.maxT[i])));
+			const bool hit = tMin <= tMax;
+			tNear[i] = hit ? tMin : INFINITY;
+			mask |= static_cast<uint32_t>(hit) << i;
+		}
+		return mask;
+	}
+
+	static uint32_t IntersectBoxes8Baseline(const Ray& ray, const AABBPacket8& boxes, float maxT, float* tNear)
+	{
+		uint32_t mask = 0;
+		for (size_t i = 0; i < 8; ++i)
+		{
+			const AABB box(vec3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), vec3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]));
+			float tMin, tMax;
+			const bool hit = ray.Intersect(box, tMin, tMax, maxT);
+			tNear[i] = hit ? tMin : INFINITY;
+			mask |= static_cast<uint32_t>(hit) << i;
+		}
+		return mask;
+	}
+
+#endif
+
+#if ODM_SIMD_SSE
+	static const RayKernels s_BaselineKernels = { SimdLevel::Baseline, &IntersectRays8SSE, &IntersectBoxes8SSE };
+#else
+	static const RayKernels s_BaselineKernels = { SimdLevel::Baseline, &IntersectRays8Baseline, &IntersectBoxes8Baseline };
+#endif
+
+#if ODM_SIMD_SSE
+#pragma region AVX2
+
+	ODM_TARGET("avx2,fma")
+	static uint32_t IntersectRays8AVX2(const RayPacket8& rays, const AABB& box, float* tNear)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 ix = _mm256_load_ps(rays.inverseX), iy = _mm256_load_ps(rays.inverseY), iz = _mm256_load_ps(rays.inverseZ);
+		const __m256 ox = _mm256_load_ps(rays.originX), oy = _mm256_load_ps(rays.originY), oz = _mm256_load_ps(rays.originZ);
+		const __m256 signX = _mm256_cmp_ps(ix, zero, _CMP_LT_OQ), signY = _mm256_cmp_ps(iy, zero, _CMP_LT_OQ), signZ = _mm256_cmp_ps(iz, zero, _CMP_LT_OQ);
+		const __m256 minX = _mm256_set1_ps(box.min.x), minY = _mm256_set1_ps(box.min.y), minZ = _mm256_set1_ps(box.min.z);
+		const __m256 maxX = _mm256_set1_ps(box.max.x), maxY = _mm256_set1_ps(box.max.y), maxZ = _mm256_set1_ps(box.max.z);
+
+		const __m256 x0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_blendv_ps(minX, maxX, signX), ox), ix);
+		const __m256 x1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_blendv_ps(maxX, minX, signX), ox), ix);
+		const __m256 y0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_blendv_ps(minY, maxY, signY), oy), iy);
+		const __m256 y1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_blendv_ps(maxY, minY, signY), oy), iy);
+		const __m256 z0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_blendv_ps(minZ, maxZ, signZ), oz), iz);
+		const __m256 z1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_blendv_ps(maxZ, minZ, signZ), oz), iz);
+		const __m256 tMin = _mm256_max_ps(x0, _mm256_max_ps(y0, _mm256_max_ps(z0, zero)));
+		const __m256 tMax = _mm256_min_ps(x1, _mm256_min_ps(y1, _mm256_min_ps(z1, _mm256_load_ps(rays.maxT))));
+		const __m256 hit = _mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ);
+		_mm256_storeu_ps(tNear, _mm256_blendv_ps(_mm256_set1_ps(INFINITY), tMin, hit));
+		return static_cast<uint32_t>(_mm256_movemask_ps(hit));
+	}
+
+	ODM_TARGET("avx2,fma")
+	static uint32_t IntersectBoxes8AVX2(const Ray& ray, const AABBPacket8& boxes, float maxT, float* tNear)
+	{
+		const vec3& origin = ray.GetStart();
+		const vec3& inverse = ray.GetInverseDirection();
+		const float* nearX = ray.GetSign(0) ? boxes.maxX : boxes.minX;
+		const float* farX = ray.GetSign(0) ? boxes.minX : boxes.maxX;
+		const float* nearY = ray.GetSign(1) ? boxes.maxY : boxes.minY;
+		const float* farY = ray.GetSign(1) ? boxes.minY : boxes.maxY;
+		const float* nearZ = ray.GetSign(2) ? boxes.maxZ : boxes.minZ;
+		const float* farZ = ray.GetSign(2) ? boxes.minZ : boxes.maxZ;
+
+		const __m256 ox = _mm256_set1_ps(origin.x), oy = _mm256_set1_ps(origin.y), oz = _mm256_set1_ps(origin.z);
+		const __m256 ix = _mm256_set1_ps(inverse.x), iy = _mm256_set1_ps(inverse.y), iz = _mm256_set1_ps(inverse.z);
+		const __m256 x0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(nearX), ox), ix);
+		const __m256 x1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(farX), ox), ix);
+		const __m256 y0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(nearY), oy), iy);
+		const __m256 y1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(farY), oy), iy);
+		const __m256 z0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(nearZ), oz), iz);
+		const __m256 z1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(farZ), oz), iz);
+		const __m256 tMin = _mm256_max_ps(x0, _mm256_max_ps(y0, _mm256_max_ps(z0, _mm256_setzero_ps())));
+		const __m256 tMax = _mm256_min_ps(x1, _mm256_min_ps(y1, _mm256_min_ps(z1, _mm256_set1_ps(maxT))));
+		const __m256 hit = _mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ);
+		_mm256_storeu_ps(tNear, _mm256_blendv_ps(_mm256_set1_ps(INFINITY), tMin, hit));
+		return static_cast<uint32_t>(_mm256_movemask_ps(hit));
+	}
+
+	static const RayKernels s_AVX2Kernels = { SimdLevel::AVX2, &IntersectRays8AVX2, &IntersectBoxes8AVX2 };
+
+#pragma endregion
+#endif
+
+	const RayKernels& GetRayKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:
+			return s_AVX2Kernels;
+		default:
+			break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const RayKernels& GetRayKernels()
+	{
+		static const RayKernels& kernels = GetRayKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	uint32_t IntersectRays8(const RayPacket8& rays, const AABB& box, Span<float> tNear)
+	{
+		assert(tNear.size() >= 8);
+		return GetRayKernels().IntersectRays8(rays, box, tNear.data());
+	}
+
+	uint32_t IntersectBoxes8(const Ray& ray, const AABBPacket8& boxes, float maxT, Span<float> tNear)
+	{
+		assert(tNear.size() >= 8);
+		return GetRayKernels().IntersectBoxes8(ray, boxes, maxT, tNear.data());
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#ifndef _RAY_BATCH_H_
+#define _RAY_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "Ray.h"
+#include "../Cpu.h"
+#include "../Span.h"
+
+namespace odm
+{
+	/** Eight rays in structure-of-arrays form, for testing them together against one box. */
+	struct RayPacket8
+	{
+		alignas(32) float originX[8];
+		alignas(32) float originY[8];
+		alignas(32) float originZ[8];
+		alignas(32) float inverseX[8];		// Ray::GetInverseDirection() of each ray.
+		alignas(32) float inverseY[8];
+		alignas(32) float inverseZ[8];
+		alignas(32) float maxT[8];			// Hits further than this are ignored; negative for lanes without a ray.
+
+		/**
+		 * Packs up to eight rays; the lanes past the last ray never hit.
+		 * @param rays The rays.
+		 * @param maxT Distance beyond which boxes are not looked for, in lengths of each ray's direction; 1 stops at the rays' ends.
+		 */
+		explicit RayPacket8(Span<const Ray> rays, float maxT = 1.0f);
+	};
+
+	/** Eight boxes in structure-of-arrays form, for testing them together against one ray. */
+	struct AABBPacket8
+	{
+		alignas(32) float minX[8];
+		alignas(32) float minY[8];
+		alignas(32) float minZ[8];
+		alignas(32) float maxX[8];
+		alignas(32) float maxY[8];
+		alignas(32) float maxZ[8];
+
+		/**
+		 * Packs up to eight boxes; the lanes past the last box hold empty boxes, which no ray hits.
+		 * @param boxes The boxes.
+		 */
+		explicit AABBPacket8(Span<const AABB> boxes);
+	};
+
+	/**
+	 * Table of ray packet kernels compiled for one instruction set tier.
+	 * Both return a mask with bit i set when lane i hits, and store each lane's entry distance or INFINITY when it misses;
+	 * every lane gives the same answer as Ray::Intersect.
+	 */
+	struct RayKernels
+	{
+		SimdLevel level;
+
+		/** Tests the eight rays of a packet against one box. */
+		uint32_t (*IntersectRays8)(const RayPacket8& rays, const AABB& box, float* tNear);
+
+		/** Tests one ray against the eight boxes of a packet, up to maxT. */
+		uint32_t (*IntersectBoxes8)(const Ray& ray, const AABBPacket8& boxes, float maxT, float* tNear);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const RayKernels& GetRayKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const RayKernels& GetRayKernels(SimdLevel level);
+
+	/**
+	 * Tests eight rays against one box, e.g. a packet of coherent rays against a hierarchy node.
+	 * @param rays The rays.
+	 * @param box The box.
+	 * @param tNear Receives the entry distance of each ray, INFINITY for the ones that miss; eight floats.
+	 * @returns A mask with bit i set when ray i hits.
+	 */
+	uint32_t IntersectRays8(const RayPacket8& rays, const AABB& box, Span<float> tNear);
+
+	/**
+	 * Tests one ray against eight boxes, e.g. the children of a wide hierarchy node.
+	 * @param ray The ray.
+	 * @param boxes The boxes.
+	 * @param maxT Distance beyond which boxes are not looked for; 1 stops at the ray's end.
+	 * @param tNear Receives the entry distance into each box, INFINITY for the ones missed; eight floats.
+	 * @returns A mask with bit i set when box i is hit.
+	 */
+	uint32_t IntersectBoxes8(const Ray& ray, const AABBPacket8& boxes, float maxT, Span<float> tNear);
+}
+
+#endif /* end of include guard: _RAY_BATCH_H_ */
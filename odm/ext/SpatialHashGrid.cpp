@@ -0,0 +1,139 @@
+#include "SpatialHashGrid.h"
+
+#include "Morton_batch.h"
+
+namespace odm
+{
+	/** Points per piece of the chunked passes of a build. */
+	static constexpr size_t GridChunkSize = 16384;
+
+	SpatialHashGrid::SpatialHashGrid(float cellSize)
+		: m_CellSize(cellSize), m_InverseCellSize(1.0f / cellSize)
+	{
+		assert(cellSize > 0.0f);
+	}
+
+	void SpatialHashGrid::Clear()
+	{
+		m_HashShift = 64;
+		m_Slots.clear();
+		m_Cells.clear();
+		m_CellStarts.clear();
+		m_Indices.clear();
+		m_X.clear();
+		m_Y.clear();
+		m_Z.clear();
+	}
+
+	void SpatialHashGrid::Build(Vec3SoASpan<const float> positions, TaskScheduler* scheduler)
+	{
+		const float* x = positions.X();
+		const float* y = positions.Y();
+		const float* z = positions.Z();
+		BuildFrom(positions.size(), [=](size_t i) { return vec3(x[i], y[i], z[i]); }, scheduler);
+	}
+
+	void SpatialHashGrid::Build(Span<const vec3> positions, TaskScheduler* scheduler)
+	{
+		const vec3* points = positions.data();
+		BuildFrom(positions.size(), [=](size_t i) { return points[i]; }, scheduler);
+	}
+
+	template <class GetPoint>
+	void SpatialHashGrid::BuildFrom(size_t count, const GetPoint& getPoint, TaskScheduler* scheduler)
+	{
+		assert(count < UINT32_MAX);
+		Clear();
+		if (count == 0)
+			return;
+
+		// Sorting by key groups the points by cell and lays the cells out in Morton order.
+		std::vector<uint64_t> keys(count);
+		m_Indices.resize(count);
+		ParallelForChunks(scheduler, count, GridChunkSize, [&](uint32_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				keys[i] = GetKey(GetCell(getPoint(i)));
+				m_Indices[i] = static_cast<uint32_t>(i);
+			}
+		});
+		SortMortonCodes(Span<uint64_t>(keys), Span<uint32_t>(m_Indices), scheduler);
+
+		m_X.resize(count);
+		m_Y.resize(count);
+		m_Z.resize(count);
+		ParallelForChunks(scheduler, count, GridChunkSize, [&](uint32_t, size_t begin, size_t end) {
+			for (size_t entry = begin; entry < end; ++entry)
+			{
+				const vec3 point = getPoint(m_Indices[entry]);
+				m_X[entry] = point.x;
+				m_Y[entry] = point.y;
+				m_Z[entry] = point.z;
+			}
+		});
+
+		for (size_t entry = 0; entry < count; ++entry)
+		{
+			if (entry == 0 || keys[entry] != keys[entry - 1])
+			{
+				m_Cells.push_back(GetCell(vec3(m_X[entry], m_Y[entry], m_Z[entry])));
+				m_CellStarts.push_back(static_cast<uint32_t>(entry));
+			}
+		}
+		m_CellStarts.push_back(static_cast<uint32_t>(count));
+
+		// At most half full, so probe sequences stay short.
+		size_t slotCount = 2;
+		m_HashShift = 63;
+		while (slotCount < 2 * m_Cells.size())
+		{
+			slotCount *= 2;
+			--m_HashShift;
+		}
+		m_Slots.assign(slotCount, Slot{ EmptyKey, 0 });
+
+		const size_t mask = slotCount - 1;
+		for (uint32_t cellIndex = 0; cellIndex < m_Cells.size(); ++cellIndex)
+		{
+			const uint64_t key = keys[m_CellStarts[cellIndex]];
+			size_t slot = static_cast<size_t>(Hash(key) >> m_HashShift);
+			while (m_Slots[slot].key != EmptyKey)
+				slot = (slot + 1) & mask;
+			m_Slots[slot] = { key, cellIndex };
+		}
+	}
+
+	template <class Test>
+	void SpatialHashGrid::Query(const AABB& box, std::vector<uint32_t>& results, const Test& test) const
+	{
+		results.clear();
+		VisitCells(box, [&](Span<const uint32_t> points) {
+			const size_t first = static_cast<size_t>(points.data() - m_Indices.data());
+			for (size_t entry = first; entry < first + points.size(); ++entry)
+			{
+				if (test(m_X[entry], m_Y[entry], m_Z[entry]))
+					results.push_back(m_Indices[entry]);
+			}
+			return true;
+		});
+	}
+
+	void SpatialHashGrid::QueryRadius(const vec3& center, float radius, std::vector<uint32_t>& results) const
+	{
+		const float radiusSquared = radius * radius;
+		const vec3 extent(radius);
+		Query(AABB(center - extent, center + extent), results, [&](float x, float y, float z) {
+			const float dx = x - center.x;
+			const float dy = y - center.y;
+			const float dz = z - center.z;
+			return dx * dx + dy * dy + dz * dz <= radiusSquared;
+		});
+	}
+
+	void SpatialHashGrid::QueryBox(const AABB& box, std::vector<uint32_t>& results) const
+	{
+		Query(box, results, [&](float x, float y, float z) {
+			return box.Contains(vec3(x, y, z));
+		});
+	}
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#ifndef _SPATIAL_HASH_GRID_H_
+#define _SPATIAL_HASH_GRID_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "AABB.h"
+#include "Morton.h"
+#include "Sphere.h"
+#include "../Span.h"
+#include "../TaskScheduler.h"
+#include "../Vec3SoA.h"
+
+namespace odm
+{
+	/** Integer coordinates of a cell of a SpatialHashGrid. */
+	struct GridCell
+	{
+		int32_t x;
+		int32_t y;
+		int32_t z;
+	};
+
+	/**
+	 * Uniform grid over points whose occupied cells live in an open-addressing hash table, so the grid is unbounded and costs memory
+	 * only for cells that hold points. The points of each cell are stored contiguously, cells in Morton order, so a cell and its
+	 * neighbours are mostly close in memory.
+	 * The grid is rebuilt as a whole, typically once per tick; queries are read-only and may run on several threads at once.
+	 */
+	class SpatialHashGrid
+	{
+	public:
+		/** Cells per axis the grid can tell apart, centered on the origin; points further out are clamped onto the outermost cells. */
+		static constexpr int32_t CellRange = 1 << Morton63AxisBits;
+
+		/**
+		 * Constructs an empty grid.
+		 * @param cellSize Edge length of a cell; about the typical query radius works best.
+		 */
+		explicit SpatialHashGrid(float cellSize = 1.0f);
+
+		/**
+		 * Replaces the content with a set of points, e.g. all agents or particles of this tick.
+		 * @param positions The points; point i gets index i.
+		 * @param scheduler Computes the cells, sorts and gathers the points on several threads when given.
+		 */
+		void Build(Vec3SoASpan<const float> positions, TaskScheduler* scheduler = nullptr);
+
+		/**
+		 * Replaces the content with a set of points.
+		 * @param positions The points; point i gets index i.
+		 * @param scheduler Computes the cells, sorts and gathers the points on several threads when given.
+		 */
+		void Build(Span<const vec3> positions, TaskScheduler* scheduler = nullptr);
+
+		/** Removes every point, keeping the allocations. */
+		void Clear();
+
+		/** Gets the cell a point falls in. */
+		NODISCARD GridCell GetCell(const vec3& point) const
+		{
+			return { QuantizeAxis(point.x), QuantizeAxis(point.y), QuantizeAxis(point.z) };
+		}
+
+		/**
+		 * Gets the points of one cell in constant time.
+		 * @returns Indices of the points; empty when the cell holds none. Valid until the next Build or Clear.
+		 */
+		NODISCARD Span<const uint32_t> GetCellPoints(const GridCell& cell) const
+		{
+			const uint32_t cellIndex = FindCell(GetKey(cell));
+			return cellIndex == UINT32_MAX ? Span<const uint32_t>() : GetEntries(cellIndex);
+		}
+
+		/**
+		 * Calls callback(indices) with the points of every occupied cell a box touches, so callers can run their own tests on whole cells.
+		 * @param box The query box.
+		 * @param callback Takes a Span<const uint32_t> of point indices; returns false to stop.
+		 */
+		template <class Callback>
+		void VisitCells(const AABB& box, Callback&& callback) const
+		{
+			if (m_Cells.empty())
+				return;
+
+			const GridCell low = GetCell(box.min);
+			const GridCell high = GetCell(box.max);
+			if (high.x < low.x || high.y < low.y || high.z < low.z)
+				return;
+
+			// A box spanning more cells than are occupied is cheaper to answer by walking the occupied cells.
+			const uint64_t volume = static_cast<uint64_t>(high.x - low.x + 1) * static_cast<uint64_t>(high.y - low.y + 1) * static_cast<uint64_t>(high.z - low.z + 1);
+			if (volume > m_Cells.size())
+			{
+				for (uint32_t cellIndex = 0; cellIndex < m_Cells.size(); ++cellIndex)
+				{
+					const GridCell& cell = m_Cells[cellIndex];
+					if (cell.x >= low.x && cell.x <= high.x && cell.y >= low.y && cell.y <= high.y && cell.z >= low.z && cell.z <= high.z)
+					{
+						if (!callback(GetEntries(cellIndex)))
+							return;
+					}
+				}
+				return;
+			}
+
+			for (int32_t x = low.x; x <= high.x; ++x)
+			{
+				for (int32_t y = low.y; y <= high.y; ++y)
+				{
+					for (int32_t z = low.z; z <= high.z; ++z)
+					{
+						const Span<const uint32_t> points = GetCellPoints({ x, y, z });
+						if (!points.empty() && !callback(points))
+							return;
+					}
+				}
+			}
+		}
+
+		/**
+		 * Finds the points within a distance of a center, boundary included.
+		 * @param center Center of the query sphere.
+		 * @param radius Radius of the query sphere.
+		 * @param results Receives the point indices, grouped by cell; cleared first.
+		 */
+		void QueryRadius(const vec3& center, float radius, std::vector<uint32_t>& results) const;
+
+		/** Finds the points inside a sphere, boundary included; see QueryRadius. */
+		void QuerySphere(const Sphere& sphere, std::vector<uint32_t>& results) const { QueryRadius(sphere.Center, sphere.Radius, results); }
+
+		/**
+		 * Finds the points inside a box, in the sense of AABB::Contains.
+		 * @param box The query box.
+		 * @param results Receives the point indices, grouped by cell; cleared first.
+		 */
+		void QueryBox(const AABB& box, std::vector<uint32_t>& results) const;
+
+		NODISCARD float GetCellSize() const { return m_CellSize; }
+		NODISCARD size_t GetPointCount() const { return m_Indices.size(); }
+		NODISCARD size_t GetCellCount() const { return m_Cells.size(); }
+
+	private:
+		struct Slot
+		{
+			uint64_t key;
+			uint32_t cell;
+		};
+
+		static constexpr uint64_t EmptyKey = UINT64_MAX;
+
+		NODISCARD int32_t QuantizeAxis(float v) const
+		{
+			const float cell = std::floor(v * m_InverseCellSize);
+			const float limit = static_cast<float>(CellRange / 2);
+			return static_cast<int32_t>(std::min(std::max(cell, -limit), limit - 1.0f));
+		}
+
+		/** Morton code of a cell, its coordinates offset to be unsigned; never EmptyKey since the top bit stays clear. */
+		NODISCARD static uint64_t GetKey(const GridCell& cell)
+		{
+			constexpr int64_t bias = CellRange / 2;
+			const auto clamp = [](int32_t v) { return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(v + bias, 0), CellRange - 1)); };
+			return EncodeMorton63(clamp(cell.x), clamp(cell.y), clamp(cell.z));
+		}
+
+		NODISCARD static uint64_t Hash(uint64_t key) { return key * 0x9E3779B97F4A7C15ull; }
+
+		/** Looks up a cell by key; UINT32_MAX when no point falls in it. */
+		NODISCARD uint32_t FindCell(uint64_t key) const
+		{
+			if (m_Slots.empty())
+				return UINT32_MAX;
+
+			const size_t mask = m_Slots.size() - 1;
+			for (size_t slot = static_cast<size_t>(Hash(key) >> m_HashShift);; slot = (slot + 1) & mask)
+			{
+				if (m_Slots[slot].key == key)
+					return m_Slots[slot].cell;
+				if (m_Slots[slot].key == EmptyKey)
+					return UINT32_MAX;
+			}
+		}
+
+		NODISCARD Span<const uint32_t> GetEntries(uint32_t cellIndex) const
+		{
+			return Span<const uint32_t>(m_Indices.data() + m_CellStarts[cellIndex], m_CellStarts[cellIndex + 1] - m_CellStarts[cellIndex]);
+		}
+
+		template <class GetPoint>
+		void BuildFrom(size_t count, const GetPoint& getPoint, TaskScheduler* scheduler);
+
+		template <class Test>
+		void Query(const AABB& box, std::vector<uint32_t>& results, const Test& test) const;
+
+		float m_CellSize;
+		float m_InverseCellSize;
+		uint32_t m_HashShift = 64;
+		std::vector<Slot> m_Slots;				// Open-addressing table with linear probing, a power of two at most half full.
+		std::vector<GridCell> m_Cells;			// Coordinates of each occupied cell, in ascending order of key.
+		std::vector<uint32_t> m_CellStarts;		// First entry of each cell, plus one past the last entry.
+		std::vector<uint32_t> m_Indices;		// Point index of each entry, grouped by cell.
+		std::vector<float> m_X, m_Y, m_Z;		// Position of each entry.
+	};
+}
+
+#endif /* end of include guard: _SPATIAL_HASH_GRID_H_ */
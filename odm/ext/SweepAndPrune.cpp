@@ -0,0 +1,333 @@
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include "../Simd.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace odm
+{
+	/** Objects per piece of the chunked passes over all objects. */
+	static constexpr size_t GatherChunkSize = 16384;
+
+	/** Positions of the sweep per task of the pair scan. */
+	static constexpr size_t ScanChunkSize = 1024;
+
+	/** Element moves per object the insertion sort may spend before it gives up on coherence and sorts from scratch. */
+	static constexpr size_t InsertionSortBudget = 16;
+
+	/** How much more the centers must spread along another axis before the sweep changes axis and loses its coherent order. */
+	static constexpr double AxisSwitchRatio = 1.5;
+
+	static inline ProxyPair MakePair(uint32_t a, uint32_t b)
+	{
+		return a < b ? ProxyPair{ a, b } : ProxyPair{ b, a };
+	}
+
+	static inline int CountTrailingZeros(uint32_t v)
+	{
+		assert(v != 0);
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, v);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(v);
+#endif
+	}
+
+	/** Reports the pairs of position i with the positions whose lanes are set in mask, the first lane being position j. */
+	static inline void EmitPairs(uint32_t mask, const uint32_t* objects, size_t i, size_t j, std::vector<ProxyPair>& pairs)
+	{
+		while (mask != 0)
+		{
+			pairs.push_back(MakePair(objects[i], objects[j + CountTrailingZeros(mask)]));
+			mask &= mask - 1;
+		}
+	}
+
+#if ODM_SIMD_SSE
+
+	/** Tests four boxes at a time; lanes past the end of the overlap on the sweep axis fail their own sweep-axis test. */
+	static void ScanPairsSSE(const float* const axes[6], const uint32_t* objects, size_t first, size_t end, std::vector<ProxyPair>& pairs)
+	{
+		const float* minA = axes[0];
+		const float* maxA = axes[1];
+		const float* minB = axes[2];
+		const float* maxB = axes[3];
+		const float* minC = axes[4];
+		const float* maxC = axes[5];
+		for (size_t i = first; i < end; ++i)
+		{
+			const __m128 minAi = _mm_set1_ps(minA[i]), maxAi = _mm_set1_ps(maxA[i]);
+			const __m128 minBi = _mm_set1_ps(minB[i]), maxBi = _mm_set1_ps(maxB[i]);
+			const __m128 minCi = _mm_set1_ps(minC[i]), maxCi = _mm_set1_ps(maxC[i]);
+			for (size_t j = i + 1; minA[j] < maxA[i]; j += 4)
+			{
+				__m128 overlap = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(minA + j), maxAi), _mm_cmpgt_ps(_mm_loadu_ps(maxA + j), minAi));
+				overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(minB + j), maxBi), _mm_cmpgt_ps(_mm_loadu_ps(maxB + j), minBi)));
+				overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(minC + j), maxCi), _mm_cmpgt_ps(_mm_loadu_ps(maxC + j), minCi)));
+				EmitPairs(static_cast<uint32_t>(_mm_movemask_ps(overlap)), objects, i, j, pairs);
+			}
+		}
+	}
+
+	static const SweepAndPruneKernels s_BaselineKernels = { SimdLevel::Baseline, &ScanPairsSSE };
+
+#pragma region AVX2
+
+	ODM_TARGET("avx2,fma")
+	static void ScanPairsAVX2(const float* const axes[6], const uint32_t* objects, size_t first, size_t end, std::vector<ProxyPair>& pairs)
+	{
+		const float* minA = axes[0];
+		const float* maxA = axes[1];
+		const float* minB = axes[2];
+		const float* maxB = axes[3];
+		const float* minC = axes[4];
+		const float* maxC = axes[5];
+		for (size_t i = first; i < end; ++i)
+		{
+			const __m256 minAi = _mm256_set1_ps(minA[i]), maxAi = _mm256_set1_ps(maxA[i]);
+			const __m256 minBi = _mm256_set1_ps(minB[i]), maxBi = _mm256_set1_ps(maxB[i]);
+			const __m256 minCi = _mm256_set1_ps(minC[i]), maxCi = _mm256_set1_ps(maxC[i]);
+			for (size_t j = i + 1; minA[j] < maxA[i]; j += 8)
+			{
+				__m256 overlap = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(minA + j), maxAi, _CMP_LT_OQ),
+					_mm256_cmp_ps(_mm256_loadu_ps(maxA + j), minAi, _CMP_GT_OQ));
+				overlap = _mm256_and_ps(overlap, _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(minB + j), maxBi, _CMP_LT_OQ),
+					_mm256_cmp_ps(_mm256_loadu_ps(maxB + j), minBi, _CMP_GT_OQ)));
+				overlap = _mm256_and_ps(overlap, _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(minC + j), maxCi, _CMP_LT_OQ),
+					_mm256_cmp_ps(_mm256_loadu_ps(maxC + j), minCi, _CMP_GT_OQ)));
+				EmitPairs(static_cast<uint32_t>(_mm256_movemask_ps(overlap)), objects, i, j, pairs);
+			}
+		}
+	}
+
+	// AVX-512 shares these kernels; most boxes overlap only a few neighbours on the sweep axis, so wider blocks would mostly test padding.
+	static const SweepAndPruneKernels s_AVX2Kernels = { SimdLevel::AVX2, &ScanPairsAVX2 };
+
+#pragma endregion
+
+#else
+
+	static void ScanPairsScalar(const float* const axes[6], const uint32_t* objects, size_t first, size_t end, std::vector<ProxyPair>& pairs)
+	{
+		const float* minA = axes[0];
+		const float* maxA = axes[1];
+		const float* minB = axes[2];
+		const float* maxB = axes[3];
+		const float* minC = axes[4];
+		const float* maxC = axes[5];
+		for (size_t i = first; i < end; ++i)
+		{
+			// The padding starts at +infinity, so the walk always stops at the end of the arrays.
+			for (size_t j = i + 1; minA[j] < maxA[i]; ++j)
+			{
+				if (maxA[j] > minA[i] && minB[j] < maxB[i] && maxB[j] > minB[i] && minC[j] < maxC[i] && maxC[j] > minC[i])
+					pairs.push_back(MakePair(objects[i], objects[j]));
+			}
+		}
+	}
+
+	static const SweepAndPruneKernels s_BaselineKernels = { SimdLevel::Baseline, &ScanPairsScalar };
+
+#endif
+
+	const SweepAndPruneKernels& GetSweepAndPruneKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:
+			return s_AVX2Kernels;
+		default:
+			break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const SweepAndPruneKernels& GetSweepAndPruneKernels()
+	{
+		static const SweepAndPruneKernels& kernels = GetSweepAndPruneKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	/**
+	 * Picks the axis along which the box centers spread most.
+	 * @param current Axis kept unless another is clearly better, or -1 when there is none to keep.
+	 */
+	int SweepAndPrune::ChooseAxis(Span<const AABB> bounds, int current, TaskScheduler* scheduler) const
+	{
+		struct Moments
+		{
+			double sum[3] = {};
+			double sumSquares[3] = {};
+		};
+
+		// Per-chunk sums added up in chunk order, so the choice does not depend on the scheduler.
+		std::vector<Moments> partial((bounds.size() + GatherChunkSize - 1) / GatherChunkSize);
+		ParallelForChunks(scheduler, bounds.size(), GatherChunkSize, [&](uint32_t chunk, size_t begin, size_t end) {
+			Moments& moments = partial[chunk];
+			for (size_t i = begin; i < end; ++i)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					const double center = 0.5 * (static_cast<double>(bounds[i].min[axis]) + bounds[i].max[axis]);
+					moments.sum[axis] += center;
+					moments.sumSquares[axis] += center * center;
+				}
+			}
+		});
+
+		Moments total;
+		for (const Moments& moments : partial)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				total.sum[axis] += moments.sum[axis];
+				total.sumSquares[axis] += moments.sumSquares[axis];
+			}
+		}
+
+		double variance[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const double mean = total.sum[axis] / static_cast<double>(bounds.size());
+			variance[axis] = total.sumSquares[axis] / static_cast<double>(bounds.size()) - mean * mean;
+		}
+
+		int best = 0;
+		for (int axis = 1; axis < 3; ++axis)
+		{
+			if (variance[axis] > variance[best])
+				best = axis;
+		}
+		return current < 0 || variance[best] > AxisSwitchRatio * variance[current] ? best : current;
+	}
+
+	void SweepAndPrune::Sort(Span<const AABB> bounds, bool restart)
+	{
+		const int axis = m_Axis;
+		const auto byMin = [&](uint32_t a, uint32_t b) {
+			return bounds[a].min[axis] < bounds[b].min[axis];
+		};
+
+		if (restart)
+		{
+			m_Order.resize(bounds.size());
+			std::iota(m_Order.begin(), m_Order.end(), 0u);
+			std::stable_sort(m_Order.begin(), m_Order.end(), byMin);
+			return;
+		}
+
+		// Frame coherence leaves most objects where they were; the insertion sort only pays for the ones that passed a neighbour.
+		const size_t count = m_Order.size();
+		std::vector<float> keys(count);
+		for (size_t k = 0; k < count; ++k)
+			keys[k] = bounds[m_Order[k]].min[axis];
+
+		const size_t budget = InsertionSortBudget * count;
+		size_t moves = 0;
+		for (size_t i = 1; i < count; ++i)
+		{
+			const float key = keys[i];
+			const uint32_t object = m_Order[i];
+			size_t j = i;
+			for (; j > 0 && keys[j - 1] > key; --j)
+			{
+				keys[j] = keys[j - 1];
+				m_Order[j] = m_Order[j - 1];
+			}
+			keys[j] = key;
+			m_Order[j] = object;
+
+			moves += i - j;
+			if (moves > budget)
+			{
+				// The scene changed too much for the old order to help.
+				std::stable_sort(m_Order.begin(), m_Order.end(), byMin);
+				return;
+			}
+		}
+	}
+
+	void SweepAndPrune::Update(Span<const AABB> bounds, TaskScheduler* scheduler)
+	{
+		assert(bounds.size() <= UINT32_MAX);
+		const size_t count = bounds.size();
+		bool restart = count != m_Order.size();
+		if (count != 0)
+		{
+			const int axis = ChooseAxis(bounds, restart ? -1 : m_Axis, scheduler);
+			restart |= axis != m_Axis;
+			m_Axis = axis;
+		}
+		Sort(bounds, restart);
+
+		const int axisB = (m_Axis + 1) % 3;
+		const int axisC = (m_Axis + 2) % 3;
+		for (std::vector<float>& values : m_Axes)
+			values.resize(count + SweepPadding);
+
+		ParallelForChunks(scheduler, count, GatherChunkSize, [&](uint32_t, size_t begin, size_t end) {
+			for (size_t k = begin; k < end; ++k)
+			{
+				const AABB& box = bounds[m_Order[k]];
+				m_Axes[0][k] = box.min[m_Axis];
+				m_Axes[1][k] = box.max[m_Axis];
+				m_Axes[2][k] = box.min[axisB];
+				m_Axes[3][k] = box.max[axisB];
+				m_Axes[4][k] = box.min[axisC];
+				m_Axes[5][k] = box.max[axisC];
+			}
+		});
+
+		for (size_t k = count; k < count + SweepPadding; ++k)
+		{
+			m_Axes[0][k] = std::numeric_limits<float>::infinity();
+			for (int i = 1; i < 6; ++i)
+				m_Axes[i][k] = 0.0f;
+		}
+	}
+
+	void SweepAndPrune::FindPairs(std::vector<ProxyPair>& pairs, TaskScheduler* scheduler) const
+	{
+		pairs.clear();
+		const size_t count = m_Order.size();
+		if (count < 2)
+			return;
+
+		const float* const axes[6] = { m_Axes[0].data(), m_Axes[1].data(), m_Axes[2].data(), m_Axes[3].data(), m_Axes[4].data(), m_Axes[5].data() };
+		const SweepAndPruneKernels& kernels = GetSweepAndPruneKernels();
+		if (scheduler == nullptr || count <= ScanChunkSize)
+		{
+			kernels.ScanPairs(axes, m_Order.data(), 0, count, pairs);
+			return;
+		}
+
+		// Every position only looks ahead of itself, so stretches of the sweep axis are scanned independently.
+		std::vector<std::vector<ProxyPair>> partial((count + ScanChunkSize - 1) / ScanChunkSize);
+		ParallelForChunks(scheduler, count, ScanChunkSize, [&](uint32_t chunk, size_t begin, size_t end) {
+			kernels.ScanPairs(axes, m_Order.data(), begin, end, partial[chunk]);
+		});
+
+		size_t total = 0;
+		for (const std::vector<ProxyPair>& found : partial)
+			total += found.size();
+		pairs.reserve(total);
+		for (const std::vector<ProxyPair>& found : partial)
+			pairs.insert(pairs.end(), found.begin(), found.end());
+	}
+}
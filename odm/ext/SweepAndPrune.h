@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef _SWEEP_AND_PRUNE_H_
+#define _SWEEP_AND_PRUNE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "AABB.h"
+#include "ProxyPair.h"
+#include "../Cpu.h"
+#include "../Span.h"
+#include "../TaskScheduler.h"
+
+namespace odm
+{
+	/** Table of sweep kernels compiled for one instruction set tier. */
+	struct SweepAndPruneKernels
+	{
+		SimdLevel level;
+
+		/**
+		 * Reports every overlapping pair (i, j) with first <= i < end and i < j, positions in sweep order.
+		 * @param axes Min and max of the sweep axis, then of the two other axes, each in sweep order and followed by SweepPadding
+		 *        entries whose sweep-axis min is +infinity.
+		 * @param objects Object index at each position of the sweep.
+		 * @param pairs Receives the pairs of object indices; appended to.
+		 */
+		void (*ScanPairs)(const float* const axes[6], const uint32_t* objects, size_t first, size_t end, std::vector<ProxyPair>& pairs);
+	};
+
+	/** Entries past the last object that every sweep array carries, so kernels can load whole registers at the tail. */
+	static constexpr size_t SweepPadding = 8;
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const SweepAndPruneKernels& GetSweepAndPruneKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const SweepAndPruneKernels& GetSweepAndPruneKernels(SimdLevel level);
+
+	/**
+	 * Sweep-and-prune broadphase over a span of boxes that is handed in again every frame.
+	 * Boxes are kept sorted by their min on the axis along which their centers spread most; since objects move little from frame to frame,
+	 * an insertion sort starting from the previous order brings them back in order in close to linear time.
+	 * The scan then walks forward from each box while the next ones start before it ends, testing the other axes several boxes at a time.
+	 */
+	class SweepAndPrune
+	{
+	public:
+		/**
+		 * Sorts the boxes of this frame.
+		 * @param bounds Box of every object; object i is bounds[i]. A change in count starts the order over.
+		 * @param scheduler Gathers the sorted boxes on several threads when given.
+		 */
+		void Update(Span<const AABB> bounds, TaskScheduler* scheduler = nullptr);
+
+		/**
+		 * Finds every pair of boxes that overlap, in the sense of AABB::Intersects, as of the last Update.
+		 * @param pairs Receives the pairs; cleared first. The order follows the sweep and does not depend on the scheduler.
+		 * @param scheduler Scans separate stretches of the sweep axis on several threads when given.
+		 */
+		void FindPairs(std::vector<ProxyPair>& pairs, TaskScheduler* scheduler = nullptr) const;
+
+		/** Gets the axis the boxes are sorted along, 0 to 2. */
+		NODISCARD int GetSweepAxis() const { return m_Axis; }
+
+		/** Gets the number of objects as of the last Update. */
+		NODISCARD size_t GetObjectCount() const { return m_Order.size(); }
+
+		/** Gets the objects in sweep order. */
+		NODISCARD const std::vector<uint32_t>& GetOrder() const { return m_Order; }
+
+	private:
+		int ChooseAxis(Span<const AABB> bounds, int current, TaskScheduler* scheduler) const;
+		void Sort(Span<const AABB> bounds, bool restart);
+
+		int m_Axis = 0;
+		std::vector<uint32_t> m_Order;			// Objects in ascending order of their min on m_Axis.
+		std::vector<float> m_Axes[6];			// Min and max on m_Axis, then on the two other axes, in sweep order and padded.
+	};
+}
+
+#endif /* end of include guard: _SWEEP_AND_PRUNE_H_ */
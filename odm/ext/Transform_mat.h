@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Mat4x4.h"
+#include "../Quaternion.h"
 
 namespace odm
 {
@@ -19,6 +20,13 @@ namespace odm
 	 */
 	NODISCARD inline Matrix4x4 rotate(const Matrix4x4 &m, float angle, const Vector3f &v);
 
+	/**
+	 * Builds a rotation 4x4 matrix from a quaternion, without the sin and cos of the angle/axis overload.
+	 * @param m Input matrix multiplied by this rotation matrix.
+	 * @param q Rotation expressed as a unit quaternion.
+	 */
+	NODISCARD inline Matrix4x4 rotate(const Matrix4x4 &m, const Quaternion &q);
+
 	/**
 	 * Builds a scale 4x4 matrix created from vector of 3 scalars.
 	 * @param m Input matrix multiplied by this scale matrix.
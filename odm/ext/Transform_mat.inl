@@ -38,6 +38,18 @@ namespace odm
 		return Result;
 	}
 
+	Matrix4x4 rotate(const Matrix4x4& m, const Quaternion& q)
+	{
+		const Matrix4x4 Rotate(q.ToMatrix());
+
+		Matrix4x4 Result;
+		Result[0] = m[0] * Rotate[0][0] + m[1] * Rotate[0][1] + m[2] * Rotate[0][2];
+		Result[1] = m[0] * Rotate[1][0] + m[1] * Rotate[1][1] + m[2] * Rotate[1][2];
+		Result[2] = m[0] * Rotate[2][0] + m[1] * Rotate[2][1] + m[2] * Rotate[2][2];
+		Result[3] = m[3];
+		return Result;
+	}
+
 	Matrix4x4 scale(const Matrix4x4& m, const Vector3f& v)
 	{
 		auto Result(m);
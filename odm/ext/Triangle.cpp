@@ -0,0 +1,102 @@
+#include "Triangle.h"
+
+#include <cmath>
+#include <utility>
+
+namespace odm
+{
+	RayShear::RayShear(const Ray& ray)
+	{
+		const vec3& direction = ray.GetDirection();
+		const float absX = std::abs(direction.x), absY = std::abs(direction.y), absZ = std::abs(direction.z);
+		kz = absX > absY ? (absX > absZ ? 0 : 2) : (absY > absZ ? 1 : 2);
+		kx = kz == 2 ? 0 : kz + 1;
+		ky = kx == 2 ? 0 : kx + 1;
+
+		// Looking down a negative axis mirrors the plane, which swapping x and y undoes so that the winding is kept.
+		if (direction[kz] < 0.0f)
+			std::swap(kx, ky);
+
+		sx = direction[kx] / direction[kz];
+		sy = direction[ky] / direction[kz];
+		sz = 1.0f / direction[kz];
+	}
+
+	bool Triangle::Intersect(const Ray& ray, TriangleHit& hit, float maxT) const
+	{
+		const vec3& direction = ray.GetDirection();
+		const vec3 edge1 = v1 - v0;
+		const vec3 edge2 = v2 - v0;
+		const vec3 p = direction.Cross(edge2);
+		const float det = edge1.Dot(p);
+		if (det == 0.0f)
+			return false;
+
+		const float inverseDet = 1.0f / det;
+		const vec3 s = ray.GetStart() - v0;
+		const float u = s.Dot(p) * inverseDet;
+		if (!(u >= 0.0f))
+			return false;
+
+		const vec3 q = s.Cross(edge1);
+		const float v = direction.Dot(q) * inverseDet;
+		if (!(v >= 0.0f && u + v <= 1.0f))
+			return false;
+
+		const float t = edge2.Dot(q) * inverseDet;
+		if (!(t >= 0.0f && t <= maxT))
+			return false;
+
+		hit.t = t;
+		hit.u = u;
+		hit.v = v;
+		return true;
+	}
+
+	bool Triangle::IntersectWatertight(const Ray& ray, const RayShear& shear, TriangleHit& hit, float maxT) const
+	{
+		const vec3& origin = ray.GetStart();
+		const vec3 a = v0 - origin;
+		const vec3 b = v1 - origin;
+		const vec3 c = v2 - origin;
+
+		// The corners in the sheared space where the ray runs along +z from the origin.
+		const float ax = a[shear.kx] - shear.sx * a[shear.kz];
+		const float ay = a[shear.ky] - shear.sy * a[shear.kz];
+		const float bx = b[shear.kx] - shear.sx * b[shear.kz];
+		const float by = b[shear.ky] - shear.sy * b[shear.kz];
+		const float cx = c[shear.kx] - shear.sx * c[shear.kz];
+		const float cy = c[shear.ky] - shear.sy * c[shear.kz];
+
+		// Scaled barycentrics; w0 belongs to v0. An exact zero may be a rounded sign, so it is settled in double precision.
+		float w0 = cx * by - cy * bx;
+		float w1 = ax * cy - ay * cx;
+		float w2 = bx * ay - by * ax;
+		if (w0 == 0.0f || w1 == 0.0f || w2 == 0.0f)
+		{
+			w0 = static_cast<float>(static_cast<double>(cx) * by - static_cast<double>(cy) * bx);
+			w1 = static_cast<float>(static_cast<double>(ax) * cy - static_cast<double>(ay) * cx);
+			w2 = static_cast<float>(static_cast<double>(bx) * ay - static_cast<double>(by) * ax);
+		}
+
+		if ((w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) && (w0 > 0.0f || w1 > 0.0f || w2 > 0.0f))
+			return false;
+
+		const float det = w0 + w1 + w2;
+		if (det == 0.0f)
+			return false;
+
+		const float az = shear.sz * a[shear.kz];
+		const float bz = shear.sz * b[shear.kz];
+		const float cz = shear.sz * c[shear.kz];
+		const float inverseDet = 1.0f / det;
+		const float t = (w0 * az + w1 * bz + w2 * cz) * inverseDet;
+		if (!(t >= 0.0f && t <= maxT))
+			return false;
+
+		hit.t = t;
+		hit.u = w1 * inverseDet;
+		hit.v = w2 * inverseDet;
+		return true;
+	}
+}
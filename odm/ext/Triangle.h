@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef _TRIANGLE_H_
+#define _TRIANGLE_H_
+
+#include <cstdint>
+#include "AABB.h"
+#include "Ray.h"
+
+namespace odm
+{
+	/** Where a ray meets a triangle. */
+	struct TriangleHit
+	{
+		float t = INFINITY;		// Distance along the ray in units of Ray::GetDirection().
+		float u = 0.0f;			// Barycentric weight of v1; the hit point is (1 - u - v) * v0 + u * v1 + v * v2.
+		float v = 0.0f;			// Barycentric weight of v2.
+	};
+
+	/**
+	 * Ray constants of the watertight test: the axis the ray runs most along becomes z, and the shear that maps the ray onto
+	 * the z axis. Computing them once serves every triangle the ray is tested against.
+	 */
+	struct RayShear
+	{
+		int kx, ky, kz;			// Axes permuted so that kz is the dominant axis of the direction, keeping the winding.
+		float sx, sy, sz;
+
+		explicit RayShear(const Ray& ray);
+	};
+
+	/** Triangle given by its three corners; front faces wind counter-clockwise, though both faces are hit. */
+	struct Triangle
+	{
+		vec3 v0;
+		vec3 v1;
+		vec3 v2;
+
+		Triangle() = default;
+		Triangle(const vec3& a, const vec3& b, const vec3& c)
+			: v0(a), v1(b), v2(c)
+		{}
+
+		/** Gets the normal of the front face, not normalized; its length is twice the area. */
+		NODISCARD vec3 GetNormal() const { return (v1 - v0).Cross(v2 - v0); }
+
+		NODISCARD vec3 Center() const { return (v0 + v1 + v2) * (1.0f / 3.0f); }
+
+		NODISCARD AABB GetBounds() const
+		{
+			return AABB(vec3::Min(vec3::Min(v0, v1), v2), vec3::Max(vec3::Max(v0, v1), v2));
+		}
+
+		/**
+		 * Möller–Trumbore test, the fast variant: no setup per ray, but rays through a shared edge may slip between its two triangles.
+		 * @param ray The ray.
+		 * @param hit Receives the distance and barycentrics when the ray hits; left untouched otherwise.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored; 1 stops at the ray's end.
+		 * @returns Whether the ray hits the triangle between 0 and maxT.
+		 */
+		bool Intersect(const Ray& ray, TriangleHit& hit, float maxT = 1.0f) const;
+
+		/**
+		 * Watertight test (Woop, Benthin and Wald, "Watertight Ray/Triangle Intersection"): a ray through an edge or vertex shared
+		 * by several triangles hits at least one of them, which closed meshes need to keep rays from leaking through.
+		 * @param ray The ray.
+		 * @param shear RayShear(ray), shared by every test of the ray.
+		 * @param hit Receives the distance and barycentrics when the ray hits; left untouched otherwise.
+		 * @param maxT Hits further than this many Ray::GetDirection() lengths are ignored; 1 stops at the ray's end.
+		 * @returns Whether the ray hits the triangle between 0 and maxT.
+		 */
+		bool IntersectWatertight(const Ray& ray, const RayShear& shear, TriangleHit& hit, float maxT = 1.0f) const;
+
+		/** IntersectWatertight computing the shear of the ray itself. */
+		bool IntersectWatertight(const Ray& ray, TriangleHit& hit, float maxT = 1.0f) const { return IntersectWatertight(ray, RayShear(ray), hit, maxT); }
+	};
+}
+
+#endif /* end of include guard: _TRIANGLE_H_ */
@@ -0,0 +1,310 @@
+#include "Triangle_batch.h"
+
+#include "../Simd.h"
+
+#if ODM_SIMD_SSE
+	#include <immintrin.h>
+#endif
+
+namespace odm
+{
+	/** Stores the scalar watertight answer of one lane; returns its bit of the hit mask. */
+	template <size_t N>
+	static inline uint32_t IntersectLaneWatertight(const Ray& ray, const RayShear& shear, const TrianglePacket<N>& triangles, size_t lane, float maxT,
+		TrianglePacketHits<N>& hits)
+	{
+		TriangleHit hit;
+		const bool isHit = triangles.GetTriangle(lane).IntersectWatertight(ray, shear, hit, maxT);
+		hits.t[lane] = isHit ? hit.t : INFINITY;
+		hits.u[lane] = hit.u;
+		hits.v[lane] = hit.v;
+		return isHit ? 1u << lane : 0u;
+	}
+
+#if ODM_SIMD_SSE
+
+	/** Lanes of b where mask is set, else of a; SSE2 has no blend. */
+	static inline __m128 Select4(__m128 a, __m128 b, __m128 mask)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+	}
+
+	/** Triangle::Intersect of one ray against four lanes of a packet, in the same operations and order. */
+	template <size_t N>
+	static inline uint32_t Intersect4(const Ray& ray, const TrianglePacket<N>& triangles, size_t first, float maxT, TrianglePacketHits<N>& hits)
+	{
+		const vec3& direction = ray.GetDirection();
+		const vec3& origin = ray.GetStart();
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 dx = _mm_set1_ps(direction.x), dy = _mm_set1_ps(direction.y), dz = _mm_set1_ps(direction.z);
+		const __m128 v0x = _mm_load_ps(triangles.v0[0] + first), v0y = _mm_load_ps(triangles.v0[1] + first), v0z = _mm_load_ps(triangles.v0[2] + first);
+
+		const __m128 e1x = _mm_sub_ps(_mm_load_ps(triangles.v1[0] + first), v0x);
+		const __m128 e1y = _mm_sub_ps(_mm_load_ps(triangles.v1[1] + first), v0y);
+		const __m128 e1z = _mm_sub_ps(_mm_load_ps(triangles.v1[2] + first), v0z);
+		const __m128 e2x = _mm_sub_ps(_mm_load_ps(triangles.v2[0] + first), v0x);
+		const __m128 e2y = _mm_sub_ps(_mm_load_ps(triangles.v2[1] + first), v0y);
+		const __m128 e2z = _mm_sub_ps(_mm_load_ps(triangles.v2[2] + first), v0z);
+
+		const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(e2y, dz));
+		const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(e2z, dx));
+		const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(e2x, dy));
+		const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		const __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		const __m128 sx = _mm_sub_ps(_mm_set1_ps(origin.x), v0x), sy = _mm_sub_ps(_mm_set1_ps(origin.y), v0y), sz = _mm_sub_ps(_mm_set1_ps(origin.z), v0z);
+		const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+		const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(e1y, sz));
+		const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(e1z, sx));
+		const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(e1x, sy));
+		const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+		const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+		__m128 hit = _mm_and_ps(_mm_cmpneq_ps(det, zero), _mm_cmpge_ps(u, zero));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f))));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmple_ps(t, _mm_set1_ps(maxT))));
+		_mm_store_ps(hits.t + first, Select4(_mm_set1_ps(INFINITY), t, hit));
+		_mm_store_ps(hits.u + first, _mm_and_ps(hit, u));
+		_mm_store_ps(hits.v + first, _mm_and_ps(hit, v));
+		return static_cast<uint32_t>(_mm_movemask_ps(hit)) << first;
+	}
+
+	/** Triangle::IntersectWatertight of one ray against four lanes of a packet, in the same operations and order. */
+	template <size_t N>
+	static inline uint32_t IntersectWatertight4(const Ray& ray, const RayShear& shear, const TrianglePacket<N>& triangles, size_t first, float maxT,
+		TrianglePacketHits<N>& hits)
+	{
+		const vec3& origin = ray.GetStart();
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 ox = _mm_set1_ps(origin[shear.kx]), oy = _mm_set1_ps(origin[shear.ky]), oz = _mm_set1_ps(origin[shear.kz]);
+		const __m128 shearX = _mm_set1_ps(shear.sx), shearY = _mm_set1_ps(shear.sy), shearZ = _mm_set1_ps(shear.sz);
+
+		const __m128 az = _mm_sub_ps(_mm_load_ps(triangles.v0[shear.kz] + first), oz);
+		const __m128 bz = _mm_sub_ps(_mm_load_ps(triangles.v1[shear.kz] + first), oz);
+		const __m128 cz = _mm_sub_ps(_mm_load_ps(triangles.v2[shear.kz] + first), oz);
+		const __m128 ax = _mm_sub_ps(_mm_sub_ps(_mm_load_ps(triangles.v0[shear.kx] + first), ox), _mm_mul_ps(shearX, az));
+		const __m128 ay = _mm_sub_ps(_mm_sub_ps(_mm_load_ps(triangles.v0[shear.ky] + first), oy), _mm_mul_ps(shearY, az));
+		const __m128 bx = _mm_sub_ps(_mm_sub_ps(_mm_load_ps(triangles.v1[shear.kx] + first), ox), _mm_mul_ps(shearX, bz));
+		const __m128 by = _mm_sub_ps(_mm_sub_ps(_mm_load_ps(triangles.v1[shear.ky] + first), oy), _mm_mul_ps(shearY, bz));
+		const __m128 cx = _mm_sub_ps(_mm_sub_ps(_mm_load_ps(triangles.v2[shear.kx] + first), ox), _mm_mul_ps(shearX, cz));
+		const __m128 cy = _mm_sub_ps(_mm_sub_ps(_mm_load_ps(triangles.v2[shear.ky] + first), oy), _mm_mul_ps(shearY, cz));
+
+		const __m128 w0 = _mm_sub_ps(_mm_mul_ps(cx, by), _mm_mul_ps(cy, bx));
+		const __m128 w1 = _mm_sub_ps(_mm_mul_ps(ax, cy), _mm_mul_ps(ay, cx));
+		const __m128 w2 = _mm_sub_ps(_mm_mul_ps(bx, ay), _mm_mul_ps(by, ax));
+		const __m128 negative = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(w0, zero), _mm_cmplt_ps(w1, zero)), _mm_cmplt_ps(w2, zero));
+		const __m128 positive = _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(w0, zero), _mm_cmpgt_ps(w1, zero)), _mm_cmpgt_ps(w2, zero));
+		const __m128 onEdge = _mm_or_ps(_mm_or_ps(_mm_cmpeq_ps(w0, zero), _mm_cmpeq_ps(w1, zero)), _mm_cmpeq_ps(w2, zero));
+
+		const __m128 det = _mm_add_ps(_mm_add_ps(w0, w1), w2);
+		const __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+		const __m128 weightedZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, _mm_mul_ps(shearZ, az)), _mm_mul_ps(w1, _mm_mul_ps(shearZ, bz))),
+			_mm_mul_ps(w2, _mm_mul_ps(shearZ, cz)));
+		const __m128 t = _mm_mul_ps(weightedZ, inverseDet);
+
+		__m128 hit = _mm_andnot_ps(_mm_and_ps(negative, positive), _mm_cmpneq_ps(det, zero));
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmple_ps(t, _mm_set1_ps(maxT))));
+		_mm_store_ps(hits.t + first, Select4(_mm_set1_ps(INFINITY), t, hit));
+		_mm_store_ps(hits.u + first, _mm_and_ps(hit, _mm_mul_ps(w1, inverseDet)));
+		_mm_store_ps(hits.v + first, _mm_and_ps(hit, _mm_mul_ps(w2, inverseDet)));
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(hit)) << first;
+
+		// Rays through an edge or corner leave a weight at zero, which the scalar test settles in double precision.
+		const uint32_t edges = static_cast<uint32_t>(_mm_movemask_ps(onEdge)) << first;
+		for (size_t lane = first; edges != 0 && lane < first + 4; ++lane)
+		{
+			if (edges & (1u << lane))
+				mask = (mask & ~(1u << lane)) | IntersectLaneWatertight(ray, shear, triangles, lane, maxT, hits);
+		}
+		return mask;
+	}
+
+	static uint32_t Intersect4SSE(const Ray& ray, const TrianglePacket4& triangles, float maxT, TrianglePacketHits4& hits)
+	{
+		return Intersect4(ray, triangles, 0, maxT, hits);
+	}
+
+	static uint32_t Intersect8SSE(const Ray& ray, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits)
+	{
+		return Intersect4(ray, triangles, 0, maxT, hits) | Intersect4(ray, triangles, 4, maxT, hits);
+	}
+
+	static uint32_t IntersectWatertight4SSE(const Ray& ray, const RayShear& shear, const TrianglePacket4& triangles, float maxT, TrianglePacketHits4& hits)
+	{
+		return IntersectWatertight4(ray, shear, triangles, 0, maxT, hits);
+	}
+
+	static uint32_t IntersectWatertight8SSE(const Ray& ray, const RayShear& shear, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits)
+	{
+		return IntersectWatertight4(ray, shear, triangles, 0, maxT, hits) | IntersectWatertight4(ray, shear, triangles, 4, maxT, hits);
+	}
+
+	static const TriangleKernels s_BaselineKernels = { SimdLevel::Baseline, &Intersect4SSE, &Intersect8SSE, &IntersectWatertight4SSE, &IntersectWatertight8SSE };
+
+#pragma region AVX2
+
+	// Compiled without FMA on purpose: a contracted a * b - c * d rounds its two products differently, so the edge shared by two
+	// triangles would no longer weigh exactly opposite in both, which is what keeps the watertight test from leaking.
+	ODM_TARGET("avx2")
+	static uint32_t Intersect8AVX2(const Ray& ray, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits)
+	{
+		const vec3& direction = ray.GetDirection();
+		const vec3& origin = ray.GetStart();
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 dx = _mm256_set1_ps(direction.x), dy = _mm256_set1_ps(direction.y), dz = _mm256_set1_ps(direction.z);
+		const __m256 v0x = _mm256_load_ps(triangles.v0[0]), v0y = _mm256_load_ps(triangles.v0[1]), v0z = _mm256_load_ps(triangles.v0[2]);
+
+		const __m256 e1x = _mm256_sub_ps(_mm256_load_ps(triangles.v1[0]), v0x);
+		const __m256 e1y = _mm256_sub_ps(_mm256_load_ps(triangles.v1[1]), v0y);
+		const __m256 e1z = _mm256_sub_ps(_mm256_load_ps(triangles.v1[2]), v0z);
+		const __m256 e2x = _mm256_sub_ps(_mm256_load_ps(triangles.v2[0]), v0x);
+		const __m256 e2y = _mm256_sub_ps(_mm256_load_ps(triangles.v2[1]), v0y);
+		const __m256 e2z = _mm256_sub_ps(_mm256_load_ps(triangles.v2[2]), v0z);
+
+		const __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(e2y, dz));
+		const __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(e2z, dx));
+		const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(e2x, dy));
+		const __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+		const __m256 inverseDet = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+
+		const __m256 sx = _mm256_sub_ps(_mm256_set1_ps(origin.x), v0x), sy = _mm256_sub_ps(_mm256_set1_ps(origin.y), v0y), sz = _mm256_sub_ps(_mm256_set1_ps(origin.z), v0z);
+		const __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), inverseDet);
+		const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(e1y, sz));
+		const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(e1z, sx));
+		const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(e1x, sy));
+		const __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), inverseDet);
+		const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), inverseDet);
+
+		__m256 hit = _mm256_and_ps(_mm256_cmp_ps(det, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), _mm256_set1_ps(1.0f), _CMP_LE_OQ)));
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GE_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(maxT), _CMP_LE_OQ)));
+		_mm256_store_ps(hits.t, _mm256_blendv_ps(_mm256_set1_ps(INFINITY), t, hit));
+		_mm256_store_ps(hits.u, _mm256_and_ps(hit, u));
+		_mm256_store_ps(hits.v, _mm256_and_ps(hit, v));
+		return static_cast<uint32_t>(_mm256_movemask_ps(hit));
+	}
+
+	ODM_TARGET("avx2")
+	static uint32_t IntersectWatertight8AVX2(const Ray& ray, const RayShear& shear, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits)
+	{
+		const vec3& origin = ray.GetStart();
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 ox = _mm256_set1_ps(origin[shear.kx]), oy = _mm256_set1_ps(origin[shear.ky]), oz = _mm256_set1_ps(origin[shear.kz]);
+		const __m256 shearX = _mm256_set1_ps(shear.sx), shearY = _mm256_set1_ps(shear.sy), shearZ = _mm256_set1_ps(shear.sz);
+
+		const __m256 az = _mm256_sub_ps(_mm256_load_ps(triangles.v0[shear.kz]), oz);
+		const __m256 bz = _mm256_sub_ps(_mm256_load_ps(triangles.v1[shear.kz]), oz);
+		const __m256 cz = _mm256_sub_ps(_mm256_load_ps(triangles.v2[shear.kz]), oz);
+		const __m256 ax = _mm256_sub_ps(_mm256_sub_ps(_mm256_load_ps(triangles.v0[shear.kx]), ox), _mm256_mul_ps(shearX, az));
+		const __m256 ay = _mm256_sub_ps(_mm256_sub_ps(_mm256_load_ps(triangles.v0[shear.ky]), oy), _mm256_mul_ps(shearY, az));
+		const __m256 bx = _mm256_sub_ps(_mm256_sub_ps(_mm256_load_ps(triangles.v1[shear.kx]), ox), _mm256_mul_ps(shearX, bz));
+		const __m256 by = _mm256_sub_ps(_mm256_sub_ps(_mm256_load_ps(triangles.v1[shear.ky]), oy), _mm256_mul_ps(shearY, bz));
+		const __m256 cx = _mm256_sub_ps(_mm256_sub_ps(_mm256_load_ps(triangles.v2[shear.kx]), ox), _mm256_mul_ps(shearX, cz));
+		const __m256 cy = _mm256_sub_ps(_mm256_sub_ps(_mm256_load_ps(triangles.v2[shear.ky]), oy), _mm256_mul_ps(shearY, cz));
+
+		const __m256 w0 = _mm256_sub_ps(_mm256_mul_ps(cx, by), _mm256_mul_ps(cy, bx));
+		const __m256 w1 = _mm256_sub_ps(_mm256_mul_ps(ax, cy), _mm256_mul_ps(ay, cx));
+		const __m256 w2 = _mm256_sub_ps(_mm256_mul_ps(bx, ay), _mm256_mul_ps(by, ax));
+		const __m256 negative = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(w0, zero, _CMP_LT_OQ), _mm256_cmp_ps(w1, zero, _CMP_LT_OQ)), _mm256_cmp_ps(w2, zero, _CMP_LT_OQ));
+		const __m256 positive = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(w0, zero, _CMP_GT_OQ), _mm256_cmp_ps(w1, zero, _CMP_GT_OQ)), _mm256_cmp_ps(w2, zero, _CMP_GT_OQ));
+		const __m256 onEdge = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(w0, zero, _CMP_EQ_OQ), _mm256_cmp_ps(w1, zero, _CMP_EQ_OQ)), _mm256_cmp_ps(w2, zero, _CMP_EQ_OQ));
+
+		const __m256 det = _mm256_add_ps(_mm256_add_ps(w0, w1), w2);
+		const __m256 inverseDet = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+		const __m256 weightedZ = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w0, _mm256_mul_ps(shearZ, az)), _mm256_mul_ps(w1, _mm256_mul_ps(shearZ, bz))),
+			_mm256_mul_ps(w2, _mm256_mul_ps(shearZ, cz)));
+		const __m256 t = _mm256_mul_ps(weightedZ, inverseDet);
+
+		__m256 hit = _mm256_andnot_ps(_mm256_and_ps(negative, positive), _mm256_cmp_ps(det, zero, _CMP_NEQ_UQ));
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GE_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(maxT), _CMP_LE_OQ)));
+		_mm256_store_ps(hits.t, _mm256_blendv_ps(_mm256_set1_ps(INFINITY), t, hit));
+		_mm256_store_ps(hits.u, _mm256_and_ps(hit, _mm256_mul_ps(w1, inverseDet)));
+		_mm256_store_ps(hits.v, _mm256_and_ps(hit, _mm256_mul_ps(w2, inverseDet)));
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(hit));
+
+		const uint32_t edges = static_cast<uint32_t>(_mm256_movemask_ps(onEdge));
+		for (size_t lane = 0; edges != 0 && lane < 8; ++lane)
+		{
+			if (edges & (1u << lane))
+				mask = (mask & ~(1u << lane)) | IntersectLaneWatertight(ray, shear, triangles, lane, maxT, hits);
+		}
+		return mask;
+	}
+
+	// Four lanes fit one SSE register, so the 4-wide tests stay on the baseline kernels.
+	static const TriangleKernels s_AVX2Kernels = { SimdLevel::AVX2, &Intersect4SSE, &Intersect8AVX2, &IntersectWatertight4SSE, &IntersectWatertight8AVX2 };
+
+#pragma endregion
+#else
+
+	template <size_t N>
+	static uint32_t IntersectBaseline(const Ray& ray, const TrianglePacket<N>& triangles, float maxT, TrianglePacketHits<N>& hits)
+	{
+		uint32_t mask = 0;
+		for (size_t lane = 0; lane < N; ++lane)
+		{
+			TriangleHit hit;
+			const bool isHit = triangles.GetTriangle(lane).Intersect(ray, hit, maxT);
+			hits.t[lane] = isHit ? hit.t : INFINITY;
+			hits.u[lane] = hit.u;
+			hits.v[lane] = hit.v;
+			mask |= isHit ? 1u << lane : 0u;
+		}
+		return mask;
+	}
+
+	template <size_t N>
+	static uint32_t IntersectWatertightBaseline(const Ray& ray, const RayShear& shear, const TrianglePacket<N>& triangles, float maxT, TrianglePacketHits<N>& hits)
+	{
+		uint32_t mask = 0;
+		for (size_t lane = 0; lane < N; ++lane)
+			mask |= IntersectLaneWatertight(ray, shear, triangles, lane, maxT, hits);
+		return mask;
+	}
+
+	static const TriangleKernels s_BaselineKernels = { SimdLevel::Baseline, &IntersectBaseline<4>, &IntersectBaseline<8>, &IntersectWatertightBaseline<4>,
+		&IntersectWatertightBaseline<8> };
+#endif
+
+	const TriangleKernels& GetTriangleKernels(SimdLevel level)
+	{
+		assert(IsSimdLevelSupported(level));
+#if ODM_SIMD_SSE
+		switch (level)
+		{
+		case SimdLevel::AVX2:
+		case SimdLevel::AVX512:
+			return s_AVX2Kernels;
+		default:
+			break;
+		}
+#endif
+		return s_BaselineKernels;
+	}
+
+	const TriangleKernels& GetTriangleKernels()
+	{
+		static const TriangleKernels& kernels = GetTriangleKernels(GetSimdLevel());
+		return kernels;
+	}
+
+	uint32_t Intersect(const Ray& ray, const TrianglePacket4& triangles, float maxT, TrianglePacketHits4& hits)
+	{
+		return GetTriangleKernels().Intersect4(ray, triangles, maxT, hits);
+	}
+
+	uint32_t Intersect(const Ray& ray, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits)
+	{
+		return GetTriangleKernels().Intersect8(ray, triangles, maxT, hits);
+	}
+
+	uint32_t IntersectWatertight(const Ray& ray, const RayShear& shear, const TrianglePacket4& triangles, float maxT, TrianglePacketHits4& hits)
+	{
+		return GetTriangleKernels().IntersectWatertight4(ray, shear, triangles, maxT, hits);
+	}
+
+	uint32_t IntersectWatertight(const Ray& ray, const RayShear& shear, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits)
+	{
+		return GetTriangleKernels().IntersectWatertight8(ray, shear, triangles, maxT, hits);
+	}
+}
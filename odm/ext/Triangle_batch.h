@@ -0,0 +1,136 @@
+#pragma once
+
+#ifndef _TRIANGLE_BATCH_H_
+#define _TRIANGLE_BATCH_H_
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "Triangle.h"
+#include "../Cpu.h"
+#include "../Span.h"
+
+namespace odm
+{
+	/**
+	 * N triangles in structure-of-arrays form, for testing them together against one ray.
+	 * The corners are indexed [axis][lane], so the watertight test can pick the axes of its shear by index.
+	 */
+	template <size_t N>
+	struct TrianglePacket
+	{
+		static constexpr size_t Width = N;
+
+		alignas(N * sizeof(float)) float v0[3][N];
+		alignas(N * sizeof(float)) float v1[3][N];
+		alignas(N * sizeof(float)) float v2[3][N];
+
+		TrianglePacket() = default;
+
+		/**
+		 * Packs up to N triangles; the lanes past the last triangle hold NaN corners, which no ray hits.
+		 * @param triangles The triangles.
+		 */
+		explicit TrianglePacket(Span<const Triangle> triangles)
+		{
+			assert(triangles.size() <= N);
+			for (size_t i = 0; i < N; ++i)
+			{
+				const Triangle triangle = i < triangles.size() ? triangles[i] : Triangle(vec3(NAN), vec3(NAN), vec3(NAN));
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					v0[axis][i] = triangle.v0[axis];
+					v1[axis][i] = triangle.v1[axis];
+					v2[axis][i] = triangle.v2[axis];
+				}
+			}
+		}
+
+		/** Gets the triangle of one lane. */
+		NODISCARD Triangle GetTriangle(size_t lane) const
+		{
+			assert(lane < N);
+			return Triangle(vec3(v0[0][lane], v0[1][lane], v0[2][lane]), vec3(v1[0][lane], v1[1][lane], v1[2][lane]),
+				vec3(v2[0][lane], v2[1][lane], v2[2][lane]));
+		}
+	};
+
+	/** Per-lane results of testing a ray against a TrianglePacket; the lanes that miss hold a default TriangleHit, t INFINITY and u and v 0. */
+	template <size_t N>
+	struct TrianglePacketHits
+	{
+		alignas(N * sizeof(float)) float t[N];
+		alignas(N * sizeof(float)) float u[N];
+		alignas(N * sizeof(float)) float v[N];
+
+		/** Gets the hit of one lane. */
+		NODISCARD TriangleHit Get(size_t lane) const { return TriangleHit{ t[lane], u[lane], v[lane] }; }
+	};
+
+	using TrianglePacket4 = TrianglePacket<4>;
+	using TrianglePacket8 = TrianglePacket<8>;
+	using TrianglePacketHits4 = TrianglePacketHits<4>;
+	using TrianglePacketHits8 = TrianglePacketHits<8>;
+
+	/**
+	 * Table of ray-triangle packet kernels compiled for one instruction set tier.
+	 * Each returns a mask with bit i set when lane i is hit between 0 and maxT, and stores every lane's distance and barycentrics;
+	 * every lane gives the same answer as the matching Triangle test.
+	 */
+	struct TriangleKernels
+	{
+		SimdLevel level;
+
+		/** Triangle::Intersect of one ray against four triangles. */
+		uint32_t (*Intersect4)(const Ray& ray, const TrianglePacket4& triangles, float maxT, TrianglePacketHits4& hits);
+
+		/** Triangle::Intersect of one ray against eight triangles. */
+		uint32_t (*Intersect8)(const Ray& ray, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits);
+
+		/** Triangle::IntersectWatertight of one ray against four triangles. */
+		uint32_t (*IntersectWatertight4)(const Ray& ray, const RayShear& shear, const TrianglePacket4& triangles, float maxT, TrianglePacketHits4& hits);
+
+		/** Triangle::IntersectWatertight of one ray against eight triangles. */
+		uint32_t (*IntersectWatertight8)(const Ray& ray, const RayShear& shear, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits);
+	};
+
+	/**
+	 * Gets the kernels for the best tier this processor supports.
+	 * The tier is resolved from CPUID on the first call and kept for the lifetime of the process.
+	 */
+	const TriangleKernels& GetTriangleKernels();
+
+	/**
+	 * Gets the kernels of a specific tier, e.g. to compare tiers in a benchmark.
+	 * @param level The tier to be used; it must be supported by this processor.
+	 */
+	const TriangleKernels& GetTriangleKernels(SimdLevel level);
+
+	/**
+	 * Tests one ray against a packet of triangles with the fast Möller–Trumbore test.
+	 * @param ray The ray.
+	 * @param triangles The triangles.
+	 * @param maxT Distance beyond which triangles are not looked for; 1 stops at the ray's end.
+	 * @param hits Receives the distance and barycentrics of every lane.
+	 * @returns A mask with bit i set when triangle i is hit.
+	 */
+	uint32_t Intersect(const Ray& ray, const TrianglePacket4& triangles, float maxT, TrianglePacketHits4& hits);
+
+	uint32_t Intersect(const Ray& ray, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits);
+
+	/**
+	 * Tests one ray against a packet of triangles with the watertight test.
+	 * @param ray The ray.
+	 * @param shear RayShear(ray), shared by every packet the ray is tested against.
+	 * @param triangles The triangles.
+	 * @param maxT Distance beyond which triangles are not looked for; 1 stops at the ray's end.
+	 * @param hits Receives the distance and barycentrics of every lane.
+	 * @returns A mask with bit i set when triangle i is hit.
+	 */
+	uint32_t IntersectWatertight(const Ray& ray, const RayShear& shear, const TrianglePacket4& triangles, float maxT, TrianglePacketHits4& hits);
+
+	uint32_t IntersectWatertight(const Ray& ray, const RayShear& shear, const TrianglePacket8& triangles, float maxT, TrianglePacketHits8& hits);
+}
+
+#endif /* end of include guard: _TRIANGLE_BATCH_H_ */
@@ -1,3 +1,9 @@
+newoption
+{
+    trigger = "odm-scalar",
+    description = "Build odm with the plain float backend instead of SSE intrinsics"
+}
+
 project "Odm"
         kind "StaticLib"
         language "C++"
@@ -14,6 +20,45 @@ project "Odm"
             "odm/**.cpp"
         }
 
+        filter "options:odm-scalar"
+            defines { "ODM_FORCE_SCALAR" }
+
+        filter "configurations:Debug"
+		runtime "Debug"
+		symbols "on"
+
+        filter "configurations:Release"
+            runtime "Release"
+            optimize "on"
+
+project "OdmTests"
+        kind "ConsoleApp"
+        language "C++"
+        cppdialect "C++17"
+        staticruntime "on"
+
+        targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+        objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+        files
+        {
+            "tests/**.h",
+            "tests/**.cpp"
+        }
+
+        includedirs
+        {
+            "."
+        }
+
+        links
+        {
+            "Odm"
+        }
+
+        filter "options:odm-scalar"
+            defines { "ODM_FORCE_SCALAR" }
+
         filter "configurations:Debug"
 		runtime "Debug"
 		symbols "on"
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "Test.h"
+#include "odm/ext/BVH.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+static std::vector<AABB> MakeBoxes(uint32_t seed, size_t count, float extent)
+{
+	std::mt19937 rng(seed);
+	std::vector<AABB> boxes(count);
+	for (AABB& box : boxes)
+		box = RandomBox(rng, extent, 0.05f, 1.5f);
+	return boxes;
+}
+
+static bool SameTree(const BVH& a, const BVH& b)
+{
+	const Span<const BVHNode> nodesA = a.GetNodes(), nodesB = b.GetNodes();
+	const Span<const uint32_t> indicesA = a.GetPrimitiveIndices(), indicesB = b.GetPrimitiveIndices();
+	return nodesA.size() == nodesB.size() && indicesA.size() == indicesB.size()
+		&& std::memcmp(nodesA.data(), nodesB.data(), nodesA.size() * sizeof(BVHNode)) == 0
+		&& std::memcmp(indicesA.data(), indicesB.data(), indicesA.size() * sizeof(uint32_t)) == 0;
+}
+
+/** Checks every query of the hierarchy against a loop over all boxes. */
+static void CheckQueries(const BVH& bvh, const std::vector<AABB>& boxes, uint32_t seed, float extent)
+{
+	std::mt19937 rng(seed);
+	std::vector<uint32_t> found, expected;
+	for (int query = 0; query < 300; ++query)
+	{
+		const AABB box = RandomBox(rng, extent, 0.1f, 4.0f);
+		found.clear();
+		expected.clear();
+		bvh.QueryOverlap(box, found);
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (boxes[i].Intersects(box))
+				expected.push_back(i);
+		}
+		std::sort(found.begin(), found.end());
+		ODM_CHECK(found == expected);
+
+		const vec3 point = RandomPoint(rng, extent);
+		found.clear();
+		expected.clear();
+		bvh.QueryPoint(point, found);
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			if (boxes[i].min <= point && point <= boxes[i].max)
+				expected.push_back(i);
+		}
+		std::sort(found.begin(), found.end());
+		ODM_CHECK(found == expected);
+
+		const Ray ray(RandomPoint(rng, extent), RandomPoint(rng, extent));
+		float nearest = INFINITY;
+		for (const AABB& candidate : boxes)
+		{
+			float tMin, tMax;
+			if (ray.Intersect(candidate, tMin, tMax, 1.0f))
+				nearest = std::min(nearest, tMin);
+		}
+
+		BVHRayHit hit;
+		const bool isHit = bvh.RaycastClosest(ray, hit);
+		ODM_CHECK(isHit == (nearest != INFINITY));
+		ODM_CHECK(bvh.RaycastAny(ray) == isHit);
+		if (isHit)
+		{
+			// Several boxes may share the nearest distance; any of them will do.
+			float tMin, tMax;
+			ODM_CHECK(hit.t == nearest);
+			ODM_CHECK(hit.primitive < boxes.size() && ray.Intersect(boxes[hit.primitive], tMin, tMax, 1.0f) && tMin == nearest);
+		}
+	}
+}
+
+ODM_TEST(TestBVHBuildIsDeterministic)
+{
+	const std::vector<AABB> boxes = MakeBoxes(1, 10000, 50.0f);
+	const Span<const AABB> bounds(boxes.data(), boxes.size());
+	const BVH serial(bounds);
+	ThreadPool one(1), seven(7);
+	const BVH withOne(bounds, &one);
+	const BVH withSeven(bounds, &seven);
+	ODM_CHECK(serial.GetPrimitiveCount() == boxes.size());
+	ODM_CHECK(SameTree(serial, withOne));
+	ODM_CHECK(SameTree(serial, withSeven));
+}
+
+ODM_TEST(TestBVHQueriesMatchBruteForce)
+{
+	const std::vector<AABB> boxes = MakeBoxes(2, 10000, 50.0f);
+	const BVH bvh(Span<const AABB>(boxes.data(), boxes.size()));
+	CheckQueries(bvh, boxes, 3, 50.0f);
+}
+
+/** Nodes of more than 16384 boxes are binned and partitioned in chunks, which the smaller tests never reach. */
+ODM_TEST(TestBVHChunkedBuild)
+{
+	const std::vector<AABB> boxes = MakeBoxes(4, 70000, 120.0f);
+	const Span<const AABB> bounds(boxes.data(), boxes.size());
+	ThreadPool one(1), many(std::max(4u, std::thread::hardware_concurrency()));
+	const BVH withOne(bounds, &one);
+	const BVH withMany(bounds, &many);
+	ODM_CHECK(withOne.GetPrimitiveCount() == boxes.size());
+	ODM_CHECK(SameTree(withOne, withMany));
+	ODM_CHECK(SameTree(withOne, BVH(bounds)));
+	CheckQueries(withMany, boxes, 5, 120.0f);
+}
+
+ODM_TEST(TestBVHBuildLinear)
+{
+	const std::vector<AABB> boxes = MakeBoxes(6, 40000, 80.0f);
+	const Span<const AABB> bounds(boxes.data(), boxes.size());
+	ThreadPool pool(4);
+	for (MortonCodeWidth width : { MortonCodeWidth::Bits30, MortonCodeWidth::Bits63 })
+	{
+		BVH serial, parallel;
+		serial.BuildLinear(bounds, nullptr, width);
+		parallel.BuildLinear(bounds, &pool, width);
+		ODM_CHECK(serial.GetPrimitiveCount() == boxes.size());
+		ODM_CHECK(SameTree(serial, parallel));
+		CheckQueries(parallel, boxes, 7, 80.0f);
+	}
+}
+
+/** Centroids a few subnormals apart or spread past FLT_MAX give the bin grid no finite scale; the build must still find every box. */
+ODM_TEST(TestBVHExtremeCentroidSpread)
+{
+	std::vector<AABB> tiny, huge;
+	std::vector<vec3> tinyCenters, hugeCenters;
+	for (int i = 0; i < 100; ++i)
+	{
+		const vec3 center(static_cast<float>(i) * 1e-40f, 0.0f, 0.0f);
+		tiny.emplace_back(center - vec3(1.0f), center + vec3(1.0f));
+		tinyCenters.push_back(center);
+		const vec3 far(i % 2 == 0 ? 3e38f : -3e38f, static_cast<float>(i), 0.0f);
+		huge.emplace_back(far - vec3(1e37f, 0.25f, 0.25f), far + vec3(1e37f, 0.25f, 0.25f));
+		hugeCenters.push_back(far);
+	}
+
+	// AABB::Center would overflow on the far boxes, so the centers are kept.
+	const auto check = [](const std::vector<AABB>& boxes, const std::vector<vec3>& centers) {
+		const BVH bvh(Span<const AABB>(boxes.data(), boxes.size()));
+		ODM_CHECK(bvh.GetPrimitiveCount() == boxes.size());
+		std::vector<uint32_t> found;
+		for (uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			found.clear();
+			bvh.QueryPoint(centers[i], found);
+			ODM_CHECK(std::find(found.begin(), found.end(), i) != found.end());
+		}
+	};
+	check(tiny, tinyCenters);
+	check(huge, hugeCenters);
+}
+
+/** Checks that every node bounds its children, that every leaf bounds its boxes, and that every box sits in exactly one leaf. */
+static void CheckNodeBounds(const BVH& bvh, const std::vector<AABB>& boxes)
+{
+	const Span<const BVHNode> nodes = bvh.GetNodes();
+	const Span<const uint32_t> indices = bvh.GetPrimitiveIndices();
+	std::vector<uint32_t> seen(boxes.size(), 0);
+	std::vector<std::pair<uint32_t, uint32_t>> stack = { { 0u, 1u } };
+	while (!stack.empty())
+	{
+		const uint32_t nodeIndex = stack.back().first, depth = stack.back().second;
+		stack.pop_back();
+		const BVHNode& node = nodes[nodeIndex];
+		ODM_CHECK(depth <= MaxBVHDepth);
+		if (node.IsLeaf())
+		{
+			for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+			{
+				++seen[indices[i]];
+				ODM_CHECK(node.bounds.Contains(boxes[indices[i]]));
+			}
+			continue;
+		}
+
+		for (uint32_t child = node.leftFirst; child < node.leftFirst + 2; ++child)
+		{
+			ODM_CHECK(node.bounds.Contains(nodes[child].bounds));
+			stack.emplace_back(child, depth + 1);
+		}
+	}
+	ODM_CHECK(std::all_of(seen.begin(), seen.end(), [](uint32_t count) { return count == 1; }));
+}
+
+/** Moves the boxes over several frames, refitting with rotations, and checks the queries as if the tree were built afresh. */
+ODM_TEST(TestBVHRefitWithRotations)
+{
+	std::vector<AABB> boxes = MakeBoxes(8, 20000, 50.0f);
+	ThreadPool pool(4);
+	BVH bvh(Span<const AABB>(boxes.data(), boxes.size()), &pool);
+	std::mt19937 rng(9);
+	for (int frame = 0; frame < 6; ++frame)
+	{
+		// Half the frames drift every box; the others move a few boxes far, through SetPrimitiveBounds.
+		if (frame % 2 == 0)
+		{
+			for (AABB& box : boxes)
+			{
+				const vec3 displacement = RandomPoint(rng, 2.0f);
+				box = AABB(box.min + displacement, box.max + displacement);
+			}
+			bvh.Refit(Span<const AABB>(boxes.data(), boxes.size()), frame == 0 ? nullptr : &pool, true);
+		}
+		else
+		{
+			for (int i = 0; i < 500; ++i)
+			{
+				const uint32_t primitive = static_cast<uint32_t>(rng() % boxes.size());
+				boxes[primitive] = RandomBox(rng, 50.0f, 0.05f, 1.5f);
+				bvh.SetPrimitiveBounds(primitive, boxes[primitive]);
+			}
+			bvh.Refit(&pool, true);
+		}
+
+		CheckNodeBounds(bvh, boxes);
+		CheckQueries(bvh, boxes, 10 + frame, 50.0f);
+	}
+}
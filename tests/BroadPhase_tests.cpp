@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+#include "Test.h"
+#include "odm/ext/BroadPhase.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+static bool PairLess(const ProxyPair& x, const ProxyPair& y)
+{
+	return x.a != y.a ? x.a < y.a : x.b < y.b;
+}
+
+static bool IsStrictlyAscending(const std::vector<ProxyPair>& pairs)
+{
+	return std::adjacent_find(pairs.begin(), pairs.end(), [](const ProxyPair& x, const ProxyPair& y) { return !PairLess(x, y); }) == pairs.end();
+}
+
+/** The pairs each UpdatePairs reported, so runs with and without a scheduler can be compared. */
+struct BroadPhaseLog
+{
+	std::vector<std::vector<ProxyPair>> added;
+	std::vector<std::vector<ProxyPair>> removed;
+};
+
+/**
+ * Creates, moves and destroys objects at random over many steps, keeping its own pair set from the reported changes.
+ * Every step checks that set against GetPairs(), against the fat boxes, and against the objects' own bounds.
+ */
+static BroadPhaseLog RunRandomSteps(uint32_t seed, TaskScheduler* scheduler)
+{
+	std::mt19937 rng(seed);
+	BroadPhase broadPhase(0.2f);
+	std::vector<std::pair<uint32_t, AABB>> live;
+	std::set<std::pair<uint32_t, uint32_t>> pairs;
+	std::vector<ProxyPair> added, removed;
+	BroadPhaseLog log;
+
+	for (int step = 0; step < 40; ++step)
+	{
+		std::vector<uint32_t> destroyed;
+		const int creates = step == 0 ? 600 : static_cast<int>(rng() % 40);
+		const int destroys = step == 0 ? 0 : static_cast<int>(rng() % 40);
+		for (int i = 0; i < destroys && !live.empty(); ++i)
+		{
+			const size_t victim = rng() % live.size();
+			broadPhase.DestroyProxy(live[victim].first);
+			destroyed.push_back(live[victim].first);
+			live[victim] = live.back();
+			live.pop_back();
+		}
+
+		for (int i = 0; i < creates; ++i)
+		{
+			const AABB bounds = RandomBox(rng, 30.0f, 0.2f, 2.0f);
+			live.emplace_back(broadPhase.CreateProxy(bounds), bounds);
+		}
+
+		// Destroyed ids go back on the free list, so creating right after destroying hands the same id out again.
+		if (step != 0 && !live.empty())
+		{
+			const size_t victim = rng() % live.size();
+			const uint32_t proxy = live[victim].first;
+			broadPhase.DestroyProxy(proxy);
+			destroyed.push_back(proxy);
+			const AABB bounds = RandomBox(rng, 30.0f, 0.2f, 2.0f);
+			live[victim] = { broadPhase.CreateProxy(bounds), bounds };
+			ODM_CHECK(live[victim].first == proxy);
+		}
+
+		for (auto& object : live)
+		{
+			if (rng() % 3 != 0)
+				continue;
+			const vec3 displacement = RandomPoint(rng, 0.8f);
+			object.second = AABB(object.second.min + displacement, object.second.max + displacement);
+			broadPhase.MoveProxy(object.first, object.second, displacement);
+		}
+
+		broadPhase.UpdatePairs(added, removed, scheduler);
+		log.added.push_back(added);
+		log.removed.push_back(removed);
+		ODM_CHECK(IsStrictlyAscending(added));
+		ODM_CHECK(IsStrictlyAscending(removed));
+
+		// Every pair of a destroyed id ends, even when the id is live again.
+		for (const auto& pair : pairs)
+		{
+			const bool lostProxy = std::find(destroyed.begin(), destroyed.end(), pair.first) != destroyed.end()
+				|| std::find(destroyed.begin(), destroyed.end(), pair.second) != destroyed.end();
+			if (lostProxy)
+				ODM_CHECK(std::binary_search(removed.begin(), removed.end(), ProxyPair{ pair.first, pair.second }, PairLess));
+		}
+
+		for (const ProxyPair& pair : removed)
+			ODM_CHECK(pairs.erase({ pair.a, pair.b }) == 1);
+		for (const ProxyPair& pair : added)
+		{
+			ODM_CHECK(pair.a < pair.b);
+			ODM_CHECK(pairs.insert({ pair.a, pair.b }).second);
+		}
+
+		const std::vector<ProxyPair> current = broadPhase.GetPairs();
+		ODM_CHECK(current.size() == pairs.size() && broadPhase.GetPairCount() == pairs.size());
+		ODM_CHECK(std::equal(current.begin(), current.end(), pairs.begin(), pairs.end(),
+			[](const ProxyPair& pair, const std::pair<uint32_t, uint32_t>& expected) { return pair.a == expected.first && pair.b == expected.second; }));
+
+		// The set is exactly the pairs of overlapping fat boxes, which includes every pair of overlapping objects.
+		size_t fatPairs = 0;
+		for (size_t i = 0; i < live.size(); ++i)
+		{
+			for (size_t j = i + 1; j < live.size(); ++j)
+			{
+				const uint32_t a = std::min(live[i].first, live[j].first), b = std::max(live[i].first, live[j].first);
+				const bool isPair = pairs.count({ a, b }) != 0;
+				const AABB& fatA = broadPhase.GetTree().GetFatBounds(live[i].first);
+				const AABB& fatB = broadPhase.GetTree().GetFatBounds(live[j].first);
+				fatPairs += fatA.Intersects(fatB) ? 1 : 0;
+				ODM_CHECK(isPair == fatA.Intersects(fatB));
+				if (live[i].second.Intersects(live[j].second))
+					ODM_CHECK(isPair);
+			}
+		}
+		ODM_CHECK(fatPairs == pairs.size());
+	}
+	return log;
+}
+
+ODM_TEST(TestBroadPhaseRandomSteps)
+{
+	ThreadPool pool(4);
+	const BroadPhaseLog serial = RunRandomSteps(1, nullptr);
+	const BroadPhaseLog parallel = RunRandomSteps(1, &pool);
+	ODM_CHECK(serial.added == parallel.added);
+	ODM_CHECK(serial.removed == parallel.removed);
+}
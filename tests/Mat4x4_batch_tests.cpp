@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include "Test.h"
+#include "odm/Mat4x4_batch.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+static const SimdLevel s_Levels[] = { SimdLevel::Baseline, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512 };
+
+/** Counts that leave every tail length of the four, eight and sixteen float kernels. */
+static const size_t s_Counts[] = { 0, 1, 2, 3, 5, 7, 8, 13, 16, 37 };
+
+/**
+ * Whether two results agree within a few float roundings of the largest value involved.
+ * The tiers may fuse or reorder the additions, so bit equality is not expected.
+ */
+static bool Near(float actual, float expected, float magnitude)
+{
+	return std::fabs(actual - expected) <= 8.0f * FLT_EPSILON * std::max(1.0f, magnitude);
+}
+
+static bool Near(const Vector4f& actual, const Vector4f& expected, float magnitude)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		if (!Near(actual[i], expected[i], magnitude))
+			return false;
+	}
+	return true;
+}
+
+static bool Near(const Vector3f& actual, const Vector3f& expected, float magnitude)
+{
+	return Near(actual.x, expected.x, magnitude) && Near(actual.y, expected.y, magnitude) && Near(actual.z, expected.z, magnitude);
+}
+
+static bool Near(const Matrix4x4& actual, const Matrix4x4& expected, float magnitude)
+{
+	for (int col = 0; col < 4; ++col)
+	{
+		if (!Near(actual[col], expected[col], magnitude))
+			return false;
+	}
+	return true;
+}
+
+static float Magnitude(const Matrix4x4& m)
+{
+	float magnitude = 0.0f;
+	for (float value : m.elem)
+		magnitude = std::max(magnitude, std::fabs(value));
+	return magnitude;
+}
+
+static float Magnitude(const Vector4f& v)
+{
+	return std::max(std::max(std::fabs(v.x), std::fabs(v.y)), std::max(std::fabs(v.z), std::fabs(v.w)));
+}
+
+static float Magnitude(const Vector3f& v)
+{
+	return std::max(std::max(std::fabs(v.x), std::fabs(v.y)), std::fabs(v.z));
+}
+
+/** A well conditioned matrix: random entries plus a dominant diagonal, and a bottom row that keeps w away from zero. */
+static Matrix4x4 RandomMatrix(std::mt19937& rng)
+{
+	Matrix4x4 m;
+	for (float& value : m.elem)
+		value = RandomFloat(rng, -1.0f, 1.0f);
+	for (int i = 0; i < 4; ++i)
+		m[i][i] += 4.0f;
+	for (int col = 0; col < 3; ++col)
+		m[col][3] *= 0.1f;
+	return m;
+}
+
+static Vector3f RandomVector3(std::mt19937& rng)
+{
+	return Vector3f(RandomFloat(rng, -10.0f, 10.0f), RandomFloat(rng, -10.0f, 10.0f), RandomFloat(rng, -10.0f, 10.0f));
+}
+
+static Vector3f ReferenceTransform(const Matrix4x4& m, const Vector3f& v, TransformMode mode)
+{
+	switch (mode)
+	{
+	case TransformMode::Point:
+	{
+		const Vector4f r = m * Vector4f(v, 1.0f);
+		return Vector3f(r.x, r.y, r.z);
+	}
+	case TransformMode::Vector:
+	{
+		const Vector4f r = m * Vector4f(v, 0.0f);
+		return Vector3f(r.x, r.y, r.z);
+	}
+	default:
+		return m * v;
+	}
+}
+
+static void CheckMatrixKernels(const Mat4x4Kernels& kernels, std::mt19937& rng, size_t count)
+{
+	std::vector<Matrix4x4> a(count), b(count), out(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		a[i] = RandomMatrix(rng);
+		b[i] = RandomMatrix(rng);
+	}
+
+	kernels.MulMat(a.data(), b.data(), out.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		ODM_CHECK(Near(out[i], a[i] * b[i], 4.0f * Magnitude(a[i]) * Magnitude(b[i])));
+
+	std::vector<Matrix4x4> aliased = a;
+	kernels.MulMat(aliased.data(), b.data(), aliased.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		ODM_CHECK(Near(aliased[i], a[i] * b[i], 4.0f * Magnitude(a[i]) * Magnitude(b[i])));
+
+	kernels.Inverse(a.data(), out.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		ODM_CHECK(Near(out[i], a[i].Inverse(), Magnitude(a[i].Inverse())));
+
+	aliased = a;
+	kernels.Inverse(aliased.data(), aliased.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		ODM_CHECK(Near(aliased[i], a[i].Inverse(), Magnitude(a[i].Inverse())));
+}
+
+static void CheckVectorKernels(const Mat4x4Kernels& kernels, std::mt19937& rng, size_t count)
+{
+	const Matrix4x4 m = RandomMatrix(rng);
+	const float magnitude = 4.0f * Magnitude(m) * 10.0f;
+
+	std::vector<Vector4f> in4(count), out4(count);
+	for (Vector4f& v : in4)
+		v = Vector4f(RandomVector3(rng), RandomFloat(rng, -10.0f, 10.0f));
+	kernels.MulVec4(m, in4.data(), out4.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		ODM_CHECK(Near(out4[i], m * in4[i], magnitude));
+	std::vector<Vector4f> aliased4 = in4;
+	kernels.MulVec4(m, aliased4.data(), aliased4.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		ODM_CHECK(Near(aliased4[i], m * in4[i], magnitude));
+
+	// One spare element in front, so the outputs also start off the alignment the streaming stores want.
+	std::vector<Vector3f> in3(count), out3(count + 1);
+	for (Vector3f& v : in3)
+		v = RandomVector3(rng);
+	kernels.MulVec3(m, in3.data(), out3.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		ODM_CHECK(Near(out3[i], m * in3[i], magnitude));
+	std::vector<Vector3f> aliased3 = in3;
+	kernels.MulVec3(m, aliased3.data(), aliased3.data(), count);
+	for (size_t i = 0; i < count; ++i)
+		ODM_CHECK(Near(aliased3[i], m * in3[i], magnitude));
+
+	for (TransformMode mode : { TransformMode::Point, TransformMode::Vector, TransformMode::ProjectivePoint })
+	{
+		for (StoreHint hint : { StoreHint::Cached, StoreHint::NonTemporal })
+		{
+			for (size_t offset = 0; offset < 2; ++offset)
+			{
+				kernels.Transform3(m, in3.data(), out3.data() + offset, count, mode, hint);
+				for (size_t i = 0; i < count; ++i)
+				{
+					const Vector3f expected = ReferenceTransform(m, in3[i], mode);
+					ODM_CHECK(Near(out3[i + offset], expected, std::max(magnitude, Magnitude(expected))));
+				}
+			}
+
+			aliased3 = in3;
+			kernels.Transform3(m, aliased3.data(), aliased3.data(), count, mode, hint);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Vector3f expected = ReferenceTransform(m, in3[i], mode);
+				ODM_CHECK(Near(aliased3[i], expected, std::max(magnitude, Magnitude(expected))));
+			}
+		}
+	}
+
+	for (StoreHint hint : { StoreHint::Cached, StoreHint::NonTemporal })
+	{
+		kernels.Transform3To4(m, in3.data(), out4.data(), count, hint);
+		for (size_t i = 0; i < count; ++i)
+			ODM_CHECK(Near(out4[i], m * Vector4f(in3[i], 1.0f), std::max(magnitude, Magnitude(m * Vector4f(in3[i], 1.0f)))));
+	}
+}
+
+ODM_TEST(TestMat4x4KernelsMatchScalar)
+{
+	std::mt19937 rng(1);
+	for (SimdLevel level : s_Levels)
+	{
+		if (!IsSimdLevelSupported(level))
+			continue;
+
+		const Mat4x4Kernels& kernels = GetMat4x4Kernels(level);
+		ODM_CHECK(kernels.level == level);
+		for (size_t count : s_Counts)
+		{
+			CheckMatrixKernels(kernels, rng, count);
+			CheckVectorKernels(kernels, rng, count);
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#include <cmath>
+#include <vector>
+#include "Test.h"
+#include "odm/Mat4x4_batch.h"
+#include "odm/Quaternion.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+static bool NearIdentity(const Matrix4x4& m, float tolerance)
+{
+	const Matrix4x4 identity;
+	for (int i = 0; i < 16; ++i)
+	{
+		if (!(std::fabs(m.elem[i] - identity.elem[i]) <= tolerance))
+			return false;
+	}
+	return true;
+}
+
+static Matrix4x4 RandomRigid(std::mt19937& rng)
+{
+	const Quaternion rotation = Normalize(Quaternion(RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f),
+		RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f)));
+	Matrix4x4 m = rotation.ToMatrix();
+	m[3] = Vector4f(RandomPoint(rng, 100.0f), 1.0f);
+	return m;
+}
+
+/** A rigid transform with its axes scaled by different factors and sheared a little, so neither shortcut of InverseRigid applies. */
+static Matrix4x4 RandomAffine(std::mt19937& rng)
+{
+	Matrix4x4 m = RandomRigid(rng);
+	for (int col = 0; col < 3; ++col)
+	{
+		const float scale = RandomFloat(rng, 0.25f, 4.0f);
+		m[col] = Vector4f(m[col].x * scale, m[col].y * scale, m[col].z * scale, 0.0f);
+	}
+	m[1] = m[1] + m[0] * 0.3f;
+	return m;
+}
+
+/** A general matrix with a dominant diagonal, so it is safely invertible, and a projective bottom row. */
+static Matrix4x4 RandomGeneral(std::mt19937& rng)
+{
+	Matrix4x4 m;
+	for (float& value : m.elem)
+		value = RandomFloat(rng, -1.0f, 1.0f);
+	for (int i = 0; i < 4; ++i)
+		m[i][i] += 4.0f;
+	return m;
+}
+
+ODM_TEST(TestMat4x4InversesGiveIdentity)
+{
+	std::mt19937 rng(1);
+	for (int i = 0; i < 200; ++i)
+	{
+		const Matrix4x4 m = RandomGeneral(rng);
+		ODM_CHECK(NearIdentity(m * m.Inverse(), 1e-5f));
+		ODM_CHECK(NearIdentity(m.Inverse() * m, 1e-5f));
+
+		// The translation reaches 100, so its round trip carries that much more rounding than the 3x3 block.
+		const Matrix4x4 a = RandomAffine(rng);
+		ODM_CHECK(NearIdentity(a * a.InverseAffine(), 1e-4f));
+		ODM_CHECK(NearIdentity(a.InverseAffine() * a, 1e-4f));
+		ODM_CHECK(NearIdentity(a * a.Inverse(), 1e-4f));
+
+		const Matrix4x4 r = RandomRigid(rng);
+		ODM_CHECK(NearIdentity(r * r.InverseRigid(), 1e-4f));
+		ODM_CHECK(NearIdentity(r.InverseRigid() * r, 1e-4f));
+		ODM_CHECK(NearIdentity(r * r.InverseAffine(), 1e-4f));
+	}
+}
+
+ODM_TEST(TestMat4x4BatchInversesGiveIdentity)
+{
+	std::mt19937 rng(2);
+	std::vector<Matrix4x4> general(37), affine(37), rigid(37);
+	for (size_t i = 0; i < general.size(); ++i)
+	{
+		general[i] = RandomGeneral(rng);
+		affine[i] = RandomAffine(rng);
+		rigid[i] = RandomRigid(rng);
+	}
+
+	std::vector<Matrix4x4> out(general.size());
+	Inverse(Span<const Matrix4x4>(general.data(), general.size()), Span<Matrix4x4>(out.data(), out.size()));
+	for (size_t i = 0; i < general.size(); ++i)
+		ODM_CHECK(NearIdentity(general[i] * out[i], 1e-5f));
+
+	// In place, as the batch functions allow.
+	out = affine;
+	InverseAffine(Span<const Matrix4x4>(out.data(), out.size()), Span<Matrix4x4>(out.data(), out.size()));
+	for (size_t i = 0; i < affine.size(); ++i)
+		ODM_CHECK(NearIdentity(affine[i] * out[i], 1e-4f));
+
+	out = rigid;
+	InverseRigid(Span<const Matrix4x4>(out.data(), out.size()), Span<Matrix4x4>(out.data(), out.size()));
+	for (size_t i = 0; i < rigid.size(); ++i)
+		ODM_CHECK(NearIdentity(rigid[i] * out[i], 1e-4f));
+}
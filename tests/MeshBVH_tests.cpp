@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Test.h"
+#include "odm/ext/BVH.h"
+#include "odm/ext/MeshBVH.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+/** A bumpy grid of quads, whose triangles share edges and vertices, and a soup of loose triangles above it. */
+static std::vector<Triangle> MakeMesh(uint32_t seed)
+{
+	std::mt19937 rng(seed);
+	std::vector<Triangle> triangles;
+	const int size = 40;
+	const auto height = [](int x, int z) { return std::sin(x * 0.7f) * std::cos(z * 0.4f) * 3.0f; };
+	for (int z = 0; z < size; ++z)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			const vec3 a(x - 20.0f, height(x, z), z - 20.0f), b(x - 19.0f, height(x + 1, z), z - 20.0f);
+			const vec3 c(x - 20.0f, height(x, z + 1), z - 19.0f), d(x - 19.0f, height(x + 1, z + 1), z - 19.0f);
+			triangles.emplace_back(a, b, c);
+			triangles.emplace_back(b, d, c);
+		}
+	}
+
+	for (int i = 0; i < 2000; ++i)
+	{
+		const vec3 center = RandomPoint(rng, 20.0f) + vec3(0.0f, 10.0f, 0.0f);
+		triangles.emplace_back(center + RandomPoint(rng, 1.5f), center + RandomPoint(rng, 1.5f), center + RandomPoint(rng, 1.5f));
+	}
+	return triangles;
+}
+
+/**
+ * Triangles that make the binary build peel off one triangle per level until it forces a leaf at MaxBVHDepth.
+ * Every triangle spans the same huge square in y and z, so all splits cost the same and the first one tried, which
+ * separates the triangle furthest along x, wins; the leaf left at the bottom holds the whole cluster near x = 0.
+ */
+static std::vector<Triangle> MakeForcedLeafMesh(uint32_t seed, uint32_t clusterSize)
+{
+	std::mt19937 rng(seed);
+	const float half = std::ldexp(1.0f, 49);
+	const auto plane = [&](float x) { return Triangle(vec3(x, -half, -half), vec3(x, half, -half), vec3(x, 0.0f, half)); };
+	std::vector<Triangle> triangles;
+	for (uint32_t i = 0; i < clusterSize; ++i)
+		triangles.push_back(plane(RandomFloat(rng, 0.0f, 0.5f)));
+	for (int k = 1; k <= 70; ++k)
+		triangles.push_back(plane(std::pow(1.1f, static_cast<float>(k))));
+	return triangles;
+}
+
+/** Gets the true bounds of the triangles under a child slot, checking on the way that every decoded box contains them. */
+template <class Node>
+static AABB CheckSubtree(const MeshBVH& bvh, Span<const Node> nodes, const std::vector<Triangle>& triangles, uint32_t nodeIndex,
+	std::vector<uint32_t>& seen)
+{
+	const Node& node = nodes[nodeIndex];
+	AABB bounds(vec3(INFINITY), vec3(-INFINITY));
+	uint32_t child = node.firstChild, packet = node.firstPacket;
+	for (uint32_t slot = 0; slot < 8; ++slot)
+	{
+		if (!(node.GetChildMask() & (1u << slot)))
+			continue;
+
+		AABB childBounds(vec3(INFINITY), vec3(-INFINITY));
+		if (node.innerMask & (1u << slot))
+			childBounds = CheckSubtree(bvh, nodes, triangles, child++, seen);
+		else
+		{
+			for (uint32_t end = packet + node.packetCounts[slot]; packet < end; ++packet)
+			{
+				for (uint32_t lane = 0; lane < 4; ++lane)
+				{
+					const uint32_t triangle = bvh.GetTriangleIndices()[packet * 4 + lane];
+					if (triangle == UINT32_MAX)
+						continue;
+					ODM_CHECK(triangle < triangles.size());
+					++seen[triangle];
+					childBounds.Add(triangles[triangle].GetBounds());
+				}
+			}
+		}
+
+		ODM_CHECK(node.GetChildBounds(slot).Contains(childBounds));
+		bounds.Add(childBounds);
+	}
+	return bounds;
+}
+
+template <class Node>
+static void CheckStructure(const MeshBVH& bvh, Span<const Node> nodes, const std::vector<Triangle>& triangles)
+{
+	std::vector<uint32_t> seen(triangles.size(), 0);
+	const AABB bounds = CheckSubtree(bvh, nodes, triangles, 0, seen);
+	ODM_CHECK(bvh.GetBounds().Contains(bounds));
+	ODM_CHECK(std::all_of(seen.begin(), seen.end(), [](uint32_t count) { return count == 1; }));
+}
+
+static void CheckQueries(const MeshBVH& bvh, const std::vector<Triangle>& triangles, const std::vector<Ray>& rays, const std::vector<AABB>& boxes)
+{
+	for (const Ray& ray : rays)
+	{
+		const RayShear shear(ray);
+		MeshRayHit expected;
+		for (uint32_t i = 0; i < triangles.size(); ++i)
+		{
+			TriangleHit hit;
+			if (triangles[i].IntersectWatertight(ray, shear, hit, 1.0f) && hit.t < expected.t)
+				expected = { i, hit.t, hit.u, hit.v };
+		}
+
+		MeshRayHit hit;
+		const bool isHit = bvh.RaycastClosest(ray, hit);
+		ODM_CHECK(isHit == (expected.triangle != UINT32_MAX));
+		ODM_CHECK(bvh.RaycastAny(ray) == isHit);
+		if (isHit)
+			ODM_CHECK(hit.triangle == expected.triangle && hit.t == expected.t && hit.u == expected.u && hit.v == expected.v);
+	}
+
+	std::vector<uint32_t> found, expected;
+	for (const AABB& box : boxes)
+	{
+		found.clear();
+		expected.clear();
+		bvh.QueryOverlap(box, found);
+		for (uint32_t i = 0; i < triangles.size(); ++i)
+		{
+			const AABB bounds = triangles[i].GetBounds();
+			if (bounds.min <= box.max && box.min <= bounds.max)
+				expected.push_back(i);
+		}
+		std::sort(found.begin(), found.end());
+		ODM_CHECK(found == expected);
+	}
+}
+
+static void CheckMesh(const std::vector<Triangle>& triangles, const std::vector<Ray>& rays, const std::vector<AABB>& boxes)
+{
+	for (MeshBVHPrecision precision : { MeshBVHPrecision::Bits8, MeshBVHPrecision::Bits16 })
+	{
+		const MeshBVH bvh(Span<const Triangle>(triangles.data(), triangles.size()), precision);
+		ODM_CHECK(bvh.GetTriangleCount() == triangles.size());
+		if (precision == MeshBVHPrecision::Bits8)
+			CheckStructure(bvh, bvh.GetNodes8(), triangles);
+		else
+			CheckStructure(bvh, bvh.GetNodes16(), triangles);
+		CheckQueries(bvh, triangles, rays, boxes);
+	}
+}
+
+ODM_TEST(TestMeshBVHMatchesBruteForce)
+{
+	const std::vector<Triangle> triangles = MakeMesh(1);
+	std::mt19937 rng(2);
+	std::vector<Ray> rays;
+	for (int i = 0; i < 300; ++i)
+		rays.emplace_back(RandomPoint(rng, 25.0f) + vec3(0.0f, 10.0f, 0.0f), RandomPoint(rng, 25.0f) - vec3(0.0f, 10.0f, 0.0f));
+
+	// Rays straight down through grid vertices and edge midpoints, where neighbouring triangles meet.
+	for (int i = 0; i < 100; ++i)
+	{
+		const float x = std::floor(RandomFloat(rng, -20.0f, 20.0f)) + (i % 2 == 0 ? 0.0f : 0.5f);
+		const float z = std::floor(RandomFloat(rng, -20.0f, 20.0f));
+		rays.emplace_back(vec3(x, 40.0f, z), vec3(x, -40.0f, z));
+	}
+
+	std::vector<AABB> boxes;
+	for (int i = 0; i < 100; ++i)
+		boxes.push_back(RandomBox(rng, 22.0f, 0.1f, 4.0f));
+	CheckMesh(triangles, rays, boxes);
+}
+
+/** A leaf the binary build forced at MaxBVHDepth may hold more triangles than a slot can reference; none may be lost. */
+ODM_TEST(TestMeshBVHForcedLeaf)
+{
+	const uint32_t clusterSize = 9000;
+	const std::vector<Triangle> triangles = MakeForcedLeafMesh(3, clusterSize);
+
+	// The construction only tests something while the binary build really forces such a leaf.
+	std::vector<AABB> bounds;
+	for (const Triangle& triangle : triangles)
+		bounds.push_back(triangle.GetBounds());
+	uint32_t largestLeaf = 0;
+	for (const BVHNode& node : BVH(Span<const AABB>(bounds.data(), bounds.size())).GetNodes())
+		largestLeaf = std::max(largestLeaf, node.count);
+	ODM_CHECK(largestLeaf >= clusterSize);
+
+	std::mt19937 rng(4);
+	std::vector<Ray> rays;
+	for (int i = 0; i < 50; ++i)
+	{
+		const vec3 offset(0.0f, RandomFloat(rng, -1000.0f, 1000.0f), RandomFloat(rng, -1000.0f, 1000.0f));
+		rays.emplace_back(vec3(RandomFloat(rng, -1.0f, 2.0f), 0.0f, 0.0f) + offset, vec3(RandomFloat(rng, -1.0f, 900.0f), 0.0f, 0.0f) + offset);
+	}
+
+	std::vector<AABB> boxes;
+	for (int i = 0; i < 20; ++i)
+	{
+		const float x = RandomFloat(rng, -0.1f, 0.6f);
+		boxes.emplace_back(vec3(x, -1.0f, -1.0f), vec3(x + 0.01f, 1.0f, 1.0f));
+	}
+	CheckMesh(triangles, rays, boxes);
+}
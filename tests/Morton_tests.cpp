@@ -0,0 +1,92 @@
+#include <cmath>
+#include <vector>
+#include "Test.h"
+#include "odm/ext/Morton_batch.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+static const SimdLevel s_Levels[] = { SimdLevel::Baseline, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512 };
+
+/** Random points in and around the box, its corners and faces, points far outside and non-finite coordinates. */
+static std::vector<vec3> MakePoints(std::mt19937& rng, const AABB& bounds)
+{
+	const vec3 size = bounds.GetSize();
+	std::vector<vec3> points;
+	for (int i = 0; i < 1000; ++i)
+	{
+		points.emplace_back(RandomFloat(rng, -0.2f, 1.2f) * size.x + bounds.min.x, RandomFloat(rng, -0.2f, 1.2f) * size.y + bounds.min.y,
+			RandomFloat(rng, -0.2f, 1.2f) * size.z + bounds.min.z);
+	}
+
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		points.emplace_back(corner & 1 ? bounds.max.x : bounds.min.x, corner & 2 ? bounds.max.y : bounds.min.y, corner & 4 ? bounds.max.z : bounds.min.z);
+		points.emplace_back(bounds.Center().x, corner & 2 ? bounds.max.y : bounds.min.y, bounds.Center().z);
+	}
+
+	points.emplace_back(1e30f, -1e30f, 0.0f);
+	points.emplace_back(INFINITY, -INFINITY, bounds.Center().z);
+	points.emplace_back(NAN, bounds.Center().y, bounds.max.z);
+	points.emplace_back(NAN, NAN, NAN);
+	points.emplace_back(bounds.min.x, NAN, INFINITY);
+	return points;
+}
+
+static void CheckEncoding(const MortonKernels& kernels, std::mt19937& rng, const AABB& bounds)
+{
+	const std::vector<vec3> points = MakePoints(rng, bounds);
+
+	// Every count up to a few registers, so each tail length is covered, and then all of the points.
+	std::vector<size_t> counts;
+	for (size_t count = 0; count <= 20; ++count)
+		counts.push_back(count);
+	counts.push_back(points.size());
+
+	for (size_t count : counts)
+	{
+		// The offset leaves the points unaligned for the kernels' loads.
+		const size_t first = points.size() - count;
+		std::vector<uint32_t> codes30(count);
+		std::vector<uint64_t> codes63(count);
+		kernels.Encode30(points.data() + first, count, bounds, codes30.data());
+		kernels.Encode63(points.data() + first, count, bounds, codes63.data());
+		for (size_t i = 0; i < count; ++i)
+		{
+			ODM_CHECK(codes30[i] == EncodeMorton30(points[first + i], bounds));
+			ODM_CHECK(codes63[i] == EncodeMorton63(points[first + i], bounds));
+		}
+	}
+}
+
+ODM_TEST(TestMortonKernelsMatchScalar)
+{
+	std::mt19937 rng(1);
+	const AABB boxes[] = {
+		AABB(vec3(-10.0f, -3.0f, 2.0f), vec3(25.0f, 4.0f, 2.5f)),
+		AABB(vec3(0.0f, 0.0f, 5.0f), vec3(1.0f, 1.0f, 5.0f)),		// Flat along z.
+		AABB(vec3(-1e6f), vec3(1e6f))
+	};
+
+	for (SimdLevel level : s_Levels)
+	{
+		if (!IsSimdLevelSupported(level))
+			continue;
+
+		const MortonKernels& kernels = GetMortonKernels(level);
+		ODM_CHECK(kernels.level <= level);
+		for (const AABB& bounds : boxes)
+			CheckEncoding(kernels, rng, bounds);
+	}
+}
+
+ODM_TEST(TestMortonCodesOfCornersAndNaN)
+{
+	const AABB bounds(vec3(0.0f), vec3(1.0f));
+	ODM_CHECK(EncodeMorton30(bounds.min, bounds) == 0u);
+	ODM_CHECK(EncodeMorton30(bounds.max, bounds) == (1u << 30) - 1);
+	ODM_CHECK(EncodeMorton63(bounds.max, bounds) == (1ull << 63) - 1);
+	ODM_CHECK(EncodeMorton30(vec3(-5.0f), bounds) == 0u && EncodeMorton30(vec3(5.0f), bounds) == (1u << 30) - 1);
+	ODM_CHECK(EncodeMorton30(vec3(NAN), bounds) == 0u);
+	ODM_CHECK(EncodeMorton63(vec3(NAN, 1.0f, 1.0f), bounds) == EncodeMorton63(vec3(0.0f, 1.0f, 1.0f), bounds));
+}
@@ -0,0 +1,148 @@
+#include <cmath>
+#include <vector>
+#include "Test.h"
+#include "odm/Quaternion.h"
+#include "odm/ext/OBB.h"
+#include "odm/ext/OBB_batch.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+static const SimdLevel s_Levels[] = { SimdLevel::Baseline, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512 };
+
+static Quaternion RandomRotation(std::mt19937& rng)
+{
+	return Normalize(Quaternion(RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f)));
+}
+
+static OBB RandomOBB(std::mt19937& rng, float extent)
+{
+	const vec3 halfExtents(RandomFloat(rng, 0.2f, 2.0f), RandomFloat(rng, 0.2f, 2.0f), RandomFloat(rng, 0.2f, 2.0f));
+	return OBB(RandomPoint(rng, extent), RandomRotation(rng), halfExtents);
+}
+
+static bool Near(const vec3& a, const vec3& b, float tolerance)
+{
+	return std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance && std::fabs(a.z - b.z) <= tolerance;
+}
+
+ODM_TEST(TestOBBTouchingFaces)
+{
+	// A quarter turn about z with exact axes, so the faces meet exactly.
+	const vec3 x(0.0f, 1.0f, 0.0f), y(-1.0f, 0.0f, 0.0f), z(0.0f, 0.0f, 1.0f);
+	const OBB a(vec3(), x, y, z, vec3(1.0f, 2.0f, 1.0f));
+	const OBB touching(vec3(0.0f, 1.5f, 0.25f), x, y, z, vec3(0.5f, 1.0f, 1.0f));
+	const OBB apart(vec3(0.0f, 1.5f + 1.0f / 64.0f, 0.25f), x, y, z, vec3(0.5f, 1.0f, 1.0f));
+	ODM_CHECK(a.Intersects(touching) && touching.Intersects(a));
+	ODM_CHECK(!a.Intersects(apart) && !apart.Intersects(a));
+
+	// The same box as an AABB: a's extent along world x is 2, so a box starting at x = 2 touches it.
+	ODM_CHECK(a.Intersects(AABB(vec3(2.0f, -1.0f, -1.0f), vec3(3.0f, 1.0f, 1.0f))));
+	ODM_CHECK(!a.Intersects(AABB(vec3(2.0f + 1.0f / 64.0f, -1.0f, -1.0f), vec3(3.0f, 1.0f, 1.0f))));
+}
+
+/** Two cubes whose face axes all overlap, held apart only along the cross product of an edge of each. */
+ODM_TEST(TestOBBEdgeEdgeSeparation)
+{
+	const float h = std::sqrt(0.5f);
+	const OBB a(vec3(), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f), vec3(1.0f));
+
+	// b turns an edge along (1, -1, 0) towards the edge of a along z; both reach sqrt(2) along (1, 1, 0) / sqrt(2).
+	const vec3 bx(0.5f, 0.5f, h), by(-h, h, 0.0f), bz(-0.5f, -0.5f, h);
+	for (float distance : { 2.7f, 2.95f })
+	{
+		const vec3 center = vec3(1.0f, 1.0f, 0.0f) * (distance * h);
+		const OBB b(center, bx, by, bz, vec3(1.0f));
+
+		// Neither box's faces separate them, whatever the distance.
+		ODM_CHECK(std::fabs(center.x) <= 1.0f + 0.5f + h + 0.5f);
+		ODM_CHECK(std::fabs(center.Dot(bx)) <= 1.0f + 0.5f + 0.5f + h);
+
+		const bool overlaps = distance < 2.0f * std::sqrt(2.0f);
+		ODM_CHECK(a.Intersects(b) == overlaps);
+		ODM_CHECK(b.Intersects(a) == overlaps);
+		ODM_CHECK(b.Intersects(AABB(vec3(-1.0f), vec3(1.0f))) == overlaps);
+	}
+}
+
+/** Parallel edges have a zero cross product, which must not be mistaken for a separating axis. */
+ODM_TEST(TestOBBParallelBoxes)
+{
+	std::mt19937 rng(1);
+	for (int i = 0; i < 200; ++i)
+	{
+		const Quaternion rotation = RandomRotation(rng);
+		const vec3 ea(RandomFloat(rng, 0.2f, 2.0f), RandomFloat(rng, 0.2f, 2.0f), RandomFloat(rng, 0.2f, 2.0f));
+		const vec3 eb(RandomFloat(rng, 0.2f, 2.0f), RandomFloat(rng, 0.2f, 2.0f), RandomFloat(rng, 0.2f, 2.0f));
+		const OBB a(RandomPoint(rng, 10.0f), rotation, ea);
+		const int axis = i % 3;
+		const float reach = ea[axis] + eb[axis];
+
+		// Side by side along one axis and offset along another by less than the faces span, so only that axis can separate them.
+		const vec3 side = a.axes[(axis + 1) % 3] * (0.5f * (ea[(axis + 1) % 3] + eb[(axis + 1) % 3]));
+		ODM_CHECK(a.Intersects(OBB(a.center + a.axes[axis] * (0.99f * reach) + side, rotation, eb)));
+		ODM_CHECK(!a.Intersects(OBB(a.center + a.axes[axis] * (1.01f * reach) + side, rotation, eb)));
+		ODM_CHECK(a.Intersects(OBB(a.center + side, rotation, eb)));
+	}
+}
+
+ODM_TEST(TestOBBFromAABB)
+{
+	std::mt19937 rng(2);
+	for (int i = 0; i < 200; ++i)
+	{
+		const AABB box = RandomBox(rng, 5.0f, 0.1f, 3.0f);
+		const vec3 scale(RandomFloat(rng, 0.25f, 4.0f), RandomFloat(rng, 0.25f, 4.0f), RandomFloat(rng, 0.25f, 4.0f));
+		Matrix4x4 transform = RandomRotation(rng).ToMatrix();
+		for (int axis = 0; axis < 3; ++axis)
+			transform[axis] = transform[axis] * scale[axis];
+		transform[3] = Vector4f(RandomPoint(rng, 20.0f), 1.0f);
+
+		const OBB obb = OBB::FromAABB(box, transform);
+		ODM_CHECK(Near(obb.halfExtents, box.GetExtents() * scale, 1e-4f));
+		for (int axis = 0; axis < 3; ++axis)
+			ODM_CHECK(std::fabs(obb.axes[axis].Length() - 1.0f) <= 1e-5f);
+
+		// The bounds of the rotated box are those of the transformed corners, which TransformToAABB computes from the matrix.
+		const AABB expected = box.TransformToAABB(transform);
+		const AABB bounds = obb.GetBounds();
+		ODM_CHECK(Near(bounds.min, expected.min, 1e-3f));
+		ODM_CHECK(Near(bounds.max, expected.max, 1e-3f));
+	}
+}
+
+ODM_TEST(TestOBBKernelsMatchScalar)
+{
+	std::mt19937 rng(3);
+	for (SimdLevel level : s_Levels)
+	{
+		if (!IsSimdLevelSupported(level))
+			continue;
+
+		const OBBKernels& kernels = GetOBBKernels(level);
+		for (int i = 0; i < 2000; ++i)
+		{
+			const OBB obb = RandomOBB(rng, 4.0f);
+			const size_t count = 1 + i % 8;
+			std::vector<OBB> obbs;
+			std::vector<AABB> boxes;
+			for (size_t k = 0; k < count; ++k)
+			{
+				obbs.push_back(RandomOBB(rng, 4.0f));
+				boxes.push_back(RandomBox(rng, 4.0f, 0.2f, 2.0f));
+			}
+
+			// A box touching a face of obb, with the same axes, in one lane of every other packet.
+			if (i % 2 == 0)
+				obbs[0] = OBB(obb.center + obb.axes[0] * (obb.halfExtents.x + 0.5f), obb.axes[0], obb.axes[1], obb.axes[2], vec3(0.5f));
+
+			const uint32_t obbMask = kernels.IntersectOBBs8(obb, OBBPacket8(Span<const OBB>(obbs.data(), obbs.size())));
+			const uint32_t boxMask = kernels.IntersectAABBs8(obb, AABBPacket8(Span<const AABB>(boxes.data(), boxes.size())));
+			for (size_t lane = 0; lane < 8; ++lane)
+			{
+				ODM_CHECK(((obbMask >> lane) & 1u) == (lane < count && obb.Intersects(obbs[lane]) ? 1u : 0u));
+				ODM_CHECK(((boxMask >> lane) & 1u) == (lane < count && obb.Intersects(boxes[lane]) ? 1u : 0u));
+			}
+		}
+	}
+}
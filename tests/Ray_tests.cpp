@@ -0,0 +1,43 @@
+#include "Test.h"
+#include "odm/ext/BVH.h"
+#include "odm/ext/Ray_batch.h"
+
+using namespace odm;
+
+/** Rays that do not move along an axis and start on a box face on it get a NaN slab, which must not hide the other axes. */
+ODM_TEST(TestAxisParallelRayOnFace)
+{
+	const AABB box(vec3(5.0f, 0.0f, -1.0f), vec3(6.0f, 1.0f, 1.0f));
+	const Ray shortRay(vec3(0.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f));
+	const Ray longRay(vec3(0.0f, 0.0f, 0.0f), vec3(10.0f, 0.0f, 0.0f));
+	const Ray upperFaceRay(vec3(0.0f, 1.0f, 0.0f), vec3(10.0f, 1.0f, 0.0f));
+
+	float tMin, tMax;
+	ODM_CHECK(!shortRay.Intersect(box, tMin, tMax, 1.0f));
+	ODM_CHECK(longRay.Intersect(box, tMin, tMax, 1.0f) && tMin == 0.5f);
+	ODM_CHECK(longRay.HitDistance(box) == 0.5f);
+	ODM_CHECK(upperFaceRay.Intersect(box, tMin, tMax, 1.0f) && tMin == 0.5f);
+
+	const AABB boxes[] = { box, AABB(vec3(20.0f, 5.0f, 5.0f), vec3(21.0f, 6.0f, 6.0f)) };
+	BVH bvh;
+	bvh.Build(Span<const AABB>(boxes, 2));
+	BVHRayHit hit;
+	ODM_CHECK(!bvh.RaycastClosest(shortRay, hit));
+	ODM_CHECK(!bvh.RaycastAny(shortRay));
+	ODM_CHECK(bvh.RaycastClosest(longRay, hit) && hit.primitive == 0 && hit.t == 0.5f);
+
+	const Ray rays[] = { shortRay, longRay, upperFaceRay };
+	const RayPacket8 rayPacket(Span<const Ray>(rays, 3), 1.0f);
+	const AABBPacket8 boxPacket(Span<const AABB>(&box, 1));
+	for (SimdLevel level : { SimdLevel::Baseline, SimdLevel::AVX2 })
+	{
+		if (!IsSimdLevelSupported(level))
+			continue;
+
+		const RayKernels& kernels = GetRayKernels(level);
+		float tNear[8];
+		ODM_CHECK(kernels.IntersectRays8(rayPacket, box, tNear) == 0x6u && tNear[1] == 0.5f && tNear[2] == 0.5f);
+		ODM_CHECK(kernels.IntersectBoxes8(shortRay, boxPacket, 1.0f, tNear) == 0u);
+		ODM_CHECK(kernels.IntersectBoxes8(longRay, boxPacket, 1.0f, tNear) == 0x1u && tNear[0] == 0.5f);
+	}
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "Test.h"
+#include "odm/ext/SweepAndPrune.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+static bool PairLess(const ProxyPair& x, const ProxyPair& y)
+{
+	return x.a != y.a ? x.a < y.a : x.b < y.b;
+}
+
+static std::vector<ProxyPair> Sorted(std::vector<ProxyPair> pairs)
+{
+	std::sort(pairs.begin(), pairs.end(), PairLess);
+	return pairs;
+}
+
+static std::vector<ProxyPair> FindPairsBruteForce(const std::vector<AABB>& boxes)
+{
+	std::vector<ProxyPair> pairs;
+	for (uint32_t i = 0; i < boxes.size(); ++i)
+	{
+		for (uint32_t j = i + 1; j < boxes.size(); ++j)
+		{
+			if (boxes[i].Intersects(boxes[j]))
+				pairs.push_back({ i, j });
+		}
+	}
+	return pairs;
+}
+
+/** Runs the kernels of one tier over the whole sweep, with the arrays laid out as SweepAndPruneKernels::ScanPairs documents. */
+static std::vector<ProxyPair> ScanWithKernels(const SweepAndPruneKernels& kernels, const SweepAndPrune& sweep, const std::vector<AABB>& boxes)
+{
+	const int axisA = sweep.GetSweepAxis(), axisB = (axisA + 1) % 3, axisC = (axisA + 2) % 3;
+	const std::vector<uint32_t>& order = sweep.GetOrder();
+	std::vector<float> values[6];
+	for (std::vector<float>& axis : values)
+		axis.assign(order.size() + SweepPadding, 0.0f);
+	for (size_t k = 0; k < order.size(); ++k)
+	{
+		const AABB& box = boxes[order[k]];
+		values[0][k] = box.min[axisA];
+		values[1][k] = box.max[axisA];
+		values[2][k] = box.min[axisB];
+		values[3][k] = box.max[axisB];
+		values[4][k] = box.min[axisC];
+		values[5][k] = box.max[axisC];
+	}
+	std::fill(values[0].begin() + order.size(), values[0].end(), std::numeric_limits<float>::infinity());
+
+	const float* const axes[6] = { values[0].data(), values[1].data(), values[2].data(), values[3].data(), values[4].data(), values[5].data() };
+	std::vector<ProxyPair> pairs;
+	kernels.ScanPairs(axes, order.data(), 0, order.size(), pairs);
+	return pairs;
+}
+
+static void CheckFrame(const SweepAndPrune& sweep, const std::vector<AABB>& boxes, TaskScheduler* scheduler)
+{
+	const std::vector<ProxyPair> expected = FindPairsBruteForce(boxes);
+	ODM_CHECK(sweep.GetObjectCount() == boxes.size());
+
+	std::vector<ProxyPair> serial, parallel;
+	sweep.FindPairs(serial);
+	sweep.FindPairs(parallel, scheduler);
+	ODM_CHECK(serial == parallel);
+	ODM_CHECK(std::all_of(serial.begin(), serial.end(), [](const ProxyPair& pair) { return pair.a < pair.b; }));
+	ODM_CHECK(Sorted(serial) == expected);
+
+	for (SimdLevel level : { SimdLevel::Baseline, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512 })
+	{
+		if (IsSimdLevelSupported(level))
+			ODM_CHECK(Sorted(ScanWithKernels(GetSweepAndPruneKernels(level), sweep, boxes)) == expected);
+	}
+}
+
+ODM_TEST(TestSweepAndPruneMatchesBruteForce)
+{
+	std::mt19937 rng(1);
+	std::vector<AABB> boxes;
+	for (int i = 0; i < 3000; ++i)
+		boxes.push_back(RandomBox(rng, 40.0f, 0.2f, 1.5f));
+
+	// Boxes on a grid of whole units touch their neighbours' faces, which AABB::Intersects does not count.
+	for (int x = 0; x < 6; ++x)
+	{
+		for (int z = 0; z < 6; ++z)
+			boxes.emplace_back(vec3(x, 0.0f, z), vec3(x + 1.0f, 1.0f, z + 1.0f));
+	}
+
+	ThreadPool pool(4);
+	SweepAndPrune sweep;
+	for (int frame = 0; frame < 8; ++frame)
+	{
+		if (frame == 4)
+		{
+			// A jump far beyond the insertion sort's budget, then a change of count; both start the order over.
+			for (AABB& box : boxes)
+				box = RandomBox(rng, 40.0f, 0.2f, 1.5f);
+		}
+		else if (frame == 6)
+			boxes.resize(boxes.size() - 500);
+		else if (frame != 0)
+		{
+			for (AABB& box : boxes)
+			{
+				const vec3 displacement = RandomPoint(rng, 0.5f);
+				box = AABB(box.min + displacement, box.max + displacement);
+			}
+		}
+
+		sweep.Update(Span<const AABB>(boxes.data(), boxes.size()), frame % 2 == 0 ? &pool : nullptr);
+		CheckFrame(sweep, boxes, &pool);
+	}
+}
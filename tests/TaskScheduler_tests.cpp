@@ -0,0 +1,42 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "Test.h"
+#include "odm/TaskScheduler.h"
+
+using namespace odm;
+
+/** Checks that every index is visited exactly once and that each chunk is the piece its number says. */
+static void CheckChunks(TaskScheduler* scheduler, size_t count, size_t chunkSize)
+{
+	std::unique_ptr<std::atomic<uint32_t>[]> visits(new std::atomic<uint32_t>[count]);
+	for (size_t i = 0; i < count; ++i)
+		visits[i] = 0;
+
+	std::atomic<uint32_t> badChunks{ 0 };
+	ParallelForChunks(scheduler, count, chunkSize, [&](uint32_t chunk, size_t begin, size_t end) {
+		if (begin != chunk * chunkSize || end != std::min(begin + chunkSize, count) || begin >= end)
+			++badChunks;
+		for (size_t i = begin; i < end; ++i)
+			++visits[i];
+	});
+
+	ODM_CHECK(badChunks == 0);
+	size_t wrongVisits = 0;
+	for (size_t i = 0; i < count; ++i)
+		wrongVisits += visits[i] != 1 ? 1 : 0;
+	ODM_CHECK(wrongVisits == 0);
+}
+
+ODM_TEST(TestParallelForChunksVisitsEachIndexOnce)
+{
+	ThreadPool one(1), many(4);
+	for (TaskScheduler* scheduler : { static_cast<TaskScheduler*>(nullptr), static_cast<TaskScheduler*>(&one), static_cast<TaskScheduler*>(&many) })
+	{
+		CheckChunks(scheduler, 0, 64);
+		CheckChunks(scheduler, 1, 64);
+		CheckChunks(scheduler, 64, 64);
+		CheckChunks(scheduler, 100003, 1000);
+		CheckChunks(scheduler, 16384 * 5 + 17, 16384);
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#ifndef _ODM_TEST_H_
+#define _ODM_TEST_H_
+
+#include <cstdint>
+#include <random>
+#include "odm/ext/AABB.h"
+
+namespace odm
+{
+	namespace tests
+	{
+		/** Adds a test to the list main runs; used through ODM_TEST. */
+		struct TestRegistration
+		{
+			TestRegistration(const char* name, void (*test)());
+		};
+
+		/** Prints a failed check and counts it against the running test; used through ODM_CHECK. */
+		void ReportFailure(const char* file, int line, const char* condition);
+
+		/** Uniform float in [lo, hi). */
+		inline float RandomFloat(std::mt19937& rng, float lo, float hi)
+		{
+			return std::uniform_real_distribution<float>(lo, hi)(rng);
+		}
+
+		/** Uniform point in the cube [-extent, extent)^3. */
+		inline vec3 RandomPoint(std::mt19937& rng, float extent)
+		{
+			return vec3(RandomFloat(rng, -extent, extent), RandomFloat(rng, -extent, extent), RandomFloat(rng, -extent, extent));
+		}
+
+		/** Box centered in the cube [-extent, extent)^3, with half sizes in [minHalf, maxHalf) along each axis. */
+		inline AABB RandomBox(std::mt19937& rng, float extent, float minHalf, float maxHalf)
+		{
+			const vec3 center = RandomPoint(rng, extent);
+			const vec3 half(RandomFloat(rng, minHalf, maxHalf), RandomFloat(rng, minHalf, maxHalf), RandomFloat(rng, minHalf, maxHalf));
+			return AABB(center - half, center + half);
+		}
+	}
+}
+
+/** Reports the condition with its file and line when it is false; the test keeps running. */
+#define ODM_CHECK(condition) \
+	do { if (!(condition)) ::odm::tests::ReportFailure(__FILE__, __LINE__, #condition); } while (0)
+
+/** Defines a test function that main runs, in the order of registration within a file. */
+#define ODM_TEST(name) \
+	static void name(); \
+	static const ::odm::tests::TestRegistration s_##name##Registration(#name, &name); \
+	static void name()
+
+#endif /* end of include guard: _ODM_TEST_H_ */
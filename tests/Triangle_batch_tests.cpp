@@ -0,0 +1,134 @@
+#include <cmath>
+#include <vector>
+#include "Test.h"
+#include "odm/ext/Triangle_batch.h"
+
+using namespace odm;
+using namespace odm::tests;
+
+static const SimdLevel s_Levels[] = { SimdLevel::Baseline, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512 };
+
+static bool SameHit(const TriangleHit& a, const TriangleHit& b)
+{
+	return a.t == b.t && a.u == b.u && a.v == b.v;
+}
+
+/** Checks every lane of both tests against the Triangle tests, bit for bit, misses included. */
+template <size_t N>
+static void CheckPacket(const TriangleKernels& kernels, const std::vector<Triangle>& triangles, const Ray& ray, float maxT)
+{
+	const TrianglePacket<N> packet(Span<const Triangle>(triangles.data(), triangles.size()));
+	const RayShear shear(ray);
+	TrianglePacketHits<N> hits, watertightHits;
+	uint32_t mask, watertightMask;
+	if constexpr (N == 4)
+	{
+		mask = kernels.Intersect4(ray, packet, maxT, hits);
+		watertightMask = kernels.IntersectWatertight4(ray, shear, packet, maxT, watertightHits);
+	}
+	else
+	{
+		mask = kernels.Intersect8(ray, packet, maxT, hits);
+		watertightMask = kernels.IntersectWatertight8(ray, shear, packet, maxT, watertightHits);
+	}
+
+	for (size_t lane = 0; lane < N; ++lane)
+	{
+		const Triangle triangle = packet.GetTriangle(lane);
+		TriangleHit expected, expectedWatertight;
+		const bool isHit = triangle.Intersect(ray, expected, maxT);
+		const bool isWatertightHit = triangle.IntersectWatertight(ray, shear, expectedWatertight, maxT);
+		ODM_CHECK(((mask >> lane) & 1u) == (isHit ? 1u : 0u));
+		ODM_CHECK(SameHit(hits.Get(lane), expected));
+		ODM_CHECK(((watertightMask >> lane) & 1u) == (isWatertightHit ? 1u : 0u));
+		ODM_CHECK(SameHit(watertightHits.Get(lane), expectedWatertight));
+	}
+	ODM_CHECK((mask >> triangles.size()) == 0 && (watertightMask >> triangles.size()) == 0);
+}
+
+/** Eight triangles around the origin in the plane z = 0; neighbours share an edge and all of them share the center. */
+static std::vector<Triangle> MakeFan()
+{
+	std::vector<vec3> rim;
+	for (int k = 0; k < 8; ++k)
+		rim.emplace_back(std::cos(k * 0.785398f), std::sin(k * 0.785398f), 0.0f);
+
+	std::vector<Triangle> fan;
+	for (int k = 0; k < 8; ++k)
+		fan.emplace_back(vec3(), rim[k], rim[(k + 1) % 8]);
+	return fan;
+}
+
+ODM_TEST(TestTriangleKernelsOnSharedEdges)
+{
+	const std::vector<Triangle> fan = MakeFan();
+	const std::vector<Triangle> half(fan.begin(), fan.begin() + 4);
+
+	// Straight down through the shared center and the middle of every shared edge, which lie inside the fan, then through the
+	// corners and edges on its rim.
+	std::vector<vec3> targets = { vec3() };
+	for (const Triangle& triangle : fan)
+		targets.push_back((triangle.v0 + triangle.v1) * 0.5f);
+	const size_t insideCount = targets.size();
+	for (const Triangle& triangle : fan)
+	{
+		targets.push_back(triangle.v1);
+		targets.push_back((triangle.v1 + triangle.v2) * 0.5f);
+	}
+
+	std::mt19937 rng(1);
+	for (SimdLevel level : s_Levels)
+	{
+		if (!IsSimdLevelSupported(level))
+			continue;
+
+		const TriangleKernels& kernels = GetTriangleKernels(level);
+		for (size_t i = 0; i < targets.size(); ++i)
+		{
+			const vec3& target = targets[i];
+			const Ray ray(target + vec3(0.0f, 0.0f, 1.0f), target - vec3(0.0f, 0.0f, 1.0f));
+			CheckPacket<4>(kernels, half, ray, 1.0f);
+			CheckPacket<8>(kernels, fan, ray, 1.0f);
+
+			// The watertight test never lets a ray through the fan between its triangles.
+			TrianglePacketHits8 hits;
+			if (i < insideCount)
+				ODM_CHECK(kernels.IntersectWatertight8(ray, RayShear(ray), TrianglePacket8(Span<const Triangle>(fan.data(), fan.size())), 1.0f, hits) != 0);
+
+			// Slanted rays aimed at the same points, from random directions.
+			const vec3 origin = target + RandomPoint(rng, 1.0f) + vec3(0.0f, 0.0f, 2.0f);
+			const Ray slanted(origin, target * 2.0f - origin);
+			CheckPacket<4>(kernels, half, slanted, 1.0f);
+			CheckPacket<8>(kernels, fan, slanted, 1.0f);
+		}
+	}
+}
+
+ODM_TEST(TestTriangleKernelsMatchScalar)
+{
+	std::mt19937 rng(2);
+	for (SimdLevel level : s_Levels)
+	{
+		if (!IsSimdLevelSupported(level))
+			continue;
+
+		const TriangleKernels& kernels = GetTriangleKernels(level);
+		for (int i = 0; i < 2000; ++i)
+		{
+			// Partial packets too, whose empty lanes hold NaN corners.
+			const size_t count = 1 + i % 8;
+			std::vector<Triangle> triangles;
+			for (size_t k = 0; k < count; ++k)
+			{
+				const vec3 center = RandomPoint(rng, 2.0f);
+				triangles.emplace_back(center + RandomPoint(rng, 1.5f), center + RandomPoint(rng, 1.5f), center + RandomPoint(rng, 1.5f));
+			}
+
+			const Ray ray(RandomPoint(rng, 4.0f), RandomPoint(rng, 4.0f));
+			const float maxT = i % 3 == 0 ? 0.5f : 1.0f;
+			if (count <= 4)
+				CheckPacket<4>(kernels, triangles, ray, maxT);
+			CheckPacket<8>(kernels, triangles, ray, maxT);
+		}
+	}
+}
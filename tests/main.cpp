@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <vector>
+#include "Test.h"
+
+namespace odm
+{
+	namespace tests
+	{
+		struct RegisteredTest
+		{
+			const char* name;
+			void (*test)();
+		};
+
+		/** A function-local list, so registrations from other files' static initializers find it constructed. */
+		static std::vector<RegisteredTest>& GetTests()
+		{
+			static std::vector<RegisteredTest> tests;
+			return tests;
+		}
+
+		static int s_Failures = 0;
+
+		TestRegistration::TestRegistration(const char* name, void (*test)())
+		{
+			GetTests().push_back({ name, test });
+		}
+
+		void ReportFailure(const char* file, int line, const char* condition)
+		{
+			std::printf("%s:%d: check failed: %s\n", file, line, condition);
+			++s_Failures;
+		}
+	}
+}
+
+int main()
+{
+	using namespace odm::tests;
+
+	int failedTests = 0;
+	for (const RegisteredTest& test : GetTests())
+	{
+		const int failuresBefore = s_Failures;
+		test.test();
+		if (s_Failures != failuresBefore)
+		{
+			std::printf("FAILED %s (%d checks)\n", test.name, s_Failures - failuresBefore);
+			++failedTests;
+		}
+	}
+
+	std::printf("%d of %zu tests failed\n", failedTests, GetTests().size());
+	return failedTests != 0 ? 1 : 0;
+}